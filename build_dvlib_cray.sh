@@ -33,18 +33,12 @@ else
 	LIBLSBL="-L $SDAVI_LIBLSB_PATH/lib/ -llsb -Wl,-rpath,$SDAVI_LIBLSB_PATH/lib/"
 fi
 
-# currently only for testing: deactivate actual put operation for redirected files
-# uncomment the -D compile option flag, if desired
-# only available for netcdf at the moment
-no_data_during_redirect=""
-#no_data_during_redirect="-D__WRITE_NO_DATA_DURING_REDIRECT__"
-
 # DVLib for NetCDF
 if [ "$SDAVI_BUILD_FOR_NETCDF" = "YES" ]; then
 	echo "Building lib/libdvl.so for netcdf"
-	cc $NETCDFI $LIBLSBI $no_data_during_redirect -Wall -fPIC -shared -std=c99 -O2 -o lib/libdvl.so src/dvlib/*.c  src/dvlib/extended_api/*.c -ldl $NETCDFL $LIBLSBL -lnetcdf
+	cc $NETCDFI $LIBLSBI -Wall -fPIC -shared -std=c99 -O2 -o lib/libdvl.so src/dvlib/*.c  src/dvlib/extended_api/*.c -ldl -lrt $NETCDFL $LIBLSBL -lnetcdf
 	echo "Building lib/libdvlmt.so for netcdf (multithreading-aware for multithreaded clients; note: netcdf itself is *not* thread-safe; client application must handle that)"
-	cc $NETCDFI $LIBLSBI $no_data_during_redirect -Wall -Wno-unused-variable -Wno-unused-but-set-variable -fPIC -shared -std=c99 -O2 -D__MT__ -o lib/libdvlmt.so src/dvlib/*.c src/dvlib/extended_api/*.c -ldl $NETCDFL $LIBLSBL -lnetcdf -pthread
+	cc $NETCDFI $LIBLSBI -Wall -Wno-unused-variable -Wno-unused-but-set-variable -fPIC -shared -std=c99 -O2 -D__MT__ -o lib/libdvlmt.so src/dvlib/*.c src/dvlib/extended_api/*.c -ldl -lrt $NETCDFL $LIBLSBL -lnetcdf -pthread
 fi
 
 # DVLib for Parallel NetCDF (libdvlpn.so) not active at the moment
@@ -53,7 +47,9 @@ fi
 # module unload cray-parallel-netcdf
 # PNETCDFI="-I /opt/cray/pe/parallel-netcdf/1.7.0/GNU/5.1/include/"
 # PNETCDFL="-L /opt/cray/pe/parallel-netcdf/1.7.0/GNU/5.1/lib/"
-# cc $PNETCDFI $MPILIBLSBI $USERDMA $GNII -Wall -fPIC -shared -std=c99 -O2 -D__NCMPI__ -D__FLASH__ -o lib/libdvlpn.so src/dvlib/pnetcdf/*.c src/dvlib/dvl.c src/dvlib/dvl_proxy.c src/dvlib/dvl_rdma.c  -ldl $PNETCDFL $MPILIBLSBL -lpnetcdf
+# cc $PNETCDFI $MPILIBLSBI $USERDMA $GNII -Wall -fPIC -shared -std=c99 -O2 -D__NCMPI__ -D__FLASH__ -o lib/libdvlpn.so src/dvlib/pnetcdf/*.c src/dvlib/dvl.c src/dvlib/dvl_proxy.c src/dvlib/dvl_shm.c src/dvlib/dvl_lease.c src/dvlib/dvl_report.c src/dvlib/dvl_lcache.c src/dvlib/dvl_readahead.c src/dvlib/dvl_rdma.c  -ldl -lrt $PNETCDFL $MPILIBLSBL -lpnetcdf
+# multithreading-aware variant (MPI must be initialized with MPI_THREAD_MULTIPLE):
+# cc $PNETCDFI $MPILIBLSBI $USERDMA $GNII -Wall -Wno-unused-variable -Wno-unused-but-set-variable -fPIC -shared -std=c99 -O2 -D__NCMPI__ -D__FLASH__ -D__MT__ -o lib/libdvlpnmt.so src/dvlib/pnetcdf/*.c src/dvlib/dvl.c src/dvlib/dvl_proxy.c src/dvlib/dvl_shm.c src/dvlib/dvl_lease.c src/dvlib/dvl_report.c src/dvlib/dvl_lcache.c src/dvlib/dvl_readahead.c src/dvlib/dvl_rdma.c  -ldl -lrt $PNETCDFL $MPILIBLSBL -lpnetcdf -pthread
 
 
 # DVLib for HDF5
@@ -63,14 +59,18 @@ if [ "$SDAVI_BUILD_FOR_HDF5" = "YES" ]; then
 	# hdf5-v1.10 is used by netcdf (thus, unload it first)
 	module unload cray-hdf5
 	module load cray-hdf5/1.8.16 
-	cc $HDF5_8I $LIBLSBI -Wall -fPIC -shared -std=c99 -O2 -D__HDF5__ -D__HDF5_1_8__ -D__FLASH__ -o lib/libdvlh8.so src/dvlib/hdf5/*.c src/dvlib/dvl.c src/dvlib/dvl_proxy.c src/dvlib/dvl_rdma.c src/dvlib/extended_api/*.c -ldl $HDF5_8L $LIBLSBL -lhdf5
+	cc $HDF5_8I $LIBLSBI -Wall -fPIC -shared -std=c99 -O2 -D__HDF5__ -D__HDF5_1_8__ -D__FLASH__ -o lib/libdvlh8.so src/dvlib/hdf5/*.c src/dvlib/dvl.c src/dvlib/dvl_proxy.c src/dvlib/dvl_shm.c src/dvlib/dvl_lease.c src/dvlib/dvl_report.c src/dvlib/dvl_lcache.c src/dvlib/dvl_readahead.c src/dvlib/dvl_rdma.c src/dvlib/extended_api/*.c -ldl -lrt $HDF5_8L $LIBLSBL -lhdf5
+	echo "Building lib/libdvlh8mt.so for HDF5 v1.8.16 (multithreading-aware; note: HDF5 must be built thread-safe)"
+	cc $HDF5_8I $LIBLSBI -Wall -Wno-unused-variable -Wno-unused-but-set-variable -fPIC -shared -std=c99 -O2 -D__HDF5__ -D__HDF5_1_8__ -D__FLASH__ -D__MT__ -o lib/libdvlh8mt.so src/dvlib/hdf5/*.c src/dvlib/dvl.c src/dvlib/dvl_proxy.c src/dvlib/dvl_shm.c src/dvlib/dvl_lease.c src/dvlib/dvl_report.c src/dvlib/dvl_lcache.c src/dvlib/dvl_readahead.c src/dvlib/dvl_rdma.c src/dvlib/extended_api/*.c -ldl -lrt $HDF5_8L $LIBLSBL -lhdf5 -pthread
     echo "Building lib/libhdf5profiler8.so for HDF5 v1.8.16 for FLASH simulator"
     cc $HDF5_8I $LIBLSBI -Wall -fPIC -shared -std=c99 -O2 -D__HDF5_1_8__ -o lib/libhdf5profiler8.so hdf5_profiler/hdf5_bind.c -ldl $HDF5_8L $LIBLSBL -lhdf5
 	echo "Building lib/libdvlh10.so for HDF5 v1.10 for h5py"
 	# restore default, which is v1.10 (please adjust if it is different)
 	module unload cray-hdf5
 	module load cray-hdf5
-	cc $HDF5_10I $LIBLSBI -Wall -fPIC -shared -std=c99 -O2 -D__HDF5__ -D__HDF5_1_10__ -D__FLASH__ -o lib/libdvlh10.so src/dvlib/hdf5/*.c src/dvlib/dvl.c src/dvlib/dvl_proxy.c src/dvlib/dvl_rdma.c src/dvlib/extended_api/*.c -ldl $HDF5_10L $LIBLSBL -lhdf5
+	cc $HDF5_10I $LIBLSBI -Wall -fPIC -shared -std=c99 -O2 -D__HDF5__ -D__HDF5_1_10__ -D__FLASH__ -o lib/libdvlh10.so src/dvlib/hdf5/*.c src/dvlib/dvl.c src/dvlib/dvl_proxy.c src/dvlib/dvl_shm.c src/dvlib/dvl_lease.c src/dvlib/dvl_report.c src/dvlib/dvl_lcache.c src/dvlib/dvl_readahead.c src/dvlib/dvl_rdma.c src/dvlib/extended_api/*.c -ldl -lrt $HDF5_10L $LIBLSBL -lhdf5
+	echo "Building lib/libdvlh10mt.so for HDF5 v1.10 (multithreading-aware; note: HDF5 must be built thread-safe)"
+	cc $HDF5_10I $LIBLSBI -Wall -Wno-unused-variable -Wno-unused-but-set-variable -fPIC -shared -std=c99 -O2 -D__HDF5__ -D__HDF5_1_10__ -D__FLASH__ -D__MT__ -o lib/libdvlh10mt.so src/dvlib/hdf5/*.c src/dvlib/dvl.c src/dvlib/dvl_proxy.c src/dvlib/dvl_shm.c src/dvlib/dvl_lease.c src/dvlib/dvl_report.c src/dvlib/dvl_lcache.c src/dvlib/dvl_readahead.c src/dvlib/dvl_rdma.c src/dvlib/extended_api/*.c -ldl -lrt $HDF5_10L $LIBLSBL -lhdf5 -pthread
     echo "Building lib/libhdf5profiler10.so for HDF5 v1.10 for h5py"
     cc $HDF5_10I $LIBLSBI -Wall -fPIC -shared -std=c99 -O2 -D__HDF5_1_10__ -o lib/libhdf5profiler10.so hdf5_profiler/hdf5_bind.c -ldl $HDF5_10L $LIBLSBL -lhdf5
 	module load cray-netcdf
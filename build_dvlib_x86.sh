@@ -64,26 +64,24 @@ else
 	LIBLSBL="-L $SDAVI_LIBLSB_PATH/lib/ -llsb -Wl,-rpath,$SDAVI_LIBLSB_PATH/lib/"
 fi
 
-# currently only for testing: deactivate actual put/write operation for redirected files
-# uncomment the -D compile option flag, if desired
-# only available for netcdf at the moment
-no_data_during_redirect=""
-#no_data_during_redirect="-D__WRITE_NO_DATA_DURING_REDIRECT__"
-
 # DVLib for NetCDF
 if [ "$SDAVI_BUILD_FOR_NETCDF" = "YES" ]; then
 	echo "Building build/lib/libdvl.so for netcdf"
-	gcc $NETCDFI $LIBLSBI $no_data_during_redirect -Wall -fPIC -shared -std=c99 -O2 -o build/lib/libdvl${suffix}.so src/dvlib/*.c src/dvlib/extended_api/*.c -ldl $NETCDFL $LIBLSBL -lnetcdf
+	gcc $NETCDFI $LIBLSBI -Wall -fPIC -shared -std=c99 -O2 -o build/lib/libdvl${suffix}.so src/dvlib/*.c src/dvlib/extended_api/*.c -ldl -lrt $NETCDFL $LIBLSBL -lnetcdf
 	echo "Building build/lib/libdvlmt.so for netcdf (multithreading-aware for multithreaded clients; note: netcdf itself is *not* thread-safe; client application must handle that)"
-	gcc $NETCDFI $LIBLSBI $no_data_during_redirect -Wall -Wno-unused-variable -Wno-unused-but-set-variable -fPIC -shared -std=c99 -O2 -D__MT__ -o build/lib/libdvlmt${suffix}.so src/dvlib/*.c src/dvlib/extended_api/*.c -ldl $NETCDFL $LIBLSBL -lnetcdf -pthread
+	gcc $NETCDFI $LIBLSBI -Wall -Wno-unused-variable -Wno-unused-but-set-variable -fPIC -shared -std=c99 -O2 -D__MT__ -o build/lib/libdvlmt${suffix}.so src/dvlib/*.c src/dvlib/extended_api/*.c -ldl -lrt $NETCDFL $LIBLSBL -lnetcdf -pthread
 fi
 
 # DVLib for HDF5
 if [ "$SDAVI_BUILD_FOR_HDF5" = "YES" ]; then
 	echo "Building build/lib/libdvlh8.so for HDF5 v1.8.16"
-	gcc $HDF5_8I $LIBLSBI -Wall -fPIC -shared -std=c99 -O2 -D__HDF5__ -D__HDF5_1_8__ -D__FLASH__ -o build/lib/libdvlh8${suffix}.so src/dvlib/hdf5/*.c src/dvlib/dvl.c src/dvlib/dvl_proxy.c src/dvlib/dvl_rdma.c src/dvlib/extended_api/*.c -ldl $HDF5_8L $LIBLSBL -lhdf5
+	gcc $HDF5_8I $LIBLSBI -Wall -fPIC -shared -std=c99 -O2 -D__HDF5__ -D__HDF5_1_8__ -D__FLASH__ -o build/lib/libdvlh8${suffix}.so src/dvlib/hdf5/*.c src/dvlib/dvl.c src/dvlib/dvl_proxy.c src/dvlib/dvl_shm.c src/dvlib/dvl_lease.c src/dvlib/dvl_report.c src/dvlib/dvl_lcache.c src/dvlib/dvl_readahead.c src/dvlib/dvl_rdma.c src/dvlib/extended_api/*.c -ldl -lrt $HDF5_8L $LIBLSBL -lhdf5
+	echo "Building build/lib/libdvlh8mt.so for HDF5 v1.8.16 (multithreading-aware; note: HDF5 must be built thread-safe)"
+	gcc $HDF5_8I $LIBLSBI -Wall -Wno-unused-variable -Wno-unused-but-set-variable -fPIC -shared -std=c99 -O2 -D__HDF5__ -D__HDF5_1_8__ -D__FLASH__ -D__MT__ -o build/lib/libdvlh8mt${suffix}.so src/dvlib/hdf5/*.c src/dvlib/dvl.c src/dvlib/dvl_proxy.c src/dvlib/dvl_shm.c src/dvlib/dvl_lease.c src/dvlib/dvl_report.c src/dvlib/dvl_lcache.c src/dvlib/dvl_readahead.c src/dvlib/dvl_rdma.c src/dvlib/extended_api/*.c -ldl -lrt $HDF5_8L $LIBLSBL -lhdf5 -pthread
 	echo "Building build/lib/libdvlh10.so for HDF5 v1.10 (h5py)"
-	gcc $HDF5_10I $LIBLSBI -Wall -fPIC -shared -std=c99 -O2 -D__HDF5__ -D__HDF5_1_10__ -D__FLASH__ -o build/lib/libdvlh10${suffix}.so src/dvlib/hdf5/*.c src/dvlib/dvl.c src/dvlib/dvl_proxy.c src/dvlib/dvl_rdma.c src/dvlib/extended_api/*.c -ldl $HDF5_10L $LIBLSBL -lhdf5
+	gcc $HDF5_10I $LIBLSBI -Wall -fPIC -shared -std=c99 -O2 -D__HDF5__ -D__HDF5_1_10__ -D__FLASH__ -o build/lib/libdvlh10${suffix}.so src/dvlib/hdf5/*.c src/dvlib/dvl.c src/dvlib/dvl_proxy.c src/dvlib/dvl_shm.c src/dvlib/dvl_lease.c src/dvlib/dvl_report.c src/dvlib/dvl_lcache.c src/dvlib/dvl_readahead.c src/dvlib/dvl_rdma.c src/dvlib/extended_api/*.c -ldl -lrt $HDF5_10L $LIBLSBL -lhdf5
+	echo "Building build/lib/libdvlh10mt.so for HDF5 v1.10 (multithreading-aware; note: HDF5 must be built thread-safe)"
+	gcc $HDF5_10I $LIBLSBI -Wall -Wno-unused-variable -Wno-unused-but-set-variable -fPIC -shared -std=c99 -O2 -D__HDF5__ -D__HDF5_1_10__ -D__FLASH__ -D__MT__ -o build/lib/libdvlh10mt${suffix}.so src/dvlib/hdf5/*.c src/dvlib/dvl.c src/dvlib/dvl_proxy.c src/dvlib/dvl_shm.c src/dvlib/dvl_lease.c src/dvlib/dvl_report.c src/dvlib/dvl_lcache.c src/dvlib/dvl_readahead.c src/dvlib/dvl_rdma.c src/dvlib/extended_api/*.c -ldl -lrt $HDF5_10L $LIBLSBL -lhdf5 -pthread
     echo "Building build/lib/libhdf5profiler8.so for HDF5 v1.8.16"
     gcc $HDF5_8I $LIBLSBI -Wall -fPIC -shared -std=c99 -O2 -D__HDF5_1_8__ -o build/lib/libhdf5profiler8${suffix}.so hdf5_profiler/hdf5_bind.c -ldl $HDF5_8L $LIBLSBL -lhdf5
     echo "Building build/lib/libhdf5profiler10.so for HDF5 v1.10 (h5py)"
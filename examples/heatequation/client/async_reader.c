@@ -0,0 +1,126 @@
+/*
+ * Heat equation client using the asynchronous open API of DVLib.
+ *
+ * The reader walks forward through ../output/data_<i> with a fixed step. While it
+ * analyzes file i, the open of file i + step is already announced to DV
+ * (sdavi_open_async), which starts the re-simulation in the background. The
+ * remaining accesses are given to DV as hints up front (sdavi_hint). Thus, the
+ * analysis (compute) overlaps with the simulation of the next files.
+ *
+ * build (netCDF variant of DVLib):
+ *   gcc -std=c99 -O2 -o async_reader async_reader.c -I<netcdf>/include -I<simfs>/src/dvlib/extended_api \
+ *       -L<simfs>/build/lib -ldvl -L<netcdf>/lib -lnetcdf
+ *
+ * run (DV must be running with dv_config_files/heatequation.dv):
+ *   ./async_reader [first] [last] [step] [compute_ms]
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <netcdf.h>
+
+#include "dvl_extended_api.h"
+
+#define RESULT_PATH "../output/data_"
+#define MAX_NAME 256
+#define MAX_HINTS 1024
+
+static double now_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1.0e6;
+}
+
+static void make_name(char *name, int i) {
+    snprintf(name, MAX_NAME, "%s%i", RESULT_PATH, i);
+}
+
+/* reads the data variable and simulates some analysis work */
+static double analyze(const char *name, int compute_ms) {
+    int ncid, varid;
+    double sum = 0.0;
+
+    if (nc_open(name, NC_NOWRITE, &ncid) != NC_NOERR) {
+        fprintf(stderr, "cannot open %s\n", name);
+        return 0.0;
+    }
+
+    if (nc_inq_varid(ncid, "data", &varid) == NC_NOERR) {
+        static double data[100 * 100];
+        if (nc_get_var_double(ncid, varid, data) == NC_NOERR) {
+            for (int k = 0; k < 100 * 100; k++) {
+                sum += data[k];
+            }
+        }
+    }
+    nc_close(ncid);
+
+    usleep(compute_ms * 1000);
+    return sum / (100 * 100);
+}
+
+int main(int argc, char *argv[]) {
+    int first = argc > 1 ? atoi(argv[1]) : 20;
+    int last = argc > 2 ? atoi(argv[2]) : 1000;
+    int step = argc > 3 ? atoi(argv[3]) : 20;
+    int compute_ms = argc > 4 ? atoi(argv[4]) : 500;
+
+    if (step <= 0 || last < first) {
+        fprintf(stderr, "usage: %s [first] [last] [step > 0] [compute_ms]\n", argv[0]);
+        return 1;
+    }
+
+    // announce the complete trajectory
+    static char names[MAX_HINTS][MAX_NAME];
+    const char *hints[MAX_HINTS];
+    int n = 0;
+    for (int i = first; i <= last && n < MAX_HINTS; i += step) {
+        make_name(names[n], i);
+        hints[n] = names[n];
+        n++;
+    }
+    sdavi_hint(hints, n);
+
+    char name[MAX_NAME];
+    make_name(name, first);
+    int64_t current = sdavi_open_async(name);
+
+    double total_wait = 0.0;
+    double start = now_ms();
+
+    for (int i = first; i <= last; i += step) {
+        // prefetch the next file while this one is analyzed
+        int64_t next = -1;
+        char next_name[MAX_NAME];
+        if (i + step <= last) {
+            make_name(next_name, i + step);
+            next = sdavi_open_async(next_name);
+        }
+
+        double t = now_ms();
+        if (0 <= current) {
+            sdavi_wait(current);
+        }
+        double waited = now_ms() - t;
+        total_wait += waited;
+
+        make_name(name, i);
+        double mean = analyze(name, compute_ms);
+        printf("%s: mean %f; waited %.1f ms\n", name, mean, waited);
+
+        if (0 <= current) {
+            sdavi_release(current);
+        }
+        current = next;
+    }
+
+    double total = now_ms() - start;
+    printf("total %.1f ms; waiting %.1f ms; overlap of compute and simulation: %.1f %%\n",
+           total, total_wait, total > 0.0 ? 100.0 * (1.0 - total_wait / total) : 0.0);
+    return 0;
+}
@@ -0,0 +1,96 @@
+/*
+ * Open rate benchmark of the DVLib path cache (see normalize_path() in dvl.c).
+ *
+ * Opens available result files through dirs distinct directory spellings: symlinks
+ * path_bench_dirs/d<k> -> ../../output (created by this program). Every other open goes through
+ * d0 (hot directory), the others cycle through d1 .. d<dirs-1>. With more directories than
+ * MAX_PATH_CACHE_ENTRIES, the cache has to evict entries while the hot one should stay cached.
+ *
+ * Run it with the default path cache, with DV_PATH_CACHE=2 (validated entries) and with
+ * DV_PATH_CACHE=0 (realpath() per open) to compare; DVLib prints the hits and misses of the
+ * path cache at finalize.
+ *
+ * build (netCDF variant of DVLib):
+ *   gcc -std=c99 -O2 -o path_bench path_bench.c -I<netcdf>/include \
+ *       -L<simfs>/build/lib -ldvl -L<netcdf>/lib -lnetcdf
+ *
+ * run (DV must be running with dv_config_files/heatequation.dv; the files must be available):
+ *   ./path_bench [first] [last] [dirs] [opens]
+ *   DV_PATH_CACHE=0 ./path_bench [first] [last] [dirs] [opens]
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <netcdf.h>
+
+#define DIRS_PATH "path_bench_dirs"
+#define TARGET "../../output"
+#define MAX_NAME 256
+
+static double now_s() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1.0e9;
+}
+
+static int make_dirs(int dirs) {
+    if (mkdir(DIRS_PATH, 0755) != 0 && errno != EEXIST) {
+        perror("cannot create " DIRS_PATH);
+        return -1;
+    }
+
+    char name[MAX_NAME];
+    for (int k = 0; k < dirs; k++) {
+        snprintf(name, MAX_NAME, "%s/d%i", DIRS_PATH, k);
+        if (symlink(TARGET, name) != 0 && errno != EEXIST) {
+            perror("cannot create symlink");
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    int first = argc > 1 ? atoi(argv[1]) : 1;
+    int last = argc > 2 ? atoi(argv[2]) : 10;
+    int dirs = argc > 3 ? atoi(argv[3]) : 256;
+    int opens = argc > 4 ? atoi(argv[4]) : 10000;
+    if (last < first || dirs < 2 || opens <= 0) {
+        fprintf(stderr, "usage: %s [first] [last] [dirs >= 2] [opens]\n", argv[0]);
+        return 2;
+    }
+
+    if (make_dirs(dirs) != 0) {
+        return 1;
+    }
+
+    char name[MAX_NAME];
+    int errors = 0;
+    int cold = 0;
+    double start = now_s();
+    for (int i = 0; i < opens; i++) {
+        int dir = (i % 2 == 0) ? 0 : 1 + (cold++ % (dirs - 1));
+        int nr = first + i % (last - first + 1);
+        snprintf(name, MAX_NAME, "%s/d%i/data_%i", DIRS_PATH, dir, nr);
+
+        int ncid;
+        if (nc_open(name, NC_NOWRITE, &ncid) != NC_NOERR) {
+            errors++;
+            continue;
+        }
+        nc_close(ncid);
+    }
+    double t = now_s() - start;
+
+    char *mode = getenv("DV_PATH_CACHE");
+    printf("path cache %s: %i opens through %i directories in %.3f s: %.0f opens/s, %i errors\n",
+           mode != NULL ? mode : "default", opens, dirs, t, 0.0 < t ? opens / t : 0.0, errors);
+    return errors == 0 ? 0 : 1;
+}
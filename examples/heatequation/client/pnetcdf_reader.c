@@ -0,0 +1,80 @@
+/*
+ * Heat equation client using collective PnetCDF calls (PnetCDF variant of DVLib).
+ *
+ * All ranks open ../output/data_<i> collectively and read a block of rows of the
+ * data variable (ncmpi_get_vara_double_all). With the default DV_NCMPI_COLLECTIVE=1,
+ * only rank 0 talks to DV and broadcasts the reply; DV_NCMPI_COLLECTIVE=0 lets every
+ * rank send its own requests (compare the request counts in the DV log).
+ *
+ * build:
+ *   mpicc -std=c99 -O2 -o pnetcdf_reader pnetcdf_reader.c -I<pnetcdf>/include \
+ *       -L<simfs>/build/lib -ldvlpn -L<pnetcdf>/lib -lpnetcdf
+ *
+ * run (DV must be running with dv_config_files/heatequation.dv):
+ *   mpirun -n 4 ./pnetcdf_reader [first] [last] [step]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <mpi.h>
+#include <pnetcdf.h>
+
+#define RESULT_PATH "../output/data_"
+#define MAX_NAME 256
+#define N 100
+
+int main(int argc, char *argv[]) {
+    MPI_Init(&argc, &argv);
+
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    int first = argc > 1 ? atoi(argv[1]) : 20;
+    int last = argc > 2 ? atoi(argv[2]) : 100;
+    int step = argc > 3 ? atoi(argv[3]) : 20;
+    if (step <= 0) {
+        step = 1;
+    }
+
+    // block of rows of this rank
+    MPI_Offset rows = N / size;
+    MPI_Offset start[2] = {rank * rows, 0};
+    MPI_Offset count[2] = {rank == size - 1 ? N - rank * rows : rows, N};
+
+    double *data = malloc(count[0] * N * sizeof(double));
+    char name[MAX_NAME];
+
+    for (int i = first; i <= last; i += step) {
+        snprintf(name, MAX_NAME, "%s%i", RESULT_PATH, i);
+
+        double t = MPI_Wtime();
+        int ncid, varid;
+        if (ncmpi_open(MPI_COMM_WORLD, name, NC_NOWRITE, MPI_INFO_NULL, &ncid) != NC_NOERR) {
+            if (rank == 0) {
+                fprintf(stderr, "cannot open %s\n", name);
+            }
+            continue;
+        }
+
+        double local = 0.0;
+        if (ncmpi_inq_varid(ncid, "data", &varid) == NC_NOERR
+            && ncmpi_get_vara_double_all(ncid, varid, start, count, data) == NC_NOERR) {
+            for (MPI_Offset k = 0; k < count[0] * N; k++) {
+                local += data[k];
+            }
+        }
+        ncmpi_close(ncid);
+
+        double sum = 0.0;
+        MPI_Reduce(&local, &sum, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+        if (rank == 0) {
+            printf("%s: mean %f; %.1f ms\n", name, sum / (N * N), (MPI_Wtime() - t) * 1000.0);
+        }
+    }
+
+    free(data);
+    MPI_Finalize();
+    return 0;
+}
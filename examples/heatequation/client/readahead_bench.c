@@ -0,0 +1,117 @@
+/*
+ * First-read latency benchmark of the DVLib readahead hints.
+ *
+ * Walks forward through ../output/data_<i> with a fixed step and measures the time of the
+ * first read of each file (nc_get_var of the data variable right after nc_open) and of the
+ * nc_open itself (the variants without MT issue the advice at the next nc_close). Before the
+ * walk, the files are dropped from the page cache of this node (posix_fadvise DONTNEED) so
+ * that every first read is cold unless DVLib has announced the file in time. compute_ms
+ * emulates the analysis between two files; the readahead works during this time.
+ *
+ * Run it once with readahead (e.g. DV_READAHEAD=2; off by default) and once with DV_READAHEAD=0
+ * to compare.
+ * The first files of the walk are read cold in both runs: DV needs a few opens to detect
+ * the stride.
+ *
+ * build (netCDF variant of DVLib):
+ *   gcc -std=c99 -O2 -o readahead_bench readahead_bench.c -I<netcdf>/include \
+ *       -L<simfs>/build/lib -ldvl -L<netcdf>/lib -lnetcdf
+ *
+ * run (DV must be running with dv_config_files/heatequation.dv; the files should be available):
+ *   DV_READAHEAD=2 ./readahead_bench [first] [last] [step] [compute_ms]
+ *   DV_READAHEAD=0 ./readahead_bench [first] [last] [step] [compute_ms]
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <netcdf.h>
+
+#define RESULT_PATH "../output/data_"
+#define MAX_NAME 256
+
+static double now_us() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1.0e6 + ts.tv_nsec / 1.0e3;
+}
+
+static void make_name(char *name, int i) {
+    snprintf(name, MAX_NAME, "%s%i", RESULT_PATH, i);
+}
+
+static void drop_from_page_cache(const char *name) {
+    int fd = open(name, O_RDONLY);
+    if (fd < 0) {
+        return;
+    }
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+}
+
+/* time of the first read of the file in us (open_us: time of nc_open); < 0 on error */
+static double first_read_us(const char *name, double *open_us) {
+    int ncid, varid;
+    double open_start = now_us();
+    if (nc_open(name, NC_NOWRITE, &ncid) != NC_NOERR) {
+        fprintf(stderr, "cannot open %s\n", name);
+        return -1.0;
+    }
+    *open_us = now_us() - open_start;
+
+    double t = -1.0;
+    if (nc_inq_varid(ncid, "data", &varid) == NC_NOERR) {
+        static double data[100 * 100];
+        double start = now_us();
+        if (nc_get_var_double(ncid, varid, data) == NC_NOERR) {
+            t = now_us() - start;
+        }
+    }
+
+    nc_close(ncid);
+    return t;
+}
+
+int main(int argc, char *argv[]) {
+    int first = argc > 1 ? atoi(argv[1]) : 1;
+    int last = argc > 2 ? atoi(argv[2]) : 100;
+    int step = argc > 3 ? atoi(argv[3]) : 1;
+    int compute_ms = argc > 4 ? atoi(argv[4]) : 50;
+    if (step <= 0) {
+        step = 1;
+    }
+
+    char name[MAX_NAME];
+    for (int i = first; i <= last; i += step) {
+        make_name(name, i);
+        drop_from_page_cache(name);
+    }
+
+    double total_us = 0.0;
+    double total_open_us = 0.0;
+    double max_us = 0.0;
+    int files = 0;
+    for (int i = first; i <= last; i += step) {
+        make_name(name, i);
+        double open_us = 0.0;
+        double t = first_read_us(name, &open_us);
+        if (0.0 <= t) {
+            total_us += t;
+            total_open_us += open_us;
+            max_us = t > max_us ? t : max_us;
+            files++;
+            printf("%s: open %.1f us, first read %.1f us\n", name, open_us, t);
+        }
+        usleep(compute_ms * 1000);
+    }
+
+    printf("readahead %s: %i files, mean open %.1f us, mean first read %.1f us, max %.1f us\n",
+           getenv("DV_READAHEAD") != NULL && 0 < atoi(getenv("DV_READAHEAD")) ? "on" : "off",
+           files, 0 < files ? total_open_us / files : 0.0, 0 < files ? total_us / files : 0.0, max_us);
+    return 0;
+}
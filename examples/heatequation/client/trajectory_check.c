@@ -0,0 +1,119 @@
+/*
+ * Trajectory replay check of the stride prefetcher (forward and backward, see PrefetchContext).
+ *
+ * Opens ../output/data_<nr> along a trajectory and measures the time of each nc_open(), which
+ * blocks while DV (re-)simulates the file. compute_ms emulates the analysis between two files.
+ * After the first warmup opens (DV needs a few opens to detect the stride and to estimate
+ * alpha and tau), the prefetcher should have launched the simulations ahead of the client:
+ * opens that take longer than wait_ms are reported as WAIT and make the check fail.
+ *
+ * trajectory:
+ *   first:last:step   e.g. 100:1:-1 for a backward walk, 1:100:2 for a forward walk
+ *   file              nrs separated by white space (e.g. recorded from the CLIENT_OPEN events of DV)
+ *
+ * build (netCDF variant of DVLib):
+ *   gcc -std=c99 -O2 -o trajectory_check trajectory_check.c -I<netcdf>/include \
+ *       -L<simfs>/build/lib -ldvl -L<netcdf>/lib -lnetcdf
+ *
+ * run (DV must be running with dv_config_files/heatequation.dv; remove the output files first
+ * so that the walk depends on re-simulations):
+ *   ./trajectory_check trajectory [compute_ms] [warmup] [wait_ms]
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <netcdf.h>
+
+#define RESULT_PATH "../output/data_"
+#define MAX_NAME 256
+#define MAX_NRS 100000
+
+static double now_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1.0e3 + ts.tv_nsec / 1.0e6;
+}
+
+/* number of nrs read into nrs; < 0 on error */
+static int read_trajectory(const char *spec, int *nrs) {
+    int first, last, step;
+    char tail;
+    if (sscanf(spec, "%d:%d:%d%c", &first, &last, &step, &tail) == 3) {
+        if (step == 0 || (0 < step && last < first) || (step < 0 && first < last)) {
+            fprintf(stderr, "step %i does not lead from %i to %i\n", step, first, last);
+            return -1;
+        }
+        int count = 0;
+        for (int nr = first; count < MAX_NRS && (0 < step ? nr <= last : last <= nr); nr += step) {
+            nrs[count++] = nr;
+        }
+        return count;
+    }
+
+    FILE *f = fopen(spec, "r");
+    if (f == NULL) {
+        fprintf(stderr, "cannot open trajectory %s\n", spec);
+        return -1;
+    }
+    int count = 0;
+    while (count < MAX_NRS && fscanf(f, "%d", &nrs[count]) == 1) {
+        count++;
+    }
+    fclose(f);
+    return count;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s first:last:step|file [compute_ms] [warmup] [wait_ms]\n", argv[0]);
+        return 2;
+    }
+    int compute_ms = argc > 2 ? atoi(argv[2]) : 50;
+    int warmup = argc > 3 ? atoi(argv[3]) : 5;
+    double wait_ms = argc > 4 ? atof(argv[4]) : 100.0;
+
+    static int nrs[MAX_NRS];
+    int count = read_trajectory(argv[1], nrs);
+    if (count <= 0) {
+        return 2;
+    }
+
+    char name[MAX_NAME];
+    int waits = 0;
+    int errors = 0;
+    double total_ms = 0.0;
+    for (int i = 0; i < count; i++) {
+        snprintf(name, MAX_NAME, "%s%i", RESULT_PATH, nrs[i]);
+
+        int ncid;
+        double start = now_ms();
+        if (nc_open(name, NC_NOWRITE, &ncid) != NC_NOERR) {
+            fprintf(stderr, "cannot open %s\n", name);
+            errors++;
+            continue;
+        }
+        double t = now_ms() - start;
+        nc_close(ncid);
+
+        int counted = warmup <= i;
+        int wait = counted && wait_ms < t;
+        if (counted) {
+            total_ms += t;
+            waits += wait;
+        }
+        printf("%5i %s: open %.1f ms%s\n", i, name, t, wait ? " WAIT" : (counted ? "" : " (warmup)"));
+
+        usleep(compute_ms * 1000);
+    }
+
+    int checked = count - warmup < 0 ? 0 : count - warmup;
+    printf("trajectory %s: %i opens checked, mean open %.1f ms, %i waits > %.1f ms, %i errors: %s\n",
+           argv[1], checked, 0 < checked ? total_ms / checked : 0.0, waits, wait_ms, errors,
+           waits == 0 && errors == 0 ? "OK" : "FAILED");
+    return waits == 0 && errors == 0 ? 0 : 1;
+}
@@ -0,0 +1,76 @@
+/*
+ * Round trip benchmark of the DVLib <-> DV transport.
+ *
+ * Measures the mean latency of
+ * - sdavi_test_file(): one message exchange incl. cache lookup in DV
+ * - nc_open() + nc_close() of an available file (hit open through DVLib)
+ *
+ * Run it once with the shared-memory transport (default if DV runs on this node
+ * with dv_shm_transport = 1) and once with DV_SHM=0 (TCP sockets) to compare.
+ *
+ * build (netCDF variant of DVLib):
+ *   gcc -std=c99 -O2 -o transport_bench transport_bench.c -I<netcdf>/include -I<simfs>/src/dvlib/extended_api \
+ *       -L<simfs>/build/lib -ldvl -L<netcdf>/lib -lnetcdf
+ *
+ * run (DV must be running with dv_config_files/heatequation.dv; the file must be available):
+ *   ./transport_bench [nr] [iterations]
+ *   DV_SHM=0 ./transport_bench [nr] [iterations]
+ * set DV_LEASES=0 to make every nc_open() reach DV (a leased open skips the round trip).
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <netcdf.h>
+
+#include "dvl_extended_api.h"
+
+#define RESULT_PATH "../output/data_"
+#define MAX_NAME 256
+
+static double now_us() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1.0e6 + ts.tv_nsec / 1.0e3;
+}
+
+int main(int argc, char *argv[]) {
+    int nr = argc > 1 ? atoi(argv[1]) : 20;
+    int iterations = argc > 2 ? atoi(argv[2]) : 10000;
+    if (iterations <= 0) {
+        iterations = 1;
+    }
+
+    char name[MAX_NAME];
+    snprintf(name, MAX_NAME, "%s%i", RESULT_PATH, nr);
+
+    // makes the file available (if needed) and warms up the connection
+    int ncid;
+    if (nc_open(name, NC_NOWRITE, &ncid) != NC_NOERR) {
+        fprintf(stderr, "cannot open %s\n", name);
+        return 1;
+    }
+    nc_close(ncid);
+
+    double t = now_us();
+    for (int i = 0; i < iterations; i++) {
+        sdavi_test_file(name);
+    }
+    double test_us = (now_us() - t) / iterations;
+
+    t = now_us();
+    for (int i = 0; i < iterations; i++) {
+        if (nc_open(name, NC_NOWRITE, &ncid) == NC_NOERR) {
+            nc_close(ncid);
+        }
+    }
+    double open_us = (now_us() - t) / iterations;
+
+    printf("transport %s: sdavi_test_file %.2f us; nc_open + nc_close (hit) %.2f us; %i iterations\n",
+           getenv("DV_SHM") != NULL && atoi(getenv("DV_SHM")) == 0 ? "socket" : "default",
+           test_us, open_us, iterations);
+    return 0;
+}
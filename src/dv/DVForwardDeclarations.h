@@ -12,10 +12,13 @@
 // class is used or class members are accessed
 
 namespace dv {
+	class BlockCache;
 	class ClientDescriptor;
+	class ColdTier;
 	class Cosmo;
 	class CosmoConfig;
 	class DV;
+	class EvictionJournal;
 	class FileCache;
 	class FileCollection;
 	class FileDescriptor;
@@ -23,11 +26,13 @@ namespace dv {
 	class FlashConfig;
 	class JobQueue;
 	class MessageHandler;
+	class MetadataStore;
 	class Profiler;
 	class RestartFiles;
 	class SimConfig;
 	class SimJob;
 	class Simulator;
+	class StagingArea;
 	class VariableDescriptor;
 }
 
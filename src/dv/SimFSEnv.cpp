@@ -80,18 +80,23 @@ SimFSEnv::SimFSEnv(SimFS &fs, string name, string conf_file): fs_(fs){
 
 
 
-int SimFSEnv::loadFiles(KeyValueStore * files){
+int SimFSEnv::openFiles(PersistentIndex * files){
 
-    if (FileSystemHelper::fileExists(getKVFile())){
-        files->fromFile(getKVFile());
+    if (!files->open(getIndexBase())){
+        LOG(ERROR, 0, "Cannot open the file index " + getIndexBase());
+        return -1;
     }
 
-    return 0;
-}
+    if (files->isNew() && FileSystemHelper::fileExists(getKVFile())){
+        KeyValueStore kv;
+        kv.fromFile(getKVFile());
+        for (const auto &f : kv.getStoreMap()){
+            files->set(f.first, f.second);
+        }
+        LOG(INFO, 0, "Imported " + std::to_string(kv.getStoreMap().size()) + " files of " + getKVFile());
+    }
 
-int SimFSEnv::saveFiles(KeyValueStore * files){
-    printf("saving in %s\n", getKVFile().c_str());
-    return files->toFile(getKVFile());
+    return 0;
 }
 
 int SimFSEnv::save(){
@@ -145,6 +150,10 @@ string SimFSEnv::getKVFile(){
     return path_ + std::string("/") + DIR_SIMFS + std::string("/") + ENV_KV_NAME;
 }
 
+string SimFSEnv::getIndexBase(){
+    return path_ + std::string("/") + DIR_SIMFS + std::string("/") + FILEIDX;
+}
+
 string SimFSEnv::getConfigFile(){
     return path_ + std::string("/") + DIR_SIMFS + std::string("/") + CONF_NAME;
 }
@@ -2,6 +2,7 @@
 #define _SIMFSENV_HPP_
 
 #include "toolbox/KeyValueStore.h"
+#include "toolbox/PersistentIndex.h"
 #include "SimFS.hpp"
 
 using namespace std;
@@ -29,8 +30,9 @@ namespace simfs{
 
         int save();
 
-        int loadFiles(KeyValueStore * files);
-        int saveFiles(KeyValueStore * files);
+        /* opens the persistent file index (see PersistentIndex); the files of
+           an env.kv of older versions are imported when the index is created */
+        int openFiles(PersistentIndex * files);
 
         string getPath();
         string getConfigFile();
@@ -48,6 +50,7 @@ namespace simfs{
     private:
         int init(string env_path);
         string getKVFile();
+        string getIndexBase();
         string getStateFile();
     };
 }
@@ -0,0 +1,309 @@
+//
+// Snapshot of file cache and restart lookup for a fast warm start of DV
+//
+
+#include "CacheSnapshot.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <sys/stat.h>
+#include <utility>
+#include <vector>
+
+#include "../server/DV.h"
+#include "../simulator/Simulator.h"
+#include "../toolbox/FileSystemHelper.h"
+#include "filecaches/FileCache.h"
+#include "filecaches/FileDescriptor.h"
+
+namespace dv {
+
+constexpr char CacheSnapshot::kMagic[];
+constexpr uint32_t CacheSnapshot::kVersion;
+
+namespace {
+
+template<typename T>
+void append(std::string *buffer, T value) {
+    buffer->append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+void appendString(std::string *buffer, const std::string &s) {
+    append<uint32_t>(buffer, s.size());
+    buffer->append(s);
+}
+
+/**
+ * bounds checked reading of the snapshot; all reads fail after the first failure
+ */
+class Reader {
+public:
+    Reader(const char *data, size_t size) : data_(data), size_(size) {}
+
+    template<typename T>
+    bool read(T *value) {
+        if (!ok_ || size_ - pos_ < sizeof(T)) {
+            ok_ = false;
+            return false;
+        }
+        std::memcpy(value, data_ + pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return true;
+    }
+
+    bool readString(std::string *s) {
+        uint32_t len = 0;
+        if (!read(&len) || size_ - pos_ < len) {
+            ok_ = false;
+            return false;
+        }
+        s->assign(data_ + pos_, len);
+        pos_ += len;
+        return true;
+    }
+
+    /**
+     * count of the following items; each needs at least min_item_size bytes
+     */
+    bool readCount(uint64_t *count, size_t min_item_size) {
+        if (!read(count) || (size_ - pos_) / min_item_size < *count) {
+            ok_ = false;
+            return false;
+        }
+        return true;
+    }
+
+    bool atEnd() const {
+        return ok_ && pos_ == size_;
+    }
+
+private:
+    const char *data_;
+    size_t size_;
+    size_t pos_ = 0;
+    bool ok_ = true;
+};
+
+}
+
+bool CacheSnapshot::write(DV *dv, const std::string &filename) {
+    DVConfig *config = dv->getConfigPtr();
+
+    std::vector<FileCache::SnapshotEntry> entries;
+    dv->getFileCachePtr()->getSnapshotEntries(&entries);
+    std::vector<FileCache::SnapshotEntry> history;
+    int64_t adaptation = -1;
+    dv->getFileCachePtr()->getSnapshotHistory(&history, &adaptation);
+
+    std::vector<std::pair<dv::id_type, std::string>> static_checkpoints;
+    std::vector<std::pair<dv::id_type, std::string>> dynamic_checkpoints;
+    dv->getSimulatorPtr()->getRestartSnapshot(&static_checkpoints, &dynamic_checkpoints);
+
+    std::string buffer;
+    buffer.append(kMagic, sizeof(kMagic));
+    append<uint32_t>(&buffer, kVersion);
+    appendString(&buffer, config->filecache_type_);
+    append<int64_t>(&buffer, config->filecache_fifo_queue_size_);
+    appendString(&buffer, config->sim_result_path_);
+    appendString(&buffer, config->sim_checkpoint_path_);
+
+    append<uint64_t>(&buffer, entries.size());
+    for (const auto &entry : entries) {
+        append<uint8_t>(&buffer, entry.part);
+        append<int64_t>(&buffer, entry.size);
+        appendString(&buffer, entry.key);
+        appendString(&buffer, entry.name);
+        appendString(&buffer, entry.file_name);
+    }
+
+    append<uint64_t>(&buffer, history.size());
+    for (const auto &entry : history) {
+        append<uint8_t>(&buffer, entry.part);
+        appendString(&buffer, entry.key);
+        appendString(&buffer, entry.name);
+        appendString(&buffer, entry.file_name);
+    }
+    append<int64_t>(&buffer, adaptation);
+
+    for (const auto *checkpoints : {&static_checkpoints, &dynamic_checkpoints}) {
+        append<uint64_t>(&buffer, checkpoints->size());
+        for (const auto &checkpoint : *checkpoints) {
+            append<int64_t>(&buffer, checkpoint.first);
+            appendString(&buffer, checkpoint.second);
+        }
+    }
+
+    for (const std::vector<double> *values : {&dv->getSimulatorPtr()->getAlphas(), &dv->getSimulatorPtr()->getTaus()}) {
+        append<uint64_t>(&buffer, values->size());
+        for (double v : *values) {
+            append<double>(&buffer, v);
+        }
+    }
+
+    // readers never see a partially written snapshot
+    std::string tmp_filename = filename + ".tmp";
+    std::ofstream out(tmp_filename, std::ios::binary | std::ios::trunc);
+    out.write(buffer.data(), buffer.size());
+    out.close();
+    if (!out || std::rename(tmp_filename.c_str(), filename.c_str()) != 0) {
+        std::cerr << "CacheSnapshot: could not write " << filename << std::endl;
+        toolbox::FileSystemHelper::rmFile(tmp_filename);
+        return false;
+    }
+
+    std::cout << "CacheSnapshot: " << entries.size() << " files, " << history.size() << " history entries, "
+              << static_checkpoints.size() + dynamic_checkpoints.size() << " restart files written to " << filename << std::endl;
+    return true;
+}
+
+bool CacheSnapshot::restore(DV *dv, const std::string &filename) {
+    DVConfig *config = dv->getConfigPtr();
+
+    // the mtime of the snapshot bounds the folders that are scanned for new files below
+    struct stat st;
+    std::ifstream in(filename, std::ios::binary);
+    if (!in || stat(filename.c_str(), &st) != 0) {
+        std::cout << "CacheSnapshot: no snapshot " << filename << "; scanning files." << std::endl;
+        return false;
+    }
+
+    std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+    if (data.empty()) {
+        return false;
+    }
+
+    Reader reader(data.data(), data.size());
+
+    char magic[sizeof(kMagic)];
+    uint32_t version = 0;
+    std::string cache_type;
+    int64_t fifo_queue_size = 0;
+    std::string result_path;
+    std::string checkpoint_path;
+    bool ok = reader.read(&magic) && std::memcmp(magic, kMagic, sizeof(kMagic)) == 0
+              && reader.read(&version) && version == kVersion
+              && reader.readString(&cache_type) && reader.read(&fifo_queue_size)
+              && reader.readString(&result_path) && reader.readString(&checkpoint_path);
+
+    // the FIFO queue of the wrapper must exist on both sides (sizes may differ)
+    bool matches = ok && cache_type == config->filecache_type_
+                   && (0 < fifo_queue_size) == (0 < config->filecache_fifo_queue_size_)
+                   && result_path == config->sim_result_path_ && checkpoint_path == config->sim_checkpoint_path_;
+
+    std::vector<FileCache::SnapshotEntry> entries;
+    uint64_t count = 0;
+    if (matches && reader.readCount(&count, sizeof(uint8_t) + sizeof(int64_t) + 3 * sizeof(uint32_t))) {
+        entries.reserve(count);
+        for (uint64_t i = 0; i < count; ++i) {
+            uint8_t part = 0;
+            int64_t file_size = 0;
+            FileCache::SnapshotEntry entry;
+            if (!(reader.read(&part) && part <= FileCache::kFifo && reader.read(&file_size)
+                  && reader.readString(&entry.key) && reader.readString(&entry.name)
+                  && reader.readString(&entry.file_name))) {
+                ok = false;
+                break;
+            }
+            entry.part = static_cast<FileCache::SnapshotPart>(part);
+            entry.size = file_size;
+            entries.push_back(std::move(entry));
+        }
+    }
+
+    std::vector<FileCache::SnapshotEntry> history;
+    int64_t adaptation = -1;
+    if (matches && reader.readCount(&count, sizeof(uint8_t) + 3 * sizeof(uint32_t))) {
+        history.reserve(count);
+        for (uint64_t i = 0; i < count; ++i) {
+            uint8_t part = 0;
+            FileCache::SnapshotEntry entry;
+            if (!(reader.read(&part) && part <= FileCache::kGhostFrequency && reader.readString(&entry.key)
+                  && reader.readString(&entry.name) && reader.readString(&entry.file_name))) {
+                ok = false;
+                break;
+            }
+            entry.part = static_cast<FileCache::SnapshotPart>(part);
+            entry.size = 0;
+            history.push_back(std::move(entry));
+        }
+        reader.read(&adaptation);
+    }
+
+    std::vector<std::pair<dv::id_type, std::string>> static_checkpoints;
+    std::vector<std::pair<dv::id_type, std::string>> dynamic_checkpoints;
+    for (auto *checkpoints : {&static_checkpoints, &dynamic_checkpoints}) {
+        if (matches && reader.readCount(&count, sizeof(int64_t) + sizeof(uint32_t))) {
+            checkpoints->reserve(count);
+            for (uint64_t i = 0; i < count; ++i) {
+                int64_t nr = 0;
+                std::string checkpoint;
+                reader.read(&nr);
+                reader.readString(&checkpoint);
+                checkpoints->emplace_back(nr, checkpoint);
+            }
+        }
+    }
+
+    std::vector<double> alphas;
+    std::vector<double> taus;
+    for (std::vector<double> *values : {&alphas, &taus}) {
+        if (matches && reader.readCount(&count, sizeof(double))) {
+            values->resize(count);
+            for (uint64_t i = 0; i < count; ++i) {
+                reader.read(&(*values)[i]);
+            }
+        }
+    }
+
+    ok = ok && matches && reader.atEnd();
+
+    if (!ok) {
+        std::cout << "CacheSnapshot: " << filename << (matches ? " is damaged" : " does not match the configuration")
+                  << "; scanning files." << std::endl;
+        return false;
+    }
+
+    // restart lookup first: costs of the cached files depend on it;
+    // checkpoints written while DV was not running: only folders changed since the snapshot are listed
+    dv->getSimulatorPtr()->restoreRestartSnapshot(static_checkpoints, dynamic_checkpoints);
+    dv->getSimulatorPtr()->scanRestartFiles(st.st_mtime);
+    dv->getSimulatorPtr()->extendAlphas(alphas);
+    dv->getSimulatorPtr()->extendTaus(taus);
+
+    // the files are checked at their first open (see FileDescriptor::isUnverified())
+    for (const auto &entry : entries) {
+        dv->addResultName(entry.key);
+    }
+
+    FileCache *cache = dv->getFileCachePtr();
+    cache->restoreSnapshotEntries(entries);
+    cache->restoreSnapshotHistory(history, adaptation);
+
+    // files added while DV was not running: only folders changed since the snapshot are listed
+    std::vector<toolbox::FileSystemHelper::ScanEntry> new_files;
+    FileCache::scanResultFiles(dv, &new_files, st.st_mtime);
+    dv::counter_type added = 0;
+    for (const auto &file : new_files) {
+        if (file.size <= 0 || cache->internal_lookup_get(file.rel_path) != nullptr
+            || cache->internal_lookup_get(file.name) != nullptr) {
+            continue;
+        }
+        std::unique_ptr<FileDescriptor> fd = std::make_unique<FileDescriptor>(file.name, file.full_path);
+        fd->setFileAvailable(true);
+        fd->setSize(file.size);
+        cache->put(file.rel_path, std::move(fd));
+        ++added;
+    }
+
+    std::cout << "CacheSnapshot: " << entries.size() << " files and " << history.size()
+              << " history entries restored from " << filename << ", " << added << " new files found; "
+              << cache->size() << " files cached." << std::endl;
+    return true;
+}
+
+}
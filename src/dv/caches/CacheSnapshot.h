@@ -0,0 +1,63 @@
+//
+// Snapshot of file cache and restart lookup for a fast warm start of DV
+//
+
+#ifndef DV_CACHES_CACHESNAPSHOT_H_
+#define DV_CACHES_CACHESNAPSHOT_H_
+
+#include <cstdint>
+#include <string>
+
+#include "../DVForwardDeclarations.h"
+
+namespace dv {
+
+	/**
+	 * Without a snapshot, DV scans the result and checkpoint trees at startup (directory scan, file type
+	 * lookup in Lua and stat per file; see FileCache::initializeWithFiles() and
+	 * Simulator::scanRestartFiles()), and the history of the cache policy is lost.
+	 *
+	 * The snapshot (see filecache_snapshot_file in the config file) keeps
+	 * - the resident files of the file cache in recency order including the frequency part
+	 *   of the policy (see FileCache::SnapshotEntry)
+	 * - the history of the policy: non-resident files (ARC B1/B2, LIRS non-resident HIR)
+	 *   and the adaptation parameter (see FileCache::getSnapshotHistory())
+	 * - the restart lookup including the checkpoints added during runtime
+	 * - the alpha and tau estimates of the simulator
+	 * It is written at shutdown and optionally periodically (filecache_snapshot_interval_s).
+	 *
+	 * At startup, the snapshot replaces both scans if it was written for the same cache type and
+	 * the same result and checkpoint paths. It is read and checked completely before anything is
+	 * restored. The restored files are not checked at startup but at their first open; a file that no
+	 * longer exists is a miss then. Restored checkpoints are checked (stat) before they become restart
+	 * points. Result and checkpoint files added while DV was not running are found by listing only
+	 * the folders modified since the snapshot was written (see FileSystemHelper::scanDir()).
+	 *
+	 * Binary format (host byte order; strings as uint32 length + bytes):
+	 *   magic, version, cache type, fifo queue size, result path, checkpoint path,
+	 *   files (count; per file: part, size, key, name, filename),
+	 *   history (count; per entry: part, key, name, filename), adaptation (int64, -1: none),
+	 *   static checkpoints (count; nr, filename), dynamic checkpoints (count; nr, filename),
+	 *   alphas (count; double), taus (count; double)
+	 */
+	class CacheSnapshot {
+	public:
+		/**
+		 * writes to a temporary file that replaces filename; true on success
+		 */
+		static bool write(DV *dv, const std::string &filename);
+
+		/**
+		 * restores file cache and simulator of dv; false if there is no usable snapshot,
+		 * nothing has been restored then
+		 */
+		static bool restore(DV *dv, const std::string &filename);
+
+	private:
+		static constexpr char kMagic[] = "DVSNAP";
+		static constexpr uint32_t kVersion = 3;
+	};
+
+}
+
+#endif //DV_CACHES_CACHESNAPSHOT_H_
@@ -0,0 +1,492 @@
+//
+// Cold tier: evicted result files kept (optionally compressed) in a second store
+//
+
+#include "ColdTier.h"
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <unordered_set>
+
+#include "../DVLog.h"
+#include "../toolbox/FileSystemHelper.h"
+#include "../toolbox/LZCodec.h"
+#include "../toolbox/StringHelper.h"
+#include "../toolbox/TimeHelper.h"
+
+namespace dv {
+
+constexpr char ColdTier::kIndexName[];
+constexpr double ColdTier::kInitialMoveBytesPerSecond;
+constexpr double ColdTier::kInitialDecompressBytesPerSecond;
+constexpr double ColdTier::kThroughputWeight;
+
+namespace {
+
+/**
+ * names of the files of the tier: <id>.raw, <id>.lz and their temporary files (<name>.tmp)
+ */
+bool isTierFile(const std::string &name) {
+    std::string::size_type digits = name.find_first_not_of("0123456789");
+    if (digits == 0 || digits == std::string::npos) {
+        return false;
+    }
+    std::string suffix = name.substr(digits);
+    return suffix == ".raw" || suffix == ".lz" || suffix == ".raw.tmp" || suffix == ".lz.tmp";
+}
+
+}
+
+ColdTier::ColdTier(const std::string &path, dv::size_type capacity, bool compress) :
+    path_(path), capacity_(capacity), compress_(compress) {
+
+    event_fd_ = eventfd(0, EFD_NONBLOCK);
+    if (event_fd_ < 0) {
+        LOG(ERROR, 0, "Cold tier: cannot create eventfd: " + std::to_string(errno));
+        return;
+    }
+
+    loadIndex();
+    worker_thread_ = std::thread(&ColdTier::workLoop, this);
+}
+
+ColdTier::~ColdTier() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    queue_cv_.notify_all();
+    if (worker_thread_.joinable()) {
+        worker_thread_.join();
+    }
+
+    // files whose move into the tier failed are not kept
+    for (auto it = entries_.begin(); it != entries_.end();) {
+        auto next = std::next(it);
+        if (!it->pending_file.empty()) {
+            removeEntry(it);
+        }
+        it = next;
+    }
+
+    if (0 <= event_fd_) {
+        writeIndex();
+        close(event_fd_);
+    }
+}
+
+bool ColdTier::isOk() const {
+    return 0 <= event_fd_;
+}
+
+int ColdTier::getEventFd() const {
+    return event_fd_;
+}
+
+bool ColdTier::demote(const std::string &key, const std::string &file_name) {
+    dv::size_type size = toolbox::FileSystemHelper::fileSize(file_name);
+    if (size < 0 || capacity_ < size) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto existing = by_key_.find(key);
+    if (existing != by_key_.end()) {
+        if (existing->second->promoting) {
+            return false;
+        }
+        removeEntry(existing->second);
+    }
+
+    // promoting files stay until their promotion has finished
+    auto victim = entries_.end();
+    while (capacity_ < used_ + size && victim != entries_.begin()) {
+        --victim;
+        if (!victim->promoting) {
+            removeEntry(victim++);
+            ++eviction_count_;
+        }
+    }
+    if (capacity_ < used_ + size) {
+        return false;
+    }
+
+    // only renames here; a copy to another file system is left to the worker thread
+    uint64_t id = next_id_++;
+    Entry entry{key, id, size, size, false, "", false, false};
+    if (std::rename(file_name.c_str(), tierFile(id, false).c_str()) == 0) {
+        if (compress_) {
+            jobs_.push_back(Job{kCompress, key, id, ""});
+        }
+    } else if (errno == EXDEV) {
+        entry.pending_file = transitFile(file_name, id, "coldtier_demote");
+        if (std::rename(file_name.c_str(), entry.pending_file.c_str()) != 0) {
+            std::cerr << "ColdTier: could not move " << file_name << " aside" << std::endl;
+            return false;
+        }
+        jobs_.push_back(Job{kMove, key, id, ""});
+    } else {
+        std::cerr << "ColdTier: could not move " << file_name << " to " << path_ << std::endl;
+        return false;
+    }
+
+    used_ += size;
+    entries_.push_front(entry);
+    by_key_[key] = entries_.begin();
+    ++demotion_count_;
+    queue_cv_.notify_one();
+    return true;
+}
+
+bool ColdTier::contains(const std::string &key) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = by_key_.find(key);
+    return it != by_key_.end() && !it->second->promoting;
+}
+
+bool ColdTier::isPromoting(const std::string &key) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = by_key_.find(key);
+    return it != by_key_.end() && it->second->promoting && !it->second->removed;
+}
+
+double ColdTier::estimatePromoteSeconds(const std::string &key) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = by_key_.find(key);
+    if (it == by_key_.end() || it->second->promoting) {
+        return -1.0;
+    }
+
+    const Entry &entry = *it->second;
+    return entry.original_size / (entry.compressed ? decompress_bytes_per_s_ : move_bytes_per_s_);
+}
+
+bool ColdTier::startPromote(const std::string &key, const std::string &file_name) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = by_key_.find(key);
+        if (it == by_key_.end() || it->second->promoting) {
+            return false;
+        }
+
+        it->second->promoting = true;
+        jobs_.push_back(Job{kPromote, key, it->second->id, file_name});
+    }
+    queue_cv_.notify_one();
+    return true;
+}
+
+std::vector<std::pair<std::string, bool>> ColdTier::takePromoted() {
+    uint64_t count;
+    if (read(event_fd_, &count, sizeof(count)) < 0 && errno != EAGAIN) {
+        LOG(ERROR, 0, "Cold tier: eventfd read error: " + std::to_string(errno));
+    }
+
+    std::vector<std::pair<std::string, bool>> promoted;
+    std::lock_guard<std::mutex> lock(mutex_);
+    promoted.swap(promoted_);
+    return promoted;
+}
+
+void ColdTier::remove(const std::string &key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = by_key_.find(key);
+    if (it == by_key_.end()) {
+        return;
+    }
+
+    if (it->second->promoting) {
+        // the worker thread drops the entry (see runPromote())
+        it->second->removed = true;
+    } else {
+        removeEntry(it->second);
+    }
+}
+
+void ColdTier::printStatus(std::ostream *out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    *out << "ColdTier " << path_ << " capacity " << capacity_ << " bytes, used " << used_
+         << " bytes, files " << entries_.size() << (compress_ ? " (compressed)" : "") << std::endl
+         << "demotions " << demotion_count_ << ", promotions " << promotion_count_
+         << ", compressions " << compression_count_ << ", evictions " << eviction_count_ << std::endl;
+}
+
+dv::counter_type ColdTier::getFileCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+dv::size_type ColdTier::getUsedBytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return used_;
+}
+
+dv::counter_type ColdTier::getDemotionCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return demotion_count_;
+}
+
+dv::counter_type ColdTier::getPromotionCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return promotion_count_;
+}
+
+dv::counter_type ColdTier::getCompressionCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return compression_count_;
+}
+
+dv::counter_type ColdTier::getEvictionCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return eviction_count_;
+}
+
+std::string ColdTier::tierFile(uint64_t id, bool compressed) const {
+    return toolbox::StringHelper::joinPath(path_, std::to_string(id) + (compressed ? ".lz" : ".raw"));
+}
+
+std::string ColdTier::transitFile(const std::string &file_name, uint64_t id, const char *suffix) {
+    return toolbox::StringHelper::joinPath(toolbox::FileSystemHelper::getDirname(file_name),
+            "." + toolbox::FileSystemHelper::getBasename(file_name) + "." + std::to_string(id) + "." + suffix);
+}
+
+ColdTier::iterator_type ColdTier::findJobEntry(const Job &job) {
+    auto it = by_key_.find(job.key);
+    if (it == by_key_.end() || it->second->id != job.id) {
+        return entries_.end();
+    }
+    return it->second;
+}
+
+void ColdTier::removeEntry(iterator_type it) {
+    if (!it->pending_file.empty()) {
+        toolbox::FileSystemHelper::rmFile(it->pending_file);
+    }
+    toolbox::FileSystemHelper::rmFile(tierFile(it->id, it->compressed));
+    used_ -= it->size;
+    by_key_.erase(it->key);
+    entries_.erase(it);
+}
+
+void ColdTier::loadIndex() {
+    std::string index_file = toolbox::StringHelper::joinPath(path_, kIndexName);
+    std::ifstream in(index_file);
+    std::string line;
+    uint64_t max_id = 0;
+    bool any = false;
+
+    // oldest first
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        Entry entry{"", 0, 0, 0, false, "", false, false};
+        if (!(fields >> entry.id >> entry.compressed >> entry.original_size >> entry.size)
+            || fields.get() != '\t' || !std::getline(fields, entry.key) || entry.key.empty()) {
+            continue;
+        }
+        if (toolbox::FileSystemHelper::fileSize(tierFile(entry.id, entry.compressed)) != entry.size
+            || by_key_.find(entry.key) != by_key_.end()) {
+            continue;
+        }
+
+        entries_.push_front(entry);
+        by_key_[entry.key] = entries_.begin();
+        used_ += entry.size;
+        if (!any || max_id < entry.id) {
+            max_id = entry.id;
+            any = true;
+        }
+    }
+    in.close();
+
+    // the files change from now on; the index is written again at shutdown
+    toolbox::FileSystemHelper::rmFile(index_file);
+    next_id_ = any ? max_id + 1 : 0;
+
+    // files of the tier that are not listed (crash, or a tier that was reconfigured)
+    std::unordered_set<std::string> listed;
+    for (const auto &entry : entries_) {
+        listed.insert(toolbox::FileSystemHelper::getBasename(tierFile(entry.id, entry.compressed)));
+    }
+    auto remove_unlisted = [&listed](const std::string &name, const std::string &rel_path, const std::string &full_path) {
+        if (isTierFile(name) && listed.find(name) == listed.end()) {
+            toolbox::FileSystemHelper::rmFile(full_path);
+        }
+    };
+    toolbox::FileSystemHelper::readDir(path_, remove_unlisted, false);
+
+    while (capacity_ < used_ && !entries_.empty()) {
+        removeEntry(std::prev(entries_.end()));
+        ++eviction_count_;
+    }
+
+    if (!entries_.empty()) {
+        LOG(INFO, 0, "Cold tier: " + std::to_string(entries_.size()) + " files of the last run reloaded");
+    }
+}
+
+void ColdTier::writeIndex() const {
+    std::string index_file = toolbox::StringHelper::joinPath(path_, kIndexName);
+    std::string tmp_file = index_file + ".tmp";
+    std::ofstream out(tmp_file, std::ofstream::trunc);
+    for (auto it = entries_.rbegin(); it != entries_.rend(); ++it) {
+        if (it->pending_file.empty() && !it->promoting) {
+            out << it->id << '\t' << it->compressed << '\t' << it->original_size << '\t' << it->size << '\t'
+                << it->key << '\n';
+        }
+    }
+    out.close();
+    if (!out || std::rename(tmp_file.c_str(), index_file.c_str()) != 0) {
+        std::cerr << "ColdTier: could not write the index " << index_file << std::endl;
+        toolbox::FileSystemHelper::rmFile(tmp_file);
+    }
+}
+
+void ColdTier::workLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        queue_cv_.wait(lock, [this] { return stop_ || !jobs_.empty(); });
+        if (jobs_.empty()) {
+            return;
+        }
+
+        Job job = jobs_.front();
+        jobs_.pop_front();
+        if (!stop_) {
+            switch (job.type) {
+                case kMove: runMove(job, &lock); break;
+                case kCompress: runCompress(job, &lock); break;
+                case kPromote: runPromote(job, &lock); break;
+            }
+        } else if (job.type == kMove) {
+            // at shutdown, only files still outside of the tier are moved
+            runMove(job, &lock);
+        } else if (job.type == kPromote) {
+            auto it = findJobEntry(job);
+            if (it != entries_.end()) {
+                it->promoting = false;
+                if (it->removed) {
+                    removeEntry(it);
+                }
+            }
+        }
+    }
+}
+
+void ColdTier::runMove(const Job &job, std::unique_lock<std::mutex> *lock) {
+    auto it = findJobEntry(job);
+    if (it == entries_.end()) {
+        return;
+    }
+
+    // the pending file is only removed by the server loop together with the entry
+    std::string pending_file = it->pending_file;
+    std::string raw_file = tierFile(job.id, false);
+    lock->unlock();
+    bool ok = toolbox::FileSystemHelper::mvFile(pending_file, raw_file);
+    lock->lock();
+
+    it = findJobEntry(job);
+    if (it == entries_.end()) {
+        toolbox::FileSystemHelper::rmFile(raw_file);
+        return;
+    }
+    if (!ok) {
+        std::cerr << "ColdTier: could not move " << pending_file << " to " << path_ << std::endl;
+        if (!it->promoting) {
+            removeEntry(it);
+        }
+        // a queued promotion renames the pending file back
+        return;
+    }
+
+    it->pending_file.clear();
+    if (compress_ && !it->promoting) {
+        jobs_.push_back(Job{kCompress, job.key, job.id, ""});
+    }
+}
+
+void ColdTier::runCompress(const Job &job, std::unique_lock<std::mutex> *lock) {
+    auto it = findJobEntry(job);
+    if (it == entries_.end() || it->promoting || it->compressed) {
+        return;
+    }
+
+    // the raw file is not touched by the server loop while the entry exists and is not promoted
+    std::string raw_file = tierFile(job.id, false);
+    std::string lz_file = tierFile(job.id, true);
+    std::string tmp_file = lz_file + ".tmp";
+    lock->unlock();
+    bool ok = toolbox::LZCodec::compressFile(raw_file, tmp_file);
+    dv::size_type compressed_size = ok ? toolbox::FileSystemHelper::fileSize(tmp_file) : -1;
+    lock->lock();
+
+    // the entry may have been evicted or replaced in the meantime
+    it = findJobEntry(job);
+    if (ok && it != entries_.end() && 0 <= compressed_size && compressed_size < it->size
+        && std::rename(tmp_file.c_str(), lz_file.c_str()) == 0) {
+        toolbox::FileSystemHelper::rmFile(raw_file);
+        used_ -= it->size - compressed_size;
+        it->size = compressed_size;
+        it->compressed = true;
+        ++compression_count_;
+    } else {
+        toolbox::FileSystemHelper::rmFile(tmp_file);
+    }
+}
+
+void ColdTier::runPromote(const Job &job, std::unique_lock<std::mutex> *lock) {
+    auto it = findJobEntry(job);
+    if (it == entries_.end()) {
+        return;
+    }
+
+    // promoting entries are neither evicted nor replaced: the fields stay valid without the lock
+    bool ok = false;
+    bool compressed = it->compressed;
+    dv::size_type original_size = it->original_size;
+    std::string source = it->pending_file.empty() ? tierFile(job.id, compressed) : it->pending_file;
+    // clients must not see a partially restored file
+    std::string tmp_file = transitFile(job.file_name, job.id, "coldtier_promote");
+    double s = 0.0;
+    if (!it->removed) {
+        lock->unlock();
+        toolbox::TimeHelper::time_point_type start = toolbox::TimeHelper::now();
+        ok = compressed ? toolbox::LZCodec::decompressFile(source, tmp_file)
+                        : toolbox::FileSystemHelper::mvFile(source, tmp_file);
+        s = toolbox::TimeHelper::seconds(start, toolbox::TimeHelper::now());
+        lock->lock();
+    }
+
+    // remove() during the promotion: a newer version of the file is in production
+    ok = ok && !it->removed && std::rename(tmp_file.c_str(), job.file_name.c_str()) == 0;
+    if (!ok) {
+        if (!it->removed) {
+            std::cerr << "ColdTier: could not restore " << job.file_name << std::endl;
+        }
+        toolbox::FileSystemHelper::rmFile(tmp_file);
+    }
+    removeEntry(it);
+
+    if (ok) {
+        ++promotion_count_;
+        if (0.0 < s) {
+            double &bytes_per_s = compressed ? decompress_bytes_per_s_ : move_bytes_per_s_;
+            bytes_per_s = (1.0 - kThroughputWeight) * bytes_per_s + kThroughputWeight * (original_size / s);
+        }
+    }
+    promoted_.emplace_back(job.key, ok);
+
+    uint64_t one = 1;
+    if (write(event_fd_, &one, sizeof(one)) < 0 && errno != EAGAIN) {
+        std::cerr << "ColdTier: eventfd write error: " << errno << std::endl;
+    }
+}
+
+}
@@ -0,0 +1,218 @@
+//
+// Cold tier: evicted result files kept (optionally compressed) in a second store
+//
+
+#ifndef DV_CACHES_COLDTIER_H_
+#define DV_CACHES_COLDTIER_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../DVBasicTypes.h"
+
+namespace dv {
+
+	/**
+	 * Without the cold tier, a file evicted from the file cache is deleted and the next access
+	 * pays a re-simulation (alpha + n * tau from the previous restart file).
+	 *
+	 * With the tier (see coldtier_path in the config file), evicted files are moved into the tier
+	 * directory which has its own byte budget; the files demoted first are deleted when it is full.
+	 * If compression is on, demoted files are recompressed with the built-in codec
+	 * (see toolbox::LZCodec); files that do not shrink stay uncompressed.
+	 *
+	 * A miss of a file in the tier is served by startPromote() (move back or decompress into the
+	 * result path) if estimatePromoteSeconds() is lower than the estimated re-simulation time
+	 * (see ClientDescriptor::handleOpen()); the client waits as for a file in production until
+	 * DV::finishPromotions() makes the file available. The estimate is based on the measured
+	 * throughput of earlier promotions.
+	 *
+	 * The server loop only renames: into the tier if it is on the file system of the result path,
+	 * otherwise next to the evicted file (.<name>.<id>.coldtier), from where the worker thread
+	 * copies it into the tier. Copies, compressions and promotions run in the worker thread in
+	 * queue order; finished promotions are signaled on the event fd.
+	 *
+	 * Files of the tier are named by a running id (<id>.raw, <id>.lz). At shutdown, the queued
+	 * moves are finished (queued promotions and compressions are dropped) and the index is written
+	 * to kIndexName; the next start reloads it. Files of the tier that the index does not list (e.g. after a crash) are removed;
+	 * other files in the folder are not touched.
+	 * All public methods are called from the server loop; the lock only coordinates with the
+	 * worker thread.
+	 */
+	class ColdTier {
+	public:
+		static constexpr char kIndexName[] = "coldtier.index";
+
+		/**
+		 * capacity in bytes
+		 */
+		ColdTier(const std::string &path, dv::size_type capacity, bool compress);
+
+		/**
+		 * finishes queued moves (promotions and compressions are dropped) and writes the index
+		 */
+		~ColdTier();
+
+		ColdTier(const ColdTier &) = delete;
+		ColdTier &operator=(const ColdTier &) = delete;
+
+		/**
+		 * false if the event fd could not be created (tier off then)
+		 */
+		bool isOk() const;
+
+		/**
+		 * readable after promotions have finished; see takePromoted()
+		 */
+		int getEventFd() const;
+
+		/**
+		 * moves the evicted file file_name (result file key) into the tier;
+		 * false if it cannot be kept (the caller removes the file then)
+		 */
+		bool demote(const std::string &key, const std::string &file_name);
+
+		/**
+		 * true if the file is in the tier and not being promoted
+		 */
+		bool contains(const std::string &key) const;
+
+		bool isPromoting(const std::string &key) const;
+
+		/**
+		 * estimated time to bring the file back; negative if the file is not in the tier
+		 * (or being promoted already)
+		 */
+		double estimatePromoteSeconds(const std::string &key) const;
+
+		/**
+		 * queues the restore of the file at file_name; the file leaves the tier once restored.
+		 * false if the file is not in the tier
+		 */
+		bool startPromote(const std::string &key, const std::string &file_name);
+
+		/**
+		 * promotions finished since the last call: key, and true if the file has been restored
+		 */
+		std::vector<std::pair<std::string, bool>> takePromoted();
+
+		/**
+		 * drops the file if it is in the tier (e.g. a newer version has been produced);
+		 * a running promotion of it fails
+		 */
+		void remove(const std::string &key);
+
+		void printStatus(std::ostream *out) const;
+
+		dv::counter_type getFileCount() const;
+
+		dv::size_type getUsedBytes() const;
+
+		dv::counter_type getDemotionCount() const;
+
+		dv::counter_type getPromotionCount() const;
+
+		dv::counter_type getCompressionCount() const;
+
+		dv::counter_type getEvictionCount() const;
+
+	private:
+		struct Entry {
+			std::string key;
+			uint64_t id;
+			dv::size_type original_size; // bytes of the result file
+			dv::size_type size; // bytes in the tier
+			bool compressed;
+			std::string pending_file; // not empty while the file waits next to the result file
+			bool promoting;
+			bool removed; // by remove() during its promotion
+		};
+
+		typedef std::list<Entry>::iterator iterator_type;
+
+		enum JobType { kMove, kCompress, kPromote };
+
+		struct Job {
+			JobType type;
+			std::string key;
+			uint64_t id;
+			std::string file_name; // kPromote: destination
+		};
+
+		// initial estimates until the first promotions have been measured
+		static constexpr double kInitialMoveBytesPerSecond = 500.0 * 1024 * 1024;
+		static constexpr double kInitialDecompressBytesPerSecond = 300.0 * 1024 * 1024;
+		static constexpr double kThroughputWeight = 0.25; // of a new measurement
+
+		const std::string path_;
+		const dv::size_type capacity_;
+		const bool compress_;
+
+		int event_fd_ = -1;
+
+		mutable std::mutex mutex_;
+		std::condition_variable queue_cv_;
+
+		// front: most recently demoted
+		std::list<Entry> entries_;
+		std::unordered_map<std::string, iterator_type> by_key_;
+		std::deque<Job> jobs_;
+		std::vector<std::pair<std::string, bool>> promoted_;
+		uint64_t next_id_ = 0;
+		dv::size_type used_ = 0;
+		bool stop_ = false;
+
+		double move_bytes_per_s_ = kInitialMoveBytesPerSecond;
+		double decompress_bytes_per_s_ = kInitialDecompressBytesPerSecond;
+
+		dv::counter_type demotion_count_ = 0;
+		dv::counter_type promotion_count_ = 0;
+		dv::counter_type compression_count_ = 0;
+		dv::counter_type eviction_count_ = 0;
+
+		std::thread worker_thread_;
+
+		std::string tierFile(uint64_t id, bool compressed) const;
+
+		/**
+		 * hidden file next to file_name, used while a file moves between the tier and the result path
+		 */
+		static std::string transitFile(const std::string &file_name, uint64_t id, const char *suffix);
+
+		/**
+		 * the entry with the id of the job, or entries_.end(); the lock must be held
+		 */
+		iterator_type findJobEntry(const Job &job);
+
+		/**
+		 * removes the entry and its file; the lock must be held
+		 */
+		void removeEntry(iterator_type it);
+
+		/**
+		 * reloads the index of the last run and removes unlisted files of the tier
+		 */
+		void loadIndex();
+
+		void writeIndex() const;
+
+		void workLoop();
+
+		// the lock is held on entry and exit
+		void runMove(const Job &job, std::unique_lock<std::mutex> *lock);
+		void runCompress(const Job &job, std::unique_lock<std::mutex> *lock);
+		void runPromote(const Job &job, std::unique_lock<std::mutex> *lock);
+	};
+
+}
+
+#endif //DV_CACHES_COLDTIER_H_
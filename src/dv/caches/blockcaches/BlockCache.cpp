@@ -0,0 +1,118 @@
+//
+// Block cache: variable slabs of result files kept in a side store
+//
+
+#include "BlockCache.h"
+
+#include <iterator>
+
+#include "../../toolbox/FileSystemHelper.h"
+#include "../../toolbox/StringHelper.h"
+
+namespace dv {
+
+BlockCache::BlockCache(const std::string &path, dv::size_type capacity, dv::size_type max_block_size) :
+    path_(path), capacity_(capacity), max_block_size_(max_block_size) {}
+
+bool BlockCache::add(Block block) {
+    // payload files are only accepted directly in the block store
+    if (block.name.empty() || block.name[0] == '.' || block.name.find('/') != std::string::npos) {
+        return false;
+    }
+
+    std::string fullpath = toolbox::StringHelper::joinPath(path_, block.name);
+    auto existing = by_name_.find(block.name);
+    if (existing != by_name_.end()) {
+        // the payload file has been replaced already (see DVLib)
+        remove(existing->second, false);
+    }
+
+    block.size = toolbox::FileSystemHelper::fileSize(fullpath);
+    if (block.size < 0) {
+        return false;
+    }
+    if (max_block_size_ < block.size || capacity_ < block.size) {
+        toolbox::FileSystemHelper::rmFile(fullpath);
+        return false;
+    }
+
+    while (capacity_ < used_ + block.size && !blocks_.empty()) {
+        remove(std::prev(blocks_.end()), true);
+        ++eviction_count_;
+    }
+
+    used_ += block.size;
+    blocks_.push_front(std::move(block));
+    iterator_type it = blocks_.begin();
+    by_name_[it->name] = it;
+    by_file_.emplace(it->filename, it);
+    return true;
+}
+
+const BlockCache::Block *BlockCache::find(const std::string &filename, const std::string &var_id,
+                                          const std::vector<dv::offset_type> &offsets,
+                                          const std::vector<dv::offset_type> &counts) {
+    auto range = by_file_.equal_range(filename);
+    for (auto entry = range.first; entry != range.second; ++entry) {
+        iterator_type it = entry->second;
+        if (it->var_id == var_id && blockContains(*it, offsets, counts)) {
+            blocks_.splice(blocks_.begin(), blocks_, it);
+            ++hit_count_;
+            return &(*it);
+        }
+    }
+
+    ++miss_count_;
+    return nullptr;
+}
+
+bool BlockCache::hasBlocks(const std::string &filename) const {
+    return by_file_.find(filename) != by_file_.end();
+}
+
+void BlockCache::clear() {
+    while (!blocks_.empty()) {
+        remove(blocks_.begin(), true);
+    }
+}
+
+void BlockCache::printStatus(std::ostream *out) const {
+    *out << "BlockCache " << path_ << " capacity " << capacity_ << " bytes, used " << used_
+         << " bytes, blocks " << blocks_.size() << std::endl
+         << "hits " << hit_count_ << ", misses " << miss_count_ << ", evictions " << eviction_count_ << std::endl;
+}
+
+void BlockCache::remove(iterator_type it, bool remove_payload) {
+    auto range = by_file_.equal_range(it->filename);
+    for (auto entry = range.first; entry != range.second; ++entry) {
+        if (entry->second == it) {
+            by_file_.erase(entry);
+            break;
+        }
+    }
+    by_name_.erase(it->name);
+
+    if (remove_payload) {
+        toolbox::FileSystemHelper::rmFile(toolbox::StringHelper::joinPath(path_, it->name));
+    }
+    used_ -= it->size;
+    blocks_.erase(it);
+}
+
+bool BlockCache::blockContains(const Block &block, const std::vector<dv::offset_type> &offsets,
+                               const std::vector<dv::offset_type> &counts) {
+    if (offsets.size() != block.offsets.size() || counts.size() != block.counts.size()) {
+        return false;
+    }
+
+    for (size_t i = 0; i < offsets.size(); ++i) {
+        if (counts[i] <= 0
+            || offsets[i] < block.offsets[i]
+            || block.offsets[i] + block.counts[i] < offsets[i] + counts[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}
@@ -0,0 +1,124 @@
+//
+// Block cache: variable slabs of result files kept in a side store
+//
+
+#ifndef DV_CACHES_BLOCKCACHES_BLOCKCACHE_H_
+#define DV_CACHES_BLOCKCACHES_BLOCKCACHE_H_
+
+#include <list>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../../DVBasicTypes.h"
+
+namespace dv {
+
+	/**
+	 * Blocks are the payloads of single variable slabs (offsets/counts as in nc_get_vara) that clients
+	 * have read from complete result files (see ClientBlockStoreMessageHandler). DVLib writes each block
+	 * as one payload file into the block store (see blockcache_path in the config file); DV only keeps
+	 * the index and decides about capacity and eviction (LRU, independent of the file cache).
+	 *
+	 * Gets of files that are not resident are served from a block that contains the requested slab
+	 * (see ClientVariableGetMessageHandler). Thus, analyses reading a few variables of wide outputs
+	 * do not need the complete file to be kept or re-simulated.
+	 *
+	 * Payload files are removed when their block is evicted or replaced and at server shutdown.
+	 */
+	class BlockCache {
+	public:
+		struct Block {
+			std::string name;     // payload file in the block store (basename)
+			std::string filename; // result file
+			std::string var_id;
+			std::vector<dv::offset_type> offsets;
+			std::vector<dv::offset_type> counts;
+			dv::size_type size = 0; // bytes of the payload file; set by add()
+		};
+
+		/**
+		 * capacity and max_block_size in bytes
+		 */
+		BlockCache(const std::string &path, dv::size_type capacity, dv::size_type max_block_size);
+
+		const std::string &getPath() const {
+			return path_;
+		}
+
+		dv::size_type getMaxBlockSize() const {
+			return max_block_size_;
+		}
+
+		/**
+		 * adds the block whose payload file has been written to the block store (a block with the
+		 * same name is replaced); least recently used blocks are evicted until it fits.
+		 * returns false (and removes the payload file) if the block cannot be kept.
+		 */
+		bool add(Block block);
+
+		/**
+		 * a block of var_id of filename that contains the slab (made MRU); nullptr if there is none
+		 */
+		const Block *find(const std::string &filename, const std::string &var_id,
+						  const std::vector<dv::offset_type> &offsets, const std::vector<dv::offset_type> &counts);
+
+		bool hasBlocks(const std::string &filename) const;
+
+		/**
+		 * removes all blocks including their payload files (server shutdown)
+		 */
+		void clear();
+
+		void printStatus(std::ostream *out) const;
+
+		dv::counter_type getBlockCount() const {
+			return blocks_.size();
+		}
+
+		dv::size_type getUsedBytes() const {
+			return used_;
+		}
+
+		dv::counter_type getHitCount() const {
+			return hit_count_;
+		}
+
+		dv::counter_type getMissCount() const {
+			return miss_count_;
+		}
+
+		dv::counter_type getEvictionCount() const {
+			return eviction_count_;
+		}
+
+	private:
+		typedef std::list<Block>::iterator iterator_type;
+
+		const std::string path_;
+		const dv::size_type capacity_;
+		const dv::size_type max_block_size_;
+		dv::size_type used_ = 0;
+
+		// front: MRU
+		std::list<Block> blocks_;
+		std::unordered_map<std::string, iterator_type> by_name_;
+		std::unordered_multimap<std::string, iterator_type> by_file_;
+
+		dv::counter_type hit_count_ = 0;
+		dv::counter_type miss_count_ = 0;
+		dv::counter_type eviction_count_ = 0;
+
+		/**
+		 * removes the block from the index; the payload file is deleted if remove_payload is set
+		 */
+		void remove(iterator_type it, bool remove_payload);
+
+		static bool blockContains(const Block &block, const std::vector<dv::offset_type> &offsets,
+								  const std::vector<dv::offset_type> &counts);
+	};
+
+}
+
+#endif //DV_CACHES_BLOCKCACHES_BLOCKCACHE_H_
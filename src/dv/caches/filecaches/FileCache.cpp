@@ -3,3 +3,86 @@
 //
 
 #include "FileCache.h"
+
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+
+#include "FileDescriptor.h"
+#include "../../server/DV.h"
+#include "../../simulator/Simulator.h"
+#include "../../toolbox/TimeHelper.h"
+
+namespace dv {
+
+void FileCache::scanResultFiles(DV *dv_ptr, std::vector<toolbox::FileSystemHelper::ScanEntry> *files,
+                                time_t changed_since) {
+    toolbox::TimeHelper::time_point_type start = toolbox::TimeHelper::now();
+    std::vector<toolbox::FileSystemHelper::ScanEntry> entries;
+    toolbox::FileSystemHelper::scanDir(dv_ptr->getConfigPtr()->sim_result_path_, true, &entries, 0, changed_since);
+    toolbox::TimeHelper::time_point_type scanned = toolbox::TimeHelper::now();
+
+    // filtered in place: no second copy of the entries
+    size_t scanned_count = entries.size();
+    Simulator *simulator_ptr = dv_ptr->getSimulatorPtr();
+    auto last = std::remove_if(entries.begin(), entries.end(),
+                               [dv_ptr, simulator_ptr](const toolbox::FileSystemHelper::ScanEntry &entry) {
+        dv::id_type file_type = simulator_ptr->getResultFileType(entry.name);
+        if (file_type == 0) {
+            return true;
+        }
+        dv_ptr->addResultName(entry.rel_path, file_type);
+        return false;
+    });
+    entries.erase(last, entries.end());
+
+    // the threads of the scan deliver the entries in no particular order: oldest first,
+    // such that the puts are reproducible and the latest files are the most recently used ones
+    std::sort(entries.begin(), entries.end(), [](const toolbox::FileSystemHelper::ScanEntry &a,
+                                                 const toolbox::FileSystemHelper::ScanEntry &b) {
+        return a.mtime != b.mtime ? a.mtime < b.mtime : a.rel_path < b.rel_path;
+    });
+
+    if (files->empty()) {
+        files->swap(entries);
+    } else {
+        std::move(entries.begin(), entries.end(), std::back_inserter(*files));
+    }
+    toolbox::TimeHelper::time_point_type classified = toolbox::TimeHelper::now();
+
+    double scan_s = toolbox::TimeHelper::seconds(start, scanned);
+    double total_s = toolbox::TimeHelper::seconds(start, classified);
+    std::cout << "FileCache: " << scanned_count << " files scanned in " << scan_s << " s ("
+              << (0.0 < scan_s ? scanned_count / scan_s : 0.0) << " files/s); " << files->size()
+              << " result files after classification in " << total_s << " s ("
+              << (0.0 < total_s ? scanned_count / total_s : 0.0) << " files/s)" << std::endl;
+}
+
+bool FileCache::setCapacity(dv::id_type capacity) {
+    return false;
+}
+
+void FileCache::restoreSnapshotEntries(const std::vector<SnapshotEntry> &entries) {
+    for (const auto &entry : entries) {
+        std::unique_ptr<FileDescriptor> fd = std::make_unique<FileDescriptor>(entry.name, entry.file_name);
+        fd->setFileAvailable(true);
+        fd->setSize(entry.size);
+        fd->setUnverified(true);
+        put(entry.key, std::move(fd));
+    }
+
+    for (const auto &entry : entries) {
+        if (entry.part == kFrequency && internal_lookup_get(entry.key) != nullptr) {
+            refresh(entry.key);
+        }
+    }
+}
+
+void FileCache::getSnapshotHistory(std::vector<SnapshotEntry> *entries, int64_t *adaptation) const {
+    *adaptation = -1;
+}
+
+void FileCache::restoreSnapshotHistory(const std::vector<SnapshotEntry> &entries, int64_t adaptation) {
+}
+
+}
@@ -13,6 +13,7 @@
 
 #include "../../DVForwardDeclarations.h"
 #include "../FileCollection.h"
+#include "../../toolbox/FileSystemHelper.h"
 #include "../../toolbox/KeyValueStore.h"
 #include "../../DVBasicTypes.h"
 
@@ -27,6 +28,55 @@ namespace dv {
 
 		virtual void initializeWithFiles() = 0;
 
+		/**
+		 * resident files as kept in CacheSnapshot.
+		 * part: kRecency for plain LRU order, kFrequency for the frequency part of the policy
+		 * (T2 of ARC, LIR set of LIRS), kFifo for the FIFO queue of FileCacheFifoWrapper;
+		 * history of non-resident files: kGhostRecency (B1 of ARC, non-resident HIR files of LIRS),
+		 * kGhostFrequency (B2 of ARC)
+		 */
+		enum SnapshotPart { kRecency = 0, kFrequency = 1, kFifo = 2, kGhostRecency = 3, kGhostFrequency = 4 };
+
+		struct SnapshotEntry {
+			std::string key;
+			std::string name;
+			std::string file_name;
+			dv::size_type size;
+			SnapshotPart part;
+		};
+
+		/**
+		 * appends all resident files from least to most recently used
+		 */
+		virtual void getSnapshotEntries(std::vector<SnapshotEntry> *entries) const = 0;
+
+		/**
+		 * alternative to initializeWithFiles(): puts the files in the given order and refreshes
+		 * the kFrequency entries afterwards, which restores recency order and frequency part
+		 * of all policies approximately. The files are not checked here (see FileDescriptor::isUnverified()).
+		 */
+		virtual void restoreSnapshotEntries(const std::vector<SnapshotEntry> &entries);
+
+		/**
+		 * history of the policy beyond the resident files, from least to most recent:
+		 * ghost entries (kGhost* parts; kFrequency marks the position of a resident file among them)
+		 * and an adaptation parameter (-1: none). Default: no history.
+		 */
+		virtual void getSnapshotHistory(std::vector<SnapshotEntry> *entries, int64_t *adaptation) const;
+
+		/**
+		 * after restoreSnapshotEntries()
+		 */
+		virtual void restoreSnapshotHistory(const std::vector<SnapshotEntry> &entries, int64_t adaptation);
+
+		/**
+		 * result files: parallel scan of the result tree (see FileSystemHelper::scanDir())
+		 * followed by the file type check of the simulator; for initializeWithFiles() and, with
+		 * changed_since, for the files added after a snapshot (see CacheSnapshot)
+		 */
+		static void scanResultFiles(DV *dv_ptr, std::vector<toolbox::FileSystemHelper::ScanEntry> *files,
+									time_t changed_since = 0);
+
 		// put: abstract definition in FileCollection
 
 		virtual FileDescriptor *get(const std::string &key) = 0;
@@ -41,6 +91,13 @@ namespace dv {
 
 		virtual dv::id_type capacity() const = 0;
 
+		/**
+		 * changes the capacity at runtime (see FileCacheFifoWrapper); files beyond the new
+		 * capacity are evicted at once as far as possible.
+		 * false if the cache type does not support it (default); capacity unchanged then
+		 */
+		virtual bool setCapacity(dv::id_type capacity);
+
 		virtual dv::id_type size() const = 0;
 
 		// getStats: abstract definition in FileCollection
@@ -73,7 +130,6 @@ namespace dv {
 
 			return r->second;
 		}
-
 	};
 
 }
@@ -4,6 +4,7 @@
 
 #include "FileCacheARC.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 
@@ -30,32 +31,77 @@ FileCacheARC::FileCacheARC(DV *dv_ptr, FileCacheARC::ID_type capacity)
 void FileCacheARC::initializeWithFiles() {
     std::cout << cache_name_ << "initialized with capacity " << capacity_ << std::endl;
 
-    Simulator *local_simulator_ptr = dv_ptr_->getSimulatorPtr();
-    auto accept_function = [&](const std::string &filename) -> bool {
-        return local_simulator_ptr->getResultFileType(filename) != 0;
-    };
-
-    auto add_file = [&] (const std::string &name,
-                         const std::string &rel_path,
-    const std::string &full_path) -> void {
+    std::vector<toolbox::FileSystemHelper::ScanEntry> files;
+    scanResultFiles(dv_ptr_, &files);
 
-        std::unique_ptr<FileDescriptor> fd = std::make_unique<FileDescriptor>(name, full_path);
+    for (const auto &file : files) {
+        std::unique_ptr<FileDescriptor> fd = std::make_unique<FileDescriptor>(file.name, file.full_path);
         fd->setFileAvailable(true);
-        dv::size_type size = toolbox::FileSystemHelper::fileSize(full_path);
+        dv::size_type size = file.size;
         if (size < 0) {
-            std::cerr << "FileCache: Could not determine file size of " << full_path << std::endl;
+            std::cerr << "FileCache: Could not determine file size of " << file.full_path << std::endl;
             size = 0;
         }
         fd->setSize(size);
-        this->put(name, std::move(fd));
-    };
-
-    toolbox::FileSystemHelper::readDir(dv_ptr_->getConfigPtr()->sim_result_path_,
-                                       add_file, true, accept_function);
+        this->put(file.name, std::move(fd));
+    }
 
     std::cout  << cache_name_ << size() << " files cached." << std::endl;
 }
 
+void FileCacheARC::getSnapshotEntries(std::vector<SnapshotEntry> *entries) const {
+    // T1 first: puts of the restore go to T1; refreshes of the T2 entries move them to T2
+    T1_.forEach([entries](const std::string &key, const std::unique_ptr<FileDescriptor> &fd) {
+        entries->push_back({key, fd->getName(), fd->getFileName(), fd->getSize(), kRecency});
+    });
+    T2_.forEach([entries](const std::string &key, const std::unique_ptr<FileDescriptor> &fd) {
+        entries->push_back({key, fd->getName(), fd->getFileName(), fd->getSize(), kFrequency});
+    });
+}
+
+void FileCacheARC::getSnapshotHistory(std::vector<SnapshotEntry> *entries, int64_t *adaptation) const {
+    B1_.forEach([entries](const std::string &key, const std::unique_ptr<FileDescriptor> &fd) {
+        entries->push_back({key, fd->getName(), fd->getFileName(), 0, kGhostRecency});
+    });
+    B2_.forEach([entries](const std::string &key, const std::unique_ptr<FileDescriptor> &fd) {
+        entries->push_back({key, fd->getName(), fd->getFileName(), 0, kGhostFrequency});
+    });
+    *adaptation = p_;
+}
+
+void FileCacheARC::restoreSnapshotHistory(const std::vector<SnapshotEntry> &entries, int64_t adaptation) {
+    // invariants of Fig. 4: |T1| + |B1| <= c and |T1| + |T2| + |B1| + |B2| <= 2c;
+    // the least recent ghosts are dropped if the capacity was reduced since the snapshot
+    std::vector<const SnapshotEntry *> b1;
+    std::vector<const SnapshotEntry *> b2;
+    for (const auto &entry : entries) {
+        if (find(entry.key).map != kNotFound) {
+            continue;
+        }
+        if (entry.part == kGhostRecency) {
+            b1.push_back(&entry);
+        } else if (entry.part == kGhostFrequency) {
+            b2.push_back(&entry);
+        }
+    }
+
+    ID_type b1_max = std::max<ID_type>(0, capacity_ - T1_.size());
+    ID_type b1_skip = std::max<ID_type>(0, static_cast<ID_type>(b1.size()) - b1_max);
+    for (std::size_t i = b1_skip; i < b1.size(); ++i) {
+        B1_.add(b1[i]->key, std::make_unique<FileDescriptor>(b1[i]->name, b1[i]->file_name));
+    }
+
+    ID_type b2_max = std::max<ID_type>(0, 2 * capacity_ - T1_.size() - T2_.size() - B1_.size());
+    ID_type b2_skip = std::max<ID_type>(0, static_cast<ID_type>(b2.size()) - b2_max);
+    for (std::size_t i = b2_skip; i < b2.size(); ++i) {
+        B2_.add(b2[i]->key, std::make_unique<FileDescriptor>(b2[i]->name, b2[i]->file_name));
+    }
+
+    if (0 <= adaptation) {
+        p_ = std::min<dv::id_type>(adaptation, capacity_);
+    }
+}
+
 void FileCacheARC::put(const std::string &key, std::unique_ptr<FileDescriptor> value) {
     if (debug_messages_) {
         std::cout << cache_name_ << "put_before: " << std::endl;
@@ -398,7 +444,12 @@ void FileCacheARC::evictFile(FileDescriptor *fd) {
     dv_ptr_->getStatsPtr()->incEvictions(fd->getName());
 
 
-    if (toolbox::FileSystemHelper::fileExists(fd->getFileName())) {
+    ColdTier *cold_tier = dv_ptr_->getColdTierPtr();
+    if (cold_tier != nullptr && cold_tier->demote(fd->getName(), fd->getFileName())) {
+        if (debug_messages_) {
+            std::cout << cache_name_ << "moved file " << fd->getFileName() << " to the cold tier" << std::endl;
+        }
+    } else if (toolbox::FileSystemHelper::fileExists(fd->getFileName())) {
         toolbox::FileSystemHelper::rmFile(fd->getFileName());
         if (debug_messages_) {
             std::cout << cache_name_ << "removed file " << fd->getFileName() << std::endl;
@@ -408,6 +459,12 @@ void FileCacheARC::evictFile(FileDescriptor *fd) {
         // continue, file is already "not there"
     }
 
+    // node-local DVLib read caches drop their copies
+    EvictionJournal *journal = dv_ptr_->getEvictionJournalPtr();
+    if (journal != nullptr) {
+        journal->publish(fd->getName());
+    }
+
     fd->setFileAvailable(false);
 }
 
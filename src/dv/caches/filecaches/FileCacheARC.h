@@ -102,6 +102,15 @@ namespace dv {
 
 		virtual void initializeWithFiles() override;
 
+		virtual void getSnapshotEntries(std::vector<SnapshotEntry> *entries) const override;
+
+		/**
+		 * B1 and B2 (LRU -> MRU) and p
+		 */
+		virtual void getSnapshotHistory(std::vector<SnapshotEntry> *entries, int64_t *adaptation) const override;
+
+		virtual void restoreSnapshotHistory(const std::vector<SnapshotEntry> &entries, int64_t adaptation) override;
+
 		virtual void put(const std::string &key, std::unique_ptr<FileDescriptor> value) override;
 
 		virtual FileDescriptor *get(const std::string &key) override;
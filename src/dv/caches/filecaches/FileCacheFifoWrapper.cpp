@@ -4,6 +4,7 @@
 
 #include "FileCacheFifoWrapper.h"
 
+#include <algorithm>
 #include <cstring>
 
 #include "../../server/DV.h"
@@ -14,20 +15,82 @@ namespace dv {
 constexpr char FileCacheFifoWrapper::kCacheName[];
 
 FileCacheFifoWrapper::FileCacheFifoWrapper(DV *dv_ptr, std::unique_ptr<FileCache> embedded_cache,
-        dv::id_type queue_capacity)
+        dv::id_type queue_capacity, dv::id_type queue_min_capacity)
     : FileCache(), dv_ptr_(dv_ptr), embedded_cache_(std::move(embedded_cache)),
-      fifo_queue_(queue_capacity) {
+      fifo_queue_(queue_capacity), fifo_capacity_(queue_capacity),
+      total_capacity_(queue_capacity + embedded_cache_->capacity()), adaptive_(false),
+      fifo_min_capacity_(queue_capacity), fifo_max_capacity_(queue_capacity),
+      fifo_ghosts_(0), embedded_history_(0) {
 
     debug_messages_ = dv_ptr_->getConfigPtr()->filecache_debug_output_on_;
     fifo_queue_.setDebugMode(dv_ptr_->getConfigPtr()->filecache_details_debug_output_on_);
 
     cache_name_ = std::string(kCacheName) + embedded_cache_->name();
+
+    // setting the current capacity tells whether the embedded cache supports changes at all
+    dv::id_type embedded_capacity = embedded_cache_->capacity();
+    if (0 < queue_min_capacity && 0 < embedded_capacity) {
+        adaptive_ = embedded_cache_->setCapacity(embedded_capacity);
+        if (adaptive_) {
+            dv::id_type embedded_min_capacity = dv_ptr_->getConfigPtr()->filecache_protected_mrus_ + 1;
+            fifo_min_capacity_ = std::min(queue_min_capacity, queue_capacity);
+            fifo_max_capacity_ = std::max(queue_capacity, total_capacity_ - embedded_min_capacity);
+            std::cout << cache_name_ << "adaptive FIFO queue size in range [" << fifo_min_capacity_
+                      << ", " << fifo_max_capacity_ << "], initial size " << fifo_capacity_ << std::endl;
+        } else {
+            std::cout << cache_name_ << "embedded cache does not support capacity changes."
+                      << " Fixed FIFO queue size " << fifo_capacity_ << std::endl;
+        }
+    }
 }
 
 void FileCacheFifoWrapper::initializeWithFiles() {
     embedded_cache_->initializeWithFiles();
 }
 
+void FileCacheFifoWrapper::getSnapshotEntries(std::vector<SnapshotEntry> *entries) const {
+    embedded_cache_->getSnapshotEntries(entries);
+    fifo_queue_.forEach([entries](const std::string &key, const std::unique_ptr<FileDescriptor> &fd) {
+        entries->push_back({key, fd->getName(), fd->getFileName(), fd->getSize(), kFifo});
+    });
+}
+
+void FileCacheFifoWrapper::restoreSnapshotEntries(const std::vector<SnapshotEntry> &entries) {
+    std::vector<SnapshotEntry> embedded_entries;
+    for (const auto &entry : entries) {
+        if (entry.part != kFifo) {
+            embedded_entries.push_back(entry);
+        }
+    }
+
+    // a larger FIFO queue of the last run: its files are not evicted during restore
+    dv::id_type fifo_count = entries.size() - embedded_entries.size();
+    if (adaptive_ && fifo_capacity_ < fifo_count) {
+        setFifoCapacity(fifo_count);
+    }
+
+    embedded_cache_->restoreSnapshotEntries(embedded_entries);
+
+    // put() of files without use count adds them to the FIFO queue
+    for (const auto &entry : entries) {
+        if (entry.part == kFifo) {
+            std::unique_ptr<FileDescriptor> fd = std::make_unique<FileDescriptor>(entry.name, entry.file_name);
+            fd->setFileAvailable(true);
+            fd->setSize(entry.size);
+            fd->setUnverified(true);
+            put(entry.key, std::move(fd));
+        }
+    }
+}
+
+void FileCacheFifoWrapper::getSnapshotHistory(std::vector<SnapshotEntry> *entries, int64_t *adaptation) const {
+    embedded_cache_->getSnapshotHistory(entries, adaptation);
+}
+
+void FileCacheFifoWrapper::restoreSnapshotHistory(const std::vector<SnapshotEntry> &entries, int64_t adaptation) {
+    embedded_cache_->restoreSnapshotHistory(entries, adaptation);
+}
+
 void FileCacheFifoWrapper::put(const std::string &key, std::unique_ptr<FileDescriptor> value) {
     if (debug_messages_) {
         std::cout << cache_name_ << "put_before: " << std::endl;
@@ -53,10 +116,15 @@ void FileCacheFifoWrapper::put(const std::string &key, std::unique_ptr<FileDescr
         return;
     }
 
+    // a miss of a client; files produced without request do not count
+    if (adaptive_ && 0 < value->getUseCount()) {
+        adaptSplit(key);
+    }
+
     // regular case distinction as described in class description in header file
     if (value->isFileAvailable()) {
         if (0 < value->getUseCount()) {
-            embedded_cache_->put(key, std::move(value));
+            embeddedCachePut(key, std::move(value));
         } else {
             fifoQueueAdd(key, std::move(value));
         }
@@ -87,6 +155,10 @@ FileDescriptor *FileCacheFifoWrapper::get(const std::string &key) {
     // cache to have ongoing sanity checks that cache items have not been introduced multiple times
 
     FileDescriptor *d = embedded_cache_->get(key);
+    if (d != nullptr && adaptive_) {
+        // keeps the keys of long resident files in the history
+        ghostAdd(&embedded_history_, key, 2 * total_capacity_);
+    }
 
     ID_type fifo_id = fifo_queue_.find(key);
     if (fifo_id != fifo_queue_type::kNone) {
@@ -203,7 +275,7 @@ void FileCacheFifoWrapper::refresh(const std::string &key) {
                     if (debug_messages_) {
                         std::cout << " move from FIFO queue to embedded cache." << std::endl;
                     }
-                    embedded_cache_->put(key, std::move(*fifo_queue_.get(f_id)));
+                    embeddedCachePut(key, std::move(*fifo_queue_.get(f_id)));
                     fifo_queue_.erase(f_id);
 
                 } else {
@@ -233,7 +305,7 @@ void FileCacheFifoWrapper::refresh(const std::string &key) {
                     if (debug_messages_) {
                         std::cout << " available & requested file: move from waiting list to embedded cache." << std::endl;
                     }
-                    embedded_cache_->put(key, std::move(waiting_[key]));
+                    embeddedCachePut(key, std::move(waiting_[key]));
 
                 } else {
                     // not requested file -> into FIFO queue
@@ -276,7 +348,7 @@ dv::id_type FileCacheFifoWrapper::capacity() const {
         return -1;
     }
 
-    return fifo_queue_.capacity() + embedded;
+    return fifo_capacity_ + embedded;
 }
 
 dv::id_type FileCacheFifoWrapper::size() const {
@@ -330,7 +402,7 @@ FileCollection::Stats FileCacheFifoWrapper::getStats() const {
 void FileCacheFifoWrapper::printStatus(std::ostream *out) {
     const Stats stats = getStats();
     *out << cache_name_ << " capacity " << capacity()
-         << " (FIFO queue " << fifo_queue_.capacity()
+         << " (FIFO queue " << fifo_capacity_
          << ", embedded cache " << embedded_cache_->capacity()
          << "), size " << stats.count_all << " (fifo " << fifo_queue_.size() << ", cache " << embedded_cache_->size()
          << "), evictable " << stats.count_evictable
@@ -341,6 +413,13 @@ void FileCacheFifoWrapper::printStatus(std::ostream *out) {
          << ", " << (stats.filesize_all > 0 ? ((stats.filesize_evictable * 100) / stats.filesize_all) : 0)
          << "%" << std::endl;
 
+    if (adaptive_) {
+        *out << "adaptive FIFO queue size in range [" << fifo_min_capacity_ << ", " << fifo_max_capacity_
+             << "]; ghost hits FIFO queue " << fifo_ghost_hits_ << ", embedded cache " << embedded_ghost_hits_
+             << "; ghosts FIFO queue " << fifo_ghosts_.size() << ", embedded cache " << embeddedGhostCount()
+             << std::endl;
+    }
+
     *out << std::endl;
 }
 
@@ -356,6 +435,9 @@ const toolbox::KeyValueStore &FileCacheFifoWrapper::getStatusSummary() {
     statusSummary_.setInt("cache_filesize_all", stats.filesize_all);
     statusSummary_.setInt("cache_filesize_evictable", stats.filesize_evictable);
     statusSummary_.setInt("cache_filesize_evictable_percent", stats.filesize_all > 0 ? ((stats.filesize_evictable * 100) / stats.filesize_all) : 0);
+    statusSummary_.setInt("cache_fifo_capacity", fifo_capacity_);
+    statusSummary_.setInt("cache_fifo_ghost_hits", fifo_ghost_hits_);
+    statusSummary_.setInt("cache_embedded_ghost_hits", embedded_ghost_hits_);
     return statusSummary_;
 }
 
@@ -363,48 +445,139 @@ const toolbox::KeyValueStore &FileCacheFifoWrapper::getStatusSummary() {
 //--- private methods --------------------------------------------------------------------------
 
 void FileCacheFifoWrapper::fifoQueueAdd(const std::string &key, std::unique_ptr<FileDescriptor> value) {
-    if (fifo_queue_.size() < fifo_queue_.capacity()) {
-        fifo_queue_.add(key, std::move(value));
-    } else {
-        // find a file that is not being overwritten at the moment by a simulator
-        // note: while lock check is in here for completeness, no file in FIFO has a lock.
-        // all files with locks (i.e. use count > 0) are in the embedded cache.
+    if (fifo_capacity_ <= fifo_queue_.size() && !fifoQueueEvict()) {
+        // this can only happen if all files in the FIFO queue are being re-simulated at the same time
+        // which is very unlikely. Thus: report and silently extend FIFO queue by 1.
+        // additional note: FIFO queue size should be at least as large as restart interval * number of parallel simulators + 1
+        std::cout << cache_name_ << " no evictable file found in FIFO queue. All are being re-simulated at the same time."
+                  << " Check FIFO queue size. Silent extension of FIFO queue size by 1." << std::endl;
+        std::cerr << cache_name_ << " no evictable file found in FIFO queue. All are being re-simulated at the same time."
+                  << " Check FIFO queue size. Silent extension of FIFO queue size by 1." << std::endl;
+        ++fifo_capacity_;
+        ++total_capacity_;
+    }
 
-        auto lruPredicate = [](const std::unique_ptr<FileDescriptor> &fd) -> bool {
-            return fd->getLockCount() == 0 && !fd->isFileUsedBySimulator();
-        };
+    fifo_queue_.add(key, std::move(value));
+}
 
-        ID_type victim = fifo_queue_.findFirstWithPredicate(lruPredicate, false, 0);
+bool FileCacheFifoWrapper::fifoQueueEvict() {
+    // find a file that is not being overwritten at the moment by a simulator
+    // note: while lock check is in here for completeness, no file in FIFO has a lock.
+    // all files with locks (i.e. use count > 0) are in the embedded cache.
+
+    auto lruPredicate = [](const std::unique_ptr<FileDescriptor> &fd) -> bool {
+        return fd->getLockCount() == 0 && !fd->isFileUsedBySimulator();
+    };
 
-        if (victim == fifo_queue_type::kNone) {
-            // this can only happen if all files in the FIFO queue are being re-simulated at the same time
-            // which is very unlikely. Thus: report and silently extend FIFO queue by 1.
-            // additional note: FIFO queue size should be at least as large as restart interval * number of parallel simulators + 1
-            std::cout << cache_name_ << " no evictable file found in FIFO queue. All are being re-simulated at the same time."
-                      << " Check FIFO queue size. Silent extension of FIFO queue size by 1." << std::endl;
-            std::cerr << cache_name_ << " no evictable file found in FIFO queue. All are being re-simulated at the same time."
-                      << " Check FIFO queue size. Silent extension of FIFO queue size by 1." << std::endl;
+    ID_type victim = fifo_queue_.findFirstWithPredicate(lruPredicate, false, 0);
+    if (victim == fifo_queue_type::kNone) {
+        return false;
+    }
 
-            fifo_queue_.add(key, std::move(value));
-            return;
+    // remove file
+    FileDescriptor *descriptor = fifo_queue_.get(victim)->get();
+    dv_ptr_->getStatsPtr()->incFifoQueueEvictions(descriptor->getName());
+
+    ColdTier *cold_tier = dv_ptr_->getColdTierPtr();
+    if (cold_tier != nullptr && cold_tier->demote(descriptor->getName(), descriptor->getFileName())) {
+        if (debug_messages_) {
+            std::cout << cache_name_ << "moved file from FIFO queue to the cold tier " << descriptor->getFileName() << std::endl;
         }
+    } else if (toolbox::FileSystemHelper::fileExists(descriptor->getFileName())) {
+        toolbox::FileSystemHelper::rmFile(descriptor->getFileName());
+        if (debug_messages_) {
+            std::cout << cache_name_ << "removed file from FIFO queue " << descriptor->getFileName() << std::endl;
+        }
+    } else {
+        std::cerr << cache_name_ << "evict(): file " << descriptor->getFileName() << " should be removed, but does not exist. (" << std::strerror(errno) << ")" << std::endl;
+        // continue, file is already "not there"
+    }
 
-        // remove file
-        FileDescriptor *descriptor = fifo_queue_.get(victim)->get();
-        dv_ptr_->getStatsPtr()->incFifoQueueEvictions(descriptor->getName());
+    // node-local DVLib read caches drop their copies
+    EvictionJournal *journal = dv_ptr_->getEvictionJournalPtr();
+    if (journal != nullptr) {
+        journal->publish(descriptor->getName());
+    }
 
-        if (toolbox::FileSystemHelper::fileExists(descriptor->getFileName())) {
-            toolbox::FileSystemHelper::rmFile(descriptor->getFileName());
-            if (debug_messages_) {
-                std::cout << cache_name_ << "removed file from FIFO queue " << descriptor->getFileName() << std::endl;
-            }
-        } else {
-            std::cerr << cache_name_ << "evict(): file " << descriptor->getFileName() << " should be removed, but does not exist. (" << std::strerror(errno) << ")" << std::endl;
-            // continue, file is already "not there"
+    // the name of the file is its key in the cache
+    if (adaptive_) {
+        ghostErase(&embedded_history_, descriptor->getName());
+        ghostAdd(&fifo_ghosts_, descriptor->getName(), total_capacity_);
+    }
+
+    fifo_queue_.erase(victim);
+    return true;
+}
+
+void FileCacheFifoWrapper::embeddedCachePut(const std::string &key, std::unique_ptr<FileDescriptor> value) {
+    if (adaptive_) {
+        ghostErase(&fifo_ghosts_, key);
+        ghostAdd(&embedded_history_, key, 2 * total_capacity_);
+    }
+    embedded_cache_->put(key, std::move(value));
+}
+
+void FileCacheFifoWrapper::adaptSplit(const std::string &key) {
+    // sizes before the hit is removed, as in ARC
+    dv::id_type fifo_ghosts = fifo_ghosts_.size();
+    dv::id_type embedded_ghosts = embeddedGhostCount();
+
+    if (ghostErase(&fifo_ghosts_, key)) {
+        ++fifo_ghost_hits_;
+        dv::id_type delta = embedded_ghosts <= fifo_ghosts ? 1 : embedded_ghosts / fifo_ghosts;
+        setFifoCapacity(fifo_capacity_ + delta);
+    } else if (ghostErase(&embedded_history_, key)) {
+        ++embedded_ghost_hits_;
+        dv::id_type delta = fifo_ghosts <= embedded_ghosts ? 1 : fifo_ghosts / embedded_ghosts;
+        setFifoCapacity(fifo_capacity_ - delta);
+    }
+}
+
+void FileCacheFifoWrapper::setFifoCapacity(dv::id_type fifo_capacity) {
+    fifo_capacity = std::max(fifo_min_capacity_, std::min(fifo_capacity, fifo_max_capacity_));
+    if (fifo_capacity == fifo_capacity_) {
+        return;
+    }
+
+    if (debug_messages_) {
+        std::cout << cache_name_ << "FIFO queue size " << fifo_capacity_ << " -> " << fifo_capacity << std::endl;
+    }
+
+    // the shrinking side evicts first: the number of files stays within the total capacity
+    if (fifo_capacity < fifo_capacity_) {
+        fifo_capacity_ = fifo_capacity;
+        while (fifo_capacity_ < fifo_queue_.size() && fifoQueueEvict()) {
         }
+        embedded_cache_->setCapacity(total_capacity_ - fifo_capacity_);
+    } else {
+        embedded_cache_->setCapacity(total_capacity_ - fifo_capacity);
+        fifo_capacity_ = fifo_capacity;
+    }
+}
+
+dv::id_type FileCacheFifoWrapper::embeddedGhostCount() const {
+    // the history also holds the keys of resident files
+    return std::max<dv::id_type>(1, embedded_history_.size() - embedded_cache_->size());
+}
+
+void FileCacheFifoWrapper::ghostAdd(ghost_list_type *ghosts, const std::string &key, dv::id_type max_size) {
+    ghost_list_type::ID_type id = ghosts->find(key);
+    if (id != ghost_list_type::kNone) {
+        ghosts->refreshWithId(id);
+    } else if (ghosts->size() < max_size) {
+        ghosts->add(key, true);
+    } else {
+        ghosts->replace(ghosts->getLruId(), key, true);
+    }
+}
 
-        // insert new descriptor
-        fifo_queue_.replace(victim, key, std::move(value));
+bool FileCacheFifoWrapper::ghostErase(ghost_list_type *ghosts, const std::string &key) {
+    ghost_list_type::ID_type id = ghosts->find(key);
+    if (id == ghost_list_type::kNone) {
+        return false;
     }
+    ghosts->erase(id);
+    return true;
 }
+
 }
@@ -61,6 +61,23 @@ namespace dv {
 	 * And final note: The FIFO queue is again a LinkedMap since both feature sets
 	 * must be provided: FIFO and hashmap.
 	 *
+	 * Adaptive split (0 < filecache_fifo_queue_min_size in the config file):
+	 * the split between FIFO queue and embedded cache follows the load as p in ARC does for T1/T2.
+	 * Two ghost lists keep the keys of files that left each side recently: keys evicted from the
+	 * FIFO queue, and keys handed to the embedded cache (the ones that are not resident anymore
+	 * are its ghosts). Each client miss (put of a requested file) whose key is found in one of them
+	 * would have been a hit with a larger partition on that side: the FIFO queue grows by
+	 * max(1, |embedded ghosts| / |FIFO ghosts|) on FIFO ghost hits and shrinks by
+	 * max(1, |FIFO ghosts| / |embedded ghosts|) on embedded ghost hits; the embedded cache gets the
+	 * rest of the capacity. Files beyond the new size of a side are evicted at once.
+	 * - the FIFO queue keeps at least filecache_fifo_queue_min_size entries (see note 2 above)
+	 * - the embedded cache keeps at least filecache_protected_mrus + 1 entries
+	 * - both ghost lists cover about one cache capacity of keys that left their side
+	 * - needs an embedded cache with setCapacity() (LRU and the caches built on it); the split
+	 *   stays fixed with other types (ARC and LIRS adapt internally already)
+	 * - filecache_fifo_queue_size is the initial size of the FIFO queue; a snapshot with more
+	 *   FIFO queue files enlarges it as far as possible
+	 *
 	 * v1.0 2017-09-22 / 2017-09-23 ps
 	 */
 
@@ -71,10 +88,30 @@ namespace dv {
 
 		typedef std::unordered_map<std::string, std::unique_ptr<FileDescriptor>> waiting_map_type;
 
-		FileCacheFifoWrapper(DV *dv_ptr, std::unique_ptr<FileCache> embedded_cache, dv::id_type queue_capacity);
+		typedef toolbox::LinkedMap<std::string, bool> ghost_list_type;
+
+		/**
+		 * queue_min_capacity: 0 for a fixed split; otherwise lower bound of the adaptive FIFO queue size
+		 */
+		FileCacheFifoWrapper(DV *dv_ptr, std::unique_ptr<FileCache> embedded_cache, dv::id_type queue_capacity,
+							 dv::id_type queue_min_capacity);
 
 		virtual void initializeWithFiles() override;
 
+		virtual void getSnapshotEntries(std::vector<SnapshotEntry> *entries) const override;
+
+		/**
+		 * kFifo entries go to the FIFO queue; all others are restored by the embedded cache
+		 */
+		virtual void restoreSnapshotEntries(const std::vector<SnapshotEntry> &entries) override;
+
+		/**
+		 * history of the embedded cache
+		 */
+		virtual void getSnapshotHistory(std::vector<SnapshotEntry> *entries, int64_t *adaptation) const override;
+
+		virtual void restoreSnapshotHistory(const std::vector<SnapshotEntry> &entries, int64_t adaptation) override;
+
 		virtual void put(const std::string &key, std::unique_ptr<FileDescriptor> value) override;
 
 		virtual FileDescriptor *get(const std::string &key) override;
@@ -105,6 +142,18 @@ namespace dv {
 		fifo_queue_type fifo_queue_;
 		waiting_map_type waiting_;
 
+		// the capacity of the LinkedMap only grows; this is the actual size of the FIFO queue
+		dv::id_type fifo_capacity_;
+		dv::id_type total_capacity_;
+
+		bool adaptive_;
+		dv::id_type fifo_min_capacity_;
+		dv::id_type fifo_max_capacity_;
+		ghost_list_type fifo_ghosts_;
+		ghost_list_type embedded_history_;
+		dv::counter_type fifo_ghost_hits_ = 0;
+		dv::counter_type embedded_ghost_hits_ = 0;
+
 		bool debug_messages_;
 		std::string cache_name_;
 
@@ -113,6 +162,27 @@ namespace dv {
 		toolbox::KeyValueStore statusSummary_;
 
 		void fifoQueueAdd(const std::string &key, std::unique_ptr<FileDescriptor> value);
+
+		/**
+		 * evicts the LRU file of the FIFO queue that is not being re-simulated;
+		 * false if there is none
+		 */
+		bool fifoQueueEvict();
+
+		void embeddedCachePut(const std::string &key, std::unique_ptr<FileDescriptor> value);
+
+		/**
+		 * ghost list check of a client miss and resulting change of the split
+		 */
+		void adaptSplit(const std::string &key);
+
+		void setFifoCapacity(dv::id_type fifo_capacity);
+
+		dv::id_type embeddedGhostCount() const;
+
+		static void ghostAdd(ghost_list_type *ghosts, const std::string &key, dv::id_type max_size);
+
+		static bool ghostErase(ghost_list_type *ghosts, const std::string &key);
 	};
 
 }
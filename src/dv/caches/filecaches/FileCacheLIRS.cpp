@@ -30,18 +30,18 @@ bool FileCacheLIRS::isStateWithFile(FileCacheLIRS::State state) {
 FileCacheLIRS::MetaData::MetaData(std::unique_ptr<FileDescriptor> fileDescriptor,
                                   FileCacheLIRS::State state,
                                   FileCacheLIRS::clock_type now,
-                                  DVStats *stats)
+                                  DV *dv_ptr)
     : fileDescriptor_(std::move(fileDescriptor)), state_(state),
-      current_(now), stats_(stats) {}
+      current_(now), dv_ptr_(dv_ptr) {}
 
 FileCacheLIRS::MetaData::MetaData(std::unique_ptr<FileDescriptor> fileDescriptor,
                                   FileCacheLIRS::State state,
                                   FileCacheLIRS::clock_type now,
                                   const FileCacheLIRS::MetaData &history,
-                                  DVStats *stats) {
+                                  DV *dv_ptr) {
     current_ = history.current_;
     irr_ = history.irr_;
-    stats_ = stats;
+    dv_ptr_ = dv_ptr;
     setStateWithFileDescriptor(state, std::move(fileDescriptor), now);
 }
 
@@ -73,8 +73,11 @@ void FileCacheLIRS::MetaData::setStateWithoutClockChange(FileCacheLIRS::State st
     if (!isStateWithFile(state_)) {
         FileDescriptor *fd = fileDescriptor_.get();
         if (fd != nullptr) {
-            // remove file
-            if (toolbox::FileSystemHelper::fileExists(fd->getFileName())) {
+            // remove file (or keep it in the cold tier)
+            ColdTier *cold_tier = dv_ptr_->getColdTierPtr();
+            if (cold_tier != nullptr && cold_tier->demote(fd->getName(), fd->getFileName())) {
+                std::cout << "Cache: moved file " << fd->getFileName() << " to the cold tier" << std::endl;
+            } else if (toolbox::FileSystemHelper::fileExists(fd->getFileName())) {
                 toolbox::FileSystemHelper::rmFile(fd->getFileName());
                 std::cout << "Cache: removed file " << fd->getFileName() << std::endl;
             } else {
@@ -87,11 +90,17 @@ void FileCacheLIRS::MetaData::setStateWithoutClockChange(FileCacheLIRS::State st
                 // continue, file is already "not there"
             }
 
+            // node-local DVLib read caches drop their copies
+            EvictionJournal *journal = dv_ptr_->getEvictionJournalPtr();
+            if (journal != nullptr) {
+                journal->publish(fd->getName());
+            }
+
             // remove filedescriptor
             fileDescriptor_.release();
 
             // adjust stats
-            stats_->incEvictions(fd->getName());
+            dv_ptr_->getStatsPtr()->incEvictions(fd->getName());
         }
     }
 
@@ -148,32 +157,66 @@ void FileCacheLIRS::initializeWithFiles() {
     std::cout << cache_name_ << "initialized with capacity " << total_capacity_
               << " and Q queue capacity " << resident_hir_capacity_ << std::endl;
 
-    Simulator *local_simulator_ptr = dv_ptr_->getSimulatorPtr();
-    auto accept_function = [&](const std::string &filename) -> bool {
-        return local_simulator_ptr->getResultFileType(filename) != 0;
-    };
+    std::vector<toolbox::FileSystemHelper::ScanEntry> files;
+    scanResultFiles(dv_ptr_, &files);
 
-    auto add_file = [&] (const std::string &name,
-                         const std::string &rel_path,
-    const std::string &full_path) -> void {
-
-        std::unique_ptr<FileDescriptor> fd = std::make_unique<FileDescriptor>(name, full_path);
+    for (const auto &file : files) {
+        std::unique_ptr<FileDescriptor> fd = std::make_unique<FileDescriptor>(file.name, file.full_path);
         fd->setFileAvailable(true);
-        dv::size_type size = toolbox::FileSystemHelper::fileSize(full_path);
+        dv::size_type size = file.size;
         if (size < 0) {
-            std::cerr << "FileCache: Could not determine file size of " << full_path << std::endl;
+            std::cerr << "FileCache: Could not determine file size of " << file.full_path << std::endl;
             size = 0;
         }
         fd->setSize(size);
-        this->put(name, std::move(fd));
-    };
-
-    toolbox::FileSystemHelper::readDir(dv_ptr_->getConfigPtr()->sim_result_path_,
-                                       add_file, true, accept_function);
+        this->put(file.name, std::move(fd));
+    }
 
     std::cout  << cache_name_ << q_queue_.size() << " files cached." << std::endl;
 }
 
+void FileCacheLIRS::getSnapshotEntries(std::vector<SnapshotEntry> *entries) const {
+    // resident HIR files (Q queue) first, then the LIR set in S queue order
+    q_queue_.forEach([entries](const std::string &key, MetaData * const &m) {
+        FileDescriptor *fd = m->getFileDescriptor();
+        entries->push_back({key, fd->getName(), fd->getFileName(), fd->getSize(), kRecency});
+    });
+    s_queue_.forEach([entries](const std::string &key, const std::unique_ptr<MetaData> &m) {
+        if (m->getState() == kLIR) {
+            FileDescriptor *fd = m->getFileDescriptor();
+            entries->push_back({key, fd->getName(), fd->getFileName(), fd->getSize(), kFrequency});
+        }
+    });
+}
+
+void FileCacheLIRS::getSnapshotHistory(std::vector<SnapshotEntry> *entries, int64_t *adaptation) const {
+    // S queue order of LIR files (position only) and non-resident HIR files
+    s_queue_.forEach([entries](const std::string &key, const std::unique_ptr<MetaData> &m) {
+        if (m->getState() == kLIR) {
+            entries->push_back({key, key, "", 0, kFrequency});
+        } else if (m->getState() == kNonResidentHIR) {
+            entries->push_back({key, key, "", 0, kGhostRecency});
+        }
+    });
+    *adaptation = -1;
+}
+
+void FileCacheLIRS::restoreSnapshotHistory(const std::vector<SnapshotEntry> &entries, int64_t adaptation) {
+    for (const auto &entry : entries) {
+        ID_type id = s_queue_.find(entry.key);
+        if (entry.part == kFrequency) {
+            if (id != kNone && s_queue_.get(id)->get()->getState() == kLIR) {
+                s_queue_.refreshWithId(id);
+            }
+        } else if (entry.part == kGhostRecency && id == kNone && waiting_.find(entry.key) == waiting_.end()) {
+            s_queue_.add(entry.key, std::make_unique<MetaData>(nullptr, kNonResidentHIR, tick(), dv_ptr_));
+        }
+    }
+
+    // resident HIR files that stayed below the LRU LIR file leave the S queue
+    prune_S("");
+}
+
 void FileCacheLIRS::put(const std::string &key, std::unique_ptr<FileDescriptor> value) {
     if (debug_messages_) {
         std::cout << cache_name_ << "put_before: " << std::endl;
@@ -526,11 +569,11 @@ void FileCacheLIRS::actualPut(const std::string &key, std::unique_ptr<FileDescri
     if (id == kNone) {
         // no former meta information available
         if (lir_size_ < lir_capacity_) {
-            std::unique_ptr<MetaData> md = std::make_unique<MetaData>(std::move(value), kLIR, now, dv_stats_);
+            std::unique_ptr<MetaData> md = std::make_unique<MetaData>(std::move(value), kLIR, now, dv_ptr_);
             lir_size_++;
             s_queue_.add(key, std::move(md));
         } else {
-            std::unique_ptr<MetaData> md = std::make_unique<MetaData>(std::move(value), kResidentHIR, now, dv_stats_);
+            std::unique_ptr<MetaData> md = std::make_unique<MetaData>(std::move(value), kResidentHIR, now, dv_ptr_);
             if (q_queue_.size() < resident_hir_capacity_) {
                 q_queue_.add(key, md.get());
                 s_queue_.add(key, std::move(md));
@@ -558,14 +601,14 @@ void FileCacheLIRS::actualPut(const std::string &key, std::unique_ptr<FileDescri
         if (lir_size_ < lir_capacity_) {
             assert(s == kPool);
             // note: this path will never happen; just here to be complete (and symmetric to case distinction above)
-            std::unique_ptr<MetaData> md = std::make_unique<MetaData>(std::move(value), kLIR, now, dv_stats_);
+            std::unique_ptr<MetaData> md = std::make_unique<MetaData>(std::move(value), kLIR, now, dv_ptr_);
             s_queue_.replace(id, key, std::move(md));
         } else {
 
             if (s == kNonResidentHIR) {
                 // adjust LRU of LIR set as new MRU of resident HIR
                 // and make the reactivated non-resident HIR a LIR
-                std::unique_ptr<MetaData> md = std::make_unique<MetaData>(std::move(value), kLIR, now, *mdp, dv_stats_);
+                std::unique_ptr<MetaData> md = std::make_unique<MetaData>(std::move(value), kLIR, now, *mdp, dv_ptr_);
                 if (q_queue_.size() < resident_hir_capacity_) {
                     ID_type s_lru = findLastLIR_in_S(false);
                     if (s_lru == kNone) {
@@ -614,7 +657,7 @@ void FileCacheLIRS::actualPut(const std::string &key, std::unique_ptr<FileDescri
 
             } else {
                 // kPool: like kNone just with re-using of list space
-                std::unique_ptr<MetaData> md = std::make_unique<MetaData>(std::move(value), kResidentHIR, now, dv_stats_);
+                std::unique_ptr<MetaData> md = std::make_unique<MetaData>(std::move(value), kResidentHIR, now, dv_ptr_);
                 if (q_queue_.size() < resident_hir_capacity_) {
                     q_queue_.add(key, md.get());
                     s_queue_.replace(id, key, std::move(md));
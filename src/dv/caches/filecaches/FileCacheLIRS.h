@@ -78,10 +78,10 @@ namespace dv {
 
 		class MetaData {
 		public:
-			MetaData(std::unique_ptr<FileDescriptor> fileDescriptor, State state, clock_type now, DVStats *stats);
+			MetaData(std::unique_ptr<FileDescriptor> fileDescriptor, State state, clock_type now, DV *dv_ptr);
 
 			MetaData(std::unique_ptr<FileDescriptor> fileDescriptor, State state, clock_type now,
-					 const MetaData &history, DVStats *stats);
+					 const MetaData &history, DV *dv_ptr);
 
 			bool isFileAvailable() const;
 
@@ -101,7 +101,7 @@ namespace dv {
 			State state_;
 			clock_type current_;
 			clock_type irr_ = std::numeric_limits<clock_type>::max();
-			DVStats *stats_;
+			DV *dv_ptr_;
 
 		};
 
@@ -131,6 +131,15 @@ namespace dv {
 
 		virtual void initializeWithFiles() override;
 
+		virtual void getSnapshotEntries(std::vector<SnapshotEntry> *entries) const override;
+
+		/**
+		 * non-resident HIR files and their position relative to the LIR files in S queue
+		 */
+		virtual void getSnapshotHistory(std::vector<SnapshotEntry> *entries, int64_t *adaptation) const override;
+
+		virtual void restoreSnapshotHistory(const std::vector<SnapshotEntry> &entries, int64_t adaptation) override;
+
 		virtual void put(const std::string &key, std::unique_ptr<FileDescriptor> value) override;
 
 		virtual FileDescriptor *get(const std::string &key) override;
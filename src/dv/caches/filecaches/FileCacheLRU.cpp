@@ -4,6 +4,7 @@
 
 #include "FileCacheLRU.h"
 
+#include <algorithm>
 #include <iostream>
 #include <cerrno>
 #include <cstring>
@@ -29,33 +30,30 @@ void FileCacheLRU::initializeWithFiles() {
     std::cout << cache_name_ << "initialized with capacity " << capacity_
               << " and protected MRUs " << protected_mrus_ << std::endl;
 
-    Simulator *local_simulator_ptr = dv_ptr_->getSimulatorPtr();
-    auto accept_function = [&](const std::string &filename) -> bool {
-        return local_simulator_ptr->getResultFileType(filename) != 0;
-    };
-
-    auto add_file = [&] (const std::string &name,
-                         const std::string &rel_path,
-    const std::string &full_path) -> void {
+    std::vector<toolbox::FileSystemHelper::ScanEntry> files;
+    scanResultFiles(dv_ptr_, &files);
 
-        //std::cout << "LRU adding " << name << " (" << rel_path << ")" << std::endl;
-        std::unique_ptr<FileDescriptor> fd = std::make_unique<FileDescriptor>(name, full_path);
+    for (const auto &file : files) {
+        std::unique_ptr<FileDescriptor> fd = std::make_unique<FileDescriptor>(file.name, file.full_path);
         fd->setFileAvailable(true);
-        dv::size_type size = toolbox::FileSystemHelper::fileSize(full_path);
+        dv::size_type size = file.size;
         if (size < 0) {
-            std::cerr << "FileCache: Could not determine file size of " << full_path << std::endl;
+            std::cerr << "FileCache: Could not determine file size of " << file.full_path << std::endl;
             size = 0;
         }
         fd->setSize(size);
-        if (size>0 /* <- it's not a fake file. TODO: we should identify this case better, 0-bytes file may be legit */) this->put(rel_path, std::move(fd));
-    };
-
-    toolbox::FileSystemHelper::readDir(dv_ptr_->getConfigPtr()->sim_result_path_,
-                                       add_file, true, accept_function);
+        if (size>0 /* <- it's not a fake file. TODO: we should identify this case better, 0-bytes file may be legit */) this->put(file.rel_path, std::move(fd));
+    }
 
     std::cout  << cache_name_ << cache_.size() << " files cached." << std::endl;
 }
 
+void FileCacheLRU::getSnapshotEntries(std::vector<SnapshotEntry> *entries) const {
+    cache_.forEach([entries](const std::string &key, const std::unique_ptr<FileDescriptor> &fd) {
+        entries->push_back({key, fd->getName(), fd->getFileName(), fd->getSize(), kRecency});
+    });
+}
+
 void FileCacheLRU::put(const std::string &key, std::unique_ptr<FileDescriptor> value) {
     if (debug_messages_) {
         std::cout << cache_name_ << "put_before: " << std::endl;
@@ -239,7 +237,28 @@ const std::string &FileCacheLRU::name() const {
 }
 
 dv::id_type FileCacheLRU::capacity() const {
-    return cache_.capacity();
+    // the map is larger than capacity_ if no file could be evicted
+    return std::max(capacity_, cache_.size());
+}
+
+/**
+ * also used by all classes inheriting from LRU: evict() handles their additional data structures
+ */
+bool FileCacheLRU::setCapacity(dv::id_type capacity) {
+    if (capacity <= 0 || kMaxCapacity < capacity) {
+        return false;
+    }
+
+    capacity_ = static_cast<ID_type>(capacity);
+    while (capacity_ < cache_.size()) {
+        id_cost_pair_type r = evict();
+        if (r.first == kNone) {
+            // error message was already printed; remaining files are evicted by later puts
+            break;
+        }
+        cache_.erase(r.first);
+    }
+    return true;
 }
 
 dv::id_type FileCacheLRU::size() const {
@@ -283,7 +302,7 @@ FileCollection::Stats FileCacheLRU::getStats() const {
 
 void FileCacheLRU::printStatus(std::ostream *out) {
     const Stats stats = getStats();
-    *out << cache_name_ << " capacity " << cache_.capacity()
+    *out << cache_name_ << " capacity " << capacity()
          << ", size " << stats.count_all << ", evictable " << stats.count_evictable
          << " (" << (stats.count_all > 0 ? ((stats.count_evictable * 100) / stats.count_all) : 0)
          << "%), waiting list size " << waiting_.size() << std::endl
@@ -306,7 +325,7 @@ const toolbox::KeyValueStore &FileCacheLRU::getStatusSummary() {
     // update summary
     const Stats stats = getStats();
     statusSummary_.setString("cache_name", cache_name_);
-    statusSummary_.setInt("cache_capacity", cache_.capacity());
+    statusSummary_.setInt("cache_capacity", capacity());
     statusSummary_.setInt("cache_size", stats.count_all);
     statusSummary_.setInt("cache_size_evictable", stats.count_evictable);
     statusSummary_.setInt("cache_size_evictable_percent", stats.count_all > 0 ? ((stats.count_evictable * 100) / stats.count_all) : 0);
@@ -365,7 +384,12 @@ FileCacheLRU::id_cost_pair_type FileCacheLRU::evict() {
     dv_ptr_->getStatsPtr()->incEvictions(descriptor->getName());
 
 
-    if (toolbox::FileSystemHelper::fileExists(descriptor->getFileName())) {
+    ColdTier *cold_tier = dv_ptr_->getColdTierPtr();
+    if (cold_tier != nullptr && cold_tier->demote(descriptor->getName(), descriptor->getFileName())) {
+        if (debug_messages_) {
+            std::cout << cache_name_ << "moved file " << descriptor->getFileName() << " to the cold tier" << std::endl;
+        }
+    } else if (toolbox::FileSystemHelper::fileExists(descriptor->getFileName())) {
         toolbox::FileSystemHelper::rmFile(descriptor->getFileName());
         if (debug_messages_) {
             std::cout << cache_name_ << "removed file " << descriptor->getFileName() << std::endl;
@@ -375,6 +399,12 @@ FileCacheLRU::id_cost_pair_type FileCacheLRU::evict() {
         // continue, file is already "not there"
     }
 
+    // node-local DVLib read caches drop their copies
+    EvictionJournal *journal = dv_ptr_->getEvictionJournalPtr();
+    if (journal != nullptr) {
+        journal->publish(descriptor->getName());
+    }
+
     // eviction by replacement happens for the cache database in actualPut()
     return r;
 }
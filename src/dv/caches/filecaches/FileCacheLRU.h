@@ -36,6 +36,8 @@ namespace dv {
 
 		virtual void initializeWithFiles() override;
 
+		virtual void getSnapshotEntries(std::vector<SnapshotEntry> *entries) const override;
+
 		virtual void put(const std::string &key, std::unique_ptr<FileDescriptor> value) override;
 
 		virtual FileDescriptor *get(const std::string &key) override;
@@ -50,6 +52,8 @@ namespace dv {
 
 		virtual dv::id_type capacity() const override;
 
+		virtual bool setCapacity(dv::id_type capacity) override;
+
 		virtual dv::id_type size() const override;
 
 		virtual Stats getStats() const override;
@@ -237,8 +237,13 @@ FileCacheLRU::id_cost_pair_type FileCachePartitionAwareBase::evict() {
         }
     }
 
-    // remove file
-    if (toolbox::FileSystemHelper::fileExists(descriptor->getFileName())) {
+    // remove file (or keep it in the cold tier)
+    ColdTier *cold_tier = dv_ptr_->getColdTierPtr();
+    if (cold_tier != nullptr && cold_tier->demote(descriptor->getName(), descriptor->getFileName())) {
+        if (debug_messages_) {
+            std::cout << cache_name_ << "moved file " << descriptor->getFileName() << " to the cold tier" << std::endl;
+        }
+    } else if (toolbox::FileSystemHelper::fileExists(descriptor->getFileName())) {
         toolbox::FileSystemHelper::rmFile(descriptor->getFileName());
         if (debug_messages_) {
             std::cout << cache_name_ << "removed file " << descriptor->getFileName() << std::endl;
@@ -248,6 +253,12 @@ FileCacheLRU::id_cost_pair_type FileCachePartitionAwareBase::evict() {
         // continue, file is already "not there"
     }
 
+    // node-local DVLib read caches drop their copies
+    EvictionJournal *journal = dv_ptr_->getEvictionJournalPtr();
+    if (journal != nullptr) {
+        journal->publish(descriptor->getName());
+    }
+
     // eviction by replacement happens for the cache database in actualPut()
     return r;
 }
@@ -16,32 +16,32 @@ constexpr char FileCacheUnlimited::kCacheName[];
 FileCacheUnlimited::FileCacheUnlimited(DV *dv_ptr) : dv_ptr_(dv_ptr), cache_name_(kCacheName) {}
 
 void FileCacheUnlimited::initializeWithFiles() {
-    Simulator *local_simulator_ptr = dv_ptr_->getSimulatorPtr();
-    auto accept_function = [&](const std::string &filename) -> bool {
-        return local_simulator_ptr->getResultFileType(filename) != 0;
-    };
+    std::vector<toolbox::FileSystemHelper::ScanEntry> files;
+    scanResultFiles(dv_ptr_, &files);
 
-    auto add_file = [&] (const std::string &name,
-                         const std::string &rel_path,
-    const std::string &full_path) -> void {
-
-        std::unique_ptr<FileDescriptor> fd = std::make_unique<FileDescriptor>(name, full_path);
+    for (const auto &file : files) {
+        std::unique_ptr<FileDescriptor> fd = std::make_unique<FileDescriptor>(file.name, file.full_path);
         fd->setFileAvailable(true);
-        dv::size_type size = toolbox::FileSystemHelper::fileSize(full_path);
+        dv::size_type size = file.size;
         if (size < 0) {
-            std::cerr << "FileCache: Could not determine file size of " << full_path << std::endl;
+            std::cerr << "FileCache: Could not determine file size of " << file.full_path << std::endl;
             size = 0;
         }
         fd->setSize(size);
-        if (size>0 /* <- it's not a fake file. TODO: we should identify this case better, 0-bytes file may be legit */) this->put(rel_path, std::move(fd));
-    };
-
-    toolbox::FileSystemHelper::readDir(dv_ptr_->getConfigPtr()->sim_result_path_,
-                                       add_file, true, accept_function);
+        if (size>0 /* <- it's not a fake file. TODO: we should identify this case better, 0-bytes file may be legit */) this->put(file.rel_path, std::move(fd));
+    }
 
     std::cout << "FileCacheUnlimited initialized: " << files_.size() << " files cached." << std::endl;
 }
 
+void FileCacheUnlimited::getSnapshotEntries(std::vector<SnapshotEntry> *entries) const {
+    // no order
+    for (const auto &file : files_) {
+        entries->push_back({file.first, file.second->getName(), file.second->getFileName(),
+                            file.second->getSize(), kRecency});
+    }
+}
+
 void FileCacheUnlimited::put(const std::string &key, std::unique_ptr<FileDescriptor> value) {
     total_file_size_ += value->getSize();
     files_[key] = std::move(value);
@@ -23,6 +23,8 @@ namespace dv {
 
 		virtual void initializeWithFiles() override;
 
+		virtual void getSnapshotEntries(std::vector<SnapshotEntry> *entries) const override;
+
 		virtual void put(const std::string &key, std::unique_ptr<FileDescriptor> value) override;
 
 		virtual FileDescriptor *get(const std::string &key) override;
@@ -21,6 +21,18 @@ const std::string &FileDescriptor::getFileName() const {
     return file_name_;
 }
 
+const std::string &FileDescriptor::getStagedFileName() const {
+    return staged_file_name_;
+}
+
+void FileDescriptor::setStagedFileName(const std::string &staged_file_name) {
+    staged_file_name_ = staged_file_name;
+}
+
+bool FileDescriptor::isStaged() const {
+    return !staged_file_name_.empty();
+}
+
 void FileDescriptor::setPartitionKey(dv::id_type partition_key) {
     partition_key_ = partition_key;
 }
@@ -75,6 +87,14 @@ void FileDescriptor::setFilePrefetched(bool prefetched) {
     is_prefetched_ = prefetched;
 }
 
+bool FileDescriptor::isUnverified() const {
+    return is_unverified_;
+}
+
+void FileDescriptor::setUnverified(bool unverified) {
+    is_unverified_ = unverified;
+}
+
 void FileDescriptor::setSize(dv::size_type size) {
     size_ = size;
 }
@@ -150,13 +170,62 @@ const std::unordered_set<ClientDescriptor *> &FileDescriptor::getWaitingClientPt
     return waiting_clients_ptrs_;
 }
 
-void FileDescriptor::addVariable(const std::string &id, size_t offset, size_t count) {
+void FileDescriptor::addVariable(const std::string &id, const std::vector<dv::offset_type> &offsets,
+                                 const std::vector<dv::offset_type> &counts) {
     auto r = variables_.find(id);
     if (r == variables_.end()) {
-        variables_.emplace(std::make_pair(id, VariableDescriptor(id, offset, count)));
-    } else {
-        r->second.extendWithIndices(offset, count);
+        r = variables_.emplace(std::make_pair(id, VariableDescriptor(id))).first;
+    }
+    r->second.extendWithIndices(offsets, counts);
+}
+
+bool FileDescriptor::variableContains(const std::string &id, const std::vector<dv::offset_type> &offsets,
+                                      const std::vector<dv::offset_type> &counts) const {
+    auto r = variables_.find(id);
+    if (r == variables_.end()) {
+        return false;
+    }
+    return r->second.contains(offsets, counts);
+}
+
+void FileDescriptor::removeAllVariables() {
+    variables_.clear();
+}
+
+void FileDescriptor::appendVariableWaiter(int socket, const std::string &id,
+                                          const std::vector<dv::offset_type> &offsets,
+                                          const std::vector<dv::offset_type> &counts) {
+    variable_waiters_.push_back(VariableWaiter{socket, id, offsets, counts});
+}
+
+bool FileDescriptor::hasVariableWaiters() const {
+    return !variable_waiters_.empty();
+}
+
+std::vector<int> FileDescriptor::takeSatisfiedVariableWaiterSockets() {
+    std::vector<int> sockets;
+    auto keep = variable_waiters_.begin();
+    for (auto it = variable_waiters_.begin(); it != variable_waiters_.end(); ++it) {
+        if (variableContains(it->id, it->offsets, it->counts)) {
+            sockets.push_back(it->socket);
+        } else {
+            if (keep != it) {
+                *keep = std::move(*it);
+            }
+            ++keep;
+        }
+    }
+    variable_waiters_.erase(keep, variable_waiters_.end());
+    return sockets;
+}
+
+std::vector<int> FileDescriptor::takeAllVariableWaiterSockets() {
+    std::vector<int> sockets;
+    for (const auto &waiter : variable_waiters_) {
+        sockets.push_back(waiter.socket);
     }
+    variable_waiters_.clear();
+    return sockets;
 }
 
 std::string FileDescriptor::toString() const {
@@ -25,6 +25,14 @@ namespace dv {
 
 		const std::string &getFileName() const;
 
+		/**
+		 * copy of a new file in the staging area until it is written back to file_name
+		 * (see StagingArea); empty if the file is in the result path only
+		 */
+		const std::string &getStagedFileName() const;
+		void setStagedFileName(const std::string &staged_file_name);
+		bool isStaged() const;
+
 		void setPartitionKey(dv::id_type partition_key);
 		dv::id_type getPartitionKey() const;
 
@@ -54,6 +62,13 @@ namespace dv {
 		bool isFilePrefetched() const;
 		void setFilePrefetched(bool prefetched);
 
+		/**
+		 * restored from a snapshot without checking the file (see CacheSnapshot);
+		 * it is checked at its first open
+		 */
+		bool isUnverified() const;
+		void setUnverified(bool unverified);
+
 		void setSize(dv::size_type size);
 		dv::size_type getSize() const;
 
@@ -81,7 +96,23 @@ namespace dv {
 		void removeAllWaitingClientPtrs();
 		const std::unordered_set<ClientDescriptor *> &getWaitingClientPtrs() const;
 
-		void addVariable(const std::string &id, size_t offset, size_t count);
+		/**
+		 * early data availability (see dv_variable_notification):
+		 * slabs written and flushed by the simulator are tracked per variable id.
+		 * Variable gets waiting for a slab hold their socket in the variable waiters;
+		 * they are taken as soon as their slab is written or the file is closed by the simulator.
+		 */
+		void addVariable(const std::string &id, const std::vector<dv::offset_type> &offsets,
+						 const std::vector<dv::offset_type> &counts);
+		bool variableContains(const std::string &id, const std::vector<dv::offset_type> &offsets,
+							  const std::vector<dv::offset_type> &counts) const;
+		void removeAllVariables();
+
+		void appendVariableWaiter(int socket, const std::string &id, const std::vector<dv::offset_type> &offsets,
+								  const std::vector<dv::offset_type> &counts);
+		bool hasVariableWaiters() const;
+		std::vector<int> takeSatisfiedVariableWaiterSockets();
+		std::vector<int> takeAllVariableWaiterSockets();
 
 		std::string toString() const;
 
@@ -91,6 +122,7 @@ namespace dv {
 
 		std::string name_;
 		std::string file_name_;
+		std::string staged_file_name_;
 		dv::id_type partition_key_ = 0;
 		dv::id_type id_nr_ = 0;
 
@@ -99,6 +131,7 @@ namespace dv {
 		bool file_available_ = false;
 		dv::counter_type file_used_by_simulator_count_ = 0;
 		bool is_prefetched_ = false;
+		bool is_unverified_ = false;
 
 		dv::size_type size_ = 0;
 
@@ -109,6 +142,15 @@ namespace dv {
 		std::unordered_set<ClientDescriptor *> waiting_clients_ptrs_;
 
 		std::unordered_map<std::string, VariableDescriptor> variables_;
+
+		struct VariableWaiter {
+			int socket;
+			std::string id;
+			std::vector<dv::offset_type> offsets;
+			std::vector<dv::offset_type> counts;
+		};
+
+		std::vector<VariableWaiter> variable_waiters_;
 	};
 
 }
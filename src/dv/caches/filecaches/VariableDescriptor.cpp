@@ -4,29 +4,207 @@
 
 #include "VariableDescriptor.h"
 
+#include <algorithm>
+#include <stdexcept>
+
+#include "../../toolbox/StringHelper.h"
+
 
 namespace dv {
 
-VariableDescriptor::VariableDescriptor() : id_(""), offset_(0), count_(0) {}
+VariableDescriptor::VariableDescriptor() : id_("") {}
 
-VariableDescriptor::VariableDescriptor(const std::string &id, const size_t offset, const size_t count) :
-    id_(id), offset_(offset), count_(count) {
-}
+VariableDescriptor::VariableDescriptor(const std::string &id) : id_(id) {}
+
+void VariableDescriptor::extendWithIndices(const std::vector<dv::offset_type> &offsets,
+                                           const std::vector<dv::offset_type> &counts) {
+    if (offsets.size() != counts.size()) {
+        return;
+    }
 
-void VariableDescriptor::extendWithIndices(size_t offset, size_t count) {
-    // TODO
+    Slab slab;
+    for (size_t i = 0; i < offsets.size(); ++i) {
+        if (counts[i] <= 0) {
+            // nothing written
+            return;
+        }
+        slab.lo.push_back(offsets[i]);
+        slab.hi.push_back(offsets[i] + counts[i]);
+    }
+    addSlab(std::move(slab));
 }
 
 void VariableDescriptor::extendWithDescriptor(const VariableDescriptor &other) {
-    // TODO
+    for (const auto &slab : other.slabs_) {
+        addSlab(slab);
+    }
 }
 
-bool VariableDescriptor::contains(size_t offset, size_t count) {
-    // TODO
-    return true;
+bool VariableDescriptor::contains(const std::vector<dv::offset_type> &offsets,
+                                  const std::vector<dv::offset_type> &counts) const {
+    if (offsets.size() != counts.size()) {
+        return false;
+    }
+
+    Slab request;
+    for (size_t i = 0; i < offsets.size(); ++i) {
+        if (counts[i] <= 0) {
+            // empty request
+            return true;
+        }
+        request.lo.push_back(offsets[i]);
+        request.hi.push_back(offsets[i] + counts[i]);
+    }
+
+    // subtract all written slabs from the request; contained iff nothing remains
+    std::vector<Slab> remaining{request};
+    for (const auto &slab : slabs_) {
+        if (slab.lo.size() != request.lo.size()) {
+            continue;
+        }
+
+        std::vector<Slab> next;
+        for (const auto &r : remaining) {
+            subtract(r, slab, &next);
+        }
+        remaining.swap(next);
+
+        if (remaining.empty()) {
+            return true;
+        }
+        if (kMaxCoverageBoxes < remaining.size()) {
+            return false;
+        }
+    }
+    return remaining.empty();
+}
+
+dv::counter_type VariableDescriptor::getSlabCount() const {
+    return slabs_.size();
 }
 
 void VariableDescriptor::print(std::ostream *out) {
-    *out << "VariableDescriptor " << id_ << ": offset " << offset_ << " count " << count_ << std::endl;
+    *out << "VariableDescriptor " << id_ << ": " << slabs_.size() << " slabs";
+    for (const auto &slab : slabs_) {
+        *out << " [";
+        for (size_t i = 0; i < slab.lo.size(); ++i) {
+            *out << (i == 0 ? "" : ",") << slab.lo[i] << ":" << slab.hi[i];
+        }
+        *out << ")";
+    }
+    *out << std::endl;
+}
+
+bool VariableDescriptor::parseIndices(const std::string &s, const std::string &delimiter,
+                                      dv::dimension_type dimensions, std::vector<dv::offset_type> *indices) {
+    indices->clear();
+    if (dimensions <= 0) {
+        return dimensions == 0;
+    }
+
+    std::vector<std::string> splits;
+    toolbox::StringHelper::splitStr(&splits, s, delimiter);
+    if (splits.size() != static_cast<size_t>(dimensions)) {
+        return false;
+    }
+
+    try {
+        for (const auto &item : splits) {
+            dv::offset_type index = dv::stooffset(item);
+            if (index < 0) {
+                return false;
+            }
+            indices->push_back(index);
+        }
+    } catch (const std::invalid_argument &ia) {
+        return false;
+    } catch (const std::out_of_range &oor) {
+        return false;
+    }
+    return true;
+}
+
+void VariableDescriptor::addSlab(Slab slab) {
+    for (const auto &s : slabs_) {
+        if (slabContains(s, slab)) {
+            return;
+        }
+    }
+
+    // merge with slabs that differ in exactly one dimension where they touch or overlap;
+    // repeated since a merged slab may allow further merges
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        for (auto it = slabs_.begin(); it != slabs_.end(); ++it) {
+            if (it->lo.size() != slab.lo.size()) {
+                continue;
+            }
+
+            if (slabContains(slab, *it)) {
+                slabs_.erase(it);
+                merged = true;
+                break;
+            }
+
+            size_t differing = 0;
+            size_t d = 0;
+            for (size_t i = 0; i < slab.lo.size(); ++i) {
+                if (it->lo[i] != slab.lo[i] || it->hi[i] != slab.hi[i]) {
+                    ++differing;
+                    d = i;
+                }
+            }
+            if (differing == 1 && it->lo[d] <= slab.hi[d] && slab.lo[d] <= it->hi[d]) {
+                slab.lo[d] = std::min(slab.lo[d], it->lo[d]);
+                slab.hi[d] = std::max(slab.hi[d], it->hi[d]);
+                slabs_.erase(it);
+                merged = true;
+                break;
+            }
+        }
+    }
+
+    slabs_.push_back(std::move(slab));
+}
+
+bool VariableDescriptor::slabContains(const Slab &outer, const Slab &inner) {
+    if (outer.lo.size() != inner.lo.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < outer.lo.size(); ++i) {
+        if (inner.lo[i] < outer.lo[i] || outer.hi[i] < inner.hi[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void VariableDescriptor::subtract(const Slab &a, const Slab &b, std::vector<Slab> *out) {
+    for (size_t i = 0; i < a.lo.size(); ++i) {
+        if (std::max(a.lo[i], b.lo[i]) >= std::min(a.hi[i], b.hi[i])) {
+            // disjoint
+            out->push_back(a);
+            return;
+        }
+    }
+
+    // cut off the parts below and above b dimension by dimension; the rest is covered by b
+    Slab rest = a;
+    for (size_t i = 0; i < a.lo.size(); ++i) {
+        if (rest.lo[i] < b.lo[i]) {
+            Slab part = rest;
+            part.hi[i] = b.lo[i];
+            out->push_back(std::move(part));
+            rest.lo[i] = b.lo[i];
+        }
+        if (b.hi[i] < rest.hi[i]) {
+            Slab part = rest;
+            part.lo[i] = b.hi[i];
+            out->push_back(std::move(part));
+            rest.hi[i] = b.hi[i];
+        }
+    }
+}
+
 }
-}
\ No newline at end of file
@@ -7,30 +7,66 @@
 
 #include <ostream>
 #include <string>
+#include <vector>
+
+#include "../../DVBasicTypes.h"
 
 namespace dv {
 
 	/**
-	 * not yet really implemented. We may think about redesigning it to allow better use for netcdf and hdf5.
+	 * hyperslabs of a variable that have been written (and flushed) by the simulator
+	 * (see SimulatorVariablePutMessageHandler).
+	 *
+	 * A hyperslab is given by its offsets and counts per dimension (as in nc_put_vara / nc_get_vara).
+	 * Written slabs are kept as a list of boxes; slabs that extend a box along exactly one
+	 * dimension are merged. Scalar variables have 0 dimensions.
 	 */
 	class VariableDescriptor {
 	public:
 		VariableDescriptor();
 
-		VariableDescriptor(const std::string &id, size_t offset, size_t count);
+		explicit VariableDescriptor(const std::string &id);
 
-		void extendWithIndices(size_t offset, size_t count);
+		void extendWithIndices(const std::vector<dv::offset_type> &offsets, const std::vector<dv::offset_type> &counts);
 
 		void extendWithDescriptor(const VariableDescriptor &other);
 
-		bool contains(size_t offset, size_t count);
+		/**
+		 * true if the slab is completely covered by the union of the written slabs
+		 */
+		bool contains(const std::vector<dv::offset_type> &offsets, const std::vector<dv::offset_type> &counts) const;
+
+		dv::counter_type getSlabCount() const;
 
 		void print(std::ostream *out);
 
+		/**
+		 * parses an index list as sent by DVLib (empty for 0 dimensions).
+		 * returns false if the list does not match the number of dimensions.
+		 */
+		static bool parseIndices(const std::string &s, const std::string &delimiter, dv::dimension_type dimensions,
+								 std::vector<dv::offset_type> *indices);
+
 	private:
+		struct Slab {
+			std::vector<dv::offset_type> lo;
+			std::vector<dv::offset_type> hi; // exclusive
+		};
+
+		// upper bound for the boxes kept during the coverage check; larger results are reported as not contained
+		static constexpr size_t kMaxCoverageBoxes = 4096;
+
 		std::string id_;
-		size_t offset_;
-		size_t count_;
+		std::vector<Slab> slabs_;
+
+		void addSlab(Slab slab);
+
+		static bool slabContains(const Slab &outer, const Slab &inner);
+
+		/**
+		 * appends the parts of a that are not covered by b to out
+		 */
+		static void subtract(const Slab &a, const Slab &b, std::vector<Slab> *out);
 	};
 
 }
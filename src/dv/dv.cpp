@@ -25,6 +25,7 @@
 #include "toolbox/Version.h"
 #include "toolbox/Logger.h"
 
+#include "caches/CacheSnapshot.h"
 #include "caches/filecaches/FileCacheUnlimited.h"
 #include "caches/filecaches/FileCacheLRU.h"
 #include "caches/filecaches/FileCacheARC.h"
@@ -189,7 +190,6 @@ DV * DVCreate(gengetopt_args_info &args_info, const string &config_file) {
     //--- simulator configuration ----------------------------------------------
 
     dv->setSimulatorPtr(make_unique<Simulator>(dv));
-    dv->getSimulatorPtr()->scanRestartFiles();
 
     //--- file cache configuration ---------------------------------------------
 
@@ -244,12 +244,19 @@ DV * DVCreate(gengetopt_args_info &args_info, const string &config_file) {
 
     if (0 < dv->getConfigPtr()->filecache_fifo_queue_size_) {
         dv->setFileCachePtr(std::make_unique<FileCacheFifoWrapper>(dv, std::move(embedded_cache),
-                            dv->getConfigPtr()->filecache_fifo_queue_size_));
+                            dv->getConfigPtr()->filecache_fifo_queue_size_,
+                            dv->getConfigPtr()->filecache_fifo_queue_min_size_));
     } else {
         dv->setFileCachePtr(std::move(embedded_cache));
     }
 
-    dv->getFileCachePtr()->initializeWithFiles();
+    //--- initial content: snapshot or scan of the file system -----------------
+
+    const std::string &snapshot_file = dv->getConfigPtr()->filecache_snapshot_file_;
+    if (snapshot_file.empty() || !CacheSnapshot::restore(dv, snapshot_file)) {
+        dv->getSimulatorPtr()->scanRestartFiles();
+        dv->getFileCachePtr()->initializeWithFiles();
+    }
 
     return dv;
 
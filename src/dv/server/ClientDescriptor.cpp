@@ -8,6 +8,8 @@
 
 #include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <cmath>
 #include <iostream>
 
 #include "DV.h"
@@ -21,13 +23,22 @@
 namespace dv {
 
 ClientDescriptor::ClientDescriptor(DV *dv, dv::id_type appid) :
-    dv_(dv), appid_(appid), prefetcher_(this, appid),
+    dv_(dv), appid_(appid), prefetcher_(this, appid), pattern_prefetcher_(this, appid),
+    use_pattern_prefetcher_(dv->getConfigPtr()->dv_prefetcher_type_ == "pattern"),
     max_prefetching_intervals_(dv->getConfigPtr()->dv_max_prefetching_intervals_)
 {;}
 
 void ClientDescriptor::profile(FileDescriptor * cache_entry) {
+    profile(cache_entry, toolbox::TimeHelper::now());
+}
+
+void ClientDescriptor::profile(FileDescriptor * cache_entry, const toolbox::TimeHelper::time_point_type &at) {
     if (notified_ || cache_entry != nullptr) {
-        double newtau = cli_profiler_.newTau();
+        double newtau = cli_profiler_.newTau(at);
+        if (newtau < 0) {
+            // reported open overtaken by an open sent to DV
+            return;
+        }
         LOG(PREFETCHER, 0, "adding tau: " + std::to_string(newtau) + "; current tau: " + std::to_string(cli_profiler_.getTau()));
         notified_ = false;
     }
@@ -44,6 +55,19 @@ bool ClientDescriptor::handleOpen(const std::string &filename,
        nullptr was returned and use refresh, if a descriptor was found */
     FileDescriptor * cache_entry = dv_->getFileCachePtr()->get(filename);
 
+    // entries restored from a snapshot are checked here (see CacheSnapshot); a file that is
+    // gone since is handled as a miss
+    if (cache_entry != nullptr && cache_entry->isUnverified()) {
+        cache_entry->setUnverified(false);
+        dv::size_type file_size = toolbox::FileSystemHelper::fileSize(cache_entry->getFileName());
+        if (0 < file_size) {
+            cache_entry->setSize(file_size);
+        } else {
+            LOG(CLIENT, 0, "File " + filename + " of the cache snapshot no longer exists");
+            cache_entry->setFileAvailable(false);
+        }
+    }
+
     profile(cache_entry);
 
     /* if the cache entry is marked as prefetched now mark it as not */
@@ -53,7 +77,24 @@ bool ClientDescriptor::handleOpen(const std::string &filename,
 
     SimJob *already_simulating_job = dv_->findSimulationProducingFile(filename);
     bool is_being_simulated = already_simulating_job != nullptr;
-    bool is_miss = cache_entry == nullptr && !is_being_simulated;
+    // note: an entry that is neither available nor produced by anyone is left by a deferred miss
+    bool is_miss = !is_being_simulated
+                   && (cache_entry == nullptr
+                       || (!cache_entry->isFileAvailable() && !cache_entry->isFileUsedBySimulator()));
+    deferred_misses_.erase(filename);
+    cold_tier_waits_.erase(filename);
+
+    // a miss of an evicted file may be served from the cold tier: before the put below,
+    // which may demote other files into the tier. The client waits for the restore
+    // as for a file in production (see DV::finishPromotions()).
+    std::string fullpath = toolbox::StringHelper::joinPath(dv_->getConfigPtr()->sim_result_path_, filename);
+    ColdTier *coldTier = dv_->getColdTierPtr();
+    bool is_cold_tier_wait = is_miss && coldTier != nullptr && coldTier->isPromoting(filename);
+    bool is_cold_tier_hit = is_miss && !is_cold_tier_wait && promoteFromColdTier(filename, fullpath);
+    if (is_cold_tier_hit || is_cold_tier_wait) {
+        is_miss = false;
+        cold_tier_waits_[filename] = parameters[0];
+    }
 
     if (cache_entry == nullptr) {
         /*NOTE: even if a file is being simulated by another simjob, that simjob
@@ -61,19 +102,42 @@ bool ClientDescriptor::handleOpen(const std::string &filename,
           be null. */
 
         //create the file descriptor and put it in cache as not available
-        std::string fullpath = toolbox::StringHelper::joinPath(dv_->getConfigPtr()->sim_result_path_, filename);
         std::unique_ptr<FileDescriptor> descriptor = std::make_unique<FileDescriptor>(filename, fullpath);
         descriptor->setFileAvailable(false);
         descriptor->lock();
         dv_->getFileCachePtr()->put(filename, std::move(descriptor));
-    } else cache_entry->lock();
+        cache_entry = dv_->getFileCachePtr()->internal_lookup_get(filename);
+    } else {
+        cache_entry->lock();
+    }
 
     dv::id_type target_nr = dv_->getSimulatorPtr()->result2nr(filename);
     LOG(CLIENT, 0, "Client " + std::to_string(appid_) + " is opening " + filename + "; nr: " + std::to_string(target_nr));
+    last_open_parameters_ = parameters[0];
+
+    // the open holds its own lock now: the pin of a range request is no longer needed
+    dv::id_type file_type = dv_->getSimulatorPtr()->getResultFileType(filename);
+    requested_files_.erase({file_type, dv_->getSimulatorPtr()->result2nr(filename, file_type)});
+    releasePin(filename);
 
     toolbox::TimeHelper::time_point_type now = toolbox::TimeHelper::now();
     double time = toolbox::TimeHelper::milliseconds(dv_->start_time_, now);
 
+    last_open_nr_ = target_nr;
+
+    BlockCache *blockCache = dv_->getBlockCachePtr();
+    if (is_miss && blockCache != nullptr && blockCache->hasBlocks(filename)) {
+        // gets may be served from blocks; the first get that needs the file starts the simulation
+        traceSegmentConsumption(target_nr, time, "MISS_DEFERRED");
+        LOG(CLIENT, 0, "MISS (DEFERRED): blocks of the file are cached. Params: " + parameters[0]);
+        LOG(CLIENT, 0, "[EVENT][" + std::to_string(appid_) + "] CLIENT_OPEN " + filename + " MISS_DEFERRED: " +  std::to_string(time));
+
+        deferred_misses_[filename] = parameters[0];
+        return false;
+    }
+
+    traceSegmentConsumption(target_nr, time, is_miss ? "MISS" : (is_being_simulated || is_cold_tier_wait ? "HIT_WAIT" : (is_cold_tier_hit ? "HIT_COLDTIER" : "HIT")));
+
 
     if (is_miss) { 
 
@@ -82,7 +146,11 @@ bool ClientDescriptor::handleOpen(const std::string &filename,
 
 
         /* prefetcher is in charge to restart the simulation */
-        prefetcher_.handleMiss(target_nr, parameters[0]); 
+        if (use_pattern_prefetcher_) {
+            pattern_prefetcher_.handleMiss(target_nr, parameters[0], filename);
+        } else {
+            prefetcher_.handleMiss(target_nr, parameters[0]);
+        }
 
         //logs & stats
         dv_->getStatsPtr()->incMisses();
@@ -90,8 +158,28 @@ bool ClientDescriptor::handleOpen(const std::string &filename,
         return false;
     } else { 
 
-        prefetcher_.handleHit(target_nr, parameters[0]);
+        if (use_pattern_prefetcher_) {
+            pattern_prefetcher_.handleHit(target_nr, parameters[0], filename);
+        } else {
+            prefetcher_.handleHit(target_nr, parameters[0]);
+        }
  
+        if (is_cold_tier_hit) {
+            LOG(CLIENT, 0, "HIT (COLD TIER): file is being restored from the cold tier");
+            LOG(CLIENT, 0, "[EVENT][" + std::to_string(appid_) + "] CLIENT_OPEN " + filename + " HIT_COLDTIER: " +  std::to_string(time));
+            dv_->getStatsPtr()->incColdTierHits();
+
+            return false;
+        }
+
+        if (is_cold_tier_wait) {
+            dv_->getStatsPtr()->incWaiting();
+            LOG(CLIENT, 0, "HIT (WAIT): file is being restored from the cold tier");
+            LOG(CLIENT, 0, "[EVENT][" + std::to_string(appid_) + "] CLIENT_OPEN " + filename + " HIT_WAIT: " +  std::to_string(time));
+
+            return false;
+        }
+
         if (cache_entry!=NULL && !cache_entry->isFileUsedBySimulator()){
             // is a full hit: the data is available /
             LOG(CLIENT, 0, "HIT! Data is available!");
@@ -178,6 +266,215 @@ std::unique_ptr<SimJob> ClientDescriptor::newSimulation(dv::id_type target_nr, d
     }
 }
 
+dv::id_type ClientDescriptor::horizontal_prefetch(dv::id_type &simstart, dv::id_type &simstop) {
+    double simalpha = sim_profiler_.getAlpha();
+    double simtau = sim_profiler_.getTau();
+    double mytau = cli_profiler_.getTau();
+
+    std::vector<dv::id_type> checkpoints;
+    dv_->getSimulatorPtr()->getCheckpointsInRange(simstart, simstop, &checkpoints);
+    dv::id_type intervals = checkpoints.size() + 1;
+
+    dv::id_type segments = 1;
+    if (0.0 < mytau) {
+        segments = (dv::id_type) ceil(simtau / mytau);
+    }
+    dv::id_type max_segments = dv_->getConfigPtr()->dv_max_horizontal_prefetching_intervals_;
+    if (0 <= max_segments) {
+        // < 0: unlimited
+        segments = std::min(segments, max_segments);
+    }
+    segments = std::max(std::min(segments, intervals), (dv::id_type) 1);
+
+    // consecutive restart intervals are grouped into segments of equal length
+    dv::id_type per_segment = (intervals + segments - 1) / segments;
+
+    LOG(PREFETCHER, 0, "Horizontal prefetch: " + std::to_string(simstart) + " -> " + std::to_string(simstop)
+        + "; restart intervals: " + std::to_string(intervals)
+        + "; segments: " + std::to_string(segments));
+
+    dv::id_type launched = 0;
+    dv::id_type covered_start = simstart;
+    dv::id_type covered_stop = simstop;
+    for (dv::id_type i = 0; i < intervals; i += per_segment) {
+        dv::id_type seg_start = (i == 0) ? simstart : checkpoints[i - 1];
+        dv::id_type next = i + per_segment;
+        dv::id_type seg_stop = (next < intervals) ? checkpoints[next - 1] - 1 : simstop;
+
+        std::unique_ptr<SimJob> simjob = newSimulation(seg_start, seg_stop, "");
+        if (simjob == nullptr) {
+            LOG(WARNING, 0, "Cannot create prefetch simulation for segment " + std::to_string(seg_start)
+                + " -> " + std::to_string(seg_stop));
+            continue;
+        }
+
+        if (launched == 0) {
+            covered_start = simjob->getSimStart();
+        }
+        covered_stop = simjob->getSimStop();
+
+        simjob->setPrefetched(true);
+        traceSegment(simjob.get(), seg_start, simalpha, simtau, mytau);
+
+        dv::id_type simjobid = simjob->getJobId();
+        dv_->enqueueJob(simjobid, std::move(simjob));
+        launched++;
+
+        toolbox::TimeHelper::time_point_type now = toolbox::TimeHelper::now();
+        double time = toolbox::TimeHelper::milliseconds(dv_->start_time_, now);
+        LOG(PREFETCHER, 0, "[EVENT][" + std::to_string(simjobid) + "] PREFETCH: " +  std::to_string(time));
+    }
+
+    if (0 < launched) {
+        simstart = covered_start;
+        simstop = covered_stop;
+    }
+    return launched;
+}
+
+void ClientDescriptor::traceSegment(SimJob *simjob, dv::id_type seg_start, double simalpha, double simtau, double mytau) {
+    toolbox::TimeHelper::time_point_type now = toolbox::TimeHelper::now();
+    double time = toolbox::TimeHelper::milliseconds(dv_->start_time_, now);
+
+    dv::id_type stride = prefetcher_.getStride();
+    dv::id_type abs_stride = stride < 0 ? -stride : (stride == 0 ? 1 : stride);
+
+    // first file of the segment needed by the client: lowest nr for forward, highest for backward trajectories
+    SegmentTrace trace;
+    trace.start = seg_start;
+    trace.stop = simjob->getSimStop();
+    trace.launch_time = time;
+    dv::id_type first = stride < 0 ? trace.stop : trace.start;
+    double produced = (double) (first - simjob->getSimStart()) / abs_stride;
+    dv::id_type distance = first - last_open_nr_;
+    double consumed = (double) (distance < 0 ? -distance : distance) / abs_stride;
+    trace.expected_arrival = time + 1000.0 * (simalpha + produced * simtau);
+    trace.expected_consumption = time + 1000.0 * consumed * mytau;
+
+    dv::id_type simjobid = simjob->getJobId();
+    if (kMaxSegmentTraces <= segment_traces_.size() && segment_traces_.find(simjobid) == segment_traces_.end()) {
+        auto oldest = std::min_element(segment_traces_.begin(), segment_traces_.end(),
+                                       [](const std::pair<const dv::id_type, SegmentTrace> &a,
+                                          const std::pair<const dv::id_type, SegmentTrace> &b) {
+            return a.second.launch_time < b.second.launch_time;
+        });
+        LOG(PREFETCHER, 0, "[EVENT][" + std::to_string(oldest->first) + "] SEGMENT_DROPPED: " + std::to_string(time));
+        segment_traces_.erase(oldest);
+    }
+    segment_traces_[simjobid] = trace;
+
+    LOG(PREFETCHER, 0, "[EVENT][" + std::to_string(simjobid) + "] SEGMENT " + std::to_string(trace.start)
+        + " -> " + std::to_string(trace.stop)
+        + " expected arrival: " + std::to_string(trace.expected_arrival)
+        + " expected consumption: " + std::to_string(trace.expected_consumption)
+        + ": " + std::to_string(time));
+}
+
+void ClientDescriptor::traceSegmentConsumption(dv::id_type nr, double time, const char *access) {
+    for (auto it = segment_traces_.begin(); it != segment_traces_.end(); ) {
+        const SegmentTrace &trace = it->second;
+        if (nr < trace.start || trace.stop < nr) {
+            ++it;
+            continue;
+        }
+
+        LOG(PREFETCHER, 0, "[EVENT][" + std::to_string(it->first) + "] SEGMENT_CONSUMED " + std::to_string(nr)
+            + " " + access
+            + " expected arrival: " + std::to_string(trace.expected_arrival)
+            + " expected consumption: " + std::to_string(trace.expected_consumption)
+            + ": " + std::to_string(time));
+        it = segment_traces_.erase(it);
+    }
+}
+
+void ClientDescriptor::handleLeasedOpen(const std::string &filename, double age_ms) {
+    toolbox::TimeHelper::time_point_type at = toolbox::TimeHelper::now()
+        - std::chrono::microseconds(static_cast<int64_t>(age_ms * 1000.0));
+
+    // full get for the recency update; a file that is gone meanwhile is ignored:
+    // the client has read it already
+    FileDescriptor * cache_entry = dv_->getFileCachePtr()->get(filename);
+    if (cache_entry == nullptr) {
+        LOG(WARNING, 1, "Leased open of a file no longer in the cache: " + filename);
+        return;
+    }
+
+    profile(cache_entry, at);
+
+    if (cache_entry->isFilePrefetched()) {
+        cache_entry->setFilePrefetched(false);
+    }
+
+    dv::id_type target_nr = dv_->getSimulatorPtr()->result2nr(filename);
+    dv::id_type file_type = dv_->getSimulatorPtr()->getResultFileType(filename);
+    requested_files_.erase({file_type, dv_->getSimulatorPtr()->result2nr(filename, file_type)});
+    releasePin(filename);
+
+    double time = toolbox::TimeHelper::milliseconds(dv_->start_time_, at);
+    last_open_nr_ = target_nr;
+    traceSegmentConsumption(target_nr, time, "HIT_LEASE");
+
+    if (use_pattern_prefetcher_) {
+        pattern_prefetcher_.handleHit(target_nr, last_open_parameters_, filename);
+    } else {
+        prefetcher_.handleHit(target_nr, last_open_parameters_);
+    }
+
+    LOG(CLIENT, 0, "[EVENT][" + std::to_string(appid_) + "] CLIENT_OPEN " + filename + " HIT_LEASE: " +  std::to_string(time));
+}
+
+void ClientDescriptor::startDeferredMiss(const std::string &filename, FileDescriptor *descriptor) {
+    auto it = deferred_misses_.find(filename);
+    if (it == deferred_misses_.end()) {
+        return;
+    }
+    std::string parameters = it->second;
+    deferred_misses_.erase(it);
+
+    if (descriptor->isFileAvailable() || descriptor->isFileUsedBySimulator()) {
+        return;
+    }
+
+    dv::id_type target_nr = dv_->getSimulatorPtr()->result2nr(filename);
+    toolbox::TimeHelper::time_point_type now = toolbox::TimeHelper::now();
+    double time = toolbox::TimeHelper::milliseconds(dv_->start_time_, now);
+
+    // another client may have started a simulation producing the file meanwhile
+    SimJob *already_simulating_job = dv_->findSimulationProducingFile(filename);
+    if (already_simulating_job != nullptr) {
+        dv_->getStatsPtr()->incWaiting();
+        LOG(CLIENT, 0, "DEFERRED MISS (WAIT): Data already being simulated by: " + std::to_string(already_simulating_job->getJobId()));
+        already_simulating_job->handleClientFileOpen(target_nr);
+        return;
+    }
+
+    LOG(CLIENT, 0, "DEFERRED MISS: Restarting simulation! Params: " + parameters);
+    LOG(CLIENT, 0, "[EVENT][" + std::to_string(appid_) + "] CLIENT_GET " + filename + " MISS: " +  std::to_string(time));
+
+    if (use_pattern_prefetcher_) {
+        pattern_prefetcher_.handleMiss(target_nr, parameters, filename);
+    } else {
+        prefetcher_.handleMiss(target_nr, parameters);
+    }
+
+    dv_->getStatsPtr()->incMisses();
+}
+
+void ClientDescriptor::handleColdTierPromotion(const std::string &filename, FileDescriptor *descriptor, bool ok) {
+    auto it = cold_tier_waits_.find(filename);
+    if (it == cold_tier_waits_.end()) {
+        return;
+    }
+    std::string parameters = it->second;
+    cold_tier_waits_.erase(it);
+
+    if (!ok && descriptor != nullptr) {
+        LOG(CLIENT, 0, "COLD TIER: restore of " + filename + " failed; re-simulating");
+        deferred_misses_[filename] = parameters;
+        startDeferredMiss(filename, descriptor);
+    }
+}
+
 void ClientDescriptor::handleNotification(SimJob *simjob) {
     dv::id_type jobid = simjob->getJobId();
     auto it = known_sims_.find(jobid);
@@ -245,8 +542,292 @@ void ClientDescriptor::handleRangeRequest(dv::id_type flag, std::unique_ptr<Clie
     range_requests_.push_back(std::move(request));
 
     if ((flag & kRequestRangeFlagLast) == kRequestRangeFlagLast) {
-        // TODO: actual action of handling requested ranges
+        scheduleRangeRequests();
+    }
+}
+
+void ClientDescriptor::scheduleRangeRequests() {
+    Simulator *simulator = dv_->getSimulatorPtr();
+
+    releasePins();
+    requested_files_.clear();
+
+    std::vector<ScheduleInterval> intervals;
+    std::unordered_map<dv::id_type, size_t> interval_index;
+
+    dv::id_type pinned = 0;
+    bool bounded = false;
+    for (const auto &request : range_requests_) {
+        dv::id_type file_type = simulator->getResultFileType(request->begin_);
+        dv::id_type begin = simulator->result2nr(request->begin_, file_type);
+        dv::id_type end = simulator->result2nr(request->end_, file_type);
+        dv::id_type stride = request->stride_;
+        if (stride == 0) {
+            stride = begin <= end ? 1 : -1;
+        }
+        if ((0 < stride && end < begin) || (stride < 0 && begin < end)) {
+            LOG(WARNING, 0, "Range request " + request->begin_ + " -> " + request->end_
+                + " does not match stride " + std::to_string(stride) + ": ignored");
+            continue;
+        }
+        bool descending = stride < 0;
+
+        for (dv::id_type nr = begin; !bounded && (0 < stride ? nr <= end : end <= nr); nr += stride) {
+            bool inserted = false;
+            bounded = !addRequestedFile(file_type, nr, &inserted);
+            if (!inserted) {
+                continue;
+            }
+
+            if (pinIfCached(file_type, nr)) {
+                pinned++;
+                continue;
+            }
+
+            if (dv_->findSimulationWithNrInRange(nr) != nullptr) {
+                continue;
+            }
+
+            addToSchedule(nr, descending, &intervals, &interval_index);
+        }
+    }
+
+    if (bounded) {
+        LOG(WARNING, 0, "Client " + std::to_string(appid_) + ": range requests exceed "
+            + std::to_string(requested_files_.size()) + " files: the rest is ignored");
+    }
+
+    LOG(CLIENT, 0, "Client " + std::to_string(appid_) + ": range requests: "
+        + std::to_string(requested_files_.size()) + " files, "
+        + std::to_string(pinned) + " of them cached; "
+        + std::to_string(intervals.size()) + " restart intervals to simulate");
+
+    dv::id_type jobs = launchSchedule(intervals);
+
+    LOG(CLIENT, 0, "Client " + std::to_string(appid_) + ": range requests scheduled with "
+        + std::to_string(jobs) + " jobs");
+}
+
+void ClientDescriptor::handleHints(const std::vector<std::string> &filenames) {
+    std::vector<ScheduleInterval> intervals;
+    std::unordered_map<dv::id_type, size_t> interval_index;
+
+    dv::id_type previous = last_open_nr_;
+    for (const auto &filename : filenames) {
+        dv::id_type nr = dv_->getSimulatorPtr()->result2nr(filename);
+        bool descending = 0 <= previous && nr < previous;
+        previous = nr;
+
+        // hinted files are pinned as well when produced (see pinIfRequested())
+        dv::id_type file_type = dv_->getSimulatorPtr()->getResultFileType(filename);
+        bool inserted = false;
+        if (!addRequestedFile(file_type, dv_->getSimulatorPtr()->result2nr(filename, file_type), &inserted)) {
+            break;
+        }
+        if (!inserted) {
+            continue;
+        }
+
+        // known to the cache: either available (pinned now) or already waiting for a simulation
+        FileDescriptor *descriptor = dv_->getFileCachePtr()->internal_lookup_get(filename);
+        if (descriptor != nullptr) {
+            if (descriptor->isFileAvailable()) {
+                pinIfRequested(file_type, dv_->getSimulatorPtr()->result2nr(filename, file_type), filename, descriptor);
+            }
+            continue;
+        }
+
+        if (dv_->findSimulationWithNrInRange(nr) != nullptr) {
+            continue;
+        }
+
+        addToSchedule(nr, descending, &intervals, &interval_index);
+    }
+
+    dv::id_type jobs = launchSchedule(intervals);
+
+    LOG(CLIENT, 0, "Client " + std::to_string(appid_) + ": " + std::to_string(filenames.size())
+        + " hints scheduled with " + std::to_string(jobs) + " jobs");
+}
+
+void ClientDescriptor::addToSchedule(dv::id_type nr, bool descending,
+                                     std::vector<ScheduleInterval> *intervals,
+                                     std::unordered_map<dv::id_type, size_t> *interval_index) {
+    dv::id_type checkpoint = dv_->getSimulatorPtr()->getCheckpointNr(nr);
+    auto it = interval_index->find(checkpoint);
+    if (it == interval_index->end()) {
+        (*interval_index)[checkpoint] = intervals->size();
+        intervals->push_back({checkpoint, nr, nr, descending});
+    } else {
+        ScheduleInterval &interval = (*intervals)[it->second];
+        interval.first = std::min(interval.first, nr);
+        interval.last = std::max(interval.last, nr);
+    }
+}
+
+dv::id_type ClientDescriptor::launchSchedule(const std::vector<ScheduleInterval> &intervals) {
+    Simulator *simulator = dv_->getSimulatorPtr();
+
+    // consecutive intervals in ascending access order are merged into runs and split again
+    // at checkpoints according to the alpha/tau model (see horizontal_prefetch());
+    // descending runs get one job per interval to follow the client backwards
+    dv::id_type jobs = 0;
+    size_t i = 0;
+    while (i < intervals.size()) {
+        dv::id_type run_start = intervals[i].first;
+        dv::id_type run_stop = intervals[i].last;
+        bool descending = intervals[i].descending;
+        size_t j = i + 1;
+        while (!descending && j < intervals.size() && !intervals[j].descending
+               && intervals[j].checkpoint == simulator->getNextCheckpointNr(intervals[j - 1].checkpoint + 1)) {
+            run_stop = intervals[j].last;
+            j++;
+        }
+
+        if (descending) {
+            std::unique_ptr<SimJob> simjob = newSimulation(run_start, run_stop, "");
+            if (simjob != nullptr) {
+                simjob->setPrefetched(true);
+                dv::id_type simjobid = simjob->getJobId();
+                dv_->enqueueJob(simjobid, std::move(simjob));
+                jobs++;
+            }
+        } else {
+            jobs += horizontal_prefetch(run_start, run_stop);
+        }
+        i = j;
+    }
+
+    return jobs;
+}
+
+void ClientDescriptor::getReadaheadFiles(const std::string &filename, size_t count, std::vector<std::string> *files) {
+    Simulator *simulator = dv_->getSimulatorPtr();
+    dv::id_type file_type = simulator->getResultFileType(filename);
+    if (file_type == 0) {
+        return;
+    }
+    dv::id_type nr = simulator->result2nr(filename, file_type);
+
+    std::vector<dv::id_type> nrs;
+    if (use_pattern_prefetcher_) {
+        pattern_prefetcher_.getPredictions(nr, &nrs);
+    } else {
+        dv::id_type stride = prefetcher_.getStride();
+        for (size_t k = 1; stride != 0 && k <= count; ++k) {
+            nrs.push_back(nr + static_cast<dv::id_type>(k) * stride);
+        }
+    }
+
+    // files that are not available yet are hinted with a later open
+    for (size_t k = 0; k < nrs.size() && k < count; ++k) {
+        const std::string *name = dv_->findResultName(file_type, nrs[k]);
+        if (name == nullptr) {
+            continue;
+        }
+        FileDescriptor *descriptor = dv_->getFileCachePtr()->internal_lookup_get(*name);
+        if (descriptor != nullptr && descriptor->isFileAvailable()) {
+            files->push_back(*name);
+        }
+    }
+}
+
+void ClientDescriptor::pinIfRequested(dv::id_type file_type, dv::id_type nr, const std::string &filename,
+                                      FileDescriptor *descriptor) {
+    auto it = requested_files_.find({file_type, nr});
+    if (descriptor == nullptr || it == requested_files_.end()) {
+        return;
+    }
+
+    dv::id_type max_pins = dv_->getFileCachePtr()->capacity() / 2;
+    if (max_pins <= (dv::id_type) pinned_files_.size()) {
+        return;
+    }
+
+    if (pinned_files_.insert(filename).second) {
+        descriptor->lock();
+        requested_files_.erase(it);
+    }
+}
+
+bool ClientDescriptor::addRequestedFile(dv::id_type file_type, dv::id_type nr, bool *inserted) {
+    *inserted = false;
+    size_t max_files = kMaxRequestedFiles;
+    dv::id_type capacity = dv_->getFileCachePtr()->capacity();
+    if (0 < capacity) {
+        max_files = std::min(max_files, static_cast<size_t>(capacity));
+    }
+    if (max_files <= requested_files_.size() + pinned_files_.size()) {
+        return false;
+    }
+
+    *inserted = requested_files_.insert({file_type, nr}).second;
+    return true;
+}
+
+bool ClientDescriptor::pinIfCached(dv::id_type file_type, dv::id_type nr) {
+    const std::string *name = file_type != 0 ? dv_->findResultName(file_type, nr) : nullptr;
+    if (name == nullptr) {
+        return false;
+    }
+
+    FileDescriptor *descriptor = dv_->getFileCachePtr()->internal_lookup_get(*name);
+    if (descriptor == nullptr || !descriptor->isFileAvailable()) {
+        return false;
+    }
+
+    pinIfRequested(file_type, nr, *name, descriptor);
+    return true;
+}
+
+void ClientDescriptor::releasePin(const std::string &filename) {
+    auto it = pinned_files_.find(filename);
+    if (it == pinned_files_.end()) {
+        return;
+    }
+
+    FileDescriptor *descriptor = dv_->getFileCachePtr()->internal_lookup_get(filename);
+    if (descriptor != nullptr) {
+        descriptor->unlock();
+    }
+    pinned_files_.erase(it);
+}
+
+bool ClientDescriptor::promoteFromColdTier(const std::string &filename, const std::string &fullpath) {
+    ColdTier *coldTier = dv_->getColdTierPtr();
+    if (coldTier == nullptr) {
+        return false;
+    }
+
+    double promote_s = coldTier->estimatePromoteSeconds(filename);
+    if (promote_s < 0.0) {
+        return false;
+    }
+
+    Simulator *simulator = dv_->getSimulatorPtr();
+    double alpha = simulator->getAlpha();
+    double tau = simulator->getTau();
+    if (0.0 <= alpha && 0.0 <= tau) {
+        double resim_s = alpha + simulator->getPrevRestartDiff(filename) * tau;
+        if (resim_s <= promote_s) {
+            LOG(CLIENT, 0, "COLD TIER: re-simulation of " + filename + " (" + std::to_string(resim_s)
+                           + " s) is estimated to be faster than its restore (" + std::to_string(promote_s) + " s)");
+            coldTier->remove(filename);
+            return false;
+        }
+    }
+
+    return coldTier->startPromote(filename, fullpath);
+}
+
+void ClientDescriptor::releasePins() {
+    for (const auto &filename : pinned_files_) {
+        FileDescriptor *descriptor = dv_->getFileCachePtr()->internal_lookup_get(filename);
+        if (descriptor != nullptr) {
+            descriptor->unlock();
+        }
     }
+    pinned_files_.clear();
 }
 
 }
@@ -10,13 +10,17 @@
 #define DV_SERVER_CLIENTDESCRIPTOR_H_
 
 #include <memory>
+#include <set>
 #include <string>
+#include <utility>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
 #include "../DVBasicTypes.h"
 #include "../DVForwardDeclarations.h"
 #include "Profiler.h"
+#include "PatternPrefetcher.h"
 #include "PrefetchContext.h"
 
 
@@ -25,11 +29,18 @@ namespace dv {
 
 	class ClientDescriptor {
         friend class PrefetchContext;
+        friend class PatternPrefetcher;
 
 	public:
 		static constexpr dv::id_type kRequestRangeFlagFirst = 1;
 		static constexpr dv::id_type kRequestRangeFlagLast = 2;
 
+		/** upper bound of the pending range request and hint files of a client (see requested_files_) */
+		static constexpr size_t kMaxRequestedFiles = 4096;
+
+		/** upper bound of the traced segments of a client (see segment_traces_) */
+		static constexpr size_t kMaxSegmentTraces = 256;
+
 		class RangeRequest {
 		public:
 			RangeRequest(const std::string &begin, const std::string &end, dv::id_type stride)
@@ -45,16 +56,77 @@ namespace dv {
 		bool handleOpen(const std::string &filename,
 						const std::vector<std::string> &parameters);
 
+		/**
+		 * open under a client read lease (see LeaseTable), reported age_ms after the fact.
+		 * updates cache recency, client profile, and prefetcher like a hit in handleOpen(),
+		 * but takes no lock: the lease holds one and the client sends no close.
+		 */
+		void handleLeasedOpen(const std::string &filename, double age_ms);
+
+		/**
+		 * starts the simulation of filename if its miss has been deferred in handleOpen():
+		 * the open of a file with blocks in the block cache (see BlockCache) does not start a simulation
+		 * yet since the gets of the client may be served from blocks. Called for the first get that
+		 * needs the file itself.
+		 */
+		void startDeferredMiss(const std::string &filename, FileDescriptor *descriptor);
+
+		/**
+		 * end of a promotion from the cold tier the client has been waiting for (see DV::finishPromotions());
+		 * if it failed, the miss is handled as a deferred one
+		 */
+		void handleColdTierPromotion(const std::string &filename, FileDescriptor *descriptor, bool ok);
+
 		void handleNotification(SimJob *simjob);
 
 		double computeHotspot(dv::id_type nr);
 
 		dv::id_type updateDirection(dv::id_type nr, bool & direction_changed);
 
+        /**
+         * horizontal prefetching: splits [simstart, simstop] at the available checkpoints
+         * into segments that are simulated by concurrent jobs (at most
+         * dv_max_horizontal_prefetching_intervals; < 0: unlimited). Following the alpha/tau
+         * model, ceil(sim tau / client tau) parallel jobs are needed to produce the files
+         * at the consumption rate of the client.
+         * simstart and simstop are updated to the range actually covered by the launched jobs.
+         * returns the number of launched jobs
+         */
         dv::id_type horizontal_prefetch(dv::id_type &simstart, dv::id_type &simstop);
 
+		/**
+		 * collects range requests; the complete set (see kRequestRangeFlagLast) is scheduled
+		 * as bulk: the requested nrs are grouped by restart intervals (deduplicated against
+		 * cached files and running/queued jobs) and jobs are enqueued in the access order of the client.
+		 * Requested files are pinned in the cache when produced (cached ones at once) until the client
+		 * opens them. At most kMaxRequestedFiles (and the capacity of the file cache) are requested.
+		 * A new set (see kRequestRangeFlagFirst) replaces the old one and releases its pins.
+		 */
 		void handleRangeRequest(dv::id_type flag, std::unique_ptr<ClientDescriptor::RangeRequest> request);
 
+		/**
+		 * explicitly announced future accesses (in access order; see sdavi_hint() in DVLib).
+		 * files that are neither known to the cache nor covered by a job are scheduled like
+		 * range requests and pinned when produced.
+		 */
+		void handleHints(const std::vector<std::string> &filenames);
+
+		/**
+		 * up to count available result files that this client is likely to open after filename
+		 * (next nrs by the stride of the prefetcher or the predictions of the pattern prefetcher);
+		 * sent as readahead hints with the open reply (see ClientFileOpenMessageHandler)
+		 */
+		void getReadaheadFiles(const std::string &filename, size_t count, std::vector<std::string> *files);
+
+		/**
+		 * locks the descriptor if (file_type, nr) is part of the pending range requests of this client
+		 * (at most half of the file cache may be pinned by a client)
+		 */
+		void pinIfRequested(dv::id_type file_type, dv::id_type nr, const std::string &filename,
+							FileDescriptor *descriptor);
+
+		void releasePins();
+
         std::unique_ptr<SimJob> newSimulation(dv::id_type target_nr, dv::id_type simstop, std::string strparams);
 
     public:
@@ -70,7 +142,12 @@ namespace dv {
 
 		dv::id_type last_open_nr_ = -1;
 
+		/** job parameters of the last open sent to DV; reused for leased opens */
+		std::string last_open_parameters_;
+
         PrefetchContext prefetcher_;
+        PatternPrefetcher pattern_prefetcher_;
+        const bool use_pattern_prefetcher_;
 
 		const dv::id_type max_prefetching_intervals_;
 
@@ -82,11 +159,73 @@ namespace dv {
 
 		std::unordered_set<dv::id_type> known_sims_;
 
+		/** open parameters of deferred misses by filename (see startDeferredMiss()) */
+		std::unordered_map<std::string, std::string> deferred_misses_;
+
+		/** open parameters of files the client waits for to be restored from the cold tier */
+		std::unordered_map<std::string, std::string> cold_tier_waits_;
+
 		std::vector<std::unique_ptr<ClientDescriptor::RangeRequest>> range_requests_;
 
+		/** (result file type, nr) of pending range requests and hints */
+		std::set<std::pair<dv::id_type, dv::id_type>> requested_files_;
+		std::unordered_set<std::string> pinned_files_;
+
+		/** restart interval in access order holding the lowest and highest requested nr */
+		struct ScheduleInterval {
+			dv::id_type checkpoint;
+			dv::id_type first;
+			dv::id_type last;
+			bool descending;
+		};
+
+		void scheduleRangeRequests();
+		void addToSchedule(dv::id_type nr, bool descending,
+						   std::vector<ScheduleInterval> *intervals,
+						   std::unordered_map<dv::id_type, size_t> *interval_index);
+		dv::id_type launchSchedule(const std::vector<ScheduleInterval> &intervals);
+		void releasePin(const std::string &filename);
+
+		/**
+		 * false if the bound of requested_files_ is reached; see kMaxRequestedFiles
+		 */
+		bool addRequestedFile(dv::id_type file_type, dv::id_type nr, bool *inserted);
+
+		/**
+		 * pins the file of (file_type, nr) if it is cached; true then
+		 */
+		bool pinIfCached(dv::id_type file_type, dv::id_type nr);
+
+		/**
+		 * starts the restore of filename from the cold tier if that is estimated to be faster than its
+		 * re-simulation (alpha + n * tau from the previous restart file; unknown estimates: tier)
+		 */
+		bool promoteFromColdTier(const std::string &filename, const std::string &fullpath);
+
+		/**
+		 * tracer for horizontal prefetching: expected arrival of the first needed file
+		 * of a segment vs. its expected consumption by the client (in ms like the event log);
+		 * the actual consumption is logged when the client opens a file of the segment.
+		 * Segments the client never opens (killed jobs, direction changes) are dropped
+		 * oldest first beyond kMaxSegmentTraces.
+		 */
+		struct SegmentTrace {
+			dv::id_type start;
+			dv::id_type stop;
+			double launch_time;
+			double expected_arrival;
+			double expected_consumption;
+		};
+
+		std::unordered_map<dv::id_type, SegmentTrace> segment_traces_;
+
+		void traceSegment(SimJob *simjob, dv::id_type seg_start, double simalpha, double simtau, double mytau);
+		void traceSegmentConsumption(dv::id_type nr, double time, const char *access);
+
 		dv::id_type next_target_nr(dv::id_type current, dv::id_type direction);
         
         void profile(FileDescriptor * cache_entry);
+        void profile(FileDescriptor * cache_entry, const toolbox::TimeHelper::time_point_type &at);
 	};
 
 }
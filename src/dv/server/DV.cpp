@@ -14,12 +14,15 @@
 #include <sys/types.h>
 #include <stdlib.h>
 
+#include <algorithm>
 #include <cassert>
 #include <cstring>
+#include <limits>
 #include <vector>
 
 #include "MessageHandler.h"
 #include "MessageHandlerFactory.h"
+#include "../caches/CacheSnapshot.h"
 #include "../caches/filecaches/FileCache.h"
 #include "../simulator/Simulator.h"
 #include "../toolbox/StatisticsHelper.h"
@@ -32,6 +35,8 @@
 
 namespace dv {
 
+constexpr size_t DV::kMinResultNames;
+
 DV::DV(std::unique_ptr<DVConfig> config) : config_(std::move(config)) {
     jobqueue_.setMaxSimJobs(config_->dv_max_parallel_simjobs_);
     ip_address_ = config_->dv_hostname_;
@@ -61,6 +66,34 @@ void DV::setFileCachePtr(std::unique_ptr<FileCache> cache_ptr) {
     filecache_ptr_ = std::move(cache_ptr);
 }
 
+ShmTransport *DV::getShmTransportPtr() const {
+    return shm_transport_.get();
+}
+
+LeaseTable *DV::getLeaseTablePtr() const {
+    return lease_table_.get();
+}
+
+BlockCache *DV::getBlockCachePtr() const {
+    return block_cache_.get();
+}
+
+ColdTier *DV::getColdTierPtr() const {
+    return cold_tier_.get();
+}
+
+StagingArea *DV::getStagingAreaPtr() const {
+    return staging_area_.get();
+}
+
+EvictionJournal *DV::getEvictionJournalPtr() const {
+    return eviction_journal_.get();
+}
+
+MetadataStore *DV::getMetadataStorePtr() const {
+    return metadata_store_.get();
+}
+
 void DV::setPassive(){
     passive_mode_ = true;
 }
@@ -69,13 +102,13 @@ bool DV::isPassive(){
     return passive_mode_;
 }
 
-void DV::setFileIndex(toolbox::KeyValueStore * idx){
+void DV::setFileIndex(toolbox::PersistentIndex * idx){
     file_idx_ = idx;
 }
 
 void DV::indexFile(std::string filename){
     if (file_idx_==NULL) return;
-    file_idx_->setString(filename, "1");
+    file_idx_->set(filename, "1");
 }
 
 
@@ -87,20 +120,73 @@ void DV::run() {
 
     if (!this->listening_) startServer();
 
+    // the cache is initialized (scan or snapshot): evicted names can be swept from now on
+    if (result_names_limit_ == 0) {
+        result_names_limit_ = std::max(kMinResultNames, 2 * result_names_.size());
+    }
+
     fd_set read_fds;
     int max_fd = sim_socket_ > client_socket_ ? sim_socket_ : client_socket_;
+    int shm_fd = shm_transport_ != nullptr ? shm_transport_->getEventFd() : -1;
+    if (max_fd < shm_fd) {
+        max_fd = shm_fd;
+    }
+    int staging_fd = staging_area_ != nullptr ? staging_area_->getEventFd() : -1;
+    if (max_fd < staging_fd) {
+        max_fd = staging_fd;
+    }
+    int cold_tier_fd = cold_tier_ != nullptr ? cold_tier_->getEventFd() : -1;
+    if (max_fd < cold_tier_fd) {
+        max_fd = cold_tier_fd;
+    }
 
     std::string delimiter(":");
 
     start_time_ = toolbox::TimeHelper::now();
+    toolbox::TimeHelper::time_point_type last_snapshot_time = start_time_;
+    long snapshot_interval_ms = config_->filecache_snapshot_file_.empty() ? 0 : config_->filecache_snapshot_interval_s_ * 1000;
 
     while (!config_->stop_requested_predicate_() && !quit_requested_) {
         FD_ZERO(&read_fds);
         FD_SET(sim_socket_, &read_fds);
         FD_SET(client_socket_, &read_fds);
+        if (0 <= shm_fd) {
+            FD_SET(shm_fd, &read_fds);
+        }
+        if (0 <= staging_fd) {
+            FD_SET(staging_fd, &read_fds);
+        }
+        if (0 <= cold_tier_fd) {
+            FD_SET(cold_tier_fd, &read_fds);
+        }
 
-        // TODO: add timeout to select
-        int nr = select(max_fd + 1, &read_fds, nullptr, nullptr, nullptr);
+        // the timeout is only needed to release expired leases and to write periodic snapshots in time
+        long ms = -1;
+        if (lease_table_ != nullptr) {
+            lease_table_->expire();
+            ms = lease_table_->msUntilNextExpiry();
+        }
+        if (0 < snapshot_interval_ms) {
+            long since_snapshot = toolbox::TimeHelper::milliseconds(last_snapshot_time, toolbox::TimeHelper::now());
+            if (snapshot_interval_ms <= since_snapshot) {
+                CacheSnapshot::write(this, config_->filecache_snapshot_file_);
+                last_snapshot_time = toolbox::TimeHelper::now();
+                since_snapshot = 0;
+            }
+            if (ms < 0 || snapshot_interval_ms - since_snapshot < ms) {
+                ms = snapshot_interval_ms - since_snapshot;
+            }
+        }
+
+        struct timeval timeout;
+        struct timeval *timeout_ptr = nullptr;
+        if (0 <= ms) {
+            timeout.tv_sec = ms / 1000;
+            timeout.tv_usec = (ms % 1000) * 1000;
+            timeout_ptr = &timeout;
+        }
+
+        int nr = select(max_fd + 1, &read_fds, nullptr, nullptr, timeout_ptr);
         if (0 < nr) {
             char buf[kMaxBufferLen];
             size_t buflen = sizeof(buf);
@@ -161,6 +247,29 @@ void DV::run() {
                     std::cerr << "Server: accept: client socket: error " << errno << std::endl;
                 }
             }
+
+            if (0 <= shm_fd && FD_ISSET(shm_fd, &read_fds)) {
+                // requests of node-local clients (see ShmTransport); same handling as above
+                shm_transport_->drain([this, &delimiter](int socket, char *msg, uint32_t len) {
+                    if (config_->dv_debug_output_on_) {
+                        std::cout << "Server: got message on shm channel: " << msg << std::endl;
+                    }
+
+                    std::vector<std::string> params;
+                    toolbox::StringHelper::splitCStr(&params, msg, delimiter);
+
+                    ++message_count_;
+                    MessageHandlerFactory::runMessageHandler2(this, socket, MessageHandlerFactory::kClient, params);
+                });
+            }
+
+            if (0 <= staging_fd && FD_ISSET(staging_fd, &read_fds)) {
+                finishWriteBacks();
+            }
+
+            if (0 <= cold_tier_fd && FD_ISSET(cold_tier_fd, &read_fds)) {
+                finishPromotions();
+            }
         } else if (nr < 0) {
             // error
             if (!config_->stop_requested_predicate_() && !quit_requested_) {
@@ -184,6 +293,29 @@ const toolbox::KeyValueStore &DV::getStatusSummary() {
     // update KV store
     statusSummary_.setInt("dv_message_count", message_count_);
     statusSummary_.setInt("dv_connection_count", conncount_);
+    statusSummary_.setInt("dv_shm_message_count", shm_transport_ != nullptr ? shm_transport_->getRequestCount() : 0);
+    statusSummary_.setInt("dv_lease_active", lease_table_ != nullptr ? lease_table_->size() : 0);
+    statusSummary_.setInt("dv_lease_grants", lease_table_ != nullptr ? lease_table_->getGrantCount() : 0);
+    statusSummary_.setInt("dv_lease_reported_opens", lease_table_ != nullptr ? lease_table_->getReportedOpenCount() : 0);
+    statusSummary_.setInt("dv_blockcache_blocks", block_cache_ != nullptr ? block_cache_->getBlockCount() : 0);
+    statusSummary_.setInt("dv_blockcache_bytes", block_cache_ != nullptr ? block_cache_->getUsedBytes() : 0);
+    statusSummary_.setInt("dv_blockcache_hits", block_cache_ != nullptr ? block_cache_->getHitCount() : 0);
+    statusSummary_.setInt("dv_blockcache_evictions", block_cache_ != nullptr ? block_cache_->getEvictionCount() : 0);
+    statusSummary_.setInt("dv_coldtier_files", cold_tier_ != nullptr ? cold_tier_->getFileCount() : 0);
+    statusSummary_.setInt("dv_coldtier_bytes", cold_tier_ != nullptr ? cold_tier_->getUsedBytes() : 0);
+    statusSummary_.setInt("dv_coldtier_demotions", cold_tier_ != nullptr ? cold_tier_->getDemotionCount() : 0);
+    statusSummary_.setInt("dv_coldtier_hits", stats_.getColdTierHits());
+    statusSummary_.setInt("dv_coldtier_evictions", cold_tier_ != nullptr ? cold_tier_->getEvictionCount() : 0);
+    statusSummary_.setInt("dv_staging_files", staging_area_ != nullptr ? staging_area_->getStagedCount() : 0);
+    statusSummary_.setInt("dv_staging_writebacks", staging_area_ != nullptr ? staging_area_->getWriteBackCount() : 0);
+    statusSummary_.setInt("dv_staging_writeback_bytes", staging_area_ != nullptr ? staging_area_->getWrittenBackBytes() : 0);
+    statusSummary_.setInt("dv_staging_failures", staging_area_ != nullptr ? staging_area_->getFailureCount() : 0);
+    statusSummary_.setInt("dv_eviction_journal_records", eviction_journal_ != nullptr ? eviction_journal_->getRecordCount() : 0);
+    statusSummary_.setInt("dv_metadata_stubs", metadata_store_ != nullptr ? metadata_store_->getStubCount() : 0);
+    statusSummary_.setInt("dv_metadata_stub_replies", metadata_store_ != nullptr ? metadata_store_->getServedCount() : 0);
+    statusSummary_.setInt("dv_prefetch_predictions", stats_.getPrefetchPredictions());
+    statusSummary_.setInt("dv_prefetch_useful_predictions", stats_.getUsefulPrefetchPredictions());
+    statusSummary_.setDouble("dv_prefetch_accuracy", stats_.getPrefetchAccuracy());
     statusSummary_.extendMap(simulator_ptr_->getStatusSummary().getStoreMap());
     statusSummary_.extendMap(filecache_ptr_->getStatusSummary().getStoreMap());
 
@@ -333,6 +465,22 @@ dv::counter_type DV::getNumberOfPrefetchingJobs(dv::id_type client) {
     return count;
 }
 
+bool DV::isCheckpointInUse(dv::id_type nr) const {
+    for (const auto &job : simulation_jobs_) {
+        if (job.second->getSimStart() == nr) {
+            return true;
+        }
+    }
+
+    for (SimJob *job : jobqueue_.queue()) {
+        if (job->getSimStart() == nr) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 void DV::deindexJob(dv::id_type id) {
     simulation_jobs_.erase(id);
 }
@@ -348,6 +496,10 @@ void DV::registerClient(dv::id_type appid, std::unique_ptr<ClientDescriptor> cli
 }
 
 void DV::unregisterClient(dv::id_type appid) {
+    auto it = clients_.find(appid);
+    if (it != clients_.end()) {
+        it->second->releasePins();
+    }
     clients_.erase(appid);
     // note: removal of the unique_ptr<> will then also free back the heap space of the client
 }
@@ -361,6 +513,93 @@ ClientDescriptor *DV::findClientDescriptor(dv::id_type appid) {
     return it->second.get();
 }
 
+void DV::pinRequestedFile(dv::id_type file_type, dv::id_type nr, const std::string &filename,
+                          FileDescriptor *descriptor) {
+    for (auto &client : clients_) {
+        client.second->pinIfRequested(file_type, nr, filename, descriptor);
+    }
+}
+
+bool DV::sendToSocket(int socket, const std::string &reply) {
+    if (ShmTransport::isShmSocket(socket)) {
+        return shm_transport_ != nullptr && shm_transport_->send(socket, reply);
+    }
+
+    const char *ptr = reply.c_str();
+    size_t len = reply.size();
+    while (len > 0) {
+        ssize_t sent = send(socket, ptr, len, 0);
+        if (sent < 1) {
+            return false;
+        }
+        ptr += sent;
+        len -= sent;
+    }
+    return true;
+}
+
+void DV::addResultName(const std::string &filename, dv::id_type file_type) {
+    if (file_type == 0) {
+        file_type = simulator_ptr_->getResultFileType(filename);
+    }
+    if (file_type == 0) {
+        return;
+    }
+    result_names_[std::make_pair(file_type, simulator_ptr_->result2nr(filename, file_type))] = filename;
+    if (0 < result_names_limit_ && result_names_limit_ <= result_names_.size()) {
+        sweepResultNames();
+    }
+}
+
+void DV::sweepResultNames() {
+    size_t before = result_names_.size();
+    for (auto it = result_names_.begin(); it != result_names_.end();) {
+        if (filecache_ptr_->internal_lookup_get(it->second) == nullptr) {
+            it = result_names_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    result_names_limit_ = std::max(kMinResultNames, 2 * result_names_.size());
+    LOG(INFO, 1, "Result names: " + std::to_string(before - result_names_.size()) + " of evicted files dropped, "
+                 + std::to_string(result_names_.size()) + " kept.");
+}
+
+const std::string *DV::findResultName(dv::id_type file_type, dv::id_type nr) const {
+    auto it = result_names_.find(std::make_pair(file_type, nr));
+    return it != result_names_.end() ? &it->second : nullptr;
+}
+
+std::string DV::getMetadataFilename(const std::string &filename) {
+    dv::id_type file_type = simulator_ptr_->getResultFileType(filename);
+    if (metadata_store_ == nullptr || file_type == 0) {
+        return simulator_ptr_->getMetadataFilename(filename);
+    }
+
+    std::string stub = metadata_store_->getStub(file_type);
+    if (stub.empty() && metadata_store_->needsStub(file_type)) {
+        // first miss of this type: derive the stub from a known file that is available
+        // (bounded lookup; otherwise the first produced file of the type derives it, see
+        // SimulatorFileCloseMessageHandler)
+        dv::counter_type candidates = 0;
+        for (auto it = result_names_.lower_bound(std::make_pair(file_type, std::numeric_limits<dv::id_type>::min()));
+             it != result_names_.end() && it->first.first == file_type && candidates < kMaxMetadataCandidates;
+             ++it, ++candidates) {
+            FileDescriptor *descriptor = filecache_ptr_->internal_lookup_get(it->second);
+            if (descriptor == nullptr || !descriptor->isFileAvailable()) {
+                continue;
+            }
+            const std::string &file_name = descriptor->isStaged() ? descriptor->getStagedFileName()
+                                                                  : descriptor->getFileName();
+            if (metadata_store_->deriveStub(file_type, file_name) || !metadata_store_->needsStub(file_type)) {
+                break;
+            }
+        }
+        stub = metadata_store_->getStub(file_type);
+    }
+    return stub.empty() ? simulator_ptr_->getMetadataFilename(filename) : stub;
+}
+
 void DV::extendedApiSetInfo(std::string key, dv::id_type value) {
     extended_api_info_map_[key] = value;
 }
@@ -456,6 +695,78 @@ int DV::startServerPart(std::string &port) {
 void DV::startServer() {
     sim_socket_ = startServerPart(config_->dv_sim_port_);
     client_socket_ = startServerPart(config_->dv_client_port_);
+    if (config_->dv_shm_transport_) {
+        shm_transport_ = std::make_unique<ShmTransport>(config_->dv_client_port_);
+        if (!shm_transport_->isOk()) {
+            std::cerr << "WARNING: shared-memory transport not available; clients use sockets only." << std::endl;
+            shm_transport_.reset();
+        }
+    }
+    if (0 < config_->dv_lease_ms_) {
+        lease_table_ = std::make_unique<LeaseTable>(this);
+    }
+    if (0 < config_->blockcache_size_) {
+        if (!toolbox::FileSystemHelper::folderExists(config_->blockcache_path_)
+            && toolbox::FileSystemHelper::mkDir(config_->blockcache_path_) != 0) {
+            std::cerr << "WARNING: cannot create block store " << config_->blockcache_path_
+                      << "; block cache off." << std::endl;
+        } else {
+            block_cache_ = std::make_unique<BlockCache>(config_->blockcache_path_, config_->blockcache_size_,
+                                                        config_->blockcache_max_block_size_);
+        }
+    }
+    if (0 < config_->coldtier_size_) {
+        if (!toolbox::FileSystemHelper::folderExists(config_->coldtier_path_)
+            && toolbox::FileSystemHelper::mkDir(config_->coldtier_path_) != 0) {
+            std::cerr << "WARNING: cannot create cold tier " << config_->coldtier_path_
+                      << "; cold tier off." << std::endl;
+        } else {
+            cold_tier_ = std::make_unique<ColdTier>(config_->coldtier_path_, config_->coldtier_size_,
+                                                    config_->coldtier_compress_);
+            if (!cold_tier_->isOk()) {
+                std::cerr << "WARNING: cold tier not available; cold tier off." << std::endl;
+                cold_tier_.reset();
+            }
+        }
+    }
+    if (!config_->staging_path_.empty()) {
+        if (!toolbox::FileSystemHelper::folderExists(config_->staging_path_)
+            && toolbox::FileSystemHelper::mkDir(config_->staging_path_) != 0) {
+            std::cerr << "WARNING: cannot create staging folder " << config_->staging_path_
+                      << "; staging off." << std::endl;
+        } else {
+            staging_area_ = std::make_unique<StagingArea>(config_->staging_path_, config_->sim_result_path_);
+            if (!staging_area_->isOk()) {
+                std::cerr << "WARNING: staging area not available; staging off." << std::endl;
+                staging_area_.reset();
+            } else {
+                // files of the snapshot that were still staged: locked until written back
+                for (const auto &filename : staging_area_->getRecoveredFiles()) {
+                    FileDescriptor *descriptor = filecache_ptr_->internal_lookup_get(filename);
+                    if (descriptor != nullptr && !descriptor->isStaged()) {
+                        descriptor->setStagedFileName(toolbox::StringHelper::joinPath(config_->staging_path_, filename));
+                        descriptor->lock();
+                    }
+                }
+            }
+        }
+    }
+    if (!config_->metadata_path_.empty()) {
+        if (!toolbox::FileSystemHelper::folderExists(config_->metadata_path_)
+            && toolbox::FileSystemHelper::mkDir(config_->metadata_path_) != 0) {
+            std::cerr << "WARNING: cannot create metadata folder " << config_->metadata_path_
+                      << "; metadata stubs off." << std::endl;
+        } else {
+            metadata_store_ = std::make_unique<MetadataStore>(config_->metadata_path_);
+        }
+    }
+    if (config_->dv_eviction_journal_) {
+        eviction_journal_ = std::make_unique<EvictionJournal>(config_->dv_client_port_);
+        if (!eviction_journal_->isOk()) {
+            std::cerr << "WARNING: eviction journal not available; DVLib read caches check result files by stat." << std::endl;
+            eviction_journal_.reset();
+        }
+    }
     std::cout << std::endl << "DV server online. simulator: " << config_->dv_hostname_ << ":" << config_->dv_sim_port_
               << ", client: " << config_->dv_hostname_ << ":" << config_->dv_client_port_ << std::endl
               << "dv_max_prefetching_intervals " << config_->dv_max_prefetching_intervals_
@@ -468,9 +779,102 @@ void DV::startServer() {
 void DV::stopServer() {
     close(client_socket_);
     close(sim_socket_);
+    if (!config_->filecache_snapshot_file_.empty()) {
+        CacheSnapshot::write(this, config_->filecache_snapshot_file_);
+    }
+    shm_transport_.reset();
+    if (lease_table_ != nullptr) {
+        lease_table_->releaseAll();
+        lease_table_.reset();
+    }
+    if (block_cache_ != nullptr) {
+        block_cache_->printStatus(&std::cout);
+        block_cache_->clear();
+        block_cache_.reset();
+    }
+    if (cold_tier_ != nullptr) {
+        cold_tier_->printStatus(&std::cout);
+        cold_tier_.reset();
+    }
+    if (staging_area_ != nullptr) {
+        // finishes the pending write-backs
+        staging_area_->printStatus(&std::cout);
+        staging_area_.reset();
+    }
+    if (metadata_store_ != nullptr) {
+        metadata_store_->printStatus(&std::cout);
+        metadata_store_.reset();
+    }
+    eviction_journal_.reset();
     std::cout << "DV server sockets for simulator and client closed." << std::endl << std::endl;
 }
 
+void DV::finishWriteBacks() {
+    for (const auto &filename : staging_area_->takeWrittenBack()) {
+        // only internal lookup: the write-back is no access of the file
+        FileDescriptor *descriptor = filecache_ptr_->internal_lookup_get(filename);
+        if (descriptor == nullptr) {
+            // staged file of an earlier run that the cache does not know (no snapshot): as found by the startup scan
+            std::string fullpath = toolbox::StringHelper::joinPath(config_->sim_result_path_, filename);
+            std::unique_ptr<FileDescriptor> fd = std::make_unique<FileDescriptor>(filename, fullpath);
+            fd->setFileAvailable(true);
+            fd->setSize(toolbox::FileSystemHelper::fileSize(fullpath));
+            addResultName(filename);
+            filecache_ptr_->put(filename, std::move(fd));
+            LOG(SIMULATOR, 1, "Written back to the result path (earlier run): " + filename);
+            continue;
+        }
+        if (!descriptor->isStaged()) {
+            LOG(ERROR, 0, "Write-back of a file that is not staged: " + filename);
+            continue;
+        }
+
+        descriptor->setStagedFileName("");
+        descriptor->unlock();
+        LOG(SIMULATOR, 1, "Written back to the result path: " + filename);
+    }
+}
+
+void DV::finishPromotions() {
+    for (const auto &promoted : cold_tier_->takePromoted()) {
+        const std::string &filename = promoted.first;
+        FileDescriptor *descriptor = filecache_ptr_->internal_lookup_get(filename);
+        if (promoted.second) {
+            std::string fullpath = toolbox::StringHelper::joinPath(config_->sim_result_path_, filename);
+            if (descriptor == nullptr) {
+                std::unique_ptr<FileDescriptor> fd = std::make_unique<FileDescriptor>(filename, fullpath);
+                fd->setFileAvailable(true);
+                fd->setSize(toolbox::FileSystemHelper::fileSize(fullpath));
+                filecache_ptr_->put(filename, std::move(fd));
+                LOG(CLIENT, 1, "Restored from the cold tier: " + filename);
+                continue;
+            }
+
+            descriptor->setFileAvailable(true);
+            descriptor->setSize(toolbox::FileSystemHelper::fileSize(fullpath));
+            LOG(CLIENT, 1, "Restored from the cold tier: " + filename);
+
+            // as at the close of a file by its simulator (see SimulatorFileCloseMessageHandler)
+            std::vector<int> sockets(descriptor->getNotificationSockets().begin(),
+                                     descriptor->getNotificationSockets().end());
+            std::vector<int> variable_sockets = descriptor->takeAllVariableWaiterSockets();
+            sockets.insert(sockets.end(), variable_sockets.begin(), variable_sockets.end());
+            for (auto socket : sockets) {
+                sendToSocket(socket, MessageHandler::kLibReplyFileOpen);
+            }
+            for (auto socket : sockets) {
+                close(socket);
+            }
+            descriptor->removeAllNotificationSockets();
+            descriptor->removeAllWaitingClientPtrs();
+        }
+
+        for (auto &client : clients_) {
+            client.second->handleColdTierPromotion(filename, descriptor, promoted.second);
+        }
+    }
+}
+
 void DV::printStats() {
     stats_.print(&std::cout);
 }
@@ -7,9 +7,11 @@
 
 
 #include <iostream>
+#include <map>
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <utility>
 
 #include "../DVBasicTypes.h"
 #include "../DVForwardDeclarations.h"
@@ -17,10 +19,18 @@
 #include "DVStats.h"
 #include "ClientDescriptor.h"
 #include "JobQueue.h"
+#include "EvictionJournal.h"
+#include "LeaseTable.h"
+#include "MetadataStore.h"
+#include "ShmTransport.h"
+#include "StagingArea.h"
+#include "../caches/ColdTier.h"
+#include "../caches/blockcaches/BlockCache.h"
 #include "../caches/filecaches/FileCache.h"
 #include "../simulator/Simulator.h"
 #include "../simulator/SimJob.h"
 #include "../DVLog.h"
+#include "../toolbox/PersistentIndex.h"
 #include "../toolbox/StatisticsHelper.h"
 
 
@@ -39,6 +49,8 @@ namespace dv {
 	public:
 		static constexpr int kListenBacklog = 4; // used for each listening socket, may be adjusted
 		static constexpr int kMaxBufferLen = 4096;
+		static constexpr int kMaxMetadataCandidates = 16; // known files checked to derive a missing stub
+		static constexpr size_t kMinResultNames = 4096; // result names kept before the first sweep
 
         toolbox::TimeHelper::time_point_type start_time_;
 
@@ -59,6 +71,41 @@ namespace dv {
 		FileCache *getFileCachePtr() const;
 		void setFileCachePtr(std::unique_ptr<FileCache> cache_ptr);
 
+		/**
+		 * nullptr if the shared-memory transport is off (see dv_shm_transport)
+		 */
+		ShmTransport *getShmTransportPtr() const;
+
+		/**
+		 * nullptr if client read leases are off (see dv_lease_ms)
+		 */
+		LeaseTable *getLeaseTablePtr() const;
+
+		/**
+		 * nullptr if the block cache is off (see blockcache_size_mb)
+		 */
+		BlockCache *getBlockCachePtr() const;
+
+		/**
+		 * nullptr if the cold tier is off (see coldtier_size_mb)
+		 */
+		ColdTier *getColdTierPtr() const;
+
+		/**
+		 * nullptr if staging of new result files is off (see staging_path)
+		 */
+		StagingArea *getStagingAreaPtr() const;
+
+		/**
+		 * nullptr if the eviction journal for node-local DVLib read caches is not available
+		 */
+		EvictionJournal *getEvictionJournalPtr() const;
+
+		/**
+		 * nullptr if metadata stubs are off (see metadata_path)
+		 */
+		MetadataStore *getMetadataStorePtr() const;
+
 		const std::string getIpAddress() const;
 
 		const std::string &getSimPort() const;
@@ -76,7 +123,7 @@ namespace dv {
         void setPassive();
         bool isPassive();
     
-        void setFileIndex(toolbox::KeyValueStore * idx);
+        void setFileIndex(toolbox::PersistentIndex * idx);
         void indexFile(std::string filename);
 
 		/**
@@ -122,6 +169,12 @@ namespace dv {
 		 */
 		dv::counter_type getNumberOfPrefetchingJobs(dv::id_type client);
 
+		/**
+		 * true if a running or queued job uses the checkpoint nr as restart point.
+		 * used to protect checkpoint files from eviction.
+		 */
+		bool isCheckpointInUse(dv::id_type nr) const;
+
         /* deindexJob just removes the job from the index.
          * removeJob removes it from the index and frees space in the JobQuee
          * (it can lead to the launch of a new queued simulation).
@@ -134,6 +187,39 @@ namespace dv {
 		void unregisterClient(dv::id_type appid);
 		ClientDescriptor *findClientDescriptor(dv::id_type appid); // not const since client may adjust the client descriptor
 
+		/**
+		 * offers a file that is being produced to all clients with pending range requests.
+		 * clients that requested (file_type, nr) pin the file in the cache until they open it.
+		 */
+		void pinRequestedFile(dv::id_type file_type, dv::id_type nr, const std::string &filename,
+							  FileDescriptor *descriptor);
+
+		/**
+		 * sends reply on a client socket or shm channel (see ShmTransport::isShmSocket())
+		 */
+		bool sendToSocket(int socket, const std::string &reply);
+
+		/**
+		 * name index of the result files seen so far (scanned at startup, restored from the cache
+		 * snapshot, or created by simulators); used to name predicted files (see readahead hints
+		 * in ClientFileOpenMessageHandler). Check the cache: names of evicted files are only dropped
+		 * when the index has doubled since the last sweep (see sweepResultNames()).
+		 * file_type == 0 -> type will be determined first
+		 */
+		void addResultName(const std::string &filename, dv::id_type file_type = 0);
+
+		/**
+		 * nullptr if no result file of the given type and nr is known
+		 */
+		const std::string *findResultName(dv::id_type file_type, dv::id_type nr) const;
+
+		/**
+		 * metadata file that clients open while filename is being produced: the stub of its type in
+		 * the metadata store (derived from an available file of the type if there is none yet),
+		 * otherwise the .meta file of the simulator (see Simulator::getMetadataFilename())
+		 */
+		std::string getMetadataFilename(const std::string &filename);
+
 		void run();
 		
 		void quit();
@@ -159,7 +245,7 @@ namespace dv {
         bool listening_ = false;
 
 		toolbox::KeyValueStore statusSummary_;
-        toolbox::KeyValueStore * file_idx_ = NULL;
+        toolbox::PersistentIndex * file_idx_ = NULL;
         
 
 		std::string ip_address_;
@@ -184,8 +270,33 @@ namespace dv {
 		int sim_socket_ = 0;
 		int client_socket_ = 0;
 
+		std::unique_ptr<ShmTransport> shm_transport_;
+
+		std::unique_ptr<LeaseTable> lease_table_;
+
+		std::unique_ptr<BlockCache> block_cache_;
+
+		std::unique_ptr<ColdTier> cold_tier_;
+
+		std::unique_ptr<StagingArea> staging_area_;
+
+		std::unique_ptr<EvictionJournal> eviction_journal_;
+
+		std::unique_ptr<MetadataStore> metadata_store_;
+
 		std::unordered_map<dv::id_type, std::unique_ptr<ClientDescriptor>> clients_;
 
+		// (result file type, nr) -> name; see addResultName()
+		std::map<std::pair<dv::id_type, dv::id_type>, std::string> result_names_;
+		size_t result_names_limit_ = 0; // 0: no sweeps while the cache is being initialized
+
+		/**
+		 * drops the names of the files that are no longer in the cache; the next sweep is due when
+		 * the index has doubled (at least kMinResultNames). Thus, the index stays in proportion
+		 * to the cache.
+		 */
+		void sweepResultNames();
+
 		// this is currently mainly for testing purpose of set_info and get_info
 		// no interaction with actual DV state yet.
 		std::unordered_map<std::string, dv::id_type> extended_api_info_map_;
@@ -206,6 +317,17 @@ namespace dv {
 
 		int startServerPart(std::string &port);
 
+		/**
+		 * releases the staging locks of the files written back to the result path (see StagingArea)
+		 */
+		void finishWriteBacks();
+
+		/**
+		 * makes the files restored from the cold tier available and notifies the waiting clients;
+		 * failed restores are re-simulated (see ClientDescriptor::handleColdTierPromotion())
+		 */
+		void finishPromotions();
+
 
 		void stopServer();
 
@@ -55,6 +55,11 @@ bool DVConfig::assure_config_ok() {
     }
 
     // checks
+    if (dv_prefetcher_type_ != "stride" && dv_prefetcher_type_ != "pattern") {
+        std::cerr << "dv_prefetcher_type must be \"stride\" or \"pattern\"." << std::endl;
+        return false;
+    }
+
     if (filecache_size_ <= 0) {
         std::cerr << "filecache_size must be > 0." << std::endl;
         return false;
@@ -70,6 +75,11 @@ bool DVConfig::assure_config_ok() {
         return false;
     }
 
+    if (filecache_fifo_queue_min_size_ < 0 || filecache_fifo_queue_size_ < filecache_fifo_queue_min_size_) {
+        std::cerr << "filecache_fifo_queue_min_size must be >= 0 and <= filecache_fifo_queue_size." << std::endl;
+        return false;
+    }
+
     filecache_embedded_cache_size_ = filecache_size_ - filecache_fifo_queue_size_;
 
     if (FileCache::getFileCacheType(filecache_type_) == FileCache::kLIRS) {
@@ -99,6 +109,53 @@ bool DVConfig::assure_config_ok() {
         return false;
     }
 
+    if (filecache_snapshot_interval_s_ < 0) {
+        std::cerr << "filecache_snapshot_interval_s must be >= 0." << std::endl;
+        return false;
+    }
+
+    if (blockcache_size_ < 0) {
+        std::cerr << "blockcache_size_mb must be >= 0." << std::endl;
+        return false;
+    }
+
+    if (0 < blockcache_size_) {
+        if (blockcache_path_.empty() || blockcache_path_.find(':') != std::string::npos) {
+            std::cerr << "blockcache_path must be set and must not contain ':' if the block cache is on." << std::endl;
+            return false;
+        }
+
+        if (blockcache_max_block_size_ <= 0 || blockcache_size_ < blockcache_max_block_size_) {
+            std::cerr << "blockcache_max_block_kb must be > 0 and must not exceed blockcache_size_mb." << std::endl;
+            return false;
+        }
+    }
+
+    if (coldtier_size_ < 0) {
+        std::cerr << "coldtier_size_mb must be >= 0." << std::endl;
+        return false;
+    }
+
+    if (0 < coldtier_size_ && coldtier_path_.empty()) {
+        std::cerr << "coldtier_path must be set if the cold tier is on." << std::endl;
+        return false;
+    }
+
+    if (!staging_path_.empty() && staging_path_ == sim_result_path_) {
+        std::cerr << "staging_path must differ from the result path." << std::endl;
+        return false;
+    }
+
+    if (!metadata_path_.empty() && metadata_path_ == sim_result_path_) {
+        std::cerr << "metadata_path must differ from the result path." << std::endl;
+        return false;
+    }
+
+    if (sim_checkpoint_cache_size_ < 0) {
+        std::cerr << "sim_checkpoint_cache_size must be >= 0." << std::endl;
+        return false;
+    }
+
     if (sim_config_path_.empty()
             || sim_checkpoint_path_.empty()
             || sim_result_path_.empty()) {
@@ -130,6 +187,11 @@ void DVConfig::print(std::ostream *out) {
          << "=> derived: dv_max_prefetching_intervals = " << dv_max_prefetching_intervals_
          << (dv_max_prefetching_intervals_ == 0 ? " (prefetching off)" :
              (dv_max_prefetching_intervals_ == -1 ? " (prefetching unlimited)" : "")) << std::endl
+         << "dv_prefetcher_type = " << dv_prefetcher_type_ << std::endl
+         << "dv_shm_transport = " << (dv_shm_transport_ ? "on" : "off") << std::endl
+         << "dv_lease_ms = " << dv_lease_ms_ << (dv_lease_ms_ <= 0 ? " (leases off)" : "") << std::endl
+         << "dv_variable_notification = " << (dv_variable_notification_ ? "on" : "off (notification at file close)") << std::endl
+         << "dv_eviction_journal = " << (dv_eviction_journal_ ? "on" : "off") << std::endl
          << "dv_batch_job_id = " << dv_batch_job_id_ << std::endl
          << "dv_stat_label = " << dv_stat_label_ << std::endl;
 
@@ -144,13 +206,16 @@ void DVConfig::print(std::ostream *out) {
          << "sim_checkpoint_path = " << sim_checkpoint_path_ << std::endl
          << "sim_result_path = " << sim_result_path_ << std::endl
          << "sim_temporary_redirect_path = " << sim_temporary_redirect_path_ << std::endl
+         << "sim_redirect_skip_writes = " << (sim_redirect_skip_writes_ ? "on" : "off") << std::endl
          << "sim_parameter_template_style = " << (sim_parameter_template_style_ + 1) << std::endl
          << "sim_parameter_template_file = " << sim_parameter_template_file_ << std::endl
          << "sim_parameter_output_file = " << sim_parameter_output_file_ << std::endl
          << "sim_job_template_style  = " << (sim_job_template_style_ + 1) << std::endl
          << "sim_job_template_file = " << sim_job_template_file_ << std::endl
          << "sim_job_output_file = " << sim_job_output_file_ << std::endl
-         << "sim_kill_threshold = " << sim_kill_threshold_ << std::endl;
+         << "sim_kill_threshold = " << sim_kill_threshold_ << std::endl
+         << "sim_checkpoint_cache_size = " << sim_checkpoint_cache_size_
+         << (sim_checkpoint_cache_size_ == 0 ? " (unlimited)" : "") << std::endl;
 
     *out << "filecache_type = " << filecache_type_ << std::endl
          << "filecache_size = " << filecache_size_ << std::endl
@@ -158,9 +223,30 @@ void DVConfig::print(std::ostream *out) {
          << (0 < filecache_fifo_queue_size_? "=> FIFO queue wrapper active: embedded cache size "
              + std::to_string(filecache_embedded_cache_size_)
              + "\n" : "")
+         << "filecache_fifo_queue_min_size = " << filecache_fifo_queue_min_size_
+         << (filecache_fifo_queue_min_size_ == 0 ? " (fixed split)" : " (adaptive split)") << std::endl
          << "filecache_lir_set_size = " << filecache_lir_set_size_ << std::endl
          << "filecache_protected_mrus = " << filecache_protected_mrus_ << std::endl
          << "filecache_penalty_factor = " << filecache_penalty_factor_ << std::endl
+         << "filecache_snapshot_file = " << filecache_snapshot_file_
+         << (filecache_snapshot_file_.empty() ? " (snapshot off)" : "") << std::endl
+         << "filecache_snapshot_interval_s = " << filecache_snapshot_interval_s_
+         << (filecache_snapshot_interval_s_ == 0 ? " (at shutdown only)" : "") << std::endl;
+
+    *out << "blockcache_path = " << blockcache_path_ << std::endl
+         << "blockcache_size = " << blockcache_size_ << " bytes" << (blockcache_size_ == 0 ? " (block cache off)" : "") << std::endl
+         << "blockcache_max_block_size = " << blockcache_max_block_size_ << " bytes" << std::endl
+         << std::endl;
+
+    *out << "coldtier_path = " << coldtier_path_ << std::endl
+         << "coldtier_size = " << coldtier_size_ << " bytes" << (coldtier_size_ == 0 ? " (cold tier off)" : "") << std::endl
+         << "coldtier_compress = " << (coldtier_compress_ ? "on" : "off") << std::endl
+         << std::endl;
+
+    *out << "staging_path = " << staging_path_ << (staging_path_.empty() ? " (staging off)" : "") << std::endl
+         << std::endl;
+
+    *out << "metadata_path = " << metadata_path_ << (metadata_path_.empty() ? " (metadata stubs off)" : "") << std::endl
          << std::endl;
 }
 
@@ -231,10 +317,15 @@ bool DVConfig::checkApi() {
     checkApiPart(lua::LuaWrapper::kString, "dv_sim_port");
     checkApiPart(lua::LuaWrapper::kString, "dv_batch_job_id");
     checkApiPart(lua::LuaWrapper::kString, "dv_statistics_label");
+    checkApiPart(lua::LuaWrapper::kString, "dv_prefetcher_type");
 
     checkApiPart(lua::LuaWrapper::kInt, "dv_max_parallel_simjobs");
     checkApiPart(lua::LuaWrapper::kInt, "dv_max_horizontal_prefetching_intervals");
     checkApiPart(lua::LuaWrapper::kInt, "dv_max_vertical_prefetching_intervals");
+    checkApiPart(lua::LuaWrapper::kInt, "dv_shm_transport");
+    checkApiPart(lua::LuaWrapper::kInt, "dv_lease_ms");
+    checkApiPart(lua::LuaWrapper::kInt, "dv_variable_notification");
+    checkApiPart(lua::LuaWrapper::kInt, "dv_eviction_journal");
     // note: dv_max_prefetching_intervals is derived and not read from config file
     checkApiPart(lua::LuaWrapper::kInt, "optional_dv_prefetch_all_files_at_once");
 
@@ -243,6 +334,7 @@ bool DVConfig::checkApi() {
     checkApiPart(lua::LuaWrapper::kString, "sim_checkpoint_path");
     checkApiPart(lua::LuaWrapper::kString, "sim_result_path");
     checkApiPart(lua::LuaWrapper::kString, "sim_temporary_redirect_path");
+    checkApiPart(lua::LuaWrapper::kInt, "sim_redirect_skip_writes");
 
     checkApiPart(lua::LuaWrapper::kInt, "sim_parameter_template_style");
     checkApiPart(lua::LuaWrapper::kString, "sim_parameter_template_file");
@@ -253,6 +345,7 @@ bool DVConfig::checkApi() {
     checkApiPart(lua::LuaWrapper::kString, "sim_job_output_file");
 
     checkApiPart(lua::LuaWrapper::kInt, "sim_kill_threshold");
+    checkApiPart(lua::LuaWrapper::kInt, "sim_checkpoint_cache_size");
 
     checkApiPart(lua::LuaWrapper::kInt, "optional_sim_max_nr");
     checkApiPart(lua::LuaWrapper::kInt, "optional_dv_prefetch_all_files_at_once");
@@ -261,9 +354,28 @@ bool DVConfig::checkApi() {
     checkApiPart(lua::LuaWrapper::kString, "filecache_type");
     checkApiPart(lua::LuaWrapper::kInt, "filecache_size");
     checkApiPart(lua::LuaWrapper::kInt, "filecache_fifo_queue_size");
+    checkApiPart(lua::LuaWrapper::kInt, "filecache_fifo_queue_min_size");
     checkApiPart(lua::LuaWrapper::kInt, "filecache_lir_set_size");
     checkApiPart(lua::LuaWrapper::kInt, "filecache_protected_mrus");
     checkApiPart(lua::LuaWrapper::kDouble, "filecache_penalty_factor");
+    checkApiPart(lua::LuaWrapper::kString, "filecache_snapshot_file");
+    checkApiPart(lua::LuaWrapper::kInt, "filecache_snapshot_interval_s");
+
+    // API checks: blockcache constants
+    checkApiPart(lua::LuaWrapper::kString, "blockcache_path");
+    checkApiPart(lua::LuaWrapper::kInt, "blockcache_size_mb");
+    checkApiPart(lua::LuaWrapper::kInt, "blockcache_max_block_kb");
+
+    // API checks: coldtier constants
+    checkApiPart(lua::LuaWrapper::kString, "coldtier_path");
+    checkApiPart(lua::LuaWrapper::kInt, "coldtier_size_mb");
+    checkApiPart(lua::LuaWrapper::kInt, "coldtier_compress");
+
+    // API checks: staging constants
+    checkApiPart(lua::LuaWrapper::kString, "staging_path");
+
+    // API checks: metadata constants
+    checkApiPart(lua::LuaWrapper::kString, "metadata_path");
 
     return checkApiStatus_;
 }
@@ -298,10 +410,15 @@ bool DVConfig::fetchConstants() {
     dv_sim_port_ = lw_.getString("dv_sim_port");
     dv_batch_job_id_ = lw_.getString("dv_batch_job_id");
     dv_stat_label_ = lw_.getString("dv_statistics_label");
+    dv_prefetcher_type_ = lw_.getString("dv_prefetcher_type");
 
     dv_max_parallel_simjobs_ = lw_.getInt("dv_max_parallel_simjobs");
     dv_max_horizontal_prefetching_intervals_ = lw_.getInt("dv_max_horizontal_prefetching_intervals");
     dv_max_vertical_prefetching_intervals_ = lw_.getInt("dv_max_vertical_prefetching_intervals");
+    dv_shm_transport_ = lw_.getInt("dv_shm_transport") == 1;
+    dv_lease_ms_ = lw_.getInt("dv_lease_ms");
+    dv_variable_notification_ = lw_.getInt("dv_variable_notification") == 1;
+    dv_eviction_journal_ = lw_.getInt("dv_eviction_journal") == 1;
 
 
     // multiplication and additional checks happen during assure_config_ok()
@@ -314,8 +431,10 @@ bool DVConfig::fetchConstants() {
     sim_checkpoint_path_ = lw_.getString("sim_checkpoint_path");
     sim_result_path_ = lw_.getString("sim_result_path");
     sim_temporary_redirect_path_ = lw_.getString("sim_temporary_redirect_path");
+    sim_redirect_skip_writes_ = lw_.getInt("sim_redirect_skip_writes") == 1;
 
     sim_kill_threshold_ = lw_.getInt("sim_kill_threshold");
+    sim_checkpoint_cache_size_ = lw_.getInt("sim_checkpoint_cache_size");
 
     sim_parameter_template_file_ = lw_.getString("sim_parameter_template_file");
     switch(lw_.getInt("sim_parameter_template_style")) {
@@ -351,9 +470,28 @@ bool DVConfig::fetchConstants() {
     filecache_type_ = lw_.getString("filecache_type");
     filecache_size_ = lw_.getInt("filecache_size");
     filecache_fifo_queue_size_ = lw_.getInt("filecache_fifo_queue_size");
+    filecache_fifo_queue_min_size_ = lw_.getInt("filecache_fifo_queue_min_size");
     filecache_lir_set_size_ = lw_.getInt("filecache_lir_set_size");
     filecache_protected_mrus_ = lw_.getInt("filecache_protected_mrus");
     filecache_penalty_factor_ = lw_.getDouble("filecache_penalty_factor");
+    filecache_snapshot_file_ = lw_.getString("filecache_snapshot_file");
+    filecache_snapshot_interval_s_ = lw_.getInt("filecache_snapshot_interval_s");
+
+    // blockcache
+    blockcache_path_ = lw_.getString("blockcache_path");
+    blockcache_size_ = lw_.getInt("blockcache_size_mb") * 1024 * 1024;
+    blockcache_max_block_size_ = lw_.getInt("blockcache_max_block_kb") * 1024;
+
+    // coldtier
+    coldtier_path_ = lw_.getString("coldtier_path");
+    coldtier_size_ = lw_.getInt("coldtier_size_mb") * 1024 * 1024;
+    coldtier_compress_ = lw_.getInt("coldtier_compress") == 1;
+
+    // staging
+    staging_path_ = lw_.getString("staging_path");
+
+    // metadata
+    metadata_path_ = lw_.getString("metadata_path");
 
     return true;
 }
@@ -21,7 +21,7 @@ namespace dv {
 
 	class DVConfig {
 	public:
-		static constexpr int kApiVersion = 5;
+		static constexpr int kApiVersion = 18;
 
 		// API versions
 		// 0: initial version
@@ -31,6 +31,19 @@ namespace dv {
 		// 3: added sim_kill_threshold
 		// 4: added temporary redirect dummy path
 		// 5: added filecache_fifo_queue_size
+		// 6: added sim_checkpoint_cache_size
+		// 7: added dv_prefetcher_type
+		// 8: added dv_shm_transport
+		// 9: added dv_lease_ms
+		// 10: added dv_variable_notification
+		// 11: added blockcache_path, blockcache_size_mb, blockcache_max_block_kb
+		// 12: added filecache_snapshot_file, filecache_snapshot_interval_s
+		// 13: added coldtier_path, coldtier_size_mb, coldtier_compress
+		// 14: added staging_path
+		// 15: added sim_redirect_skip_writes
+		// 16: added metadata_path
+		// 17: added filecache_fifo_queue_min_size
+		// 18: added dv_eviction_journal
 
 		//--- initialization ---------------------------------------------------
 		bool loadConfigFile(const std::string &filename);
@@ -63,6 +76,11 @@ namespace dv {
 		dv::id_type dv_max_horizontal_prefetching_intervals_;
 		dv::id_type dv_max_vertical_prefetching_intervals_;
 		dv::id_type dv_max_prefetching_intervals_; /** this is the product of horizontal * vertical */
+		std::string dv_prefetcher_type_; /** "stride" (PrefetchContext) or "pattern" (PatternPrefetcher) */
+		bool dv_shm_transport_; /** shared-memory transport for node-local clients (see ShmTransport) */
+		dv::id_type dv_lease_ms_; /** duration of client read leases on available files; 0: off (see LeaseTable) */
+		bool dv_variable_notification_; /** notify variable gets as soon as the requested slab is written (see VariableDescriptor) */
+		bool dv_eviction_journal_; /** publish evictions to the DVLib local read caches of this node (see EvictionJournal) */
 
 		std::string dv_batch_job_id_;
 		std::string dv_stat_label_;
@@ -77,6 +95,7 @@ namespace dv {
 		std::string sim_checkpoint_path_;
 		std::string sim_result_path_;
 		std::string sim_temporary_redirect_path_;
+		bool sim_redirect_skip_writes_; /** DVLib skips the data writes of redirected result files (kLibReplyFileCreateRedirectSkipWrites) */
 
 		toolbox::TextTemplate::Style sim_parameter_template_style_;
 		std::string sim_parameter_template_file_;
@@ -90,6 +109,8 @@ namespace dv {
         
         dv::id_type sim_kill_threshold_;
 
+		dv::id_type sim_checkpoint_cache_size_; /** max. number of checkpoints added during runtime; 0: unlimited */
+
 		//--- filecache --------------------------------------------------------
 		bool filecache_debug_output_on_;
 		bool filecache_details_debug_output_on_;
@@ -97,10 +118,29 @@ namespace dv {
 		std::string filecache_type_;
 		FileCacheLRU::ID_type filecache_size_;
 		FileCacheLRU::ID_type filecache_fifo_queue_size_;
+		FileCacheLRU::ID_type filecache_fifo_queue_min_size_; /** 0: fixed split; see FileCacheFifoWrapper */
 		FileCacheLRU::ID_type filecache_embedded_cache_size_; /** calculated during assure routine */
 		FileCacheLIRS::ID_type filecache_lir_set_size_;
 		FileCacheLRU::ID_type filecache_protected_mrus_;
 		double filecache_penalty_factor_;
+		std::string filecache_snapshot_file_; /** see CacheSnapshot; empty: off */
+		dv::id_type filecache_snapshot_interval_s_; /** 0: snapshot at shutdown only */
+
+		//--- blockcache -------------------------------------------------------
+		std::string blockcache_path_; /** block store; see BlockCache */
+		dv::size_type blockcache_size_; /** bytes (config file: MiB); 0: block cache off */
+		dv::size_type blockcache_max_block_size_; /** bytes (config file: KiB) */
+
+		//--- coldtier ---------------------------------------------------------
+		std::string coldtier_path_; /** evicted result files; see ColdTier */
+		dv::size_type coldtier_size_; /** bytes (config file: MiB); 0: cold tier off */
+		bool coldtier_compress_; /** recompression of demoted files in the background */
+
+		//--- staging ----------------------------------------------------------
+		std::string staging_path_; /** node-local folder for new result files; see StagingArea; empty: off */
+
+		//--- metadata ---------------------------------------------------------
+		std::string metadata_path_; /** header-only stubs of result files; see MetadataStore; empty: off */
 
 
 		//--- functions --------------------------------------------------------
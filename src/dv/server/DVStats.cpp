@@ -41,6 +41,14 @@ dv::counter_type DVStats::getWaiting() const {
     return waiting_;
 }
 
+void DVStats::incColdTierHits() {
+    ++cold_tier_hits_;
+}
+
+dv::counter_type DVStats::getColdTierHits() const {
+    return cold_tier_hits_;
+}
+
 void DVStats::incEvictions(std::string fileName) {
     LOG(CACHE, 0, "Evicting " + fileName);
     ++evictions_;
@@ -67,15 +75,40 @@ dv::counter_type DVStats::getResim() const {
     return total_resim_;
 }
 
+void DVStats::incPrefetchPredictions() {
+    ++prefetch_predictions_;
+}
+
+dv::counter_type DVStats::getPrefetchPredictions() const {
+    return prefetch_predictions_;
+}
+
+void DVStats::incUsefulPrefetchPredictions() {
+    ++useful_prefetch_predictions_;
+}
+
+dv::counter_type DVStats::getUsefulPrefetchPredictions() const {
+    return useful_prefetch_predictions_;
+}
+
+double DVStats::getPrefetchAccuracy() const {
+    if (prefetch_predictions_ == 0) {
+        return 0.0;
+    }
+    return (double) useful_prefetch_predictions_ / (double) prefetch_predictions_;
+}
+
 void DVStats::print(std::ostream *out) const {
     *out << "access stats: "
          << total_ << " total, "
          << hits_ << " hits, "
          << misses_ << " misses, "
          << waiting_ << " waiting, "
+         << cold_tier_hits_ << " cold tier hits, "
          << evictions_ << " evictions, "
          << fifo_queue_evictions_ << " FIFO queue evictions, "
-         << total_resim_ << " total re-simulations"
+         << total_resim_ << " total re-simulations, "
+         << useful_prefetch_predictions_ << "/" << prefetch_predictions_ << " useful prefetch predictions"
          << std::endl;
 }
 
@@ -29,6 +29,10 @@ namespace dv {
 		void incWaiting();
 		dv::counter_type getWaiting() const;
 
+		/** misses served from the cold tier instead of a re-simulation (see ColdTier) */
+		void incColdTierHits();
+		dv::counter_type getColdTierHits() const;
+
 		void incEvictions(std::string fileName);
 		dv::counter_type getEvictions() const;
 
@@ -38,6 +42,15 @@ namespace dv {
 		void incResim(dv::counter_type amount);
 		dv::counter_type getResim() const;
 
+		void incPrefetchPredictions();
+		dv::counter_type getPrefetchPredictions() const;
+
+		void incUsefulPrefetchPredictions();
+		dv::counter_type getUsefulPrefetchPredictions() const;
+
+		/** ratio useful / issued predictions; 0.0 if no predictions were issued */
+		double getPrefetchAccuracy() const;
+
 		void print(std::ostream *out) const;
 
 
@@ -46,9 +59,12 @@ namespace dv {
 		dv::counter_type hits_ = 0;
 		dv::counter_type misses_ = 0;
 		dv::counter_type waiting_ = 0;
+		dv::counter_type cold_tier_hits_ = 0;
 		dv::counter_type evictions_ = 0;
 		dv::counter_type fifo_queue_evictions_ = 0;
 		dv::counter_type total_resim_ = 0;
+		dv::counter_type prefetch_predictions_ = 0;
+		dv::counter_type useful_prefetch_predictions_ = 0;
 	};
 
 }
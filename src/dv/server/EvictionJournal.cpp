@@ -0,0 +1,94 @@
+//
+// Shared-memory journal of evicted result files for node-local DVLib read caches
+//
+
+#include "EvictionJournal.h"
+
+#include <cerrno>
+#include <chrono>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "../DVLog.h"
+
+namespace dv {
+
+constexpr char EvictionJournal::kSegmentPrefix[];
+constexpr uint32_t EvictionJournal::kMagic;
+constexpr uint32_t EvictionJournal::kVersion;
+constexpr uint32_t EvictionJournal::kEntries;
+
+EvictionJournal::EvictionJournal(const std::string &port) : name_(kSegmentPrefix + port) {
+    // a segment of a crashed DV instance is replaced
+    shm_unlink(name_.c_str());
+
+    // clients map the segment read-only
+    int fd = shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        LOG(ERROR, 0, "Eviction journal: cannot create " + name_ + ": " + std::to_string(errno));
+        return;
+    }
+
+    if (ftruncate(fd, sizeof(Header)) != 0) {
+        LOG(ERROR, 0, "Eviction journal: cannot resize " + name_ + ": " + std::to_string(errno));
+        close(fd);
+        shm_unlink(name_.c_str());
+        return;
+    }
+
+    void *ptr = mmap(nullptr, sizeof(Header), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (ptr == MAP_FAILED) {
+        LOG(ERROR, 0, "Eviction journal: cannot map " + name_ + ": " + std::to_string(errno));
+        shm_unlink(name_.c_str());
+        return;
+    }
+
+    // ftruncate zeroed the segment; magic is published last (clients check it)
+    header_ = static_cast<Header *>(ptr);
+    header_->version = kVersion;
+    header_->pid = getpid();
+    header_->entries = kEntries;
+    header_->epoch = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    __atomic_store_n(&header_->magic, kMagic, __ATOMIC_RELEASE);
+
+    LOG(INFO, 0, "Eviction journal: " + name_);
+}
+
+EvictionJournal::~EvictionJournal() {
+    if (header_ == nullptr) {
+        return;
+    }
+
+    // clients still attached see magic == 0 and drop their copies
+    __atomic_store_n(&header_->magic, 0, __ATOMIC_RELEASE);
+    munmap(header_, sizeof(Header));
+    shm_unlink(name_.c_str());
+}
+
+void EvictionJournal::publish(const std::string &filename) {
+    if (header_ == nullptr) {
+        return;
+    }
+
+    // single writer (server loop): readers detect overwritten records by seq
+    uint64_t seq = header_->head + 1;
+    Record &record = header_->record[seq % kEntries];
+    __atomic_store_n(&record.seq, 0, __ATOMIC_RELEASE);
+    __atomic_store_n(&record.hash, hash(filename), __ATOMIC_RELEASE);
+    __atomic_store_n(&record.seq, seq, __ATOMIC_RELEASE);
+    __atomic_store_n(&header_->head, seq, __ATOMIC_RELEASE);
+}
+
+uint64_t EvictionJournal::hash(const std::string &filename) {
+    uint64_t h = 14695981039346656037ull;
+    for (unsigned char c : filename) {
+        h ^= c;
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+}
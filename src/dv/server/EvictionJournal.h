@@ -0,0 +1,83 @@
+//
+// Shared-memory journal of evicted result files for node-local DVLib read caches
+//
+
+#ifndef DV_SERVER_EVICTIONJOURNAL_H_
+#define DV_SERVER_EVICTIONJOURNAL_H_
+
+#include <cstdint>
+#include <string>
+
+namespace dv {
+
+    /**
+     * DVLib may keep copies of available result files in a node-local cache folder (see
+     * DV_LOCAL_CACHE in dvl_lcache.h). A copy is valid as long as DV keeps the result file; thus,
+     * DV publishes each eviction of a result file in a POSIX shm segment (kSegmentPrefix + client
+     * port) that node-local clients map read-only. Only created with dv_eviction_journal = 1.
+     *
+     * The segment holds a ring of kEntries records (sequence number, FNV-1a hash of the file name).
+     * seq 0 is never used; head is the sequence number of the last record. A reader that falls
+     * behind by more than kEntries records (the record at its position has a newer seq) drops
+     * all copies. The epoch changes with each DV start; copies taken under another epoch are
+     * dropped as well.
+     *
+     * The layout must match the layout used in DVLib (dvl_lcache.c).
+     */
+    class EvictionJournal {
+    public:
+        static constexpr char kSegmentPrefix[] = "/simfs_dv_evict_";
+        static constexpr uint32_t kMagic = 0x53464a45; // "SFJE"
+        static constexpr uint32_t kVersion = 1;
+        static constexpr uint32_t kEntries = 4096;
+
+        struct Record {
+            uint64_t seq; // written last
+            uint64_t hash;
+        };
+
+        struct Header {
+            uint32_t magic;
+            uint32_t version;
+            int32_t pid; // DV
+            uint32_t entries;
+            uint64_t epoch;
+            uint64_t head;
+            Record record[kEntries];
+        };
+
+        /**
+         * creates the segment for the given client port; check isOk() afterwards
+         */
+        explicit EvictionJournal(const std::string &port);
+        ~EvictionJournal();
+
+        EvictionJournal(const EvictionJournal &) = delete;
+        EvictionJournal &operator=(const EvictionJournal &) = delete;
+
+        bool isOk() const {
+            return header_ != nullptr;
+        }
+
+        /**
+         * the result file filename (name of the file descriptor) has been evicted
+         */
+        void publish(const std::string &filename);
+
+        uint64_t getRecordCount() const {
+            return header_ != nullptr ? header_->head : 0;
+        }
+
+        /**
+         * 64-bit FNV-1a; DVLib hashes the path passed to open in the same way
+         */
+        static uint64_t hash(const std::string &filename);
+
+    private:
+        std::string name_;
+        Header *header_ = nullptr;
+    };
+
+}
+
+#endif //DV_SERVER_EVICTIONJOURNAL_H_
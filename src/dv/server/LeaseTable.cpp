@@ -0,0 +1,92 @@
+//
+// Client read leases on available files
+//
+
+#include "LeaseTable.h"
+
+#include <chrono>
+
+#include "DV.h"
+#include "../caches/filecaches/FileCache.h"
+#include "../caches/filecaches/FileDescriptor.h"
+
+namespace dv {
+
+LeaseTable::LeaseTable(DV *dv) : dv_(dv) {
+    next_expiry_ = toolbox::TimeHelper::now();
+}
+
+void LeaseTable::grant(const std::string &filename, FileDescriptor *descriptor, dv::id_type ms) {
+    toolbox::TimeHelper::time_point_type expiry = toolbox::TimeHelper::now() + std::chrono::milliseconds(ms);
+
+    auto it = leases_.find(filename);
+    if (it == leases_.end()) {
+        descriptor->lock();
+        if (leases_.empty() || expiry < next_expiry_) {
+            next_expiry_ = expiry;
+        }
+        leases_.emplace(filename, expiry);
+        LOG(CLIENT, 1, "Lease granted on " + filename);
+    } else {
+        // extension: next_expiry_ may be too early now, which only costs an additional scan
+        it->second = expiry;
+    }
+
+    ++grant_count_;
+}
+
+void LeaseTable::expire() {
+    if (leases_.empty()) {
+        return;
+    }
+
+    toolbox::TimeHelper::time_point_type now = toolbox::TimeHelper::now();
+    if (now < next_expiry_) {
+        return;
+    }
+
+    bool first = true;
+    for (auto it = leases_.begin(); it != leases_.end();) {
+        if (it->second <= now) {
+            release(it->first);
+            it = leases_.erase(it);
+            continue;
+        }
+
+        if (first || it->second < next_expiry_) {
+            next_expiry_ = it->second;
+            first = false;
+        }
+        ++it;
+    }
+}
+
+void LeaseTable::releaseAll() {
+    for (auto &lease : leases_) {
+        release(lease.first);
+    }
+    leases_.clear();
+}
+
+long LeaseTable::msUntilNextExpiry() const {
+    if (leases_.empty()) {
+        return -1;
+    }
+
+    double ms = toolbox::TimeHelper::milliseconds(toolbox::TimeHelper::now(), next_expiry_);
+    return ms <= 0 ? 0 : static_cast<long>(ms) + 1;
+}
+
+void LeaseTable::release(const std::string &filename) {
+    // only internal lookup: expiry is no access of the file
+    FileDescriptor *descriptor = dv_->getFileCachePtr()->internal_lookup_get(filename);
+    if (descriptor == nullptr) {
+        LOG(ERROR, 0, "Lease expired on a non-existing file: " + filename);
+        return;
+    }
+
+    descriptor->unlock();
+    LOG(CLIENT, 1, "Lease expired on " + filename);
+}
+
+}
@@ -0,0 +1,90 @@
+//
+// Client read leases on available files
+//
+
+#ifndef DV_SERVER_LEASETABLE_H_
+#define DV_SERVER_LEASETABLE_H_
+
+#include <string>
+#include <unordered_map>
+
+#include "../DVBasicTypes.h"
+#include "../DVForwardDeclarations.h"
+#include "../toolbox/TimeHelper.h"
+
+namespace dv {
+
+    /**
+     * Read leases granted to clients on hits of available files (see dv_lease_ms in the config file).
+     *
+     * The open reply of a hit carries the lease duration. DVLib then re-opens the file without
+     * asking DV until its lease expires and reports these opens in batches (kMsgAccessReport) for
+     * the LRU and prefetcher bookkeeping. Leased opens and their closes are not sent to DV.
+     *
+     * Lock semantics: a leased file holds exactly one additional lock (independent of the number
+     * of clients/threads holding the lease) until DV-side expiry. Thus, the cache cannot evict a
+     * leased file; DV waits leases out instead of revoking them (DV cannot call clients).
+     * The client-side expiry is computed from the time the open request was sent and thus always
+     * ends before the DV-side expiry. A granted lease is extended by later hits.
+     */
+    class LeaseTable {
+    public:
+        explicit LeaseTable(DV *dv);
+
+        /**
+         * grants (or extends) a lease of ms milliseconds on the available file filename.
+         * the descriptor is locked once when the lease is created.
+         */
+        void grant(const std::string &filename, FileDescriptor *descriptor, dv::id_type ms);
+
+        /**
+         * releases the locks of all expired leases; called from the DV main loop
+         */
+        void expire();
+
+        /**
+         * releases all leases (server shutdown)
+         */
+        void releaseAll();
+
+        /**
+         * ms until the next lease expires; -1 if no lease is active
+         */
+        long msUntilNextExpiry() const;
+
+        dv::counter_type size() const {
+            return leases_.size();
+        }
+
+        dv::counter_type getGrantCount() const {
+            return grant_count_;
+        }
+
+        /**
+         * opens under a lease as reported by the clients
+         */
+        void countReportedOpen() {
+            ++reported_open_count_;
+        }
+
+        dv::counter_type getReportedOpenCount() const {
+            return reported_open_count_;
+        }
+
+    private:
+        DV *dv_;
+
+        std::unordered_map<std::string, toolbox::TimeHelper::time_point_type> leases_;
+
+        // earliest expiry in leases_; expire() only scans the table once this point is reached
+        toolbox::TimeHelper::time_point_type next_expiry_;
+
+        dv::counter_type grant_count_ = 0;
+        dv::counter_type reported_open_count_ = 0;
+
+        void release(const std::string &filename);
+    };
+
+}
+
+#endif //DV_SERVER_LEASETABLE_H_
@@ -4,7 +4,6 @@
 
 #include "MessageHandler.h"
 
-#include <sys/socket.h>
 #include <iostream>
 #include "DV.h"
 #include "DVConfig.h"
@@ -15,10 +14,15 @@ namespace dv {
 constexpr char MessageHandler::kLibReplyFileOpen[];
 constexpr char MessageHandler::kLibReplyFileSim[];
 constexpr char MessageHandler::kLibReplyRDMA[];
+constexpr char MessageHandler::kLibReplyVariableAvail[];
+constexpr char MessageHandler::kLibReplyBlock[];
 
 constexpr char MessageHandler::kLibReplyFileCreateAck[];
 constexpr char MessageHandler::kLibReplyFileCreateKill[];
 constexpr char MessageHandler::kLibReplyFileCreateRedirect[];
+constexpr char MessageHandler::kLibReplyFileCreateAckReportPuts[];
+constexpr char MessageHandler::kLibReplyFileCreateStage[];
+constexpr char MessageHandler::kLibReplyFileCreateRedirectSkipWrites[];
 
 constexpr char MessageHandler::kMsgDelimiter[];
 constexpr char MessageHandler::kParamDelimiter[];
@@ -56,17 +60,7 @@ bool MessageHandler::sendAllToSocket(int socket, const std::string &reply) {
         std::cout << "Messagehandler: sending on socket " << socket << ": " << reply << std::endl;
     }
 
-    const char *ptr = reply.c_str();
-    size_t len = reply.size();
-    while (len > 0) {
-        ssize_t sent = send(socket, ptr, len, 0);
-        if (sent < 1) {
-            return false;
-        }
-        ptr += sent;
-        len -= sent;
-    }
-    return true;
+    return dv_->sendToSocket(socket, reply);
 }
 
 }
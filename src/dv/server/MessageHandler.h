@@ -20,10 +20,15 @@ namespace dv {
 		static constexpr char kLibReplyFileOpen[] = "0";
 		static constexpr char kLibReplyFileSim[] = "1";
 		static constexpr char kLibReplyRDMA[] = "2";
+		static constexpr char kLibReplyVariableAvail[] = "3"; // requested slab written; file still open by the simulator
+		static constexpr char kLibReplyBlock[] = "4"; // followed by :blockname; slab is served from the block cache
 
 		static constexpr char kLibReplyFileCreateAck[] = "0";
         static constexpr char kLibReplyFileCreateKill[] = "1";
 		static constexpr char kLibReplyFileCreateRedirect[] = "2";
+		static constexpr char kLibReplyFileCreateAckReportPuts[] = "0:1"; // ack; report flushed variable puts
+		static constexpr char kLibReplyFileCreateStage[] = "3"; // followed by :report puts (0/1):staged path (see StagingArea)
+		static constexpr char kLibReplyFileCreateRedirectSkipWrites[] = "4"; // as redirect; DVLib skips the data writes (see sim_redirect_skip_writes)
 
 		static constexpr char kMsgDelimiter[] = ":";
 		static constexpr char kParamDelimiter[] = ";";
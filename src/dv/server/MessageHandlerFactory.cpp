@@ -14,6 +14,9 @@
 #include "client_listeners/ClientFileOpenMessageHandler.h"
 #include "client_listeners/ClientFileCloseMessageHandler.h"
 #include "client_listeners/ClientVariableGetMessageHandler.h"
+#include "client_listeners/ClientAccessReportMessageHandler.h"
+#include "client_listeners/ClientBlockStoreMessageHandler.h"
+#include "client_listeners/ClientShmReplyMessageHandler.h"
 #include "simulator_listeners/SimulatorCheckpointCreateMessageHandler.h"
 #include "simulator_listeners/SimulatorFileCloseMessageHandler.h"
 #include "simulator_listeners/SimulatorVariablePutMessageHandler.h"
@@ -34,6 +37,9 @@ constexpr char MessageHandlerFactory::kMsgFileCreate[];
 constexpr char MessageHandlerFactory::kMsgFinalize[];
 constexpr char MessageHandlerFactory::kMsgCheckpointCreate[];
 constexpr char MessageHandlerFactory::kMsgExtendedApi[];
+constexpr char MessageHandlerFactory::kMsgAccessReport[];
+constexpr char MessageHandlerFactory::kMsgBlockStore[];
+constexpr char MessageHandlerFactory::kMsgShmReply[];
 constexpr char MessageHandlerFactory::kMsgStatusRequest[];
 constexpr char MessageHandlerFactory::kMsgStopServer[];
 
@@ -52,6 +58,12 @@ std::unique_ptr<MessageHandler> MessageHandlerFactory::createMessageHandler(DV *
             return std::make_unique<ClientFileCloseMessageHandler>(dv, socket, params);
         } else if (msg == kMsgVarGet) {
             return std::make_unique<ClientVariableGetMessageHandler>(dv, socket, params);
+        } else if (msg == kMsgAccessReport) {
+            return std::make_unique<ClientAccessReportMessageHandler>(dv, socket, params);
+        } else if (msg == kMsgBlockStore) {
+            return std::make_unique<ClientBlockStoreMessageHandler>(dv, socket, params);
+        } else if (msg == kMsgShmReply) {
+            return std::make_unique<ClientShmReplyMessageHandler>(dv, socket, params);
         } else if (msg == kMsgFinalize) {
             // TODO if desired; not used yet
         } else if (msg == kMsgExtendedApi) {
@@ -104,6 +116,12 @@ void MessageHandlerFactory::runMessageHandler(DV *dv, int socket, MessageHandler
             ClientFileCloseMessageHandler(dv, socket, params).serve();
         } else if (msg == kMsgVarGet) {
             ClientVariableGetMessageHandler(dv, socket, params).serve();
+        } else if (msg == kMsgAccessReport) {
+            ClientAccessReportMessageHandler(dv, socket, params).serve();
+        } else if (msg == kMsgBlockStore) {
+            ClientBlockStoreMessageHandler(dv, socket, params).serve();
+        } else if (msg == kMsgShmReply) {
+            ClientShmReplyMessageHandler(dv, socket, params).serve();
         } else if (msg == kMsgFinalize) {
             // TODO
         } else if (msg == kMsgExtendedApi) {
@@ -155,6 +173,12 @@ void MessageHandlerFactory::runMessageHandler2(DV *dv, int socket, MessageHandle
         ClientFileCloseMessageHandler(dv, socket, params).serve();
     } else if (msg == kMsgVarGet) {
         ClientVariableGetMessageHandler(dv, socket, params).serve();
+    } else if (msg == kMsgAccessReport) {
+        ClientAccessReportMessageHandler(dv, socket, params).serve();
+    } else if (msg == kMsgBlockStore) {
+        ClientBlockStoreMessageHandler(dv, socket, params).serve();
+    } else if (msg == kMsgShmReply) {
+        ClientShmReplyMessageHandler(dv, socket, params).serve();
     } else if (msg == kMsgFileCloseSim) {
         SimulatorFileCloseMessageHandler(dv, socket, params).serve();
     } else if (msg == kMsgVarPut) {
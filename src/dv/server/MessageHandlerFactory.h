@@ -33,6 +33,15 @@ namespace dv {
 
 		static constexpr char kMsgExtendedApi[] = "E";
 
+		// batched access events of clients (closes, opens under read leases)
+		static constexpr char kMsgAccessReport[] = "R";
+
+		// blocks written by clients to the block store (see BlockCache)
+		static constexpr char kMsgBlockStore[] = "B";
+
+		// replies too large for the shm transport, fetched on a socket (see ShmTransport)
+		static constexpr char kMsgShmReply[] = "L";
+
 		// see dv_status and stop_dv apps for these messages
 		static constexpr char kMsgStatusRequest[] = "S";
 		static constexpr char kMsgStopServer[] = "X";
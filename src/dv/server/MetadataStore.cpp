@@ -0,0 +1,279 @@
+//
+// Header-only metadata stubs of result files for clients of files in production
+//
+
+#include "MetadataStore.h"
+
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+#include "../DVLog.h"
+#include "../toolbox/FileSystemHelper.h"
+#include "../toolbox/StringHelper.h"
+
+namespace dv {
+
+namespace {
+
+    constexpr char kStubSuffix[] = ".meta";
+    constexpr char kTmpSuffix[] = ".tmp";
+
+    // largest header that is copied into a stub
+    constexpr dv::size_type kMaxHeaderSize = 64 * 1024 * 1024;
+
+    bool endsWith(const std::string &s, const std::string &suffix) {
+        return suffix.size() <= s.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+
+    /**
+     * reader of the big-endian header of netCDF classic files; see the netCDF classic and 64-bit
+     * offset format specification (CDF-5: 64-bit counts)
+     */
+    class ClassicHeaderReader {
+    public:
+        ClassicHeaderReader(std::istream *in, int version, uint64_t file_size) :
+            in_(in), version_(version), file_size_(file_size) {}
+
+        bool read() {
+            uint64_t numrecs;
+            return nonNeg(&numrecs) && dimList() && attList() && varList();
+        }
+
+    private:
+        static constexpr uint32_t kTagDimension = 0x0A;
+        static constexpr uint32_t kTagVariable = 0x0B;
+        static constexpr uint32_t kTagAttribute = 0x0C;
+
+        std::istream *in_;
+        const int version_;
+        const uint64_t file_size_;
+
+        bool bytes(int n, uint64_t *value) {
+            unsigned char b[8];
+            if (!in_->read(reinterpret_cast<char *>(b), n)) {
+                return false;
+            }
+            *value = 0;
+            for (int i = 0; i < n; ++i) {
+                *value = (*value << 8) | b[i];
+            }
+            return true;
+        }
+
+        bool nonNeg(uint64_t *value) {
+            return bytes(version_ == 5 ? 8 : 4, value);
+        }
+
+        bool skip(uint64_t n) {
+            // a count beyond the file: no valid header
+            if (file_size_ < n) {
+                return false;
+            }
+            uint64_t padded = (n + 3) & ~static_cast<uint64_t>(3);
+            in_->seekg(static_cast<std::streamoff>(padded), std::ios::cur);
+            return static_cast<bool>(*in_);
+        }
+
+        bool name() {
+            uint64_t n;
+            return nonNeg(&n) && skip(n);
+        }
+
+        // tag and count of a list; count 0 for an absent list (tag ZERO)
+        bool listHeader(uint32_t expected_tag, uint64_t *count) {
+            uint64_t tag;
+            if (!bytes(4, &tag) || !nonNeg(count)) {
+                return false;
+            }
+            return (tag == expected_tag || (tag == 0 && *count == 0)) && *count <= file_size_;
+        }
+
+        bool typeSize(uint64_t type, uint64_t *size) {
+            static const uint64_t kSizes[] = {0, 1, 1, 2, 4, 4, 8, 1, 2, 4, 8, 8};
+            uint64_t max_type = version_ == 5 ? 11 : 6;
+            if (type < 1 || max_type < type) {
+                return false;
+            }
+            *size = kSizes[type];
+            return true;
+        }
+
+        bool dimList() {
+            uint64_t count;
+            if (!listHeader(kTagDimension, &count)) {
+                return false;
+            }
+            for (uint64_t i = 0; i < count; ++i) {
+                uint64_t length;
+                if (!name() || !nonNeg(&length)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        bool attList() {
+            uint64_t count;
+            if (!listHeader(kTagAttribute, &count)) {
+                return false;
+            }
+            for (uint64_t i = 0; i < count; ++i) {
+                uint64_t type, size, nelems;
+                if (!name() || !bytes(4, &type) || !typeSize(type, &size) || !nonNeg(&nelems)
+                    || file_size_ / size < nelems || !skip(nelems * size)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        bool varList() {
+            uint64_t count;
+            if (!listHeader(kTagVariable, &count)) {
+                return false;
+            }
+            for (uint64_t i = 0; i < count; ++i) {
+                uint64_t ndims, dimid, type, size, vsize, begin;
+                if (!name() || !nonNeg(&ndims) || file_size_ < ndims) {
+                    return false;
+                }
+                for (uint64_t d = 0; d < ndims; ++d) {
+                    if (!nonNeg(&dimid)) {
+                        return false;
+                    }
+                }
+                // begin: 32-bit offset in CDF-1 only
+                if (!attList() || !bytes(4, &type) || !typeSize(type, &size) || !nonNeg(&vsize)
+                    || !bytes(version_ == 1 ? 4 : 8, &begin)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+    };
+
+}
+
+MetadataStore::MetadataStore(const std::string &path) : path_(path) {
+    // stubs of an earlier run are reused until they are derived again; partial stubs are removed
+    auto find_stub = [this](const std::string &name, const std::string &rel_path, const std::string &full_path) {
+        if (endsWith(name, kTmpSuffix)) {
+            toolbox::FileSystemHelper::rmFile(full_path);
+            return;
+        }
+        if (!endsWith(name, kStubSuffix)) {
+            return;
+        }
+        try {
+            dv::id_type file_type = dv::stoid(name.substr(0, name.size() - sizeof(kStubSuffix) + 1));
+            stubs_[file_type] = false;
+        } catch (const std::exception &e) {
+            // not a stub of the store
+        }
+    };
+    toolbox::FileSystemHelper::readDir(path_, find_stub, false);
+}
+
+const std::string &MetadataStore::getPath() const {
+    return path_;
+}
+
+std::string MetadataStore::getStub(dv::id_type file_type) {
+    if (stubs_.find(file_type) == stubs_.end()) {
+        return "";
+    }
+    ++served_count_;
+    return stubName(file_type);
+}
+
+bool MetadataStore::needsStub(dv::id_type file_type) const {
+    if (unsupported_.find(file_type) != unsupported_.end()) {
+        return false;
+    }
+    auto it = stubs_.find(file_type);
+    return it == stubs_.end() || !it->second;
+}
+
+bool MetadataStore::deriveStub(dv::id_type file_type, const std::string &file_name) {
+    int64_t file_size = toolbox::FileSystemHelper::fileSize(file_name);
+    std::ifstream in(file_name, std::ios::binary);
+    if (file_size <= 0 || !in) {
+        ++failure_count_;
+        return false;
+    }
+
+    dv::size_type header_size = netcdfHeaderSize(&in, file_size);
+    if (header_size == 0) {
+        LOG(INFO, 1, "Metadata store: no stub for file type " + std::to_string(file_type) + " (" + file_name
+                     + " is no netCDF classic file)");
+        unsupported_.insert(file_type);
+        return false;
+    }
+
+    std::vector<char> header(header_size);
+    in.clear();
+    in.seekg(0);
+    if (!in.read(header.data(), header.size())) {
+        ++failure_count_;
+        return false;
+    }
+
+    // the hole keeps the size of the file: offsets of the header stay valid
+    std::string stub = stubName(file_type);
+    std::string tmp = stub + kTmpSuffix;
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        out.write(header.data(), header.size());
+        if (!out) {
+            ++failure_count_;
+            toolbox::FileSystemHelper::rmFile(tmp);
+            return false;
+        }
+    }
+    if (truncate(tmp.c_str(), static_cast<off_t>(file_size)) != 0 || std::rename(tmp.c_str(), stub.c_str()) != 0) {
+        LOG(WARNING, 0, "Metadata store: cannot write " + stub + ": " + std::to_string(errno));
+        ++failure_count_;
+        toolbox::FileSystemHelper::rmFile(tmp);
+        return false;
+    }
+
+    stubs_[file_type] = true;
+    LOG(INFO, 1, "Metadata store: stub for file type " + std::to_string(file_type) + " derived from " + file_name);
+    return true;
+}
+
+void MetadataStore::printStatus(std::ostream *out) const {
+    *out << "MetadataStore " << path_ << " stubs " << stubs_.size() << ", served " << served_count_
+         << ", failures " << failure_count_ << ", unsupported file types " << unsupported_.size() << std::endl;
+}
+
+dv::size_type MetadataStore::netcdfHeaderSize(std::istream *in, dv::size_type file_size) {
+    char magic[4];
+    if (!in->read(magic, sizeof(magic)) || magic[0] != 'C' || magic[1] != 'D' || magic[2] != 'F') {
+        return 0;
+    }
+    int version = magic[3];
+    if (version != 1 && version != 2 && version != 5) {
+        return 0;
+    }
+
+    ClassicHeaderReader reader(in, version, file_size);
+    if (!reader.read()) {
+        return 0;
+    }
+    std::streamoff size = in->tellg();
+    if (size <= 0 || file_size < static_cast<dv::size_type>(size) || kMaxHeaderSize < static_cast<dv::size_type>(size)) {
+        return 0;
+    }
+    return size;
+}
+
+std::string MetadataStore::stubName(dv::id_type file_type) const {
+    return toolbox::StringHelper::joinPath(path_, std::to_string(file_type) + kStubSuffix);
+}
+
+}
@@ -0,0 +1,98 @@
+//
+// Header-only metadata stubs of result files for clients of files in production
+//
+
+#ifndef DV_SERVER_METADATASTORE_H_
+#define DV_SERVER_METADATASTORE_H_
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "../DVBasicTypes.h"
+
+namespace dv {
+
+    /**
+     * A client that opens a file in production gets the name of a metadata file in the open reply
+     * (kLibReplyFileSim); DVLib opens it instead, so header inquiries (dimensions, variables,
+     * attributes) are answered at once and the client blocks at the first data get only. Without
+     * the store, this is the hand-made .meta file in the folder of the result file; if it does not
+     * exist, the open blocks until the file has been produced.
+     *
+     * The store (see metadata_path in the config file) keeps one stub per result file type, derived
+     * from a produced file of that type: the header of a netCDF classic file (CDF-1, CDF-2, CDF-5)
+     * followed by a hole up to the size of the file. Other formats (netCDF-4/HDF5) keep their
+     * metadata spread over the file and are not stubbed; their clients use the .meta file.
+     *
+     * Stubs of an earlier run are reused; each stub is derived again from the first file of its type
+     * that is produced (or found available) in this run. Stubs are replaced by rename, thus clients
+     * that have a stub open are not affected. All methods are called from the server loop.
+     */
+    class MetadataStore {
+    public:
+        explicit MetadataStore(const std::string &path);
+
+        MetadataStore(const MetadataStore &) = delete;
+        MetadataStore &operator=(const MetadataStore &) = delete;
+
+        const std::string &getPath() const;
+
+        /**
+         * full path of the stub for result files of file_type; empty if there is none
+         */
+        std::string getStub(dv::id_type file_type);
+
+        /**
+         * true if the stub of file_type has not been derived in this run yet and the files of
+         * this type may have a supported format
+         */
+        bool needsStub(dv::id_type file_type) const;
+
+        /**
+         * derives the stub of file_type from the available result file file_name;
+         * false if its format is not supported (the type is not tried again) or on I/O errors
+         */
+        bool deriveStub(dv::id_type file_type, const std::string &file_name);
+
+        void printStatus(std::ostream *out) const;
+
+        dv::counter_type getStubCount() const {
+            return stubs_.size();
+        }
+
+        dv::counter_type getServedCount() const {
+            return served_count_;
+        }
+
+        dv::counter_type getFailureCount() const {
+            return failure_count_;
+        }
+
+        /**
+         * size of the header of a netCDF classic file; 0 if the stream holds another format or the
+         * header is damaged (file_size: size of the file, bounds the header)
+         */
+        static dv::size_type netcdfHeaderSize(std::istream *in, dv::size_type file_size);
+
+    private:
+        const std::string path_;
+
+        // file type -> stub has been derived in this run
+        std::unordered_map<dv::id_type, bool> stubs_;
+
+        // file types whose files have no supported format
+        std::unordered_set<dv::id_type> unsupported_;
+
+        dv::counter_type served_count_ = 0;
+        dv::counter_type failure_count_ = 0;
+
+        std::string stubName(dv::id_type file_type) const;
+    };
+
+}
+
+#endif //DV_SERVER_METADATASTORE_H_
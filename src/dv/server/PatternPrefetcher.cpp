@@ -0,0 +1,209 @@
+//
+// Delta-correlation prefetcher for multi-stride / periodic access patterns
+//
+
+#include "PatternPrefetcher.h"
+
+#include "ClientDescriptor.h"
+#include "DV.h"
+#include "DVStats.h"
+#include "../DVLog.h"
+#include "../caches/filecaches/FileDescriptor.h"
+#include "../simulator/Simulator.h"
+#include "../simulator/SimJob.h"
+
+namespace dv {
+
+constexpr size_t PatternPrefetcher::kHistoryLength;
+constexpr size_t PatternPrefetcher::kPredictionDepth;
+constexpr int PatternPrefetcher::kMaxConfidence;
+constexpr int PatternPrefetcher::kLaunchConfidence;
+
+PatternPrefetcher::PatternPrefetcher(ClientDescriptor *client, dv::id_type appid) :
+    client_(client), appid_(appid) {
+    dv_ = client->dv_;
+}
+
+void PatternPrefetcher::handleMiss(dv::id_type target_nr, std::string parameters, const std::string &filename) {
+    // the miss itself is always served (note: no running job covers it; see ClientDescriptor)
+    enqueue(target_nr, parameters, false);
+
+    file_type_ = dv_->getSimulatorPtr()->getResultFileType(filename);
+    access(target_nr);
+}
+
+void PatternPrefetcher::handleHit(dv::id_type target_nr, std::string parameters, const std::string &filename) {
+    file_type_ = dv_->getSimulatorPtr()->getResultFileType(filename);
+    access(target_nr);
+}
+
+void PatternPrefetcher::reset() {
+    last_access_ = -1;
+    deltas_.clear();
+    confidence_ = 0;
+    predicted_.clear();
+    issued_.clear();
+    launched_.clear();
+}
+
+void PatternPrefetcher::access(dv::id_type nr) {
+    // a repeated open of the same file is no move of the client: delta 0 would predict nr itself
+    if (nr == last_access_) {
+        return;
+    }
+
+    // confidence (no reset on deviations)
+    auto it = predicted_.find(nr);
+    if (it != predicted_.end()) {
+        predicted_.erase(it);
+        if (confidence_ < kMaxConfidence) {
+            ++confidence_;
+        }
+    } else if (!predicted_.empty() && 0 < confidence_) {
+        --confidence_;
+    }
+
+    // accuracy of the predictions that launched a simulation
+    if (issued_.erase(nr) != 0) {
+        dv_->getStatsPtr()->incUsefulPrefetchPredictions();
+    }
+
+    if (0 <= last_access_) {
+        deltas_.push_back(nr - last_access_);
+        if (kHistoryLength < deltas_.size()) {
+            deltas_.pop_front();
+        }
+    }
+    last_access_ = nr;
+
+    std::vector<dv::id_type> predictions;
+    predict(nr, &predictions);
+
+    // outdated predictions are dropped to keep the confidence and the accuracy meaningful
+    if (4 * kPredictionDepth < predicted_.size()) {
+        predicted_.clear();
+    }
+    if (4 * kPredictionDepth < issued_.size()) {
+        issued_.clear();
+    }
+
+    predicted_.insert(predictions.begin(), predictions.end());
+
+    LOG(PREFETCHER, 0, "Pattern prefetcher: nr " + std::to_string(nr)
+        + "; deltas: " + std::to_string(deltas_.size())
+        + "; predictions: " + std::to_string(predictions.size())
+        + "; confidence: " + std::to_string(confidence_));
+
+    if (kLaunchConfidence <= confidence_) {
+        prefetch(predictions);
+    }
+}
+
+void PatternPrefetcher::getPredictions(dv::id_type nr, std::vector<dv::id_type> *predictions) const {
+    if (kLaunchConfidence <= confidence_) {
+        predict(nr, predictions);
+    }
+}
+
+void PatternPrefetcher::predict(dv::id_type nr, std::vector<dv::id_type> *predictions) const {
+    size_t n = deltas_.size();
+    if (n < 3) {
+        return;
+    }
+
+    dv::id_type d1 = deltas_[n - 2];
+    dv::id_type d2 = deltas_[n - 1];
+
+    // search the most recent earlier occurrence of the delta pair (d1, d2)
+    size_t match = n;
+    for (size_t i = n - 2; 1 <= i; i--) {
+        if (deltas_[i - 1] == d1 && deltas_[i] == d2) {
+            match = i;
+            break;
+        }
+    }
+
+    if (match == n) {
+        return;
+    }
+
+    // replay the deltas that followed the match; the period is (n - 1 - match)
+    size_t period = n - 1 - match;
+    dv::id_type next = nr;
+    for (size_t k = 0; k < kPredictionDepth; k++) {
+        next += deltas_[match + 1 + (k % period)];
+        if (next < 0) {
+            break;
+        }
+        predictions->push_back(next);
+    }
+}
+
+void PatternPrefetcher::prefetch(const std::vector<dv::id_type> &predictions) {
+    dv::id_type max_jobs = dv_->getConfigPtr()->dv_max_vertical_prefetching_intervals_;
+
+    for (auto nr : predictions) {
+        if (0 <= max_jobs && max_jobs <= dv_->getNumberOfPrefetchingJobs(appid_)) {
+            // < 0: unlimited
+            return;
+        }
+
+        if (isCovered(nr)) {
+            continue;
+        }
+
+        if (enqueue(nr, "", true)) {
+            issued_.insert(nr);
+            dv_->getStatsPtr()->incPrefetchPredictions();
+        }
+    }
+}
+
+bool PatternPrefetcher::isCovered(dv::id_type nr) {
+    if (dv_->findSimulationWithNrInRange(nr) != nullptr) {
+        return true;
+    }
+
+    // cached or in production
+    const std::string *name = file_type_ != 0 ? dv_->findResultName(file_type_, nr) : nullptr;
+    if (name != nullptr) {
+        FileDescriptor *descriptor = dv_->getFileCachePtr()->internal_lookup_get(*name);
+        if (descriptor != nullptr && (descriptor->isFileAvailable() || descriptor->isFileUsedBySimulator())) {
+            return true;
+        }
+    }
+
+    // recently simulated ranges are most likely still in the cache
+    for (const auto &range : launched_) {
+        if (range.first <= nr && nr <= range.second) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool PatternPrefetcher::enqueue(dv::id_type target_nr, const std::string &parameters, bool prefetched) {
+    std::unique_ptr<SimJob> simjob = client_->newSimulation(target_nr, target_nr, parameters);
+    if (simjob == nullptr) {
+        LOG(WARNING, 0, "Pattern prefetcher: cannot create simulation for nr " + std::to_string(target_nr));
+        return false;
+    }
+
+    simjob->setPrefetched(prefetched);
+    launched_.emplace_back(simjob->getSimStart(), simjob->getSimStop());
+    if (kHistoryLength < launched_.size()) {
+        launched_.pop_front();
+    }
+
+    dv::id_type simjobid = simjob->getJobId();
+    if (prefetched) {
+        toolbox::TimeHelper::time_point_type now = toolbox::TimeHelper::now();
+        double time = toolbox::TimeHelper::milliseconds(dv_->start_time_, now);
+        LOG(PREFETCHER, 0, "[EVENT][" + std::to_string(simjobid) + "] PREFETCH: " + std::to_string(time));
+    }
+    dv_->enqueueJob(simjobid, std::move(simjob));
+    return true;
+}
+
+}
@@ -0,0 +1,89 @@
+//
+// Delta-correlation prefetcher for multi-stride / periodic access patterns
+//
+
+#ifndef DV_SERVER_PATTERNPREFETCHER_H_
+#define DV_SERVER_PATTERNPREFETCHER_H_
+
+#include <deque>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "../DVBasicTypes.h"
+#include "../DVForwardDeclarations.h"
+
+namespace dv {
+
+    /**
+     * Alternative to the stride based PrefetchContext (see dv_prefetcher_type = "pattern").
+     *
+     * Keeps a short history of the deltas between consecutive accesses of a client.
+     * The last two deltas are searched in the older history (delta correlation); if found,
+     * the deltas that followed that occurrence are replayed to predict the next
+     * kPredictionDepth accesses. This covers constant strides as well as interleaved
+     * strides (e.g. +6 +6 +6 +24) and zig-zag patterns.
+     *
+     * A deviating access does not reset the prefetcher: it only lowers the confidence
+     * and the history recovers after a few accesses. Simulations are only launched for
+     * predictions while the confidence is >= kLaunchConfidence.
+     *
+     * A repeated access of the same nr is ignored. Predictions that are cached, in production
+     * or covered by a running simulation launch nothing.
+     *
+     * Issued (i.e. launched a simulation) and useful (i.e. issued and later accessed) predictions
+     * are reported to DVStats.
+     */
+    class PatternPrefetcher {
+    public:
+        static constexpr size_t kHistoryLength = 16;
+        static constexpr size_t kPredictionDepth = 8;
+        static constexpr int kMaxConfidence = 3;
+        static constexpr int kLaunchConfidence = 1;
+
+        PatternPrefetcher(ClientDescriptor *client, dv::id_type appid);
+
+        /**
+         * filename: accessed file; its result file type is used to look up the predicted files
+         */
+        void handleHit(dv::id_type target_nr, std::string parameters, const std::string &filename);
+        void handleMiss(dv::id_type target_nr, std::string parameters, const std::string &filename);
+
+        void reset();
+
+        /**
+         * next accesses after nr (access order) if the pattern is trusted for prefetching; empty otherwise
+         */
+        void getPredictions(dv::id_type nr, std::vector<dv::id_type> *predictions) const;
+
+    private:
+        DV *dv_;
+        ClientDescriptor *client_;
+        dv::id_type appid_;
+
+        dv::id_type file_type_ = 0;
+        dv::id_type last_access_ = -1;
+        std::deque<dv::id_type> deltas_;
+
+        int confidence_ = 0;
+        std::unordered_set<dv::id_type> predicted_;
+
+        /* predictions that launched a simulation; see DVStats */
+        std::unordered_set<dv::id_type> issued_;
+
+        /* ranges (simstart, simstop) of the recently launched jobs of this prefetcher */
+        std::deque<std::pair<dv::id_type, dv::id_type>> launched_;
+
+        void access(dv::id_type nr);
+        void predict(dv::id_type nr, std::vector<dv::id_type> *predictions) const;
+        void prefetch(const std::vector<dv::id_type> &predictions);
+        bool isCovered(dv::id_type nr);
+        /**
+         * false if no simulation could be created
+         */
+        bool enqueue(dv::id_type target_nr, const std::string &parameters, bool prefetched);
+    };
+}
+
+#endif //DV_SERVER_PATTERNPREFETCHER_H_
@@ -106,7 +106,7 @@ void PrefetchContext::check_for_prefetch(dv::id_type nr) {
         }
 
         if (stride_>0) forward_prefetch(nr);
-        else backward_prefetch(nr);
+        else if (stride_<0) backward_prefetch(nr);
     }
 }
 
@@ -146,42 +146,108 @@ void PrefetchContext::forward_prefetch(dv::id_type nr) {
     if (nr > critical_step) {
         /* PREFETCH!!! */
 
-        toolbox::TimeHelper::time_point_type now = toolbox::TimeHelper::now();
-        double time = toolbox::TimeHelper::milliseconds(dv_->start_time_, now);
-
         int simlen = ceil(simalpha / MAX(simtau, mytau))*stride_;
         for (int i=0; i<parsims_; i++) {
-            dv::id_type simjobid = -1;
             LOG(PREFETCHER, 0, "New simulation! " + \
                 std::to_string(last_nr_) + " -> " + std::to_string(last_nr_ + simlen) + "; " + \
                 "simlen: " + std::to_string(simlen) + "; " + \
                 "nextcheckpoint: " + \
                 std::to_string(dv_->getSimulatorPtr()->getNextCheckpointNr(last_nr_ + simlen)));
 
+            /* the range may be split into concurrent segments at the checkpoints */
             dv::id_type start_from = dv_->getSimulatorPtr()->getNextCheckpointNr(last_nr_);
-            std::unique_ptr<SimJob> simjob = client_->newSimulation(start_from, last_nr_ + simlen, "");
-            if (simjob==NULL){
+            dv::id_type stop_at = last_nr_ + simlen;
+            if (client_->horizontal_prefetch(start_from, stop_at) == 0){
                 LOG(WARNING, 0, "Cannot create prefetch simulation!");
             }else{
-                last_nr_ = simjob->getSimStop();
-                simjobid = simjob->getJobId();
-                dv_->enqueueJob(simjobid, std::move(simjob));
+                last_nr_ = stop_at;
             }
-            LOG(PREFETCHER, 0, "[EVENT][" + std::to_string(simjobid) + "] PREFETCH: " +  std::to_string(time));
-
         }
 
-        dv::id_type max_parsims = dv_->getConfigPtr()->dv_max_vertical_prefetching_intervals_;
-        dv::id_type optimal = (dv::id_type) MIN(ceil(simtau / mytau), max_parsims);
-        if (parsims_ < optimal) parsims_ = MIN(parsims_*2, optimal);
-        else parsims_ = optimal;
-        printf("PrefetchContext (FW): parsims: %li; optimal: %li; max: %li\n", parsims_, (dv::id_type) ceil(simtau / mytau), max_parsims);
+        update_parsims(simtau, mytau, "FW");
     }
 
 }
 
 void PrefetchContext::backward_prefetch(dv::id_type nr) {
-    //printf("Backward prefetch not implented!\n");
+    /* mirrored version of forward_prefetch:
+     * last_nr_ is the lowest nr that is covered by the simulations launched so far.
+     * The client is approaching it from above with |stride| per access. New simulations
+     * are launched for the restart intervals below last_nr_ ahead of the client. */
+    double simalpha = client_->sim_profiler_.getAlpha();
+    double simtau = client_->sim_profiler_.getTau();
+    double mytau = client_->cli_profiler_.getTau();
+
+    dv::id_type abs_stride = -stride_;
+
+    if (last_nr_ == -1 || nr < last_nr_) {
+        /* if we don't have a last_nr, then the simulation was not prefetched,
+           and it started from the previous restart; */
+        last_nr_ = dv_->getSimulatorPtr()->getCheckpointNr(nr);
+    }
+
+    dv::id_type critical_step = \
+        (last_nr_ / abs_stride + (simalpha / MAX(simtau/parsims_, mytau)))*abs_stride;
+
+
+    LOG(PREFETCHER, 0, "sim.alpha: " + std::to_string(simalpha) + \
+        "; sim.tau: " + std::to_string(simtau) + \
+        "; client.tau: " + std::to_string(mytau));
+    LOG(PREFETCHER, 0, "critical_step (BW): " + std::to_string(critical_step) + \
+        "; last_nr: " + std::to_string(last_nr_) + \
+        "; nr: " + std::to_string(nr) + \
+        "; stride: " + std::to_string(stride_));
+
+
+    if (nr < critical_step) {
+        /* PREFETCH!!! */
+
+        int simlen = ceil(simalpha / MAX(simtau, mytau))*abs_stride;
+        for (int i=0; i<parsims_; i++) {
+            if (last_nr_ <= 0) {
+                LOG(PREFETCHER, 0, "Beginning of the timeline reached: no backward prefetch.");
+                break;
+            }
+
+            dv::id_type stop_at = last_nr_ - 1;
+            dv::id_type start_from = MAX(stop_at - simlen, 0);
+
+            /* the interval may already be covered (e.g. by the simulation serving the last miss) */
+            SimJob *running = dv_->findSimulationWithNrInRange(stop_at);
+            if (running != nullptr) {
+                last_nr_ = running->getSimStart();
+                continue;
+            }
+
+            LOG(PREFETCHER, 0, "New simulation (BW)! " + \
+                std::to_string(start_from) + " -> " + std::to_string(stop_at) + "; " + \
+                "simlen: " + std::to_string(simlen) + "; " + \
+                "prevcheckpoint: " + \
+                std::to_string(dv_->getSimulatorPtr()->getCheckpointNr(start_from)));
+
+            if (client_->horizontal_prefetch(start_from, stop_at) == 0){
+                LOG(WARNING, 0, "Cannot create prefetch simulation!");
+                break;
+            }else{
+                last_nr_ = start_from;
+            }
+        }
+
+        update_parsims(simtau, mytau, "BW");
+    }
+}
+
+void PrefetchContext::update_parsims(double simtau, double mytau, const char *direction) {
+    dv::id_type max_parsims = dv_->getConfigPtr()->dv_max_vertical_prefetching_intervals_;
+    // no client tau yet: keep the current number
+    dv::id_type optimal = mytau > 0.0 ? (dv::id_type) ceil(simtau / mytau) : parsims_;
+    if (max_parsims >= 0) {
+        // < 0: unlimited
+        optimal = MIN(optimal, max_parsims);
+    }
+    if (parsims_ < optimal) parsims_ = MIN(parsims_*2, optimal);
+    else parsims_ = optimal;
+    printf("PrefetchContext (%s): parsims: %li; optimal: %li; max: %li\n", direction, parsims_, optimal, max_parsims);
 }
 
 }
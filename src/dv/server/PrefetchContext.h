@@ -39,6 +39,9 @@ namespace dv {
         void forward_prefetch(dv::id_type nr);
         void backward_prefetch(dv::id_type nr);
         void check_for_prefetch(dv::id_type target_nr); 
+
+        /* adapts parsims_ (doubling) towards ceil(simtau/mytau), bounded by dv_max_vertical_prefetching_intervals */
+        void update_parsims(double simtau, double mytau, const char *direction);
     
 
     };
@@ -46,7 +46,15 @@ double Profiler::getMedianAlpha() const {
 }
 
 double Profiler::newTau() {
-    toolbox::TimeHelper::time_point_type now = toolbox::TimeHelper::now();
+    return newTau(toolbox::TimeHelper::now());
+}
+
+double Profiler::newTau(const toolbox::TimeHelper::time_point_type &at) {
+    if (at < last_time_) {
+        return -1.0;
+    }
+
+    toolbox::TimeHelper::time_point_type now = at;
     double newtau = toolbox::TimeHelper::seconds(last_time_, now);
     last_time_ = now;
     if (taus_.size() == 0) moving_tau_ = newtau;
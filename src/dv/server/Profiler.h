@@ -25,6 +25,12 @@ namespace dv {
         double getMedianAlpha() const;
 
 		double newTau();
+
+		/**
+		 * variant for events reported after the fact (see leased opens in ClientDescriptor);
+		 * returns -1.0 and records nothing if at lies before the last recorded event
+		 */
+		double newTau(const toolbox::TimeHelper::time_point_type &at);
 		void extendTaus(const std::vector<double> &taus);
 		void clearTaus();
 		double getTau() const;
@@ -0,0 +1,241 @@
+//
+// Shared-memory transport between DVLib clients and a node-local DV
+//
+
+#include "ShmTransport.h"
+
+#include <cstring>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../DVLog.h"
+#include "MessageHandlerFactory.h"
+
+namespace dv {
+
+constexpr char ShmTransport::kSegmentPrefix[];
+constexpr uint32_t ShmTransport::kMagic;
+constexpr uint32_t ShmTransport::kVersion;
+constexpr uint32_t ShmTransport::kChannels;
+constexpr uint32_t ShmTransport::kRingEntries;
+constexpr uint32_t ShmTransport::kMsgSize;
+constexpr uint32_t ShmTransport::kSeqMask;
+constexpr uint32_t ShmTransport::kOversizedFlag;
+constexpr size_t ShmTransport::kMaxOversizedReplies;
+constexpr int ShmTransport::kSocketBase;
+
+namespace {
+
+    // note: no FUTEX_PRIVATE_FLAG; the futex words are shared between processes
+
+    void futexWait(uint32_t *addr, uint32_t value, long timeout_ms) {
+        struct timespec ts;
+        ts.tv_sec = timeout_ms / 1000;
+        ts.tv_nsec = (timeout_ms % 1000) * 1000000;
+        syscall(SYS_futex, addr, FUTEX_WAIT, value, &ts, nullptr, 0);
+    }
+
+    void futexWake(uint32_t *addr) {
+        syscall(SYS_futex, addr, FUTEX_WAKE, INT32_MAX, nullptr, nullptr, 0);
+    }
+
+}
+
+ShmTransport::ShmTransport(const std::string &port) : name_(kSegmentPrefix + port) {
+    // a segment of a crashed DV instance is replaced
+    shm_unlink(name_.c_str());
+
+    int fd = shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        LOG(ERROR, 0, "Shm transport: cannot create " + name_ + ": " + std::to_string(errno));
+        return;
+    }
+
+    if (ftruncate(fd, sizeof(Header)) != 0) {
+        LOG(ERROR, 0, "Shm transport: cannot resize " + name_ + ": " + std::to_string(errno));
+        close(fd);
+        shm_unlink(name_.c_str());
+        return;
+    }
+
+    void *ptr = mmap(nullptr, sizeof(Header), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (ptr == MAP_FAILED) {
+        LOG(ERROR, 0, "Shm transport: cannot map " + name_ + ": " + std::to_string(errno));
+        shm_unlink(name_.c_str());
+        return;
+    }
+
+    event_fd_ = eventfd(0, EFD_NONBLOCK);
+    if (event_fd_ < 0) {
+        LOG(ERROR, 0, "Shm transport: cannot create eventfd: " + std::to_string(errno));
+        munmap(ptr, sizeof(Header));
+        shm_unlink(name_.c_str());
+        return;
+    }
+
+    // ftruncate zeroed the segment; magic is published last (clients check it)
+    header_ = static_cast<Header *>(ptr);
+    header_->version = kVersion;
+    header_->pid = getpid();
+    header_->channels = kChannels;
+    __atomic_store_n(&header_->magic, kMagic, __ATOMIC_RELEASE);
+
+    doorbell_thread_ = std::thread(&ShmTransport::watchDoorbell, this);
+
+    LOG(INFO, 0, "Shm transport: " + name_ + " with " + std::to_string(kChannels) + " channels");
+}
+
+ShmTransport::~ShmTransport() {
+    if (header_ == nullptr) {
+        return;
+    }
+
+    stop_ = true;
+    __atomic_add_fetch(&header_->doorbell, 1, __ATOMIC_RELEASE);
+    futexWake(&header_->doorbell);
+    doorbell_thread_.join();
+
+    // clients still attached see magic == 0 and fall back to sockets
+    __atomic_store_n(&header_->magic, 0, __ATOMIC_RELEASE);
+    munmap(header_, sizeof(Header));
+    shm_unlink(name_.c_str());
+    close(event_fd_);
+}
+
+void ShmTransport::watchDoorbell() {
+    uint32_t seen = __atomic_load_n(&header_->doorbell, __ATOMIC_ACQUIRE);
+    while (!stop_) {
+        uint32_t current = __atomic_load_n(&header_->doorbell, __ATOMIC_ACQUIRE);
+        if (current != seen) {
+            seen = current;
+            uint64_t one = 1;
+            if (write(event_fd_, &one, sizeof(one)) < 0 && errno != EAGAIN) {
+                LOG(ERROR, 0, "Shm transport: eventfd write error: " + std::to_string(errno));
+            }
+            continue;
+        }
+
+        // timeout: just to check stop_ regularly
+        futexWait(&header_->doorbell, seen, 500);
+    }
+}
+
+void ShmTransport::drain(const handler_type &handler) {
+    uint64_t count;
+    if (read(event_fd_, &count, sizeof(count)) < 0 && errno != EAGAIN) {
+        LOG(ERROR, 0, "Shm transport: eventfd read error: " + std::to_string(errno));
+    }
+
+    // repeated until no more requests are found: clients may add requests while handling
+    bool found = true;
+    while (found) {
+        found = false;
+        for (uint32_t c = 0; c < kChannels; c++) {
+            Channel *ch = &header_->channel[c];
+            if (__atomic_load_n(&ch->owner, __ATOMIC_ACQUIRE) == 0) {
+                continue;
+            }
+
+            uint32_t head = __atomic_load_n(&ch->req_head, __ATOMIC_ACQUIRE);
+            uint32_t tail = ch->req_tail;
+            if (head == tail) {
+                continue;
+            }
+            found = true;
+
+            // copy: the entry is handed back to the client before the handler runs
+            Entry *e = &ch->req[tail % kRingEntries];
+            char msg[kMsgSize + 1];
+            uint32_t len = e->len < kMsgSize ? e->len : kMsgSize;
+            uint32_t seq = e->seq & kSeqMask;
+            memcpy(msg, e->data, len);
+            msg[len] = '\0';
+
+            __atomic_store_n(&ch->req_tail, tail + 1, __ATOMIC_RELEASE);
+            if (head - tail == kRingEntries) {
+                // client may be waiting for space
+                futexWake(&ch->req_tail);
+            }
+
+            ++request_count_;
+            int socket = kSocketBase - static_cast<int>(seq * kChannels + c);
+            handler(socket, msg, len);
+        }
+    }
+}
+
+bool ShmTransport::send(int socket, const std::string &reply) {
+    if (header_ == nullptr || !isShmSocket(socket)) {
+        return false;
+    }
+
+    uint32_t id = static_cast<uint32_t>(kSocketBase - socket);
+    uint32_t c = id % kChannels;
+    uint32_t seq = id / kChannels;
+    Channel *ch = &header_->channel[c];
+
+    if (__atomic_load_n(&ch->owner, __ATOMIC_ACQUIRE) == 0) {
+        LOG(WARNING, 1, "Shm transport: channel " + std::to_string(c) + " given up before reply");
+        return false;
+    }
+
+    uint32_t head = ch->resp_head;
+    uint32_t tail = __atomic_load_n(&ch->resp_tail, __ATOMIC_ACQUIRE);
+    if (head - tail == kRingEntries) {
+        // the client only has one pending request; stale replies are discarded on its next request
+        LOG(WARNING, 0, "Shm transport: response ring of channel " + std::to_string(c) + " full; reply dropped");
+        return false;
+    }
+
+    Entry *e = &ch->resp[head % kRingEntries];
+    if (reply.size() < kMsgSize) {
+        memcpy(e->data, reply.data(), reply.size());
+        e->len = static_cast<uint32_t>(reply.size());
+        e->seq = seq;
+    } else {
+        // the client fetches it on a socket
+        std::string token = std::to_string(next_token_++);
+        if (kMaxOversizedReplies <= oversized_order_.size()) {
+            oversized_.erase(oversized_order_.front());
+            oversized_order_.pop_front();
+        }
+        oversized_[token] = reply;
+        oversized_order_.push_back(token);
+
+        std::string fetch = std::string(MessageHandlerFactory::kMsgShmReply) + ":" + token;
+        memcpy(e->data, fetch.data(), fetch.size());
+        e->len = static_cast<uint32_t>(fetch.size());
+        e->seq = seq | kOversizedFlag;
+        LOG(INFO, 1, "Shm transport: reply of " + std::to_string(reply.size()) + " bytes on channel "
+                     + std::to_string(c) + " is fetched on a socket");
+    }
+
+    __atomic_store_n(&ch->resp_head, head + 1, __ATOMIC_RELEASE);
+    futexWake(&ch->resp_head);
+    return true;
+}
+
+bool ShmTransport::takeOversizedReply(const std::string &token, std::string *reply) {
+    auto it = oversized_.find(token);
+    if (it == oversized_.end()) {
+        return false;
+    }
+
+    *reply = std::move(it->second);
+    oversized_.erase(it);
+    for (auto o = oversized_order_.begin(); o != oversized_order_.end(); ++o) {
+        if (*o == token) {
+            oversized_order_.erase(o);
+            break;
+        }
+    }
+    return true;
+}
+
+}
@@ -0,0 +1,147 @@
+//
+// Shared-memory transport between DVLib clients and a node-local DV
+//
+
+#ifndef DV_SERVER_SHMTRANSPORT_H_
+#define DV_SERVER_SHMTRANSPORT_H_
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+namespace dv {
+
+    /**
+     * Optional alternative to the client TCP socket for clients running on the same node as DV
+     * (see dv_shm_transport in the config file).
+     *
+     * A POSIX shm segment (kSegmentPrefix + client port) holds kChannels channels. Each client
+     * thread claims one channel (owner = pid) and uses its two SPSC rings:
+     * - request ring: client -> DV; the client then increments the doorbell futex of the header
+     * - response ring: DV -> client; the client waits on the futex word resp_head
+     *
+     * DV is single-threaded and blocks in select(). Thus, a helper thread waits on the doorbell
+     * futex and forwards the wakeup to an eventfd that is part of the select set. DV then drains
+     * all channels in its main loop (drain()).
+     *
+     * Message handlers keep working with int sockets: each request gets a virtual socket id
+     * (< kSocketBase; encodes channel and request sequence number). sendAllToSocket() routes
+     * replies for these ids to send(). Deferred replies (notification sockets) work the same way.
+     * Note: close() on a virtual socket id just fails with EBADF, which is harmless.
+     *
+     * Replies that do not fit into an entry are not truncated: they are kept (at most
+     * kMaxOversizedReplies) and the entry only carries kOversizedFlag in seq and a fetch request
+     * (kMsgShmReply:token; see ClientShmReplyMessageHandler) that the client sends on a socket.
+     *
+     * The layout must match the layout used in DVLib (dvl_shm.c). Communication with simulators
+     * is not affected (sockets only).
+     */
+    class ShmTransport {
+    public:
+        static constexpr char kSegmentPrefix[] = "/simfs_dv_";
+        static constexpr uint32_t kMagic = 0x53465348; // "SFSH"
+        static constexpr uint32_t kVersion = 2;
+        static constexpr uint32_t kChannels = 64;
+        static constexpr uint32_t kRingEntries = 4;
+        static constexpr uint32_t kMsgSize = 4096; // BUFFER_SIZE in DVLib
+        static constexpr uint32_t kSeqMask = 0xffffff;
+        static constexpr uint32_t kOversizedFlag = 0x80000000;
+        static constexpr size_t kMaxOversizedReplies = kChannels * kRingEntries;
+        static constexpr int kSocketBase = -2; // virtual socket ids: kSocketBase - (seq * kChannels + channel)
+
+        struct Entry {
+            uint32_t seq;
+            uint32_t len;
+            char data[kMsgSize];
+        };
+
+        struct Channel {
+            int32_t owner; // pid of the client; 0: free
+            uint32_t req_head; // written by client
+            uint32_t req_tail; // written by DV
+            uint32_t resp_head; // written by DV; futex word of the waiting client
+            uint32_t resp_tail; // written by client
+            uint32_t padding[3];
+            Entry req[kRingEntries];
+            Entry resp[kRingEntries];
+        };
+
+        struct Header {
+            uint32_t magic;
+            uint32_t version;
+            int32_t pid; // DV
+            uint32_t channels;
+            uint32_t doorbell; // futex word: incremented by clients after each request
+            uint32_t padding[3];
+            Channel channel[kChannels];
+        };
+
+        typedef std::function<void(int socket, char *msg, uint32_t len)> handler_type;
+
+        static bool isShmSocket(int socket) {
+            return socket <= kSocketBase;
+        }
+
+        /**
+         * creates the segment for the given client port; check isOk() afterwards
+         */
+        explicit ShmTransport(const std::string &port);
+        ~ShmTransport();
+
+        bool isOk() const {
+            return header_ != nullptr;
+        }
+
+        /**
+         * fd for select(); readable if requests may be available
+         */
+        int getEventFd() const {
+            return event_fd_;
+        }
+
+        /**
+         * handles all pending requests; called from the DV main loop
+         * note: msg is 0 terminated
+         */
+        void drain(const handler_type &handler);
+
+        /**
+         * sends a reply to the client waiting on the given virtual socket id;
+         * returns false if the channel was given up in the meantime or the response ring is full
+         */
+        bool send(int socket, const std::string &reply);
+
+        /**
+         * oversized reply of the given token (see kOversizedFlag); false if unknown
+         */
+        bool takeOversizedReply(const std::string &token, std::string *reply);
+
+        uint64_t getRequestCount() const {
+            return request_count_;
+        }
+
+    private:
+        std::string name_;
+        Header *header_ = nullptr;
+        int event_fd_ = -1;
+
+        std::thread doorbell_thread_;
+        std::atomic<bool> stop_{false};
+
+        // token -> reply; oldest first in oversized_order_
+        std::unordered_map<std::string, std::string> oversized_;
+        std::deque<std::string> oversized_order_;
+        uint64_t next_token_ = 0;
+
+        uint64_t request_count_ = 0;
+
+        void watchDoorbell();
+    };
+
+}
+
+#endif //DV_SERVER_SHMTRANSPORT_H_
@@ -0,0 +1,296 @@
+//
+// Node-local staging of new result files with background write-back
+//
+
+#include "StagingArea.h"
+
+#include <fcntl.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+#include "../DVLog.h"
+#include "../toolbox/FileSystemHelper.h"
+#include "../toolbox/StringHelper.h"
+
+namespace dv {
+
+constexpr char StagingArea::kJournalName[];
+constexpr std::chrono::seconds StagingArea::kRetryDelay;
+
+StagingArea::StagingArea(const std::string &path, const std::string &result_path) :
+    path_(path), result_path_(result_path) {
+
+    event_fd_ = eventfd(0, EFD_NONBLOCK);
+    if (event_fd_ < 0) {
+        LOG(ERROR, 0, "Staging area: cannot create eventfd: " + std::to_string(errno));
+        return;
+    }
+
+    recover();
+    if (journal_fd_ < 0) {
+        close(event_fd_);
+        event_fd_ = -1;
+        return;
+    }
+
+    write_back_thread_ = std::thread(&StagingArea::writeBackLoop, this);
+}
+
+StagingArea::~StagingArea() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    queue_cv_.notify_all();
+    if (write_back_thread_.joinable()) {
+        write_back_thread_.join();
+    }
+
+    // the queue is empty now: files that have not been closed by their simulators are incomplete;
+    // files whose write-back failed are kept in the journal for the next start
+    for (const auto &file : staged_) {
+        if (!file.second) {
+            toolbox::FileSystemHelper::rmFile(toolbox::StringHelper::joinPath(path_, file.first));
+            journal("done", file.first);
+        }
+    }
+
+    if (0 <= journal_fd_) {
+        close(journal_fd_);
+    }
+    if (0 <= event_fd_) {
+        close(event_fd_);
+    }
+}
+
+bool StagingArea::isOk() const {
+    return 0 <= event_fd_;
+}
+
+int StagingArea::getEventFd() const {
+    return event_fd_;
+}
+
+const std::string &StagingArea::getPath() const {
+    return path_;
+}
+
+std::string StagingArea::stage(const std::string &filename) {
+    std::string staged_file = toolbox::StringHelper::joinPath(path_, filename);
+    if (!makeFolders(toolbox::FileSystemHelper::getDirname(staged_file))) {
+        LOG(WARNING, 0, "Staging area: cannot create the folder of " + staged_file);
+        return "";
+    }
+
+    staged_[filename] = false;
+    journal("staged", filename);
+    return staged_file;
+}
+
+bool StagingArea::writeBack(const std::string &filename) {
+    auto it = staged_.find(filename);
+    if (it == staged_.end() || it->second) {
+        return false;
+    }
+    it->second = true;
+    journal("closed", filename);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back(filename);
+    }
+    queue_cv_.notify_one();
+    return true;
+}
+
+std::vector<std::string> StagingArea::takeWrittenBack() {
+    uint64_t count;
+    if (read(event_fd_, &count, sizeof(count)) < 0 && errno != EAGAIN) {
+        LOG(ERROR, 0, "Staging area: eventfd read error: " + std::to_string(errno));
+    }
+
+    std::vector<std::string> files;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        files.swap(written_back_);
+    }
+    for (const auto &filename : files) {
+        staged_.erase(filename);
+    }
+    return files;
+}
+
+const std::vector<std::string> &StagingArea::getRecoveredFiles() const {
+    return recovered_;
+}
+
+void StagingArea::printStatus(std::ostream *out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    *out << "StagingArea " << path_ << " staged files " << staged_.size() << ", write-backs " << write_back_count_
+         << " (" << written_back_bytes_ << " bytes), failures " << failure_count_ << std::endl;
+}
+
+dv::counter_type StagingArea::getWriteBackCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return write_back_count_;
+}
+
+dv::size_type StagingArea::getWrittenBackBytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return written_back_bytes_;
+}
+
+dv::counter_type StagingArea::getFailureCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return failure_count_;
+}
+
+void StagingArea::writeBackLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        // queued write-backs are finished before stopping; pending retries are left to the next start
+        auto ready = [this] {
+            return stop_ || !queue_.empty()
+                   || (!retries_.empty() && retries_.front().time <= std::chrono::steady_clock::now());
+        };
+        if (retries_.empty()) {
+            queue_cv_.wait(lock, ready);
+        } else {
+            queue_cv_.wait_until(lock, retries_.front().time, ready);
+        }
+
+        std::string filename;
+        if (!queue_.empty()) {
+            filename = queue_.front();
+            queue_.pop_front();
+        } else if (stop_) {
+            return;
+        } else if (!retries_.empty() && retries_.front().time <= std::chrono::steady_clock::now()) {
+            filename = retries_.front().filename;
+            retries_.pop_front();
+        } else {
+            continue;
+        }
+
+        lock.unlock();
+        dv::size_type size = 0;
+        bool ok = writeBackFile(filename, &size);
+        if (ok) {
+            journal("done", filename);
+        }
+        lock.lock();
+
+        if (!ok) {
+            ++failure_count_;
+            retries_.push_back({std::chrono::steady_clock::now() + kRetryDelay, filename});
+            std::cerr << "StagingArea: write-back of " << filename << " failed; the file stays staged, retry in "
+                      << kRetryDelay.count() << " s" << std::endl;
+            continue;
+        }
+
+        ++write_back_count_;
+        written_back_bytes_ += size;
+        written_back_.push_back(filename);
+        uint64_t one = 1;
+        if (write(event_fd_, &one, sizeof(one)) < 0 && errno != EAGAIN) {
+            std::cerr << "StagingArea: eventfd write error: " << errno << std::endl;
+        }
+    }
+}
+
+void StagingArea::recover() {
+    std::string journal_file = toolbox::StringHelper::joinPath(path_, kJournalName);
+
+    // last state of each file of the earlier run
+    std::unordered_map<std::string, std::string> states;
+    {
+        std::ifstream in(journal_file);
+        std::string line;
+        while (std::getline(in, line)) {
+            size_t tab = line.find('\t');
+            if (tab != std::string::npos) {
+                states[line.substr(tab + 1)] = line.substr(0, tab);
+            }
+        }
+    }
+
+    for (const auto &entry : states) {
+        std::string staged_file = toolbox::StringHelper::joinPath(path_, entry.first);
+        if (entry.second == "staged") {
+            // its simulator is gone
+            if (toolbox::FileSystemHelper::fileExists(staged_file)) {
+                toolbox::FileSystemHelper::rmFile(staged_file);
+            }
+        } else if (entry.second == "closed" && toolbox::FileSystemHelper::fileExists(staged_file)) {
+            recovered_.push_back(entry.first);
+        }
+    }
+
+    // fresh journal with the recovered files only
+    std::string tmp_file = journal_file + ".tmp";
+    journal_fd_ = open(tmp_file.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644);
+    if (journal_fd_ < 0) {
+        LOG(ERROR, 0, "Staging area: cannot create the journal " + tmp_file + ": " + std::to_string(errno));
+        return;
+    }
+    for (const auto &filename : recovered_) {
+        journal("closed", filename);
+        staged_[filename] = true;
+        queue_.push_back(filename);
+    }
+    if (std::rename(tmp_file.c_str(), journal_file.c_str()) != 0) {
+        LOG(ERROR, 0, "Staging area: cannot replace the journal " + journal_file + ": " + std::to_string(errno));
+        close(journal_fd_);
+        journal_fd_ = -1;
+        return;
+    }
+
+    if (!recovered_.empty()) {
+        LOG(INFO, 0, "Staging area: " + std::to_string(recovered_.size())
+                     + " closed files of an earlier run are written back");
+    }
+}
+
+void StagingArea::journal(const char *state, const std::string &filename) const {
+    if (journal_fd_ < 0) {
+        return;
+    }
+    std::string line = std::string(state) + "\t" + filename + "\n";
+    if (write(journal_fd_, line.data(), line.size()) != static_cast<ssize_t>(line.size())) {
+        std::cerr << "StagingArea: cannot write to the journal: " << errno << std::endl;
+    }
+}
+
+bool StagingArea::writeBackFile(const std::string &filename, dv::size_type *size) const {
+    std::string staged_file = toolbox::StringHelper::joinPath(path_, filename);
+    std::string result_file = toolbox::StringHelper::joinPath(result_path_, filename);
+
+    // e.g. written by a simulator whose I/O library ignores the staging reply (HDF5, PnetCDF)
+    if (!toolbox::FileSystemHelper::fileExists(staged_file)) {
+        *size = 0;
+        return toolbox::FileSystemHelper::fileExists(result_file);
+    }
+
+    *size = toolbox::FileSystemHelper::fileSize(staged_file);
+    return makeFolders(toolbox::FileSystemHelper::getDirname(result_file))
+           && toolbox::FileSystemHelper::mvFile(staged_file, result_file);
+}
+
+bool StagingArea::makeFolders(const std::string &path) {
+    if (path.empty() || toolbox::FileSystemHelper::folderExists(path)) {
+        return true;
+    }
+    std::string parent = toolbox::FileSystemHelper::getDirname(path);
+    if (parent != path && !makeFolders(parent)) {
+        return false;
+    }
+    return toolbox::FileSystemHelper::mkDir(path) == 0 || errno == EEXIST;
+}
+
+}
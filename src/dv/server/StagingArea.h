@@ -0,0 +1,160 @@
+//
+// Node-local staging of new result files with background write-back
+//
+
+#ifndef DV_SERVER_STAGINGAREA_H_
+#define DV_SERVER_STAGINGAREA_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "../DVBasicTypes.h"
+
+namespace dv {
+
+    /**
+     * New result files in the simulation range are created in a node-local folder (see staging_path
+     * in the config file) instead of the shared result path: the create reply of DV carries the
+     * staged path (kLibReplyFileCreateStage). When the simulator closes the file, waiting clients
+     * are notified at once and read the staged copy (DVLib tries the staging path first; the path is
+     * announced in the hello reply), while a background thread writes the file back to the result
+     * path (rename; copy to a temporary file and rename across file systems) and removes the
+     * staged copy.
+     *
+     * The file descriptor holds the staged path and one additional lock from the close of the
+     * simulator until the write-back is done (see DV::finishWriteBacks()); thus, the cache cannot
+     * evict a file that is not in the result path yet. A failed write-back is retried after
+     * kRetryDelay until it succeeds; the file stays staged (and locked) in the meantime.
+     *
+     * A journal in the folder (kJournalName) records the files the staging area has created and
+     * closed; nothing else in the folder is touched. At shutdown, the queued write-backs are
+     * finished and files that have not been closed by their simulator are removed; closed files
+     * that are still staged (failed write-backs) are the only copies of their result files and are
+     * written back by the next start (see getRecoveredFiles()). Unclosed files of a crashed run
+     * are removed at the next start.
+     *
+     * All public methods are called from the server loop; the lock only coordinates with the
+     * write-back thread, which signals finished files on the event fd.
+     */
+    class StagingArea {
+    public:
+        static constexpr char kJournalName[] = ".dv_staging_journal";
+        static constexpr std::chrono::seconds kRetryDelay{10};
+
+        StagingArea(const std::string &path, const std::string &result_path);
+
+        ~StagingArea();
+
+        StagingArea(const StagingArea &) = delete;
+        StagingArea &operator=(const StagingArea &) = delete;
+
+        /**
+         * false if the eventfd could not be created (staging off then)
+         */
+        bool isOk() const;
+
+        /**
+         * readable after files have been written back; see takeWrittenBack()
+         */
+        int getEventFd() const;
+
+        const std::string &getPath() const;
+
+        /**
+         * full path of the new result file filename in the staging area (sub folders are created);
+         * empty if the file cannot be staged
+         */
+        std::string stage(const std::string &filename);
+
+        /**
+         * the simulator has closed the staged file: write-back in the background;
+         * false if the file is not staged or its write-back has been queued before
+         */
+        bool writeBack(const std::string &filename);
+
+        /**
+         * result files written back since the last call
+         */
+        std::vector<std::string> takeWrittenBack();
+
+        /**
+         * closed files of an earlier run that were still staged; their write-back has been queued
+         */
+        const std::vector<std::string> &getRecoveredFiles() const;
+
+        void printStatus(std::ostream *out) const;
+
+        dv::counter_type getStagedCount() const {
+            return staged_.size();
+        }
+
+        dv::counter_type getWriteBackCount() const;
+
+        dv::size_type getWrittenBackBytes() const;
+
+        dv::counter_type getFailureCount() const;
+
+    private:
+        const std::string path_;
+        const std::string result_path_;
+
+        int event_fd_ = -1;
+        int journal_fd_ = -1;
+
+        // staged files that have not been written back yet (true: write-back queued); server loop only
+        std::unordered_map<std::string, bool> staged_;
+        std::vector<std::string> recovered_;
+
+        struct Retry {
+            std::chrono::steady_clock::time_point time;
+            std::string filename;
+        };
+
+        mutable std::mutex mutex_;
+        std::condition_variable queue_cv_;
+        std::deque<std::string> queue_;
+        std::deque<Retry> retries_; // ordered by time (constant delay)
+        std::vector<std::string> written_back_;
+        bool stop_ = false;
+
+        dv::counter_type write_back_count_ = 0;
+        dv::size_type written_back_bytes_ = 0;
+        dv::counter_type failure_count_ = 0;
+
+        std::thread write_back_thread_;
+
+        void writeBackLoop();
+
+        /**
+         * replays the journal of an earlier run: unclosed files are removed, closed ones queued;
+         * the journal is rewritten with the queued files only
+         */
+        void recover();
+
+        /**
+         * appends "<state>\t<filename>" to the journal (states: staged, closed, done);
+         * single write, called from both threads
+         */
+        void journal(const char *state, const std::string &filename) const;
+
+        /**
+         * moves the staged file to the result path; true if it is there
+         */
+        bool writeBackFile(const std::string &filename, dv::size_type *size) const;
+
+        /**
+         * creates the folder and missing parent folders
+         */
+        static bool makeFolders(const std::string &path);
+    };
+
+}
+
+#endif //DV_SERVER_STAGINGAREA_H_
@@ -0,0 +1,101 @@
+//
+// Batched access events of clients (see dvl_report.h in DVLib)
+//
+
+#include "ClientAccessReportMessageHandler.h"
+
+#include <unistd.h>
+#include <iostream>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "../DV.h"
+#include "../ClientDescriptor.h"
+#include "../LeaseTable.h"
+#include "../../caches/filecaches/FileCache.h"
+#include "../../caches/filecaches/FileDescriptor.h"
+
+
+namespace dv {
+
+constexpr char ClientAccessReportMessageHandler::kEventLeasedOpen;
+constexpr char ClientAccessReportMessageHandler::kEventClose;
+
+ClientAccessReportMessageHandler::ClientAccessReportMessageHandler(DV *dv, int socket,
+        const std::vector<std::string> &params)
+    : MessageHandler(dv, socket, params) {
+
+    if (params.size() < kNeededVectorSize) {
+        LOG(ERROR, 0, "Insufficient number of args!");
+        return;
+    }
+
+    try {
+        for (unsigned int i = kEventsStartIndex; i + kEventParamCount <= params.size(); i += kEventParamCount) {
+            if (params[i].size() != 1) {
+                LOG(ERROR, 0, "Unknown access report event: " + params[i]);
+                return;
+            }
+            events_.push_back({params[i][0], params[i + 1], dv::stoid(params[i + 2]), std::stod(params[i + 3])});
+        }
+    } catch (const std::logic_error &e) {
+        // invalid_argument or out_of_range
+        LOG(ERROR, 0, "Cannot parse access report!");
+        return;
+    }
+
+    initialized_ = true;
+}
+
+void ClientAccessReportMessageHandler::serve() {
+    if (!initialized_) {
+        LOG(ERROR, 0, "Incomplete initialization!");
+        close(socket_);
+        return;
+    }
+
+    // one pass in the order of the events; closes of the same file share one cache lookup
+    std::unordered_map<std::string, FileDescriptor *> descriptors;
+    for (const Event &e : events_) {
+        switch (e.event) {
+        case kEventLeasedOpen: {
+            ClientDescriptor *clientDescriptor = dv_->findClientDescriptor(e.appid);
+            if (clientDescriptor == nullptr) {
+                LOG(WARNING, 0, "Client not recognized: " + std::to_string(e.appid));
+                break;
+            }
+
+            dv_->getStatsPtr()->incTotal();
+            clientDescriptor->handleLeasedOpen(e.filename, e.age);
+            if (dv_->getLeaseTablePtr() != nullptr) {
+                dv_->getLeaseTablePtr()->countReportedOpen();
+            }
+            break;
+        }
+
+        case kEventClose: {
+            auto it = descriptors.find(e.filename);
+            if (it == descriptors.end()) {
+                // only internal lookup (see ClientFileCloseMessageHandler)
+                it = descriptors.emplace(e.filename, dv_->getFileCachePtr()->internal_lookup_get(e.filename)).first;
+            }
+
+            if (it->second == nullptr) {
+                LOG(ERROR, 0, "Trying to unlock a non-exisiting file: " + e.filename);
+                break;
+            }
+
+            LOG(CLIENT, 0, "Unlocking " + e.filename);
+            it->second->unlock();
+            break;
+        }
+
+        default:
+            LOG(ERROR, 0, "Unknown access report event: " + std::string(1, e.event));
+        }
+    }
+
+    close(socket_);
+}
+
+}
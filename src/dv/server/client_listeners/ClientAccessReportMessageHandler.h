@@ -0,0 +1,53 @@
+//
+// Batched access events of clients (see dvl_report.h in DVLib)
+//
+
+#ifndef DV_SERVER_CLIENT_LISTENERS_CLIENTACCESSREPORTMESSAGEHANDLER_H_
+#define DV_SERVER_CLIENT_LISTENERS_CLIENTACCESSREPORTMESSAGEHANDLER_H_
+
+#include <string>
+#include <vector>
+
+#include "../../DVBasicTypes.h"
+#include "../MessageHandler.h"
+
+
+namespace dv {
+
+	/**
+	 * format: R:event_1:file_1:appid_1:age_1:...:event_n:file_n:appid_n:age_n
+	 * with age_i: ms between event_i and sending the report.
+	 * events are listed in the order they happened and applied in one pass; no reply is sent.
+	 *
+	 * events:
+	 * - kEventLeasedOpen: open under a client read lease (see LeaseTable)
+	 * - kEventClose: same as ClientFileCloseMessageHandler
+	 */
+	class ClientAccessReportMessageHandler : public MessageHandler {
+	public:
+		static constexpr char kEventLeasedOpen = 'O';
+		static constexpr char kEventClose = 'C';
+
+		ClientAccessReportMessageHandler(DV *dv, int socket, const std::vector<std::string> &params);
+
+		virtual void serve() override;
+
+
+	private:
+		static constexpr int kEventsStartIndex = 1;
+		static constexpr int kEventParamCount = 4;
+		static constexpr int kNeededVectorSize = 5;
+
+		struct Event {
+			char event;
+			std::string filename;
+			dv::id_type appid;
+			double age;
+		};
+
+		std::vector<Event> events_;
+	};
+
+}
+
+#endif //DV_SERVER_CLIENT_LISTENERS_CLIENTACCESSREPORTMESSAGEHANDLER_H_
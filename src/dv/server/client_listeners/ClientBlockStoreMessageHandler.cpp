@@ -0,0 +1,73 @@
+//
+// Blocks written by clients to the block store (see BlockCache)
+//
+
+#include "ClientBlockStoreMessageHandler.h"
+
+#include <unistd.h>
+#include <stdexcept>
+
+#include "../DV.h"
+#include "../../caches/filecaches/VariableDescriptor.h"
+
+
+namespace dv {
+
+ClientBlockStoreMessageHandler::ClientBlockStoreMessageHandler(DV *dv, int socket,
+        const std::vector<std::string> &params)
+    : MessageHandler(dv, socket, params) {
+
+    if (params.size() < kNeededVectorSize) {
+        LOG(ERROR, 0, "Insufficient number of arguments!");
+        return;
+    }
+
+    dv::dimension_type dimensions;
+    try {
+        dimensions = dv::stodim(params[kDimensionsIndex]);
+    } catch (const std::invalid_argument &ia) {
+        LOG(ERROR, 0, "dimensions must be an integer!");
+        return;
+    }
+
+    if (!VariableDescriptor::parseIndices(params[kOffsetsIndex], kVarDimensionDelimiter, dimensions, &block_.offsets)
+        || !VariableDescriptor::parseIndices(params[kCountsIndex], kVarDimensionDelimiter, dimensions, &block_.counts)) {
+        LOG(ERROR, 0, "Offsets/counts of the block do not match the dimensions: "
+                      + params[kOffsetsIndex] + "; " + params[kCountsIndex]);
+        return;
+    }
+
+    block_.filename = params[kFilenameIndex];
+    block_.var_id = params[kVariableIdIndex];
+    block_.name = params[kBlockNameIndex];
+    initialized_ = true;
+}
+
+void ClientBlockStoreMessageHandler::serve() {
+    if (!initialized_) {
+        LOG(ERROR, 0, "Incomplete initialization!");
+        close(socket_);
+        return;
+    }
+
+    BlockCache *blockCache = dv_->getBlockCachePtr();
+    if (blockCache == nullptr) {
+        LOG(WARNING, 0, "Block received while the block cache is off: " + block_.name);
+        close(socket_);
+        return;
+    }
+
+    std::string name = block_.name;
+    std::string filename = block_.filename;
+    if (blockCache->add(std::move(block_))) {
+        if (dv_->getConfigPtr()->dv_debug_output_on_) {
+            LOG(CLIENT, 1, "BLOCK: stored " + name + " of " + filename);
+        }
+    } else {
+        LOG(WARNING, 1, "BLOCK: rejected " + name + " of " + filename);
+    }
+
+    close(socket_);
+}
+
+}
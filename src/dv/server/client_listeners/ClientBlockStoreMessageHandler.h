@@ -0,0 +1,44 @@
+//
+// Blocks written by clients to the block store (see BlockCache)
+//
+
+#ifndef DV_SERVER_CLIENT_LISTENERS_CLIENTBLOCKSTOREMESSAGEHANDLER_H_
+#define DV_SERVER_CLIENT_LISTENERS_CLIENTBLOCKSTOREMESSAGEHANDLER_H_
+
+#include <string>
+#include <vector>
+
+#include "../../DVBasicTypes.h"
+#include "../../caches/blockcaches/BlockCache.h"
+#include "../MessageHandler.h"
+
+
+namespace dv {
+
+	/**
+	 * format: B:file:varid:dimensions:offsets:counts:blockname
+	 * the client has written the slab of the variable it read from file into the payload file
+	 * blockname of the block store. No reply is sent.
+	 */
+	class ClientBlockStoreMessageHandler : public MessageHandler {
+	public:
+		ClientBlockStoreMessageHandler(DV *dv, int socket, const std::vector<std::string> &params);
+
+		virtual void serve() override;
+
+
+	private:
+		static constexpr int kFilenameIndex = 1;
+		static constexpr int kVariableIdIndex = 2;
+		static constexpr int kDimensionsIndex = 3;
+		static constexpr int kOffsetsIndex = 4;
+		static constexpr int kCountsIndex = 5;
+		static constexpr int kBlockNameIndex = 6;
+		static constexpr int kNeededVectorSize = 7;
+
+		BlockCache::Block block_;
+	};
+
+}
+
+#endif //DV_SERVER_CLIENT_LISTENERS_CLIENTBLOCKSTOREMESSAGEHANDLER_H_
@@ -5,6 +5,8 @@
 #include "ClientFileOpenMessageHandler.h"
 
 #include <unistd.h>
+#include <algorithm>
+#include <cstdlib>
 #include <iostream>
 #include <memory>
 
@@ -20,6 +22,11 @@
 
 namespace dv {
 
+constexpr char ClientFileOpenMessageHandler::kLeaseRequest[];
+constexpr char ClientFileOpenMessageHandler::kReadaheadRequest[];
+constexpr size_t ClientFileOpenMessageHandler::kMaxReadaheadFiles;
+constexpr size_t ClientFileOpenMessageHandler::kMaxReadaheadBytes;
+
 ClientFileOpenMessageHandler::ClientFileOpenMessageHandler(DV *dv, int socket,
         const std::vector<std::string> &params)
     : MessageHandler(dv, socket, params) {
@@ -37,7 +44,22 @@ ClientFileOpenMessageHandler::ClientFileOpenMessageHandler(DV *dv, int socket,
         LOG(ERROR, 0, "Cannot extract appid!");
     }
 
-    for (unsigned int i = kJobParamsStartIndex; i < params.size(); ++i) {
+    unsigned int end = params.size();
+    const size_t readahead_len = sizeof(kReadaheadRequest) - 1;
+    while (kNeededVectorSize < end) {
+        const std::string &option = params[end - 1];
+        if (option == kLeaseRequest) {
+            lease_requested_ = true;
+        } else if (option.compare(0, readahead_len, kReadaheadRequest) == 0) {
+            long n = std::strtol(option.c_str() + readahead_len, nullptr, 10);
+            readahead_files_ = n <= 0 ? 0 : std::min(static_cast<size_t>(n), kMaxReadaheadFiles);
+        } else {
+            break;
+        }
+        --end;
+    }
+
+    for (unsigned int i = kJobParamsStartIndex; i < end; ++i) {
         jobparams_.push_back(params[i]);
     }
 
@@ -69,8 +91,34 @@ void ClientFileOpenMessageHandler::serve() {
         // ok. it is ok if fileDescriptor == nullptr
         bool can_client_read = clientDescriptor->handleOpen(filename_, jobparams_);
 
-        if (can_client_read) sendAll(kLibReplyFileOpen);
-        else sendAll(kLibReplyFileSim + dv_->getSimulatorPtr()->getMetadataFilename(filename_));
+        LeaseTable *leases = dv_->getLeaseTablePtr();
+        dv::id_type ms = 0;
+        if (can_client_read && lease_requested_ && leases != nullptr) {
+            // reply "0:<ms>": the client may re-open the file without DV for ms milliseconds
+            ms = dv_->getConfigPtr()->dv_lease_ms_;
+            leases->grant(filename_, dv_->getFileCachePtr()->internal_lookup_get(filename_), ms);
+        }
+
+        std::vector<std::string> readahead;
+        if (can_client_read && 0 < readahead_files_) {
+            clientDescriptor->getReadaheadFiles(filename_, readahead_files_, &readahead);
+        }
+
+        if (!can_client_read) {
+            sendAll(kLibReplyFileSim + dv_->getMetadataFilename(filename_));
+        } else if (0 < ms || !readahead.empty()) {
+            std::string reply = kLibReplyFileOpen + std::string(":") + std::to_string(ms);
+            size_t limit = reply.size() + kMaxReadaheadBytes;
+            for (const auto &file : readahead) {
+                if (limit < reply.size() + 1 + file.size()) {
+                    break;
+                }
+                reply += ":" + file;
+            }
+            sendAll(reply);
+        } else {
+            sendAll(kLibReplyFileOpen);
+        }
 
     }
 
@@ -27,9 +27,20 @@ namespace dv {
 		static constexpr int kJobParamsStartIndex = 3;
 		static constexpr int kNeededVectorSize = 4;
 
+		// optional last params (any order):
+		// the client can use read leases (see LeaseTable)
+		static constexpr char kLeaseRequest[] = "lease";
+		// readahead=<n>: the reply names up to n available files the client is likely to open next
+		// ("0:<lease ms or 0>:<file>:<file>..."); DVLib prefetches them into the page cache
+		static constexpr char kReadaheadRequest[] = "readahead=";
+		static constexpr size_t kMaxReadaheadFiles = 8;
+		static constexpr size_t kMaxReadaheadBytes = 2048;
+
 		std::string filename_;
 		dv::id_type appid_;
 		std::vector<std::string> jobparams_;
+		bool lease_requested_ = false;
+		size_t readahead_files_ = 0;
 	};
 
 }
@@ -0,0 +1,47 @@
+//
+// Replies too large for the shared-memory transport (see ShmTransport)
+//
+
+#include "ClientShmReplyMessageHandler.h"
+
+#include <unistd.h>
+
+#include "../DV.h"
+#include "../ShmTransport.h"
+
+
+namespace dv {
+
+ClientShmReplyMessageHandler::ClientShmReplyMessageHandler(DV *dv, int socket,
+        const std::vector<std::string> &params)
+    : MessageHandler(dv, socket, params) {
+
+    if (params.size() < kNeededVectorSize) {
+        LOG(ERROR, 0, "Insufficient number of arguments!");
+        return;
+    }
+
+    token_ = params[kTokenIndex];
+    initialized_ = true;
+}
+
+void ClientShmReplyMessageHandler::serve() {
+    if (!initialized_) {
+        LOG(ERROR, 0, "Incomplete initialization!");
+        close(socket_);
+        return;
+    }
+
+    ShmTransport *shm = dv_->getShmTransportPtr();
+    std::string reply;
+    if (shm == nullptr || !shm->takeOversizedReply(token_, &reply)) {
+        LOG(WARNING, 0, "Shm transport: unknown reply " + token_ + " requested");
+        close(socket_);
+        return;
+    }
+
+    sendAll(reply);
+    close(socket_);
+}
+
+}
@@ -0,0 +1,37 @@
+//
+// Replies too large for the shared-memory transport (see ShmTransport)
+//
+
+#ifndef DV_SERVER_CLIENT_LISTENERS_CLIENTSHMREPLYMESSAGEHANDLER_H_
+#define DV_SERVER_CLIENT_LISTENERS_CLIENTSHMREPLYMESSAGEHANDLER_H_
+
+#include <string>
+#include <vector>
+
+#include "../MessageHandler.h"
+
+
+namespace dv {
+
+	/**
+	 * format: L:token
+	 * sent on a socket by a client that got the fetch request instead of its reply on the shm channel;
+	 * the kept reply is sent on this socket. Unknown tokens close the socket without reply.
+	 */
+	class ClientShmReplyMessageHandler : public MessageHandler {
+	public:
+		ClientShmReplyMessageHandler(DV *dv, int socket, const std::vector<std::string> &params);
+
+		virtual void serve() override;
+
+
+	private:
+		static constexpr int kTokenIndex = 1;
+		static constexpr int kNeededVectorSize = 2;
+
+		std::string token_;
+	};
+
+}
+
+#endif //DV_SERVER_CLIENT_LISTENERS_CLIENTSHMREPLYMESSAGEHANDLER_H_
@@ -9,17 +9,21 @@
 
 #include "../DV.h"
 #include "../ClientDescriptor.h"
+#include "../../caches/blockcaches/BlockCache.h"
 #include "../../caches/filecaches/FileCache.h"
 #include "../../caches/filecaches/FileDescriptor.h"
+#include "../../caches/filecaches/VariableDescriptor.h"
 
 
 namespace dv {
 
+constexpr char ClientVariableGetMessageHandler::kBlockRequest[];
+
 ClientVariableGetMessageHandler::ClientVariableGetMessageHandler(DV *dv, int socket,
         const std::vector<std::string> &params)
     : MessageHandler(dv, socket, params) {
 
-    if (params.size() < (kDimensionDetailsOn ? kNeededVectorSizeWithDetails : kNeededVectorSize)) {
+    if (params.size() < kNeededVectorSize) {
         LOG(ERROR, 0, "Insufficient number of arguments!");
         return;
     }
@@ -34,8 +38,9 @@ ClientVariableGetMessageHandler::ClientVariableGetMessageHandler(DV *dv, int soc
         return;
     }
 
-    if (kDimensionDetailsOn) {
-
+    // note: older DVLib versions and the fake get of a missing metadata file send no slab;
+    // such gets are notified when the simulator closes the file
+    if (kNeededVectorSizeWithDetails <= params.size() && !params[kDimensionsIndex].empty()) {
         try {
             dimensions_ = dv::stodim(params[kDimensionsIndex]);
         } catch (const std::invalid_argument &ia) {
@@ -43,10 +48,14 @@ ClientVariableGetMessageHandler::ClientVariableGetMessageHandler(DV *dv, int soc
             return;
         }
 
-        // TODO: rest of splitting (use delimiter constant defined in DV) and convert to offset values
+        has_slab_ = VariableDescriptor::parseIndices(params[kOffsetsIndex], kVarDimensionDelimiter, dimensions_, &offsets_)
+                    && VariableDescriptor::parseIndices(params[kCountsIndex], kVarDimensionDelimiter, dimensions_, &counts_);
+        if (!has_slab_) {
+            LOG(WARNING, 0, "Offsets/counts do not match the dimensions; waiting for the complete file: "
+                            + params[kOffsetsIndex] + "; " + params[kCountsIndex]);
+        }
 
-        // TODO: remove this return as soon as this is done
-        return;
+        block_requested_ = has_slab_ && kBlockRequestIndex < params.size() && params[kBlockRequestIndex] == kBlockRequest;
     }
 
     initialized_ = true;
@@ -89,6 +98,44 @@ void ClientVariableGetMessageHandler::serve() {
         }
 
         //std::cout << "log_get_var_avail " << filename_ << std::endl;
+        return;
+    }
+
+    BlockCache *blockCache = dv_->getBlockCachePtr();
+    if (block_requested_ && blockCache != nullptr) {
+        const BlockCache::Block *block = blockCache->find(filename_, var_id_, offsets_, counts_);
+        if (block != nullptr) {
+            // the client reads the slab from the block; the file itself is not needed
+            sendAll(kLibReplyBlock + std::string(kMsgDelimiter) + block->name);
+            close(socket_);
+            if (dv_->getConfigPtr()->dv_debug_output_on_) {
+                LOG(CLIENT, 1, "READ: served from block " + block->name);
+            }
+            return;
+        }
+    }
+
+    // the file is needed: start the simulation if its open has been deferred (see ClientDescriptor::handleOpen())
+    clientDescriptor->startDeferredMiss(filename_, fileDescriptor);
+
+    if (has_slab_ && dv_->getConfigPtr()->dv_variable_notification_ && fileDescriptor->isFileUsedBySimulator()) {
+        // early data availability: the simulator reports flushed slabs per variable
+        // (see SimulatorVariablePutMessageHandler)
+        if (fileDescriptor->variableContains(var_id_, offsets_, counts_)) {
+            sendAll(kLibReplyVariableAvail);
+            close(socket_);
+            if (dv_->getConfigPtr()->dv_debug_output_on_) {
+                LOG(CLIENT, 1, "READ: variable avail");
+            }
+        } else {
+            // as below; notified by the put completing the slab or at file close at the latest
+            fileDescriptor->appendVariableWaiter(socket_, var_id_, offsets_, counts_);
+            fileDescriptor->appendWaitingClientPtr(clientDescriptor);
+
+            if (dv_->getConfigPtr()->dv_debug_output_on_) {
+                LOG(CLIENT, 1, "READ: variable not avail. Will notify.");
+            }
+        }
     } else {
         // let the client wait while the data is being simulated
         // note: message receive is blocking in DVLib
@@ -26,19 +26,25 @@ namespace dv {
 		static constexpr int kVariableIdIndex = 2;
 		static constexpr int kAppIdIndex = 3;
 		static constexpr int kNeededVectorSize = 4;
-		static constexpr bool kDimensionDetailsOn = false;
+		// optional slab of the get (used for early data availability; see dv_variable_notification)
 		static constexpr int kDimensionsIndex = 4;
 		static constexpr int kOffsetsIndex = 5;
 		static constexpr int kCountsIndex = 6;
 		static constexpr int kNeededVectorSizeWithDetails = 7;
+		// optional param after the slab: the client can read the slab from a block (see BlockCache)
+		static constexpr int kBlockRequestIndex = 7;
+		static constexpr char kBlockRequest[] = "block";
 
 		std::string filename_;
 		std::string var_id_;
 		dv::id_type appid_;
 
-		dv::dimension_type dimensions_;
+		bool has_slab_ = false;
+		dv::dimension_type dimensions_ = 0;
 		std::vector<dv::offset_type> offsets_;
 		std::vector<dv::offset_type> counts_;
+
+		bool block_requested_ = false;
 	};
 
 }
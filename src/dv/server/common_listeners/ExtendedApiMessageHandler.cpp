@@ -87,6 +87,9 @@ void ExtendedApiMessageHandler::serve() {
     case kHandleStatus:
         handle_status();
         break;
+    case kHandleHint:
+        handle_hint();
+        break;
     default:
         std::cerr << "Unknown extended API function number " << api_function_
                   << "from appid " << appid_ << " with arguments " << std::endl;
@@ -203,4 +206,18 @@ void ExtendedApiMessageHandler::handle_status() {
     std::cerr << "ExtendedApiMessageHandler::handle_status() not yet implemented." << std::endl;
     sendAll("-1");
 }
+
+void ExtendedApiMessageHandler::handle_hint() {
+    ClientDescriptor *clientDescriptor = dv_->findClientDescriptor(appid_);
+    if (clientDescriptor == nullptr) {
+        std::cerr << "ERROR in ExtendedApiMessageHandler::handle_hint(): clientdescriptor not found: " << std::endl;
+        sendAll("-1");
+        return;
+    }
+
+    // all arguments are file names in access order
+    clientDescriptor->handleHints(api_arguments_);
+    sendAll("0");
+}
+
 }
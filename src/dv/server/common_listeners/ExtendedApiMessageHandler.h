@@ -41,6 +41,7 @@ namespace dv {
 		static constexpr int kHandleRequestRange = 3;
 		static constexpr int kHandleTestFile = 4;
 		static constexpr int kHandleStatus = 5;
+		static constexpr int kHandleHint = 6;
 
 		dv::id_type appid_;
 		dv::id_type api_function_;
@@ -53,6 +54,7 @@ namespace dv {
 		void handle_request_range();
 		void handle_test_file();
 		void handle_status();
+		void handle_hint();
 	};
 
 }
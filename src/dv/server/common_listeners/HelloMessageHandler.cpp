@@ -84,10 +84,22 @@ void HelloMessageHandler::serve() {
         dv_->registerClient(rank, std::move(clientDescriptor));
         // do not access clientDescriptor here after this point
 
-        // send message
+        // send message; the block store is announced if the block cache is on (see BlockCache),
+        // the staging area if staging is on (see StagingArea); empty block fields are placeholders then
         std::string reply = dv_->getConfigPtr()->sim_result_path_ + kMsgDelimiter
                             + dv_->getConfigPtr()->sim_checkpoint_path_ + kMsgDelimiter
                             + std::to_string(rank);
+        BlockCache *blockCache = dv_->getBlockCachePtr();
+        StagingArea *stagingArea = dv_->getStagingAreaPtr();
+        if (blockCache != nullptr) {
+            reply += kMsgDelimiter + blockCache->getPath() + kMsgDelimiter
+                     + std::to_string(blockCache->getMaxBlockSize());
+        } else if (stagingArea != nullptr) {
+            reply += std::string(kMsgDelimiter) + kMsgDelimiter;
+        }
+        if (stagingArea != nullptr) {
+            reply += kMsgDelimiter + stagingArea->getPath();
+        }
         sendAll(reply);
     }
 
@@ -80,8 +80,10 @@ void SimulatorCheckpointCreateMessageHandler::serve() {
 
     /**
      * note on the decision mechanism for needsRedirect (for checkpoint files):
-     * At the moment no dynamic adding of new checkpoint files to the restart tree.
-     * Thus, a simple "file exists" check is enough.
+     * New checkpoint files are added to the restart tree upon close. Files that were
+     * evicted from the checkpoint cache are removed from the file system and the tree.
+     * Thus, a simple "file exists" check is still enough: existing checkpoints are
+     * already known and the written file is redirected.
      * (see more sophisticated decision process for result files).
      */
 
@@ -17,9 +17,9 @@
  * Small modifications:
  * - no cache modifications, of course
  * - lookup re existing file in the checkpoint/restart file tree
- * - future option: dynamically adjust this tree upon close message
- *   but not at the moment. note: DVLib is currently sending no close
- *   message for checkpoint files.
+ * - the tree is adjusted upon the close message of new (not redirected)
+ *   checkpoint files; see SimulatorFileCloseMessageHandler and
+ *   Simulator::addCheckpointFile()
  */
 
 namespace dv {
@@ -65,6 +65,15 @@ void SimulatorFileCloseMessageHandler::serve() {
     // these checks shall not be removed
     dv::id_type t = dv_->getSimulatorPtr()->getResultFileType(filename_);
     if (t == 0) {
+        // newly written checkpoint files are added to the restart lookup trees
+        // note: DVLib sends close messages only for checkpoint files that were not redirected
+        dv::id_type checkpoint_type = dv_->getSimulatorPtr()->getCheckpointFileType(filename_);
+        if (checkpoint_type != 0) {
+            dv_->getSimulatorPtr()->addCheckpointFile(filename_, checkpoint_type);
+            close(socket_);
+            return;
+        }
+
         if (dv_->getConfigPtr()->dv_debug_output_on_) {
             LOG(SIMULATOR, 0, "   unexpected file type: ignore.");
         }
@@ -137,6 +146,13 @@ void SimulatorFileCloseMessageHandler::serve() {
         }
     }
 
+    // a staged file is locked in the cache until it has been written back (see DV::finishWriteBacks());
+    // a close of a redirected re-creation of the file does not queue it again
+    if (fileDescriptor->isStaged() && dv_->getStagingAreaPtr() != nullptr
+        && dv_->getStagingAreaPtr()->writeBack(filename_)) {
+        fileDescriptor->lock();
+    }
+
     //std::cout << "log_sim_close " << filename_ << std::endl;
 
     // given asserts here:
@@ -180,8 +196,28 @@ void SimulatorFileCloseMessageHandler::serve() {
 
     fileDescriptor->removeAllNotificationSockets();
 
+    // variable gets whose slab was not reported as written before (see dv_variable_notification)
+    std::vector<int> variable_sockets = fileDescriptor->takeAllVariableWaiterSockets();
+    for (auto socket : variable_sockets) {
+        sendAllToSocket(socket, kLibReplyFileOpen);
+        ++socket_notification_count;
+    }
+    for (auto socket : variable_sockets) {
+        close(socket);
+    }
+
+    // the complete file is available now
+    fileDescriptor->removeAllVariables();
+
     LOG(SIMULATOR, 3, "  -> " + std::to_string(socket_notification_count) + " analyses have been notified");
 
+    // after the notifications: the first file of its type in this run renews the metadata stub
+    MetadataStore *metadataStore = dv_->getMetadataStorePtr();
+    if (metadataStore != nullptr && metadataStore->needsStub(t)) {
+        metadataStore->deriveStub(t, fileDescriptor->isStaged() ? fileDescriptor->getStagedFileName()
+                                                                : fileDescriptor->getFileName());
+    }
+
 
     //std::cout << "   notified " << socket_notification_count << " DVLib sockets in "
     //		  << client_notification_count << " clients." << std::endl;
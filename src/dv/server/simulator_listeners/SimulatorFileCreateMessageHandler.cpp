@@ -58,8 +58,11 @@ SimulatorFileCreateMessageHandler::SimulatorFileCreateMessageHandler(DV *dv, int
  *
  * valid replies to DVLib are:
  * kLibReplyFileCreateAck
+ * kLibReplyFileCreateAckReportPuts (see dv_variable_notification)
  * kLibReplyFileCreateKill
  * kLibReplyFileCreateRedirect:valid_absolute_redirect_path
+ * kLibReplyFileCreateRedirectSkipWrites:valid_absolute_redirect_path (see sim_redirect_skip_writes)
+ * kLibReplyFileCreateStage:report_puts:valid_absolute_staged_path (see StagingArea)
  */
 
 void SimulatorFileCreateMessageHandler::serve() {
@@ -117,6 +120,12 @@ void SimulatorFileCreateMessageHandler::serve() {
 
     bool needsRedirect = false;
 
+    // early data availability: DVLib reports flushed variable puts of result files in simulation range
+    bool reportPuts = false;
+
+    // new result files in simulation range are created in the staging area if it is on
+    std::string stagedName;
+
     FileDescriptor *fileDescriptor = dv_->getFileCachePtr()->internal_lookup_get(filename_);
 
     if (fileDescriptor != nullptr && !simjob->isPassive()) {
@@ -154,6 +163,23 @@ void SimulatorFileCreateMessageHandler::serve() {
                     return;
                 }
             }
+
+            // protect files of pending range requests from eviction until the client opens them
+            dv_->pinRequestedFile(t, nr, filename_, fileDescriptor);
+            dv_->addResultName(filename_);
+
+            // the file is produced again: an evicted copy in the cold tier is obsolete
+            if (!needsRedirect && dv_->getColdTierPtr() != nullptr) {
+                dv_->getColdTierPtr()->remove(filename_);
+            }
+
+            reportPuts = dv_->getConfigPtr()->dv_variable_notification_;
+
+            StagingArea *stagingArea = dv_->getStagingAreaPtr();
+            if (!needsRedirect && stagingArea != nullptr && !simjob->isPassive()) {
+                stagedName = stagingArea->stage(filename_);
+                fileDescriptor->setStagedFileName(stagedName);
+            }
         } else {
             if (dv_->getConfigPtr()->dv_debug_output_on_) {
                 std::cout << "   file was not asked for: ignore" << std::endl;
@@ -202,14 +228,21 @@ void SimulatorFileCreateMessageHandler::serve() {
         std::cout << "log_create " << filename_ << std::endl;
         std::cout << "log_redirect " << fullRedirectName << std::endl;
         */
-        std::string reply(kLibReplyFileCreateRedirect);
+        // the file exists in the result path: the redirected copy is removed with the redirect folders,
+        // thus its data need not be written (only the metadata, which keeps the simulator's I/O valid)
+        std::string reply(dv_->getConfigPtr()->sim_redirect_skip_writes_ ? kLibReplyFileCreateRedirectSkipWrites
+                                                                         : kLibReplyFileCreateRedirect);
         reply += std::string(kMsgDelimiter) + fullRedirectName;
         sendAll(reply);
+    } else if (!stagedName.empty()) {
+        std::string reply(kLibReplyFileCreateStage);
+        reply += std::string(kMsgDelimiter) + (reportPuts ? "1" : "0") + kMsgDelimiter + stagedName;
+        sendAll(reply);
     } else {
         //LOG(SIMULATOR, 1, "Simulation " + std::to_string(jobid_) + " is creating " + filename_);
         //std::cout << "Simulation " << jobid_ << " is creating file " << filename_ << std::endl;
         //std::cout << "log_create " << filename_ << std::endl;
-        sendAll(kLibReplyFileCreateAck);
+        sendAll(reportPuts ? kLibReplyFileCreateAckReportPuts : kLibReplyFileCreateAck);
     }
     close(socket_);
 }
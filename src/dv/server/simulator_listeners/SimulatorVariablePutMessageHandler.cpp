@@ -8,37 +8,48 @@
 #include <iostream>
 #include <stdexcept>
 
+#include "../DV.h"
+#include "../../caches/filecaches/FileCache.h"
+#include "../../caches/filecaches/FileDescriptor.h"
+#include "../../caches/filecaches/VariableDescriptor.h"
+
 namespace dv {
 
+constexpr char SimulatorVariablePutMessageHandler::kFlushed[];
+
 SimulatorVariablePutMessageHandler::SimulatorVariablePutMessageHandler(DV *dv, int socket,
         const std::vector<std::string> &params)
     : MessageHandler(dv, socket, params) {
 
     if (params.size() < kNeededVectorSize) {
-        std::cerr << "SimulatorVariablePutMessageHandler: insufficient number of arguments in params. Need "
-                  << kNeededVectorSize << " got " << params.size() << std::endl;
+        LOG(ERROR, 0, "Insufficient number of arguments in params. (Expected: " + std::to_string(kNeededVectorSize) + "; Got: " + std::to_string(params.size()) + ")");
         return;
     }
 
     try {
         jobid_ = dv::stoid(params[kJobIdIndex]);
+        dimensions_ = dv::stodim(params[kDimensionsIndex]);
     } catch (const std::invalid_argument &ia) {
-        std::cerr << "ERROR in SimulatorVariablePutMessageHandler: could not extract integer jobid from params: "
-                  << params[kJobIdIndex] << std::endl;
+        LOG(ERROR, 0, "Cannot extract jobid/dimensions from params: " + params[kJobIdIndex] + ", " + params[kDimensionsIndex]);
+        return;
     }
 
     filename_ = params[kFilenameIndex];
+    var_id_ = params[kVarIdIndex];
+
+    if (params.size() < kNeededVectorSizeWithOffsets) {
+        LOG(ERROR, 0, "Missing offsets/counts for " + filename_);
+        return;
+    }
+
+    if (!VariableDescriptor::parseIndices(params[kOffsetsIndex], kVarDimensionDelimiter, dimensions_, &offsets_)
+        || !VariableDescriptor::parseIndices(params[kCountsIndex], kVarDimensionDelimiter, dimensions_, &counts_)) {
+        LOG(ERROR, 0, "Offsets/counts do not match the " + std::to_string(dimensions_) + " dimensions: "
+                      + params[kOffsetsIndex] + "; " + params[kCountsIndex]);
+        return;
+    }
 
-    // TODO: var id, dimension check and parsing of offsets and counts
-    /* see
-     self.dims = int(params[4]);
-      if (self.dims>0):
-        self.doff = [int(x) for x in params[5].split(",")];
-        self.dcnt = [int(x) for x in params[6].split(",")];
-      else:
-        self.doff = []
-        self.dcnt = []
-     */
+    flushed_ = kNeededVectorSizeWithFlushed <= params.size() && params[kFlushedIndex] == kFlushed;
 
     initialized_ = true;
 
@@ -46,17 +57,52 @@ SimulatorVariablePutMessageHandler::SimulatorVariablePutMessageHandler(DV *dv, i
 
 void SimulatorVariablePutMessageHandler::serve() {
     if (!initialized_) {
-        std::cerr << "   -> cannot serve message due to incomplete initialization." << std::endl;
+        LOG(ERROR, 0, "cannot serve message due to incomplete initialization");
         close(socket_);
         return;
     }
 
-    std::cout << "Simulator variable PUT request  " << filename_ << "; jobid " << jobid_ << std::endl;
-    // print colored("   PUT request; vid:" + str(self.vid) + "; file: " + self.fname + "; dims: " + str(self.dims) + "; doff: " + str(self.doff) + "; dcnt: " + str(self.dcnt), "yellow")
+    if (dv_->getConfigPtr()->dv_debug_output_on_) {
+        LOG(SIMULATOR, 3, "Simulator " + std::to_string(jobid_) + " PUT " + filename_ + " var " + var_id_
+                          + "; dims " + std::to_string(dimensions_) + (flushed_ ? "; flushed" : ""));
+    }
+
+    // only flushed data can be read by clients
+    if (!flushed_ || !dv_->getConfigPtr()->dv_variable_notification_) {
+        close(socket_);
+        return;
+    }
 
-    // TODO: do the actual variable handling
+    // note: the descriptor is on the waiting list while the file is being simulated
+    FileDescriptor *fileDescriptor = dv_->getFileCachePtr()->internal_lookup_get(filename_);
+    if (fileDescriptor == nullptr || fileDescriptor->isFileAvailable() || !fileDescriptor->isFileUsedBySimulator()) {
+        // unknown, already complete (e.g. redirected re-simulation), or not in production
+        close(socket_);
+        return;
+    }
+
+    fileDescriptor->addVariable(var_id_, offsets_, counts_);
+
+    if (!fileDescriptor->hasVariableWaiters()) {
+        close(socket_);
+        return;
+    }
+
+    // early notification of the variable gets whose slab is complete now
+    // the clients themselves are notified at file close (see SimulatorFileCloseMessageHandler)
+    std::vector<int> sockets = fileDescriptor->takeSatisfiedVariableWaiterSockets();
+    for (auto socket : sockets) {
+        sendAllToSocket(socket, kLibReplyVariableAvail);
+    }
+    for (auto socket : sockets) {
+        close(socket);
+    }
+
+    if (!sockets.empty()) {
+        LOG(SIMULATOR, 3, "  -> " + std::to_string(sockets.size()) + " variable gets of " + filename_ + " (var "
+                          + var_id_ + ") have been notified before file close");
+    }
 
-    // currently just close the socket
     close(socket_);
 }
 
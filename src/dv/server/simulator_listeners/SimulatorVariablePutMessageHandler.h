@@ -27,11 +27,22 @@ namespace dv {
 		static constexpr int kDimensionsIndex = 4;
 		static constexpr int kOffsetsIndex = 5;
 		static constexpr int kCountsIndex = 6;
+		static constexpr int kFlushedIndex = 7;
 		static constexpr int kNeededVectorSize = 5;
 		static constexpr int kNeededVectorSizeWithOffsets = 7;
+		static constexpr int kNeededVectorSizeWithFlushed = 8;
+
+		static constexpr char kFlushed[] = "1";
 
 		dv::id_type jobid_;
 		std::string filename_;
+		std::string var_id_;
+		dv::dimension_type dimensions_ = 0;
+		std::vector<dv::offset_type> offsets_;
+		std::vector<dv::offset_type> counts_;
+
+		// puts sent before the data was written (older DVLib / PnetCDF) only announce the write
+		bool flushed_ = false;
 	};
 
 }
@@ -270,10 +270,12 @@ int main(int argc, char * argv[]) {
         env.setNewAddresses(addr);
         env.save(); /* so they are immediately visible */
 
-        KeyValueStore fileidx;
+        PersistentIndex fileidx;
         if (cmd == SIMFS_START_PASSIVE) { 
 
-            env.loadFiles(&fileidx);
+            if (env.openFiles(&fileidx)!=0){
+                error_exit(argv[0], "Cannot open the file index!");
+            }
 
             dv->setPassive();
             dv->setFileIndex(&fileidx);
@@ -283,7 +285,9 @@ int main(int argc, char * argv[]) {
         dv->run();
 
         if (cmd == SIMFS_START_PASSIVE) { 
-            env.saveFiles(&fileidx);
+            /* files are indexed as they are written; the shutdown merges the log into the table */
+            fileidx.compact();
+            fileidx.close();
         }
 
         delete dv;
@@ -297,8 +301,10 @@ int main(int argc, char * argv[]) {
             error_exit(argv[0], "error while initializing the environment!");
         }   
 
-        KeyValueStore fileidx;
-        env.loadFiles(&fileidx);
+        PersistentIndex fileidx;
+        if (env.openFiles(&fileidx)!=0){
+            error_exit(argv[0], "Cannot open the file index!");
+        }
         
         //get env output path
         DVConfig dvconf;
@@ -318,23 +324,24 @@ int main(int argc, char * argv[]) {
 
         if (!cwd.compare(0, env_output.size(), env_output)){
 
-            std::unordered_map<std::string, std::string> files = fileidx.getStoreMap();
             std::string reldir = cwd.substr(env_output.length());
             if (reldir=="") reldir="/";
 
             printf("Filename\t\t\tExists\t\tIndexed Chksum\t\t\tLast Chksum\n");
             //std::cout << "rel dir: " << reldir << std::endl;
-            for (auto f = files.begin(); f != files.end(); ++f){
-                std::string fdir = FileSystemHelper::getDirname(f->first);
+            /* prefix lookup: only the entries of this dir and its sub dirs are read */
+            std::string prefix = reldir=="/" ? reldir : reldir + "/";
+            fileidx.forEachWithPrefix(prefix, [&](const std::string &key, const std::string &value){
+                std::string fdir = FileSystemHelper::getDirname(key);
                 //std::cout << "fdir: " << fdir << std::endl;
-                std::string fname = env_output + "/" + f->first;
-                bool file_exists = FileSystemHelper::fileExists(fname) && FileSystemHelper::fileSize(fname) > 0;
+                std::string fname = env_output + "/" + key;
 
                 if (fdir==reldir){
-                    printf("%s\t\t", FileSystemHelper::getBasename(f->first).c_str());
+                    bool file_exists = FileSystemHelper::fileExists(fname) && FileSystemHelper::fileSize(fname) > 0;
+                    printf("%s\t\t", FileSystemHelper::getBasename(key).c_str());
                     printf("%s\t\t[indexed chksum]\t\t[last chksum]\n", file_exists ? "Yes" : "No");
                 }
-            }
+            });
         }else{
             error_exit(argv[0], "This is not an the output dir of this context!");
         }
@@ -354,8 +361,10 @@ int main(int argc, char * argv[]) {
         std::string dirname = FileSystemHelper::getDirname(file);
         std::string filename = FileSystemHelper::getBasename(file);
 
-        KeyValueStore fileidx;
-        env.loadFiles(&fileidx);
+        PersistentIndex fileidx;
+        if (env.openFiles(&fileidx)!=0){
+            error_exit(argv[0], "Cannot open the file index!");
+        }
         
         //get env output path
         DVConfig dvconf;
@@ -379,8 +388,8 @@ int main(int argc, char * argv[]) {
             std::string filename_idx = reldir + "/" + filename;
             std::cout << "indexing file " << filename_idx << "; exists: " << file_exists << std::endl;
 
-            fileidx.setString(filename_idx, file_exists ? "1" : "0");
-            if (!env.saveFiles(&fileidx)){
+            /* appended to the index log; no rewrite of the index */
+            if (!fileidx.set(filename_idx, file_exists ? "1" : "0")){
                 error_exit(argv[0], "Error while saving the index!\n");
             }        
 
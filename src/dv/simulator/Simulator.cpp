@@ -9,15 +9,15 @@
 
 #include "Simulator.h"
 #include "../server/DV.h"
-#include "../caches/RestartFiles.h"
 #include "../toolbox/FileSystemHelper.h"
 #include "../toolbox/StatisticsHelper.h"
 #include "../toolbox/StringHelper.h"
+#include "../toolbox/TimeHelper.h"
 
 
 namespace dv {
 
-Simulator::Simulator(DV *dv_ptr) : dv_ptr_(dv_ptr) {}
+Simulator::Simulator(DV *dv_ptr) : dv_ptr_(dv_ptr), dynamic_checkpoints_(0) {}
 
 void Simulator::incFilesCount(dv::counter_type increment) {
     files_ += increment;
@@ -35,46 +35,44 @@ dv::counter_type Simulator::getSimulationsCount() const {
     return simulations_;
 }
 
-void Simulator::scanRestartFiles() {
-    RestartFiles restart_files;
-
-    Simulator *local_simulator_ptr = this;
-    auto accept_function = [&] (const std::string &filename) -> bool {
-        return local_simulator_ptr->getCheckpointFileType(filename) != 0;
-    };
-
-    auto add_file = [&] (const std::string &name,
-                         const std::string &rel_path,
-    const std::string &full_path) -> void {
-
-        std::unique_ptr<FileDescriptor> fd = std::make_unique<FileDescriptor>(name, full_path);
-        fd->setFileAvailable(true);
-        dv::size_type size = toolbox::FileSystemHelper::fileSize(full_path);
-        if (size < 0) {
-            std::cerr << "scanRestartFiles: Could not determine file size of " << full_path << std::endl;
-            size = 0;
+void Simulator::scanRestartFiles(time_t changed_since) {
+    toolbox::TimeHelper::time_point_type start = toolbox::TimeHelper::now();
+    std::vector<toolbox::FileSystemHelper::ScanEntry> entries;
+    toolbox::FileSystemHelper::scanDir(dv_ptr_->getConfigPtr()->sim_checkpoint_path_, true, &entries, 0, changed_since);
+    double scan_s = toolbox::TimeHelper::seconds(start, toolbox::TimeHelper::now());
+
+    // the file type is passed on to checkpoint2nr() to save a second call into Lua per file
+    std::vector<std::pair<const toolbox::FileSystemHelper::ScanEntry *, dv::id_type>> files;
+    for (const auto &entry : entries) {
+        dv::id_type file_type = getCheckpointFileType(entry.name);
+        if (file_type != 0) {
+            if (entry.size < 0) {
+                std::cerr << "scanRestartFiles: Could not determine file size of " << entry.full_path << std::endl;
+            }
+            files.emplace_back(&entry, file_type);
         }
-        fd->setSize(size);
-        restart_files.put(name, std::move(fd));
-    };
-
-    toolbox::FileSystemHelper::readDir(dv_ptr_->getConfigPtr()->sim_checkpoint_path_,
-                                       add_file, true, accept_function);
-
-    std::vector<FileDescriptor *> files = restart_files.getAllFiles();
+    }
 
-    std::cout  << "Simulator: " << files.size() << " restart files detected. Building lookup trees..." << std::endl;
+    std::cout  << "Simulator: " << entries.size() << " files scanned in " << scan_s << " s ("
+               << (0.0 < scan_s ? entries.size() / scan_s : 0.0) << " files/s); "
+               << files.size() << " restart files detected. Building lookup trees..." << std::endl;
 
-    for (auto fd : files) {
+    for (const auto &file : files) {
 
-        dv::id_type nr = checkpoint2nr(fd->getName());
+        dv::id_type nr = checkpoint2nr(file.first->name, file.second);
 
         if (dv_ptr_->getConfigPtr()->dv_debug_output_on_) {
-            std::cout << "restart file: " << fd->getName() << "; nr: " << nr << std::endl;
+            std::cout << "restart file: " << file.first->name << "; nr: " << nr << std::endl;
+        }
+
+        // a checkpoint restored from the snapshot as dynamic one stays in the checkpoint cache
+        if (dynamic_checkpoints_.find(nr) != checkpoint_map_type::kNone) {
+            continue;
         }
 
         restarts_.emplace(nr);
         restarts_ceil_.emplace(nr);
+        static_checkpoints_[nr] = file.first->rel_path;
     }
 
     std::cout << "restart lookup tree: " << restarts_.size()
@@ -93,6 +91,118 @@ void Simulator::scanRestartFiles() {
     }
 }
 
+void Simulator::addCheckpointFile(const std::string &filename, dv::id_type file_type) {
+    if (file_type == 0) {
+        file_type = getCheckpointFileType(filename);
+    }
+
+    if (file_type == 0) {
+        LOG(WARNING, 0, "Simulator: " + filename + " is not a checkpoint file; not added to restart lookup trees.");
+        return;
+    }
+
+    dv::id_type nr = checkpoint2nr(filename, file_type);
+
+    // already known (detected at startup or added before): only refresh dynamic checkpoints
+    if (restarts_.find(nr) != restarts_.end()) {
+        if (dynamic_checkpoints_.find(nr) != checkpoint_map_type::kNone) {
+            dynamic_checkpoints_.refreshWithKey(nr);
+        }
+        return;
+    }
+
+    restarts_.emplace(nr);
+    restarts_ceil_.emplace(nr);
+    dynamic_checkpoints_.add(nr, {nr, filename});
+
+    LOG(SIMULATOR, 1, "Simulator: checkpoint " + filename + " (nr " + std::to_string(nr)
+        + ") added to restart lookup trees; dynamic checkpoints: " + std::to_string(dynamic_checkpoints_.size()));
+
+    evictCheckpoints();
+}
+
+void Simulator::getRestartSnapshot(std::vector<std::pair<dv::id_type, std::string>> *static_checkpoints,
+                                   std::vector<std::pair<dv::id_type, std::string>> *dynamic_checkpoints) const {
+    for (const auto &checkpoint : static_checkpoints_) {
+        static_checkpoints->emplace_back(checkpoint.first, checkpoint.second);
+    }
+
+    dynamic_checkpoints_.forEach([dynamic_checkpoints](const dv::id_type &nr, const CheckpointEntry &entry) {
+        dynamic_checkpoints->emplace_back(nr, entry.filename);
+    });
+}
+
+void Simulator::restoreRestartSnapshot(const std::vector<std::pair<dv::id_type, std::string>> &static_checkpoints,
+                                       const std::vector<std::pair<dv::id_type, std::string>> &dynamic_checkpoints) {
+    // checkpoints removed while DV was not running must not become restart points
+    const std::string &checkpoint_path = dv_ptr_->getConfigPtr()->sim_checkpoint_path_;
+    dv::counter_type missing = 0;
+    for (const auto &checkpoint : static_checkpoints) {
+        if (toolbox::FileSystemHelper::fileSize(toolbox::StringHelper::joinPath(checkpoint_path, checkpoint.second)) < 0) {
+            ++missing;
+            continue;
+        }
+
+        restarts_.emplace(checkpoint.first);
+        restarts_ceil_.emplace(checkpoint.first);
+        static_checkpoints_[checkpoint.first] = checkpoint.second;
+    }
+
+    for (const auto &checkpoint : dynamic_checkpoints) {
+        std::string fullpath = toolbox::StringHelper::joinPath(checkpoint_path, checkpoint.second);
+        if (toolbox::FileSystemHelper::fileSize(fullpath) < 0) {
+            ++missing;
+            continue;
+        }
+        if (restarts_.find(checkpoint.first) != restarts_.end()) {
+            continue;
+        }
+
+        restarts_.emplace(checkpoint.first);
+        restarts_ceil_.emplace(checkpoint.first);
+        dynamic_checkpoints_.add(checkpoint.first, {checkpoint.first, checkpoint.second});
+    }
+
+    std::cout << "Simulator: " << restarts_.size() << " restart files restored (" << missing
+              << " no longer exist); dynamic checkpoints: " << dynamic_checkpoints_.size() << std::endl;
+
+    evictCheckpoints();
+}
+
+void Simulator::evictCheckpoints() {
+    dv::id_type capacity = dv_ptr_->getConfigPtr()->sim_checkpoint_cache_size_;
+    if (capacity <= 0) {
+        // unlimited
+        return;
+    }
+
+    // checkpoints used as restart point by running or queued jobs must not be removed
+    DV *local_dv_ptr = dv_ptr_;
+    auto evictable = [local_dv_ptr] (const CheckpointEntry &entry) -> bool {
+        return !local_dv_ptr->isCheckpointInUse(entry.nr);
+    };
+
+    while (capacity < dynamic_checkpoints_.size()) {
+        checkpoint_map_type::ID_type id = dynamic_checkpoints_.findFirstWithPredicate(evictable, false, 0);
+        if (id == checkpoint_map_type::kNone) {
+            LOG(WARNING, 1, "Simulator: checkpoint cache is over capacity but all checkpoints are in use.");
+            return;
+        }
+
+        CheckpointEntry *entry = dynamic_checkpoints_.get(id);
+        dv::id_type nr = entry->nr;
+        std::string fullpath = toolbox::StringHelper::joinPath(dv_ptr_->getConfigPtr()->sim_checkpoint_path_,
+                                                               entry->filename);
+        LOG(SIMULATOR, 1, "Simulator: evicting checkpoint " + entry->filename + " (nr " + std::to_string(nr) + ")");
+
+        restarts_.erase(nr);
+        restarts_ceil_.erase(nr);
+        dynamic_checkpoints_.erase(id);
+        toolbox::FileSystemHelper::rmFile(fullpath);
+        ++checkpoint_evictions_;
+    }
+}
+
 
 //--- file predicates & file/id_type conversion functions ------------------
 
@@ -133,6 +243,15 @@ dv::id_type Simulator::getNextCheckpointNr(dv::id_type nr) const {
     return pstop;
 }
 
+void Simulator::getCheckpointsInRange(dv::id_type from, dv::id_type to,
+                                      std::vector<dv::id_type> *checkpoints) const {
+    checkpoints->clear();
+    auto end = restarts_ceil_.upper_bound(to);
+    for (auto it = restarts_ceil_.upper_bound(from); it != end; ++it) {
+        checkpoints->push_back(*it);
+    }
+}
+
 
 dv::id_type Simulator::getPrevRestartDiff(const std::string &filename) const {
     dv::id_type nr = result2nr(filename);
@@ -206,6 +325,11 @@ std::unique_ptr<SimJob> Simulator::generateSimJobForRange(dv::id_type appid,
     auto it1 = restarts_.lower_bound(target_start_nr);
     dv::id_type simstart = (it1 == restarts_.end()) ? 0 : *it1;
 
+    // LRU policy for dynamically added checkpoints
+    if (dynamic_checkpoints_.find(simstart) != checkpoint_map_type::kNone) {
+        dynamic_checkpoints_.refreshWithKey(simstart);
+    }
+
     // assure that full interval is simulated up to the next available checkpoint file
     // improved version that uses the effectively available checkpoint files and not only
     // the defined restart interval (if possible)
@@ -311,6 +435,8 @@ double Simulator::getTau() const {
 const toolbox::KeyValueStore &Simulator::getStatusSummary() {
     // update summary
     statusSummary_.setInt("sim_checkpoint_files", restarts_.size());
+    statusSummary_.setInt("sim_dynamic_checkpoint_files", dynamic_checkpoints_.size());
+    statusSummary_.setInt("sim_checkpoint_evictions", checkpoint_evictions_);
     statusSummary_.setInt("sim_median_alpha", getAlpha());
     statusSummary_.setDouble("sim_median_tau", getTau());
 
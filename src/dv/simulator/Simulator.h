@@ -6,16 +6,20 @@
 #define DV_SIMULATORS_SIMULATOR_H_
 
 
+#include <ctime>
 #include <functional>
 #include <memory>
 #include <set>
+#include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "../DVBasicTypes.h"
 #include "../DVForwardDeclarations.h"
 #include "../toolbox/KeyValueStore.h"
+#include "../toolbox/LinkedMap.h"
 
 
 namespace dv {
@@ -30,7 +34,35 @@ namespace dv {
 		void incSimulationsCount();
 		dv::counter_type getSimulationsCount() const;
 
-		void scanRestartFiles();
+		/**
+		 * adds the checkpoint files in sim_checkpoint_path to the restart lookup trees;
+		 * changed_since > 0: only folders modified since then are listed (checkpoints
+		 * written while DV was not running, after CacheSnapshot::restore())
+		 */
+		void scanRestartFiles(time_t changed_since = 0);
+
+		/**
+		 * registers a checkpoint file that has been written (closed) by a running simulation
+		 * in the restart lookup trees. Following jobs can then start closer to their target.
+		 *
+		 * These dynamically added checkpoints are kept in a checkpoint cache with LRU policy
+		 * (refreshed when used as restart point of a new job). If sim_checkpoint_cache_size > 0,
+		 * the LRU checkpoint that is not used as restart point by a running or queued job
+		 * is evicted (removed from the lookup trees and the file system).
+		 * Checkpoint files detected by scanRestartFiles() are never evicted.
+		 */
+		void addCheckpointFile(const std::string &filename, dv::id_type file_type = 0);
+
+		/**
+		 * restart lookup as kept in CacheSnapshot; restoring it replaces the full scanRestartFiles().
+		 * static_checkpoints: checkpoints detected by scanRestartFiles() (nr, filename)
+		 * dynamic_checkpoints: checkpoints added during runtime (nr, filename) from LRU to MRU;
+		 * only the ones whose file still exists are restored
+		 */
+		void getRestartSnapshot(std::vector<std::pair<dv::id_type, std::string>> *static_checkpoints,
+								std::vector<std::pair<dv::id_type, std::string>> *dynamic_checkpoints) const;
+		void restoreRestartSnapshot(const std::vector<std::pair<dv::id_type, std::string>> &static_checkpoints,
+									const std::vector<std::pair<dv::id_type, std::string>> &dynamic_checkpoints);
 
 
 		//--- file predicates & file/id_type conversion functions ------------------
@@ -61,6 +93,12 @@ namespace dv {
 		dv::id_type getCheckpointNr(dv::id_type nr) const;
 		dv::id_type getNextCheckpointNr(dv::id_type nr) const;
 
+		/**
+		 * collects all checkpoint nrs c with from < c <= to in ascending order;
+		 * used to split prefetch ranges into independent segments (horizontal prefetching)
+		 */
+		void getCheckpointsInRange(dv::id_type from, dv::id_type to, std::vector<dv::id_type> *checkpoints) const;
+
 		/**
 		 * for hotspot detection at the moment
 		 */
@@ -147,6 +185,24 @@ namespace dv {
 		// use the lookup nr in case it cannot be found
 
 
+		struct CheckpointEntry {
+			dv::id_type nr;
+			std::string filename;
+		};
+
+		typedef toolbox::LinkedMap<dv::id_type, CheckpointEntry> checkpoint_map_type;
+
+		checkpoint_map_type dynamic_checkpoints_;
+		// checkpoints added during runtime; key is the checkpoint nr
+
+		std::unordered_map<dv::id_type, std::string> static_checkpoints_;
+		// checkpoints detected by scanRestartFiles(); nr -> path relative to sim_checkpoint_path
+
+		dv::counter_type checkpoint_evictions_ = 0;
+
+		void evictCheckpoints();
+
+
 		std::vector<double> alphas_;
 		std::vector<double> taus_;
 
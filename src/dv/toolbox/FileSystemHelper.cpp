@@ -8,13 +8,20 @@
 #include "FileSystemHelper.h"
 
 #include <dirent.h>
+#include <fcntl.h>
 #include <libgen.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <iterator>
 #include <cstdio>
 #include <cstring>
+#include <mutex>
+#include <thread>
 #include <vector>
 #include <fstream>
 
@@ -87,6 +94,140 @@ void FileSystemHelper::readDirRecursive(const std::string &path,
 }
 
 
+constexpr unsigned int FileSystemHelper::kMaxScanThreads;
+
+void FileSystemHelper::scanDir(const std::string &path,
+                               bool include_sub_dirs,
+                               std::vector<FileSystemHelper::ScanEntry> *entries,
+                               unsigned int threads,
+                               time_t changed_since) {
+
+    if (threads == 0) {
+        threads = std::min(std::max(std::thread::hardware_concurrency(), 1u), kMaxScanThreads);
+    }
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<ScanDirItem> pending{{path, ""}};
+    unsigned int busy = 0;
+    std::vector<std::vector<ScanEntry>> results(threads);
+
+    // done if no dir is pending and no worker may add new ones
+    auto worker = [&](unsigned int id) {
+        std::vector<ScanDirItem> sub_dirs;
+        while (true) {
+            ScanDirItem dir;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [&] { return !pending.empty() || busy == 0; });
+                if (pending.empty()) {
+                    return;
+                }
+                dir = std::move(pending.back());
+                pending.pop_back();
+                ++busy;
+            }
+
+            sub_dirs.clear();
+            scanOneDir(dir, include_sub_dirs, changed_since, &results[id], &sub_dirs);
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                for (auto &sub_dir : sub_dirs) {
+                    pending.push_back(std::move(sub_dir));
+                }
+                --busy;
+            }
+            cv.notify_all();
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned int i = 1; i < threads; ++i) {
+        pool.emplace_back(worker, i);
+    }
+    worker(0);
+    for (auto &t : pool) {
+        t.join();
+    }
+
+    for (auto &result : results) {
+        std::move(result.begin(), result.end(), std::back_inserter(*entries));
+    }
+}
+
+void FileSystemHelper::scanOneDir(const FileSystemHelper::ScanDirItem &dir, bool include_sub_dirs,
+                                  time_t changed_since,
+                                  std::vector<FileSystemHelper::ScanEntry> *entries,
+                                  std::vector<FileSystemHelper::ScanDirItem> *sub_dirs) {
+
+    std::string checked_path = (dir.full_path.length() == 0) ?
+                               dir.full_path : (dir.full_path.back() == '/') ?
+                               dir.full_path : dir.full_path + "/";
+
+    std::string checked_sub_dir = (dir.rel_path.length() == 0) ?
+                                  dir.rel_path : dir.rel_path + "/";
+
+    int fd = open(checked_path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        return;
+    }
+
+    // unchanged dir: no new files here, but maybe in its sub dirs
+    struct stat dir_stat;
+    bool list_files = changed_since <= 0
+                      || (fstat(fd, &dir_stat) == 0 && changed_since <= dir_stat.st_mtime);
+    if (!list_files && !include_sub_dirs) {
+        close(fd);
+        return;
+    }
+
+    // readdir() fetches the entries in getdents64 sized batches
+    DIR *dir_ptr = fdopendir(fd);
+    if (dir_ptr == nullptr) {
+        close(fd);
+        return;
+    }
+
+    struct dirent *dir_entry_ptr;
+    while ((dir_entry_ptr = readdir(dir_ptr)) != nullptr) {
+        if (dir_entry_ptr->d_name[0] == '.') {
+            // no hidden files
+            // no . and .. folders
+            continue;
+        }
+
+        struct stat buffer;
+        bool has_stat = false;
+        unsigned char type = dir_entry_ptr->d_type;
+        if (!list_files && type != DT_DIR && type != DT_UNKNOWN) {
+            continue;
+        }
+        if (type == DT_UNKNOWN) {
+            if (fstatat(fd, dir_entry_ptr->d_name, &buffer, AT_SYMLINK_NOFOLLOW) != 0) {
+                continue;
+            }
+            has_stat = true;
+            type = S_ISREG(buffer.st_mode) ? DT_REG : S_ISDIR(buffer.st_mode) ? DT_DIR : DT_UNKNOWN;
+        }
+
+        std::string name = dir_entry_ptr->d_name;
+        if (type == DT_REG && list_files) {
+            if (!has_stat) {
+                has_stat = fstatat(fd, dir_entry_ptr->d_name, &buffer, 0) == 0;
+            }
+            entries->push_back({name, checked_sub_dir + name, checked_path + name,
+                                has_stat ? static_cast<int64_t>(buffer.st_size) : -1,
+                                has_stat ? buffer.st_mtime : 0});
+        } else if (type == DT_DIR && include_sub_dirs) {
+            sub_dirs->push_back({checked_path + name, checked_sub_dir + name});
+        }
+    }
+
+    closedir(dir_ptr);
+}
+
+
 bool FileSystemHelper::fileExists(const std::string &path) {
     struct stat buffer;
     int ret = stat(path.c_str(), &buffer);
@@ -188,6 +329,25 @@ void FileSystemHelper::cpFile(const std::string &origin, const std::string &dest
     src.close();
 }
 
+bool FileSystemHelper::mvFile(const std::string &origin, const std::string &dest) {
+    if (std::rename(origin.c_str(), dest.c_str()) == 0) {
+        return true;
+    }
+    if (errno != EXDEV) {
+        return false;
+    }
+
+    int64_t size = fileSize(origin);
+    std::string tmp = dest + ".tmp";
+    cpFile(origin, tmp);
+    if (size < 0 || fileSize(tmp) != size || std::rename(tmp.c_str(), dest.c_str()) != 0) {
+        rmFile(tmp);
+        return false;
+    }
+    rmFile(origin);
+    return true;
+}
+
 std::string FileSystemHelper::getCwd() {
     size_t currlen = PATH_LEN;
     char * path = (char *) malloc(sizeof(char)*currlen);
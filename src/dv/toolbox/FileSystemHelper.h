@@ -8,8 +8,11 @@
 #ifndef TOOLBOX_FILESYSTEMHELPER_H_
 #define TOOLBOX_FILESYSTEMHELPER_H_
 
+#include <cstdint>
+#include <ctime>
 #include <functional>
 #include <string>
+#include <vector>
 
 #define PATH_LEN 2048
 
@@ -53,6 +56,33 @@ namespace toolbox {
 							predicate_type accept_function = FileSystemHelper::acceptAll);
 
 
+		struct ScanEntry {
+			std::string name;
+			std::string rel_path;
+			std::string full_path;
+			int64_t size; // -1 if stat failed
+			time_t mtime; // 0 if stat failed
+		};
+
+		static constexpr unsigned int kMaxScanThreads = 16;
+
+		/**
+		 * Parallel alternative to readDir() for large trees: sub dirs are read by a pool of threads
+		 * (threads == 0: hardware concurrency, at most kMaxScanThreads); file sizes are determined
+		 * with fstatat() relative to the open dir. Same selection as readDir() (no hidden entries);
+		 * additionally, entries with unknown d_type are resolved with fstatat().
+		 * No predicate here: entries are appended in no particular order, to be filtered by the caller
+		 * (e.g. with calls into Lua, which must stay on the calling thread).
+		 * changed_since > 0: files are listed only in dirs modified at or after that time
+		 * (i.e. dirs where files may have been added since); sub dirs are visited in any case.
+		 */
+		static void scanDir(const std::string &path,
+							bool include_sub_dirs,
+							std::vector<ScanEntry> *entries,
+							unsigned int threads = 0,
+							time_t changed_since = 0);
+
+
 		/**
 		 * A simple test for file existence.
 		 * Uses stat().
@@ -120,6 +150,13 @@ namespace toolbox {
          */
         static void cpFile(const std::string &origin, const std::string &dest);
 
+        /**
+         * moves a file from origin to dest: rename; if they are on different file systems,
+         * copy (to dest.tmp, renamed when complete) and remove origin
+         * @return true if success
+         */
+        static bool mvFile(const std::string &origin, const std::string &dest);
+
 
         /**
          * get the current working directory 
@@ -127,6 +164,14 @@ namespace toolbox {
         static std::string getCwd();
 
 	private:
+		struct ScanDirItem {
+			std::string full_path;
+			std::string rel_path;
+		};
+
+		static void scanOneDir(const ScanDirItem &dir, bool include_sub_dirs, time_t changed_since,
+							   std::vector<ScanEntry> *entries, std::vector<ScanDirItem> *sub_dirs);
+
 		static void readDirRecursive(const std::string &path,
 							handle_file_type callback,
 							bool include_sub_dirs,
@@ -0,0 +1,254 @@
+//
+// Built-in LZ77 codec for files (no external dependency)
+//
+
+#include "LZCodec.h"
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+
+namespace toolbox {
+
+constexpr size_t LZCodec::kBlockSize;
+constexpr char LZCodec::kMagic[];
+constexpr size_t LZCodec::kMinMatch;
+constexpr size_t LZCodec::kMaxOffset;
+constexpr unsigned int LZCodec::kHashBits;
+
+namespace {
+
+inline uint32_t read32(const uint8_t *p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint8_t *writeLength(uint8_t *out, size_t len) {
+    for (; 255 <= len; len -= 255) {
+        *out++ = 255;
+    }
+    *out++ = static_cast<uint8_t>(len);
+    return out;
+}
+
+/**
+ * length nibble and extension bytes; false if the input ends early
+ */
+inline bool readLength(const uint8_t **ip, const uint8_t *iend, size_t *len) {
+    if (*len != 15) {
+        return true;
+    }
+    uint8_t b;
+    do {
+        if (iend <= *ip) {
+            return false;
+        }
+        b = *(*ip)++;
+        *len += b;
+    } while (b == 255);
+    return true;
+}
+
+/**
+ * literals followed by a match; match_len 0: literals only (last sequence)
+ */
+uint8_t *writeSequence(uint8_t *out, const uint8_t *literals, size_t literal_len, size_t offset, size_t match_len) {
+    uint8_t *token = out++;
+    size_t match_code = match_len == 0 ? 0 : match_len - 4;
+    *token = static_cast<uint8_t>(((literal_len < 15 ? literal_len : 15) << 4) | (match_code < 15 ? match_code : 15));
+
+    if (15 <= literal_len) {
+        out = writeLength(out, literal_len - 15);
+    }
+    std::memcpy(out, literals, literal_len);
+    out += literal_len;
+
+    if (match_len != 0) {
+        *out++ = static_cast<uint8_t>(offset & 0xff);
+        *out++ = static_cast<uint8_t>(offset >> 8);
+        if (15 <= match_code) {
+            out = writeLength(out, match_code - 15);
+        }
+    }
+    return out;
+}
+
+}
+
+size_t LZCodec::compress(const char *src, size_t n, char *dst) {
+    const uint8_t *in = reinterpret_cast<const uint8_t *>(src);
+    uint8_t *out = reinterpret_cast<uint8_t *>(dst);
+
+    // positions + 1; 0: empty
+    std::vector<uint32_t> table(1 << kHashBits, 0);
+    size_t anchor = 0;
+    size_t pos = 0;
+    size_t misses = 0;
+
+    while (pos + kMinMatch <= n) {
+        uint32_t seq = read32(in + pos);
+        uint32_t h = (seq * 2654435761u) >> (32 - kHashBits);
+        size_t candidate = table[h];
+        table[h] = static_cast<uint32_t>(pos + 1);
+
+        if (candidate != 0 && pos - (candidate - 1) <= kMaxOffset && read32(in + candidate - 1) == seq) {
+            --candidate;
+            size_t len = kMinMatch;
+            while (pos + len < n && in[candidate + len] == in[pos + len]) {
+                ++len;
+            }
+            out = writeSequence(out, in + anchor, pos - anchor, pos - candidate, len);
+            pos += len;
+            anchor = pos;
+            misses = 0;
+        } else {
+            // skip faster through incompressible data
+            pos += 1 + (misses++ >> 6);
+        }
+    }
+
+    out = writeSequence(out, in + anchor, n - anchor, 0, 0);
+    return out - reinterpret_cast<uint8_t *>(dst);
+}
+
+bool LZCodec::decompress(const char *src, size_t n, char *dst, size_t dst_size) {
+    const uint8_t *ip = reinterpret_cast<const uint8_t *>(src);
+    const uint8_t *iend = ip + n;
+    uint8_t *op = reinterpret_cast<uint8_t *>(dst);
+    uint8_t *ostart = op;
+    uint8_t *oend = op + dst_size;
+
+    while (ip < iend) {
+        uint8_t token = *ip++;
+
+        size_t literal_len = token >> 4;
+        if (!readLength(&ip, iend, &literal_len)
+            || static_cast<size_t>(iend - ip) < literal_len || static_cast<size_t>(oend - op) < literal_len) {
+            return false;
+        }
+        std::memcpy(op, ip, literal_len);
+        ip += literal_len;
+        op += literal_len;
+
+        // the last sequence has literals only
+        if (ip == iend) {
+            return op == oend;
+        }
+
+        if (iend - ip < 2) {
+            return false;
+        }
+        size_t offset = ip[0] | (static_cast<size_t>(ip[1]) << 8);
+        ip += 2;
+
+        size_t match_len = token & 15;
+        if (!readLength(&ip, iend, &match_len)) {
+            return false;
+        }
+        match_len += kMinMatch;
+
+        if (offset == 0 || static_cast<size_t>(op - ostart) < offset || static_cast<size_t>(oend - op) < match_len) {
+            return false;
+        }
+        const uint8_t *match = op - offset;
+        if (match_len <= offset) {
+            std::memcpy(op, match, match_len);
+            op += match_len;
+        } else {
+            // overlapping: repeats the last offset bytes
+            for (size_t i = 0; i < match_len; ++i) {
+                *op++ = match[i];
+            }
+        }
+    }
+    return false;
+}
+
+bool LZCodec::compressFile(const std::string &in, const std::string &out) {
+    FILE *fin = fopen(in.c_str(), "rb");
+    if (fin == nullptr) {
+        return false;
+    }
+    FILE *fout = fopen(out.c_str(), "wb");
+    if (fout == nullptr) {
+        fclose(fin);
+        return false;
+    }
+
+    std::unique_ptr<char[]> raw(new char[kBlockSize]);
+    std::unique_ptr<char[]> packed(new char[maxCompressedSize(kBlockSize)]);
+    bool ok = fwrite(kMagic, 1, 8, fout) == 8;
+
+    size_t len;
+    while (ok && (len = fread(raw.get(), 1, kBlockSize, fin)) > 0) {
+        size_t packed_len = compress(raw.get(), len, packed.get());
+        const char *data = packed_len < len ? packed.get() : raw.get();
+        uint32_t sizes[2] = {static_cast<uint32_t>(len), static_cast<uint32_t>(packed_len < len ? packed_len : len)};
+        ok = fwrite(sizes, sizeof(uint32_t), 2, fout) == 2 && fwrite(data, 1, sizes[1], fout) == sizes[1];
+    }
+    ok = ok && !ferror(fin);
+
+    uint32_t end[2] = {0, 0};
+    ok = ok && fwrite(end, sizeof(uint32_t), 2, fout) == 2;
+    ok = fclose(fout) == 0 && ok;
+    fclose(fin);
+
+    if (!ok) {
+        std::remove(out.c_str());
+    }
+    return ok;
+}
+
+bool LZCodec::decompressFile(const std::string &in, const std::string &out) {
+    FILE *fin = fopen(in.c_str(), "rb");
+    if (fin == nullptr) {
+        return false;
+    }
+
+    char magic[8];
+    if (fread(magic, 1, 8, fin) != 8 || std::memcmp(magic, kMagic, 8) != 0) {
+        std::cerr << "LZCodec: " << in << " is not a compressed file" << std::endl;
+        fclose(fin);
+        return false;
+    }
+
+    FILE *fout = fopen(out.c_str(), "wb");
+    if (fout == nullptr) {
+        fclose(fin);
+        return false;
+    }
+
+    std::unique_ptr<char[]> raw(new char[kBlockSize]);
+    std::unique_ptr<char[]> packed(new char[kBlockSize]);
+    bool ok = true;
+    while (ok) {
+        uint32_t sizes[2];
+        ok = fread(sizes, sizeof(uint32_t), 2, fin) == 2;
+        if (!ok || sizes[0] == 0) {
+            break;
+        }
+        ok = sizes[0] <= kBlockSize && sizes[1] <= sizes[0]
+             && fread(packed.get(), 1, sizes[1], fin) == sizes[1];
+        if (ok && sizes[1] == sizes[0]) {
+            ok = fwrite(packed.get(), 1, sizes[0], fout) == sizes[0];
+        } else if (ok) {
+            ok = decompress(packed.get(), sizes[1], raw.get(), sizes[0])
+                 && fwrite(raw.get(), 1, sizes[0], fout) == sizes[0];
+        }
+    }
+
+    ok = fclose(fout) == 0 && ok;
+    fclose(fin);
+
+    if (!ok) {
+        std::cerr << "LZCodec: " << in << " is damaged" << std::endl;
+        std::remove(out.c_str());
+    }
+    return ok;
+}
+
+}
@@ -0,0 +1,58 @@
+//
+// Built-in LZ77 codec for files (no external dependency)
+//
+
+#ifndef TOOLBOX_LZCODEC_H_
+#define TOOLBOX_LZCODEC_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+
+namespace toolbox {
+
+	/**
+	 * Byte oriented LZ77 codec in the spirit of LZ4: sequences of a token (literal and match
+	 * length nibbles), literals, 16 bit offset and length extensions. It favors speed over ratio:
+	 * incompressible data is skipped quickly, and blocks that do not shrink are stored as is.
+	 *
+	 * File format: magic "DVLZ0001", blocks of at most kBlockSize input bytes
+	 * (uint32 raw size, uint32 stored size, data; stored size == raw size: uncompressed),
+	 * a block with raw size 0 ends the file. Sizes in host byte order.
+	 */
+	class LZCodec {
+	public:
+		static constexpr size_t kBlockSize = 1 << 20;
+
+		static size_t maxCompressedSize(size_t n) {
+			return n + n / 255 + 16;
+		}
+
+		/**
+		 * dst must provide maxCompressedSize(n) bytes; returns the compressed size
+		 */
+		static size_t compress(const char *src, size_t n, char *dst);
+
+		/**
+		 * true if src decodes to exactly dst_size bytes; malformed input is rejected
+		 */
+		static bool decompress(const char *src, size_t n, char *dst, size_t dst_size);
+
+		/**
+		 * true on success; on failure, a partially written out file is removed
+		 */
+		static bool compressFile(const std::string &in, const std::string &out);
+
+		static bool decompressFile(const std::string &in, const std::string &out);
+
+	private:
+		static constexpr char kMagic[] = "DVLZ0001";
+		static constexpr size_t kMinMatch = 4;
+		static constexpr size_t kMaxOffset = 65535;
+		static constexpr unsigned int kHashBits = 16;
+	};
+
+}
+
+#endif //TOOLBOX_LZCODEC_H_
@@ -43,8 +43,9 @@ namespace toolbox {
 	 * there is some cost with copying of the internal buffers of the used containers.
 	 *
 	 * It also allows a refresh() of an entry by key, i.e. lookup by key and then move to MRU position,
-	 * without the need to remove and reinsert the element. While there is a clear() method,
-	 * no erase() method is defined on purpose.
+	 * without the need to remove and reinsert the element. Single entries are removed by id with
+	 * erase() (e.g. capacity reduction of FileCacheLRU, ghost lists of FileCacheFifoWrapper);
+	 * the freed ids are reused by add().
 	 *
 	 * The implementation keeps the values stored without movements. The list is also kept as
 	 * vector to keep index values as close as possible.
@@ -314,6 +315,21 @@ namespace toolbox {
 		}
 
 
+		/**
+		 * Applies the function to all keys and values in LRU -> MRU order.
+		 */
+		void forEach(std::function<void(const K &, const V &)> function) const {
+			ID_type max = size();
+			ID_type index = 0;
+			ID_type current = first_;
+			while (index < max) {
+				function(list_[current].key, store_[current]);
+				current = list_[current].next;
+				++index;
+			}
+		}
+
+
 		void erase(ID_type id) {
 #ifdef LM_APPLY_CHECKS
 			if (size() <= 0) {
@@ -0,0 +1,314 @@
+//
+// Persistent string index: append-only log and sorted, memory-mapped table
+//
+
+#include "PersistentIndex.h"
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+
+namespace toolbox {
+
+constexpr size_t PersistentIndex::kCompactionThreshold;
+
+PersistentIndex::~PersistentIndex() {
+    close();
+}
+
+bool PersistentIndex::open(const std::string &base_path) {
+    close();
+
+    table_path_ = base_path + ".table";
+    log_path_ = base_path + ".log";
+
+    struct stat buffer;
+    is_new_ = stat(table_path_.c_str(), &buffer) != 0 && stat(log_path_.c_str(), &buffer) != 0;
+
+    if (!mapTable() || !openLog()) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool PersistentIndex::isNew() const {
+    return is_new_;
+}
+
+bool PersistentIndex::set(const std::string &key, const std::string &value) {
+    if (log_fd_ < 0 || key.empty() || key.find_first_of("\t\n") != std::string::npos
+        || value.find_first_of("\t\n") != std::string::npos) {
+        return false;
+    }
+
+    std::string current;
+    if (get(key, &current) && current == value) {
+        return true;
+    }
+
+    // a single write: O_APPEND keeps lines of concurrent writers (e.g. passive DV and simfs index)
+    // apart; the shared lock keeps appends out of the compaction of another process
+    std::string line = key + "\t" + value + "\n";
+    flock(log_fd_, LOCK_SH);
+    bool ok = write(log_fd_, line.data(), line.size()) == static_cast<ssize_t>(line.size());
+    flock(log_fd_, LOCK_UN);
+    if (!ok) {
+        std::cerr << "PersistentIndex: could not append to " << log_path_ << std::endl;
+        return false;
+    }
+    log_entries_[key] = value;
+
+    if (kCompactionThreshold <= log_entries_.size()) {
+        return compact();
+    }
+    return true;
+}
+
+bool PersistentIndex::get(const std::string &key, std::string *value) const {
+    auto it = log_entries_.find(key);
+    if (it != log_entries_.end()) {
+        *value = it->second;
+        return true;
+    }
+
+    size_t offset = lowerBound(key);
+    if (offset == table_size_) {
+        return false;
+    }
+
+    std::string table_key;
+    readLine(offset, &table_key, value);
+    return table_key == key;
+}
+
+void PersistentIndex::forEachWithPrefix(const std::string &prefix, PersistentIndex::handle_entry_type callback) const {
+    // merge of table and log entries; log entries win
+    auto it = log_entries_.lower_bound(prefix);
+    size_t offset = lowerBound(prefix);
+    std::string key;
+    std::string value;
+    bool has_table_entry = false;
+
+    while (true) {
+        if (!has_table_entry && offset < table_size_) {
+            offset = readLine(offset, &key, &value);
+            has_table_entry = key.compare(0, prefix.size(), prefix) == 0;
+            if (!has_table_entry) {
+                offset = table_size_;
+            }
+        }
+
+        bool has_log_entry = it != log_entries_.end() && it->first.compare(0, prefix.size(), prefix) == 0;
+        if (!has_table_entry && !has_log_entry) {
+            return;
+        }
+
+        if (has_log_entry && (!has_table_entry || it->first <= key)) {
+            if (has_table_entry && it->first == key) {
+                has_table_entry = false;
+            }
+            callback(it->first, it->second);
+            ++it;
+        } else {
+            callback(key, value);
+            has_table_entry = false;
+        }
+    }
+}
+
+bool PersistentIndex::compact() {
+    if (log_fd_ < 0) {
+        return false;
+    }
+
+    flock(log_fd_, LOCK_EX);
+
+    // entries appended by other processes, and the table they may have compacted meanwhile
+    unmapTable();
+    if (!mapTable() || !readLog()) {
+        flock(log_fd_, LOCK_UN);
+        return false;
+    }
+    if (log_entries_.empty()) {
+        flock(log_fd_, LOCK_UN);
+        return true;
+    }
+
+    std::string tmp_path = table_path_ + ".tmp";
+    FILE *out = fopen(tmp_path.c_str(), "w");
+    if (out == nullptr) {
+        std::cerr << "PersistentIndex: could not write " << tmp_path << std::endl;
+        flock(log_fd_, LOCK_UN);
+        return false;
+    }
+
+    bool ok = true;
+    auto write_line = [&](const std::string &key, const std::string &value) {
+        ok = ok && fprintf(out, "%s\t%s\n", key.c_str(), value.c_str()) >= 0;
+    };
+    forEachWithPrefix("", write_line);
+
+    ok = fflush(out) == 0 && fsync(fileno(out)) == 0 && ok;
+    ok = fclose(out) == 0 && ok;
+    if (!ok || std::rename(tmp_path.c_str(), table_path_.c_str()) != 0) {
+        std::cerr << "PersistentIndex: compaction into " << table_path_ << " failed" << std::endl;
+        std::remove(tmp_path.c_str());
+        flock(log_fd_, LOCK_UN);
+        return false;
+    }
+
+    // the log is only truncated once the new table is in place
+    unmapTable();
+    ok = mapTable();
+    if (ok) {
+        if (ftruncate(log_fd_, 0) != 0) {
+            std::cerr << "PersistentIndex: could not truncate " << log_path_ << std::endl;
+        }
+        log_entries_.clear();
+    }
+    flock(log_fd_, LOCK_UN);
+    return ok;
+}
+
+void PersistentIndex::close() {
+    if (log_fd_ >= 0) {
+        ::close(log_fd_);
+        log_fd_ = -1;
+    }
+    log_entries_.clear();
+    unmapTable();
+}
+
+bool PersistentIndex::mapTable() {
+    int fd = ::open(table_path_.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        // no table yet
+        return errno == ENOENT;
+    }
+
+    struct stat buffer;
+    if (fstat(fd, &buffer) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    table_size_ = buffer.st_size;
+    if (table_size_ == 0) {
+        ::close(fd);
+        return true;
+    }
+
+    void *map = mmap(nullptr, table_size_, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        std::cerr << "PersistentIndex: could not map " << table_path_ << std::endl;
+        table_size_ = 0;
+        return false;
+    }
+    table_ = static_cast<const char *>(map);
+
+    // a table without final newline cannot come from compact()
+    if (table_[table_size_ - 1] != '\n') {
+        std::cerr << "PersistentIndex: " << table_path_ << " is damaged" << std::endl;
+        unmapTable();
+        return false;
+    }
+    return true;
+}
+
+void PersistentIndex::unmapTable() {
+    if (table_ != nullptr) {
+        munmap(const_cast<char *>(table_), table_size_);
+    }
+    table_ = nullptr;
+    table_size_ = 0;
+}
+
+bool PersistentIndex::openLog() {
+    log_fd_ = ::open(log_path_.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (log_fd_ < 0) {
+        std::cerr << "PersistentIndex: could not open " << log_path_ << std::endl;
+        return false;
+    }
+
+    // exclusive: a partial last line may be cut
+    flock(log_fd_, LOCK_EX);
+    bool ok = readLog();
+    flock(log_fd_, LOCK_UN);
+    return ok;
+}
+
+bool PersistentIndex::readLog() {
+    std::string content;
+    char buffer[65536];
+    ssize_t len;
+    while ((len = pread(log_fd_, buffer, sizeof(buffer), content.size())) > 0) {
+        content.append(buffer, len);
+    }
+
+    // partial last line of an interrupted write
+    size_t end = content.rfind('\n');
+    end = end == std::string::npos ? 0 : end + 1;
+    if (end < content.size() && ftruncate(log_fd_, end) != 0) {
+        return false;
+    }
+
+    size_t pos = 0;
+    while (pos < end) {
+        size_t eol = content.find('\n', pos);
+        size_t tab = content.find('\t', pos);
+        if (tab < eol) {
+            log_entries_[content.substr(pos, tab - pos)] = content.substr(tab + 1, eol - tab - 1);
+        }
+        pos = eol + 1;
+    }
+    return true;
+}
+
+size_t PersistentIndex::lowerBound(const std::string &key) const {
+    // lo and hi are always at line starts
+    size_t lo = 0;
+    size_t hi = table_size_;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        size_t start = mid;
+        while (lo < start && table_[start - 1] != '\n') {
+            --start;
+        }
+
+        const char *line = table_ + start;
+        const char *tab = static_cast<const char *>(memchr(line, '\t', table_size_ - start));
+        size_t key_len = tab != nullptr ? tab - line : 0;
+        int cmp = key.compare(0, std::string::npos, line, key_len);
+        if (0 < cmp) {
+            const char *eol = static_cast<const char *>(memchr(line, '\n', table_size_ - start));
+            lo = eol - table_ + 1;
+        } else {
+            hi = start;
+        }
+    }
+    return lo;
+}
+
+size_t PersistentIndex::readLine(size_t offset, std::string *key, std::string *value) const {
+    const char *line = table_ + offset;
+    const char *eol = static_cast<const char *>(memchr(line, '\n', table_size_ - offset));
+    const char *tab = static_cast<const char *>(memchr(line, '\t', eol - line));
+    if (tab == nullptr) {
+        tab = eol;
+    }
+    key->assign(line, tab - line);
+    value->assign(tab == eol ? eol : tab + 1, eol);
+    return eol - table_ + 1;
+}
+
+}
@@ -0,0 +1,107 @@
+//
+// Persistent string index: append-only log and sorted, memory-mapped table
+//
+
+#ifndef TOOLBOX_PERSISTENTINDEX_H_
+#define TOOLBOX_PERSISTENTINDEX_H_
+
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <string>
+
+
+namespace toolbox {
+
+	/**
+	 * Key value index kept in two files next to each other:
+	 * - <base>.table: sorted lines "key\tvalue\n"; memory-mapped, lookups by binary search
+	 * - <base>.log: lines of the same format appended by set() with a single write each
+	 *
+	 * Entries of the log are held in memory (sorted) and win over the table. compact() merges them
+	 * into a new table (temporary file + rename) and truncates the log; it runs automatically
+	 * when the log reaches kCompactionThreshold entries, otherwise only when called explicitly
+	 * (e.g. at the shutdown of a passive DV). close() leaves the log as it is: each set() has
+	 * already written its line. After a crash, the log is replayed on open (a partial last line
+	 * is dropped), and a log that survived a compaction only repeats entries already in the table.
+	 *
+	 * Thus, point and prefix lookups need no full load, and single updates no full rewrite.
+	 * Keys and values must not contain '\t' or '\n'. Not thread-safe.
+	 */
+	class PersistentIndex {
+	public:
+		typedef std::function<void(const std::string &key, const std::string &value)> handle_entry_type;
+
+		static constexpr size_t kCompactionThreshold = 65536;
+
+		PersistentIndex() {}
+
+		~PersistentIndex();
+
+		PersistentIndex(const PersistentIndex &) = delete;
+		PersistentIndex &operator=(const PersistentIndex &) = delete;
+
+		/**
+		 * opens (creates) the index; true on success
+		 */
+		bool open(const std::string &base_path);
+
+		/**
+		 * true if neither table nor log existed when opened
+		 */
+		bool isNew() const;
+
+		bool set(const std::string &key, const std::string &value);
+
+		/**
+		 * true if found
+		 */
+		bool get(const std::string &key, std::string *value) const;
+
+		/**
+		 * all entries whose key starts with prefix, sorted by key
+		 */
+		void forEachWithPrefix(const std::string &prefix, handle_entry_type callback) const;
+
+		bool compact();
+
+		/**
+		 * closes the files without compaction
+		 */
+		void close();
+
+	private:
+		std::string table_path_;
+		std::string log_path_;
+		bool is_new_ = false;
+
+		int log_fd_ = -1;
+		std::map<std::string, std::string> log_entries_;
+
+		const char *table_ = nullptr;
+		size_t table_size_ = 0;
+
+		bool mapTable();
+		void unmapTable();
+
+		bool openLog();
+
+		/**
+		 * (re-)reads all entries of the log; a partial last line is dropped
+		 */
+		bool readLog();
+
+		/**
+		 * first line of the table with key >= key; table_size_ if there is none
+		 */
+		size_t lowerBound(const std::string &key) const;
+
+		/**
+		 * splits the line at offset into key and value; returns the offset of the next line
+		 */
+		size_t readLine(size_t offset, std::string *key, std::string *value) const;
+	};
+
+}
+
+#endif //TOOLBOX_PERSISTENTINDEX_H_
@@ -1,5 +1,6 @@
 #define _DEFAULT_SOURCE
 
+#include <stddef.h> /* offsetof */
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -25,10 +26,20 @@
 #include "dvl.h"
 #include "dvl_internal.h"
 #include "dvl_proxy.h"
+#include "dvl_shm.h"
+#include "dvl_lease.h"
+#include "dvl_report.h"
+#include "dvl_lcache.h"
+#include "dvl_readahead.h"
+#include "dvl_block.h"
 
 
 #define MAX(a,b) (((a) > (b)) ? (a) : (b))
 
+static void init_path_cache(void);
+static char * normalize_path(const char * path, char * npath);
+static void init_file_table(void);
+
 #ifdef __MT__
 pthread_rwlock_t init_lock = PTHREAD_RWLOCK_INITIALIZER;
 volatile int init = 0;
@@ -139,6 +150,10 @@ int dvl_init(){
 #ifdef __NCMPI__
     // pnetcdf case: only rank 0 communicates with server and then broadcasts the respath to the other ranks, if possible
     // implementation follows the netcdf case below
+    dvl.ncmpi_collective = DVL_NCMPI_AGGREGATED;
+    if (getenv(ENV_NCMPI_COLLECTIVE) != NULL) {
+        dvl.ncmpi_collective = atoi(getenv(ENV_NCMPI_COLLECTIVE));
+    }
 
     if (mpi_comm_avail) {
         MPI_Comm_rank(mpi_comm, &mpi_rank);
@@ -231,6 +246,19 @@ int dvl_init(){
     if (dvl.is_simulator) dvl.gni.myrank = dvl.jobid;
     else dvl.gni.myrank = rank;
 
+#ifndef __HDF5__
+    /* optional: block store of DV (see dvl_block.h) */
+    char * block_store = strsep(&buffptr, DVL_MSG_SEP);
+    char * block_max_size = strsep(&buffptr, DVL_MSG_SEP);
+    dvl_block_init(block_store, block_max_size);
+
+    /* optional: staging area of DV for new result files (see dvl_staged_path()) */
+    char * staging_path = strsep(&buffptr, DVL_MSG_SEP);
+    if (!dvl.is_simulator && staging_path != NULL && strlen(staging_path) < MAX_FILE_NAME) {
+        memcpy(dvl.staging_path, staging_path, strlen(staging_path) + 1);
+    }
+#endif
+
 #ifdef RDMA
     dvl_gni_init(&dvl.gni); 
     
@@ -248,6 +276,11 @@ int dvl_init(){
 
 #endif //__NCMPI__
 
+    init_path_cache();
+    dvl_lease_init();
+    dvl_report_init();
+    dvl_lcache_init();
+    dvl_readahead_init();
 
     atexit(dvl_finalize);
     signal(SIGINT, dvl_sig_finalize);
@@ -256,17 +289,7 @@ int dvl_init(){
     //printf("Init data structures\n");
 
     /* initialize free file structures */
-#ifdef __MT__
-    if (pthread_rwlock_init(&dvl.open_files_lock, NULL) != 0) fatal("dvl_init(): can't create rwlock");
-#endif    
-    for (int i = 0; i < (MAX_OPEN_FILES - 1); i++){
-        dvl.open_files[i].trash_next = &(dvl.open_files[i + 1]);
-        dvl.open_files[i].id = i;
-    }
-
-    dvl.open_files[MAX_OPEN_FILES - 1].trash_next = NULL;
-    dvl.free_files = dvl.open_files;
-    dvl.open_files_idx = NULL;
+    init_file_table();
 
 
     /* initialize redirect file structures */
@@ -305,6 +328,7 @@ int dvl_init(){
     
     /* finalized setting: both only on simulator side at the moment */
     dvl.finalized = 0;
+    dvl.report_puts_count = 0;
     dvl.open_files_count = 0;
     
     printf("[DVLIB] initialized!\n");
@@ -397,6 +421,19 @@ void dvl_finalize(void){
 #endif
 
 
+    // access events not yet reported (clients only; no-op otherwise)
+    dvl_report_flush();
+
+    dvl_shm_release();
+
+    dvl_lcache_finalize();
+    dvl_readahead_finalize();
+
+    if (dvl.path_cache_mode != DVL_PATH_CACHE_OFF) {
+        DVLPRINT("[DVLIB] path cache: %lu hits, %lu misses, %u entries\n",
+                 (unsigned long) dvl.path_cache_hits, (unsigned long) dvl.path_cache_misses, dvl.path_cache_count);
+    }
+
 #if defined(BENCH) || defined(PROFILE)
     LSB_Finalize();
 #endif
@@ -414,36 +451,521 @@ int64_t file_size(const char *path) {
     return (int64_t)buffer.st_size;
 }
 
-//--- COSMO specific part ------------------------------------------------------
+const char * dvl_staged_path(const char * path, char * buff) {
+    if (dvl.staging_path[0] == '\0') return NULL;
 
-char * is_result_file_COSMO(const char * path, char * npath){
-    //char abspath[MAX_FILE_NAME];
+    size_t len = strlen(dvl.staging_path);
+    int sep = dvl.staging_path[len - 1] != '/' && path[0] != '/';
+    if (snprintf(buff, MAX_FILE_NAME, sep ? "%s/%s" : "%s%s", dvl.staging_path, path) >= MAX_FILE_NAME) return NULL;
+    if (access(buff, F_OK) != 0) return NULL;
+    return buff;
+}
+
+void dvl_report_puts_add(int id) {
+    if (dvl.report_puts_count < MAX_REPORT_PUTS_FILES) {
+        dvl.report_puts_ids[dvl.report_puts_count++] = id;
+    }
+}
+
+int dvl_report_puts_find(int id) {
+    for (uint32_t i = 0; i < dvl.report_puts_count; i++) {
+        if (dvl.report_puts_ids[i] == id) return 1;
+    }
+    return 0;
+}
+
+void dvl_report_puts_remove(int id) {
+    for (uint32_t i = 0; i < dvl.report_puts_count; i++) {
+        if (dvl.report_puts_ids[i] == id) {
+            dvl.report_puts_ids[i] = dvl.report_puts_ids[--dvl.report_puts_count];
+            return;
+        }
+    }
+}
+
+//--- open file table ----------------------------------------------------------
+
+#ifdef __MT__
+// entries are taken from / returned to a per-thread free list first; the shared pool
+// is only locked when the local list is empty or too long
+static __thread dvl_file_t * local_free_files = NULL;
+static __thread uint32_t local_free_count = 0;
+
+// thread exit: the local list goes back to the shared pool (see local_free_thread_exit())
+static pthread_key_t local_free_key;
+
+static void local_free_thread_exit(void * ptr){
+    if (local_free_files == NULL) return;
+
+    pthread_mutex_lock(&dvl.file_pool_lock);
+    while (local_free_files != NULL) {
+        dvl_file_t * f = local_free_files;
+        local_free_files = f->trash_next;
+        f->trash_next = dvl.free_files;
+        dvl.free_files = f;
+    }
+    local_free_count = 0;
+    pthread_mutex_unlock(&dvl.file_pool_lock);
+}
+#endif
+
+static void init_file_table(void) {
+    for (int i = 0; i < DVL_FILE_SHARDS; i++) {
+#ifdef __MT__
+        if (pthread_rwlock_init(&dvl.file_shards[i].lock, NULL) != 0) fatal("dvl_init(): can't create rwlock");
+#endif
+        dvl.file_shards[i].idx = NULL;
+    }
+
+    for (int i = 0; i < DVL_PATH_SHARDS; i++) {
+#ifdef __MT__
+        if (pthread_mutex_init(&dvl.path_shards[i].lock, NULL) != 0) fatal("dvl_init(): can't create mutex");
+#endif
+        dvl.path_shards[i].idx = NULL;
+    }
+
+#ifdef __MT__
+    if (pthread_mutex_init(&dvl.file_pool_lock, NULL) != 0) fatal("dvl_init(): can't create mutex");
+    if (pthread_key_create(&local_free_key, local_free_thread_exit) != 0) fatal("dvl_init(): can't create key");
+#endif
+    dvl.free_files = NULL;
+    dvl.open_files_allocated = 0;
+    dvl.open_files_active = 0;
+}
+
+static inline dvl_file_shard_t * file_shard(dvl_file_key_t key) {
+    // Fibonacci hashing: consecutive ids are spread over all shards
+    uint64_t h = (uint64_t) key * 0x9E3779B97F4A7C15ULL;
+    return &dvl.file_shards[(h >> 32) & (DVL_FILE_SHARDS - 1)];
+}
+
+/* adds a chunk of entries to the shared pool; called with file_pool_lock held (MT) */
+static void grow_file_pool(void) {
+    dvl_file_t * chunk = malloc(DVL_FILE_CHUNK * sizeof(dvl_file_t));
+    if (chunk == NULL) fatal("dvl_file_new(): out of memory");
+
+    for (int i = 0; i < (DVL_FILE_CHUNK - 1); i++) {
+        chunk[i].trash_next = &(chunk[i + 1]);
+    }
+    chunk[DVL_FILE_CHUNK - 1].trash_next = dvl.free_files;
+    dvl.free_files = chunk;
+    dvl.open_files_allocated += DVL_FILE_CHUNK;
+}
+
+static inline uint32_t path_shard_index(const char * path, size_t pathlen) {
+    // FNV-1a
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < pathlen; i++) {
+        h = (h ^ (unsigned char) path[i]) * 16777619u;
+    }
+    return h & (DVL_PATH_SHARDS - 1);
+}
+
+/* interns the path; MT: takes the lock of the shard of the path */
+static const char * intern_path(const char * path, size_t pathlen) {
+    uint32_t shard = path_shard_index(path, pathlen);
+    dvl_path_shard_t * s = &dvl.path_shards[shard];
+    dvl_path_t * p = NULL;
+
+#ifdef __MT__
+    pthread_mutex_lock(&s->lock);
+#endif
+    HASH_FIND(hh, s->idx, path, pathlen, p);
+    if (p == NULL) {
+        p = malloc(sizeof(dvl_path_t) + pathlen + 1);
+        if (p == NULL) fatal("dvl_file_new(): out of memory");
+        memcpy(p->path, path, pathlen + 1);
+        p->refs = 0;
+        p->shard = shard;
+        HASH_ADD_KEYPTR(hh, s->idx, p->path, pathlen, p);
+    }
+
+#ifdef __MT__
+    __sync_fetch_and_add(&p->refs, 1);
+    pthread_mutex_unlock(&s->lock);
+#else
+    p->refs++;
+#endif
+    return p->path;
+}
+
+/* path must be interned; MT: takes the lock of its shard for the last reference only */
+static void release_path(const char * path) {
+    dvl_path_t * p = (dvl_path_t *) (path - offsetof(dvl_path_t, path));
+    dvl_path_shard_t * s = &dvl.path_shards[p->shard];
+#ifdef __MT__
+    // not the last reference: nobody can remove the path meanwhile
+    uint32_t refs = *(volatile uint32_t *) &p->refs;
+    while (1 < refs) {
+        uint32_t seen = __sync_val_compare_and_swap(&p->refs, refs, refs - 1);
+        if (seen == refs) return;
+        refs = seen;
+    }
+
+    // the last reference: intern_path() may find the path again until it is removed under the lock
+    pthread_mutex_lock(&s->lock);
+    if (__sync_sub_and_fetch(&p->refs, 1) == 0) {
+        HASH_DEL(s->idx, p);
+        free(p);
+    }
+    pthread_mutex_unlock(&s->lock);
+#else
+    p->refs--;
+    if (p->refs == 0) {
+        HASH_DEL(s->idx, p);
+        free(p);
+    }
+#endif
+}
+
+dvl_file_t * dvl_file_new(const char * path) {
+    size_t pathlen = strlen(path);
+    if (pathlen >= MAX_FILE_NAME){
+        printf("Error: file name too long: %s\n", path);
+        DVL_ABORT;
+    }
+
+    dvl_file_t * dfile;
+
+#ifdef __MT__
+    // the shared pool is locked only to refill an empty thread-local list (half of it)
+    if (local_free_files == NULL) {
+        pthread_mutex_lock(&dvl.file_pool_lock);
+        for (int i = 0; i < DVL_FILE_LOCAL_FREE / 2; i++) {
+            if (dvl.free_files == NULL) grow_file_pool();
+            dfile = dvl.free_files;
+            dvl.free_files = dfile->trash_next;
+            dfile->trash_next = local_free_files;
+            local_free_files = dfile;
+            local_free_count++;
+        }
+        pthread_mutex_unlock(&dvl.file_pool_lock);
+        // any non-NULL value: the destructor runs at thread exit
+        pthread_setspecific(local_free_key, &local_free_files);
+    }
+    const char * ipath = intern_path(path, pathlen);
+
+    dfile = local_free_files;
+    local_free_files = dfile->trash_next;
+    local_free_count--;
+#else
+    if (dvl.free_files == NULL) grow_file_pool();
+    dfile = dvl.free_files;
+    dvl.free_files = dfile->trash_next;
+    const char * ipath = intern_path(path, pathlen);
+#endif
+
+    memset(dfile, 0, sizeof(dvl_file_t));
+    dfile->path = ipath;
+    return dfile;
+}
+
+void dvl_file_delete(dvl_file_t * dfile) {
+#ifdef __MT__
+    release_path(dfile->path);
+    dfile->path = NULL;
+
+    dfile->trash_next = local_free_files;
+    local_free_files = dfile;
+    local_free_count++;
+    if (local_free_count == 1) {
+        // e.g. a thread that closes files opened by others
+        pthread_setspecific(local_free_key, &local_free_files);
+    }
+
+    if (DVL_FILE_LOCAL_FREE < local_free_count) {
+        // return half of the local list to the shared pool
+        pthread_mutex_lock(&dvl.file_pool_lock);
+        while (DVL_FILE_LOCAL_FREE / 2 < local_free_count) {
+            dvl_file_t * f = local_free_files;
+            local_free_files = f->trash_next;
+            local_free_count--;
+            f->trash_next = dvl.free_files;
+            dvl.free_files = f;
+        }
+        pthread_mutex_unlock(&dvl.file_pool_lock);
+    }
+#else
+    release_path(dfile->path);
+    dfile->path = NULL;
+    dfile->trash_next = dvl.free_files;
+    dvl.free_files = dfile;
+#endif
+}
+
+void dvl_file_add(dvl_file_t * dfile) {
+    dvl_file_shard_t * shard = file_shard(dfile->key);
+    HASH_ADD(hh, shard->idx, key, sizeof(dvl_file_key_t), dfile);
+#ifdef __MT__
+    __sync_fetch_and_add(&dvl.open_files_active, 1);
+#else
+    dvl.open_files_active++;
+#endif
+}
+
+dvl_file_t * dvl_file_find(dvl_file_key_t key) {
+    dvl_file_t * dfile = NULL;
+    dvl_file_shard_t * shard = file_shard(key);
+    HASH_FIND(hh, shard->idx, &key, sizeof(dvl_file_key_t), dfile);
+    return dfile;
+}
+
+void dvl_file_remove(dvl_file_t * dfile) {
+    dvl_file_shard_t * shard = file_shard(dfile->key);
+    HASH_DEL(shard->idx, dfile);
+#ifdef __MT__
+    __sync_fetch_and_sub(&dvl.open_files_active, 1);
+#else
+    dvl.open_files_active--;
+#endif
+}
+
+const char * dvl_path_ref(const char * path) {
+    // the caller holds a reference: the path cannot be removed meanwhile
+    dvl_path_t * p = (dvl_path_t *) (path - offsetof(dvl_path_t, path));
+#ifdef __MT__
+    __sync_fetch_and_add(&p->refs, 1);
+#else
+    p->refs++;
+#endif
+    return path;
+}
+
+void dvl_path_unref(const char * path) {
+    release_path(path);
+}
+
+#ifdef __MT__
+void dvl_files_rdlock(dvl_file_key_t key) {
+    if (pthread_rwlock_rdlock(&file_shard(key)->lock) != 0) fatal("dvl_files_rdlock(): can't get rdlock");
+}
+
+void dvl_files_wrlock(dvl_file_key_t key) {
+    if (pthread_rwlock_wrlock(&file_shard(key)->lock) != 0) fatal("dvl_files_wrlock(): can't get wrlock");
+}
+
+void dvl_files_unlock(dvl_file_key_t key) {
+    pthread_rwlock_unlock(&file_shard(key)->lock);
+}
+#endif
 
+//--- path normalization -------------------------------------------------------
+
+/* normalizes a prefix path in place (realpath) and keeps a trailing '/' if given,
+   since the relative paths sent to DV are built by cutting off the prefix */
+static size_t normalize_prefix(char * prefix) {
+    char npath[MAX_FILE_NAME];
+    size_t len = strlen(prefix);
+
+    if (0 < len && realpath(prefix, npath) != NULL) {
+        size_t nlen = strlen(npath);
+        int slash = prefix[len - 1] == '/' && npath[nlen - 1] != '/';
+        if (nlen + slash < MAX_FILE_NAME) {
+            memcpy(prefix, npath, nlen + 1);
+            if (slash) {
+                prefix[nlen] = '/';
+                prefix[nlen + 1] = '\0';
+            }
+            len = nlen + slash;
+        }
+    }
+
+    return len;
+}
+
+static void init_path_cache(void) {
+    dvl.respath_len = normalize_prefix(dvl.respath);
+    dvl.checkpoint_path_len = normalize_prefix(dvl.checkpoint_path);
+
+    dvl.path_cache_mode = DVL_PATH_CACHE_ON;
+    if (getenv(ENV_PATH_CACHE) != NULL) {
+        dvl.path_cache_mode = atoi(getenv(ENV_PATH_CACHE));
+    }
+    dvl.path_cache_count = 0;
+    dvl.path_cache_hits = 0;
+    dvl.path_cache_misses = 0;
+    dvl.path_cache_idx = NULL;
+    dvl.path_cache_hand = NULL;
+
+#ifdef __MT__
+    if (pthread_rwlock_init(&dvl.path_cache_lock, NULL) != 0) fatal("dvl_init(): can't create rwlock");
+#endif
+}
+
+/* drops one entry (clock / second chance: the first one without a hit since the hand
+   passed it); called with write lock held (MT) */
+static void evict_path_entry(void) {
+    dvl_path_entry_t *e = dvl.path_cache_hand != NULL ? dvl.path_cache_hand : dvl.path_cache_idx;
+    while (e->referenced) {
+        e->referenced = 0;
+        e = e->hh.next != NULL ? (dvl_path_entry_t *) e->hh.next : dvl.path_cache_idx;
+    }
+
+    dvl.path_cache_hand = (dvl_path_entry_t *) e->hh.next;
+    HASH_DEL(dvl.path_cache_idx, e);
+    free(e);
+    dvl.path_cache_count--;
+}
+
+/* uncached fallback (original behavior): the file itself may not exist yet */
+static char * resolve_path(const char * path, char * npath) {
     char namebuff[MAX_FILE_NAME];
     char pathbuff[MAX_FILE_NAME];
 
     if (realpath(path, npath) == NULL){
         //file may not exist, strip it out and get realpath of the folder
-        strncpy(pathbuff, path, MAX_FILE_NAME);    
-        strncpy(namebuff, path, MAX_FILE_NAME);    
+        strncpy(pathbuff, path, MAX_FILE_NAME - 1);
+        pathbuff[MAX_FILE_NAME - 1] = '\0';
+        strncpy(namebuff, path, MAX_FILE_NAME - 1);
+        namebuff[MAX_FILE_NAME - 1] = '\0';
 
         char * fname = basename(namebuff);
         char * dname = dirname(pathbuff);
 
-        if (realpath(dname, npath) == NULL) {   
+        if (realpath(dname, npath) == NULL) {
             DVLPRINT("cannot found the directory %s (filename: %s) --> returning NULL\n", dname, fname);
             return NULL;
         }
         size_t len = strlen(npath);
-        snprintf(npath + len, MAX_FILE_NAME, "/%s", fname);
+        snprintf(npath + len, MAX_FILE_NAME - len, "/%s", fname);
+    }
+
+    return npath;
+}
+
+/**
+ * writes the normalized absolute path into npath (size MAX_FILE_NAME); returns NULL
+ * if the directory of the file does not exist.
+ *
+ * Only the directory part is resolved with realpath() and cached; the file name is
+ * appended as given. Thus, in contrast to the uncached version, a symlink as the last
+ * path component is not resolved. Relative paths are keyed with the current working dir.
+ */
+static char * normalize_path(const char * path, char * npath) {
+    if (dvl.path_cache_mode == DVL_PATH_CACHE_OFF) {
+        return resolve_path(path, npath);
+    }
+
+    const char * slash = strrchr(path, '/');
+    const char * fname = slash == NULL ? path : slash + 1;
+    if (*fname == '\0' || !strcmp(fname, ".") || !strcmp(fname, "..")) {
+        return resolve_path(path, npath);
+    }
+
+    // build the key: absolute, but not normalized directory
+    char key[MAX_FILE_NAME];
+    size_t dlen = slash == NULL ? 0 : (size_t) (slash - path);
+    size_t klen = 0;
+    if (path[0] != '/') {
+        if (getcwd(key, MAX_FILE_NAME) == NULL) {
+            return resolve_path(path, npath);
+        }
+        klen = strlen(key);
+        if (0 < dlen) {
+            if (MAX_FILE_NAME <= klen + 1 + dlen) {
+                return resolve_path(path, npath);
+            }
+            key[klen++] = '/';
+        }
+    } else if (dlen == 0) {
+        // file in the root directory
+        key[klen++] = '/';
+    }
+    if (MAX_FILE_NAME <= klen + dlen) {
+        return resolve_path(path, npath);
+    }
+    memcpy(key + klen, path, dlen);
+    klen += dlen;
+    key[klen] = '\0';
+
+    struct stat st;
+    time_t mtime = 0;
+    if (dvl.path_cache_mode == DVL_PATH_CACHE_VALIDATE) {
+        if (stat(key, &st) != 0) {
+            return NULL;
+        }
+        mtime = st.st_mtime;
+    }
+
+    // lookup
+    char dir[MAX_FILE_NAME];
+    int found = 0;
+    dvl_path_entry_t *e;
+#ifdef __MT__
+    if (pthread_rwlock_rdlock(&dvl.path_cache_lock) != 0) fatal("normalize_path(): can't get rdlock");
+#endif
+    HASH_FIND_STR(dvl.path_cache_idx, key, e);
+    if (e != NULL && (dvl.path_cache_mode != DVL_PATH_CACHE_VALIDATE || e->mtime == mtime)) {
+        memcpy(dir, e->path, strlen(e->path) + 1);
+        // several readers may set it
+        __atomic_store_n(&e->referenced, 1, __ATOMIC_RELAXED);
+        found = 1;
+    }
+#ifdef __MT__
+    pthread_rwlock_unlock(&dvl.path_cache_lock);
+#endif
+
+    if (found) {
+        // note: counters are not synchronized (statistics only)
+        dvl.path_cache_hits++;
+    } else {
+        dvl.path_cache_misses++;
+        if (realpath(key, dir) == NULL) {
+            DVLPRINT("cannot found the directory %s (filename: %s) --> returning NULL\n", key, fname);
+            return NULL;
+        }
+
+#ifdef __MT__
+        if (pthread_rwlock_wrlock(&dvl.path_cache_lock) != 0) fatal("normalize_path(): can't get wrlock");
+#endif
+        HASH_FIND_STR(dvl.path_cache_idx, key, e);
+        if (e == NULL) {
+            if (MAX_PATH_CACHE_ENTRIES <= dvl.path_cache_count) {
+                evict_path_entry();
+            }
+            e = (dvl_path_entry_t *) malloc(sizeof(dvl_path_entry_t));
+            if (e != NULL) {
+                memcpy(e->key, key, klen + 1);
+                e->referenced = 0;
+                HASH_ADD_STR(dvl.path_cache_idx, key, e);
+                dvl.path_cache_count++;
+            }
+        }
+        if (e != NULL) {
+            memcpy(e->path, dir, strlen(dir) + 1);
+            e->mtime = mtime;
+        }
+#ifdef __MT__
+        pthread_rwlock_unlock(&dvl.path_cache_lock);
+#endif
+    }
+
+    size_t len = strlen(dir);
+    int sep = dir[len - 1] != '/';
+    if (MAX_FILE_NAME <= len + sep + strlen(fname)) {
+        return NULL;
+    }
+    snprintf(npath, MAX_FILE_NAME, sep ? "%s/%s" : "%s%s", dir, fname);
+    return npath;
+}
+
+
+//--- COSMO specific part ------------------------------------------------------
+
+char * is_result_file_COSMO(const char * path, char * npath){
+    //char abspath[MAX_FILE_NAME];
+
+    // note: the file may not exist yet (see normalize_path())
+    if (normalize_path(path, npath) == NULL){
+        return NULL;
     }
 
     //DVLPRINT("path: %s; npath: %s; dvl.respath: %s\n", path, npath, dvl.respath);
-    size_t rplen = strlen(dvl.respath);  
+    size_t rplen = dvl.respath_len;
     
     //DVLPRINT("is_result_file ok: %lu %lu %i\n", strlen(npath), rplen, strncmp(npath, dvl.respath, rplen));
 
-    if (strlen(npath) >= rplen && !strncmp(npath, dvl.respath, rplen)){
+    if (strlen(npath) >= rplen && !memcmp(npath, dvl.respath, rplen)){
         return npath + rplen; /* relapath return null-termianted string */
     }
     //DVLPRINT("returning NULL -> %s is not a result file!\n", path);
@@ -455,15 +977,17 @@ char * is_result_file_COSMO(const char * path, char * npath){
 char * is_checkpoint_file_COSMO(const char * path, char * npath){
     //char abspath[MAX_FILE_NAME];
 
-    realpath(path, npath);
+    if (normalize_path(path, npath) == NULL){
+        return NULL;
+    }
 
     DVLPRINT("path: %s; npath: %s; dvl.checkpoint_path: %s\n", path, npath, dvl.checkpoint_path);
-    size_t rplen = strlen(dvl.checkpoint_path);  
+    size_t rplen = dvl.checkpoint_path_len;
     
     DVLPRINT("is_checkpoint_file ok: %lu %lu %i\n", strlen(npath), rplen, strncmp(npath, dvl.checkpoint_path, rplen));
 
 
-    if (strlen(npath) >= rplen && !strncmp(npath, dvl.checkpoint_path, rplen)){
+    if (strlen(npath) >= rplen && !memcmp(npath, dvl.checkpoint_path, rplen)){
         return npath + rplen; /* relapath return null-termianted string */
     }
     DVLPRINT("returning NULL -> %s is not a checkpoint file!\n", path);
@@ -479,10 +1003,12 @@ char * is_checkpoint_file_COSMO(const char * path, char * npath){
 char * is_result_file_FLASH(const char * path, char * npath){
     //char abspath[MAX_FILE_NAME];
 
-    realpath(path, npath);
+    if (normalize_path(path, npath) == NULL){
+        return NULL;
+    }
 
     DVLPRINT("path: %s; npath: %s; dvl.respath: %s\n", path, npath, dvl.respath);
-    size_t rplen = strlen(dvl.respath);  
+    size_t rplen = dvl.respath_len;
 
     // additional check for FLASH (note: basename may modify the input, thus a copy first)
     char name[MAX_FILE_NAME + 1];
@@ -518,7 +1044,7 @@ char * is_result_file_FLASH(const char * path, char * npath){
     // back to common code path
     DVLPRINT("is_result_file ok: %lu %lu %i\n", strlen(npath), rplen, strncmp(npath, dvl.respath, rplen));
 
-    if (strlen(npath) >= rplen && !strncmp(npath, dvl.respath, rplen)){
+    if (strlen(npath) >= rplen && !memcmp(npath, dvl.respath, rplen)){
         return npath + rplen; /* relapath return null-termianted string */
     }
     DVLPRINT("returning NULL!!!\n");
@@ -531,10 +1057,12 @@ char * is_result_file_FLASH(const char * path, char * npath){
 char * is_checkpoint_file_FLASH(const char * path, char * npath){
     //char abspath[MAX_FILE_NAME];
 
-    realpath(path, npath);
+    if (normalize_path(path, npath) == NULL){
+        return NULL;
+    }
 
     DVLPRINT("path: %s; npath: %s; dvl.checkpoint_path: %s\n", path, npath, dvl.checkpoint_path);
-    size_t rplen = strlen(dvl.respath);  
+    size_t rplen = dvl.checkpoint_path_len;
 
     // additional check for FLASH (note: basename may modify the input, thus a copy first)
     char name[MAX_FILE_NAME + 1];
@@ -563,7 +1091,7 @@ char * is_checkpoint_file_FLASH(const char * path, char * npath){
     // back to common code path
     DVLPRINT("is_checkpoint_file ok: %lu %lu %i\n", strlen(npath), rplen, strncmp(npath, dvl.checkpoint_path, rplen));
 
-    if (strlen(npath) >= rplen && !strncmp(npath, dvl.checkpoint_path, rplen)){
+    if (strlen(npath) >= rplen && !memcmp(npath, dvl.checkpoint_path, rplen)){
         return npath + rplen; /* relapath return null-termianted string */
     }
     DVLPRINT("returning NULL!!!\n");
@@ -4,6 +4,10 @@
 #define DVL_SUCCESS 0
 #define DVL_ERROR -1
 
+/* put handlers: the file has been redirected with skipped writes (DVL_CREATE_REPLY_REDIRECT_SKIP_WRITES);
+   the original put is skipped */
+#define DVL_PREVENT_WRITING_DATA_DURING_REDIRECT (-10000)
+
 #define TYPE_RESTART 0
 #define TYPE_RESULT 1
 
@@ -55,9 +59,34 @@ int dvl_nc_create(char *path, int omode, int * ncidp, onc_create_t onc_create);
 int dvl_nc_close(int ncid);
 int _dvl_nc_close(int ncid, onc_close_t onc_close);
 
-int dvl_nc_get(int ncid, int varid, const size_t start[], const size_t count[], const void * valuesp);
+/* memory types of the get wrappers: values of NC_NAT (nc_get_vara), NC_CHAR, NC_INT, NC_FLOAT, NC_DOUBLE
+   (netcdf_bind.c does not include netcdf.h; checked in dvl_nc_get.c) */
+#define DVL_MEMTYPE_NAT 0
+#define DVL_MEMTYPE_CHAR 2
+#define DVL_MEMTYPE_INT 4
+#define DVL_MEMTYPE_FLOAT 5
+#define DVL_MEMTYPE_DOUBLE 6
+
+/* dvl_nc_get(): the values have been copied from a block (see dvl_block.h); the original get is skipped */
+#define DVL_GET_SERVED -2
+
+int dvl_nc_get(int ncid, int varid, const size_t start[], const size_t count[], int memtype, const void * valuesp);
+
+/* called after the original get (ncid: as returned by dvl_nc_get()): keeps the slab as block; returns status */
+int dvl_nc_get_done(int id, int ncid, int varid, const size_t start[], const size_t count[], int memtype,
+                    const void * valuesp, int status);
 
 int dvl_nc_put(int id, int varid, const size_t start[], const size_t count[], const void * valuesp);
+
+/* 1 if the puts of the file are skipped (redirected with DVL_CREATE_REPLY_REDIRECT_SKIP_WRITES);
+   used by the put wrappers without a slab (nc_put_var, nc_put_var1, nc_put_vars) */
+int dvl_nc_put_skipped(int id);
+
+/* called after the original put: reports the written slab for early data availability; returns status */
+int dvl_nc_put_done(int id, int varid, const size_t start[], const size_t count[], int status);
+
+/* comma separated list of the array (empty for asize 0) */
+void stringify_size_array(char * buff, size_t bsize, const size_t * arr, size_t asize);
 #endif
 
 #endif /* __DVL_H__ */
@@ -0,0 +1,241 @@
+/*
+ * Blocks: variable slabs in the block store of DV (see dvl_block.h).
+ *
+ * -> block names are derived from the key (FNV-1a); DV replaces a block when its name is reported again
+ * -> payload files are written under a temporary name (leading '.') and renamed: readers see complete blocks only
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "dvl.h"
+#include "dvl_internal.h"
+#include "dvl_proxy.h"
+#include "dvl_block.h"
+
+#ifdef __MT__
+#include <pthread.h>
+#endif
+
+
+static int block_enabled = 0;
+static char block_store[MAX_FILE_NAME];
+static uint64_t block_max_size = 0;
+
+#ifdef __MT__
+static pthread_mutex_t block_lock = PTHREAD_MUTEX_INITIALIZER;
+#define BLOCK_LOCK pthread_mutex_lock(&block_lock)
+#define BLOCK_UNLOCK pthread_mutex_unlock(&block_lock)
+#else
+#define BLOCK_LOCK
+#define BLOCK_UNLOCK
+#endif
+
+static uint64_t block_recent[DVL_BLOCK_RECENT];
+static uint32_t block_tmp_count = 0;
+
+
+void dvl_block_init(const char * store, const char * max_size){
+    char * env = getenv(ENV_BLOCKS);
+    block_enabled = 0;
+    if (dvl.is_simulator || store == NULL || max_size == NULL || store[0] == '\0') return;
+    if (env != NULL && atoi(env) == 0) return;
+
+    block_max_size = strtoull(max_size, NULL, 10);
+    if (block_max_size == 0) return;
+    if (snprintf(block_store, MAX_FILE_NAME, "%s", store) >= MAX_FILE_NAME) return;
+
+    block_enabled = 1;
+    DVLPRINT("[DVLIB] block store: %s; max block size: %lu\n", block_store, (unsigned long) block_max_size);
+}
+
+int dvl_block_enabled(void){
+    return block_enabled;
+}
+
+
+/* external type and its size if slabs of the variable can be kept as blocks and
+   memtype matches; 0 otherwise */
+static size_t block_type(int ncid, int varid, int memtype, nc_type * type){
+    size_t tsize;
+    if (nc_inq_vartype(ncid, varid, type) != NC_NOERR) return 0;
+
+    /* fixed size atomic types only (no strings, no user defined types) */
+    if (*type < NC_BYTE || NC_UINT64 < *type) return 0;
+    if (memtype != NC_NAT && memtype != *type) return 0;
+    if (nc_inq_type(ncid, *type, NULL, &tsize) != NC_NOERR) return 0;
+    return tsize;
+}
+
+int dvl_block_usable(int ncid, int varid, int memtype){
+    nc_type type;
+    return block_enabled && block_type(ncid, varid, memtype, &type) > 0;
+}
+
+
+static uint64_t block_hash(const char * key){
+    uint64_t h = 14695981039346656037ULL;
+    for (; *key != '\0'; key++) {
+        h ^= (unsigned char) *key;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+/* comma separated list of n indices (see stringify_size_array()); 0 on success */
+static int parse_size_array(char * s, size_t * arr, int n){
+    for (int i = 0; i < n; i++) {
+        char * item = strsep(&s, ",");
+        if (item == NULL || item[0] == '\0') return -1;
+        arr[i] = strtoull(item, NULL, 10);
+    }
+    return (s == NULL || (n == 0 && s[0] == '\0')) ? 0 : -1;
+}
+
+
+void dvl_block_capture(int ncid, const char * path, int varid, int memtype,
+                       const size_t start[], const size_t count[], const void * valuesp){
+    char startstr[BUFFER_SIZE];
+    char countstr[BUFFER_SIZE];
+    char key[BUFFER_SIZE];
+    char name[32];
+    char bpath[MAX_FILE_NAME + 64];
+    char tmppath[MAX_FILE_NAME + 64];
+    nc_type type;
+    int ndims;
+
+    if (!block_enabled || start == NULL || count == NULL) return;
+
+    size_t tsize = block_type(ncid, varid, memtype, &type);
+    if (tsize == 0) return;
+    if (nc_inq_varndims(ncid, varid, &ndims) != NC_NOERR || DVL_BLOCK_MAX_DIMS < ndims) return;
+
+    uint64_t size = tsize;
+    for (int i = 0; i < ndims; i++) size *= count[i];
+    if (size == 0) return;
+
+    stringify_size_array(startstr, BUFFER_SIZE, start, ndims);
+    stringify_size_array(countstr, BUFFER_SIZE, count, ndims);
+    int len = snprintf(key, BUFFER_SIZE, "%s:%i:%i:%i:%s:%s", path, varid, type, ndims, startstr, countstr);
+    if (len < 0 || BUFFER_SIZE <= len) return;
+
+    /* DV accounts the payload file including the header */
+    if (block_max_size < size + len + 1) return;
+
+    uint64_t hash = block_hash(key);
+    uint32_t slot = hash % DVL_BLOCK_RECENT;
+
+    BLOCK_LOCK;
+    int recent = block_recent[slot] == hash;
+    block_recent[slot] = hash;
+    uint32_t tmp_id = block_tmp_count++;
+    BLOCK_UNLOCK;
+
+    if (recent) return;
+
+    snprintf(name, sizeof(name), "%016llx.blk", (unsigned long long) hash);
+    snprintf(bpath, sizeof(bpath), "%s/%s", block_store, name);
+    snprintf(tmppath, sizeof(tmppath), "%s/.%s.%i.%u", block_store, name, (int) getpid(), tmp_id);
+
+    FILE * f = fopen(tmppath, "wb");
+    if (f == NULL) {
+        DVLPRINT("[DVLIB] cannot write block %s\n", tmppath);
+        return;
+    }
+    int ok = fprintf(f, "%s\n", key) == len + 1 && fwrite(valuesp, 1, size, f) == size;
+    ok = fclose(f) == 0 && ok;
+    if (!ok || rename(tmppath, bpath) != 0) {
+        unlink(tmppath);
+        return;
+    }
+
+    char buff[BUFFER_SIZE];
+    int msgsize = BUFFER_SIZE;
+    MAKE_MESSAGE(buff, msgsize, "%c:%s:%i:%i:%s:%s:%s", DVL_MSG_BLOCK_STORE, path, varid, ndims, startstr, countstr, name);
+    if (msgsize < 0) {
+        unlink(bpath);
+        return;
+    }
+    dvl_send_message(buff, msgsize, 1);
+}
+
+
+int dvl_block_read(int ncid, const char * path, int varid, const char * blockname,
+                   const size_t start[], const size_t count[], void * valuesp){
+    char bpath[MAX_FILE_NAME + 64];
+    char header[BUFFER_SIZE];
+    size_t bstart[DVL_BLOCK_MAX_DIMS];
+    size_t bcount[DVL_BLOCK_MAX_DIMS];
+    size_t idx[DVL_BLOCK_MAX_DIMS];
+    nc_type type;
+    int ndims;
+
+    if (!block_enabled || blockname[0] == '\0' || blockname[0] == '.' || strchr(blockname, '/') != NULL) return -1;
+
+    size_t tsize = block_type(ncid, varid, NC_NAT, &type);
+    if (tsize == 0) return -1;
+    if (nc_inq_varndims(ncid, varid, &ndims) != NC_NOERR || DVL_BLOCK_MAX_DIMS < ndims) return -1;
+
+    snprintf(bpath, sizeof(bpath), "%s/%s", block_store, blockname);
+    FILE * f = fopen(bpath, "rb");
+    if (f == NULL) return -1;
+
+    if (fgets(header, BUFFER_SIZE, f) == NULL) {
+        fclose(f);
+        return -1;
+    }
+    long data = ftell(f);
+    header[strcspn(header, "\n")] = '\0';
+
+    /* the block must be the one of this variable (names are hashes) and contain the slab */
+    char * hptr = header;
+    char * hpath = strsep(&hptr, DVL_MSG_SEP);
+    char * hvarid = strsep(&hptr, DVL_MSG_SEP);
+    char * htype = strsep(&hptr, DVL_MSG_SEP);
+    char * hndims = strsep(&hptr, DVL_MSG_SEP);
+    char * hstart = strsep(&hptr, DVL_MSG_SEP);
+    char * hcount = strsep(&hptr, DVL_MSG_SEP);
+    int ok = hcount != NULL && strcmp(hpath, path) == 0 && atoi(hvarid) == varid
+             && atoi(htype) == type && atoi(hndims) == ndims
+             && parse_size_array(hstart, bstart, ndims) == 0 && parse_size_array(hcount, bcount, ndims) == 0;
+
+    size_t total = 1;
+    for (int d = 0; ok && d < ndims; d++) {
+        ok = bstart[d] <= start[d] && start[d] + count[d] <= bstart[d] + bcount[d];
+        idx[d] = 0;
+        total *= count[d];
+    }
+
+    if (!ok || total == 0) {
+        fclose(f);
+        return ok ? 0 : -1;
+    }
+
+    /* one read per contiguous run along the last dimension (row major like netCDF) */
+    char * out = valuesp;
+    size_t run = tsize;
+    if (0 < ndims) run *= count[ndims - 1];
+
+    while (ok) {
+        uint64_t off = 0;
+        for (int d = 0; d < ndims; d++) {
+            off = off * bcount[d] + (start[d] - bstart[d]) + (d < ndims - 1 ? idx[d] : 0);
+        }
+        ok = fseek(f, data + (long) (off * tsize), SEEK_SET) == 0 && fread(out, 1, run, f) == run;
+        out += run;
+
+        int d = ndims - 2;
+        for (; 0 <= d; d--) {
+            if (++idx[d] < count[d]) break;
+            idx[d] = 0;
+        }
+        if (d < 0) break;
+    }
+
+    fclose(f);
+    return ok ? 0 : -1;
+}
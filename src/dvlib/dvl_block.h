@@ -0,0 +1,51 @@
+#ifndef __DVL_BLOCK_H__
+#define __DVL_BLOCK_H__
+
+/* blocks: variable slabs kept in a side store (see BlockCache in the DV server).
+   DV announces its block store in the hello reply (respath:ckptpath:rank:<store>:<max block size>).
+   Clients then write the slabs they read from complete files into the store as blocks and
+   report them with
+       B:<file>:<varid>:<ndims>:<start>:<count>:<blockname>
+   Gets of files that are not resident ask DV for a block (DVL_BLOCK_REQUEST). If a block
+   contains the slab, DV replies "4:<blockname>" and the slab is copied from the block;
+   the file is neither needed nor re-simulated then.
+
+   Payload file: one header line with the key of the block (file:varid:type:ndims:start:count)
+   followed by the raw values in the external type of the variable. Thus, only gets of
+   nc_get_vara() or of the matching typed variant use blocks; the header is checked on read.
+
+   DV_BLOCKS=0 disables blocks. netCDF clients only. */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define ENV_BLOCKS "DV_BLOCKS"
+
+#define DVL_MSG_BLOCK_STORE 'B'
+
+#define DVL_BLOCK_REQUEST "block"
+
+/* slabs of variables with more dimensions are not kept as blocks */
+#define DVL_BLOCK_MAX_DIMS 32
+
+/* recently written blocks that are not written again (direct-mapped by the hash of the key) */
+#define DVL_BLOCK_RECENT 1024
+
+/* store, max_size: from the hello reply (NULL: block cache of DV is off) */
+void dvl_block_init(const char * store, const char * max_size);
+
+/* 1 if gets may ask DV for blocks */
+int dvl_block_enabled(void);
+
+/* 1 if a get of memtype from variable varid can be served from a block */
+int dvl_block_usable(int ncid, int varid, int memtype);
+
+/* writes the slab just read from a complete file as block and reports it to DV */
+void dvl_block_capture(int ncid, const char * path, int varid, int memtype,
+                       const size_t start[], const size_t count[], const void * valuesp);
+
+/* copies the slab from block blockname (reply of DV) into valuesp; 0 on success */
+int dvl_block_read(int ncid, const char * path, int varid, const char * blockname,
+                   const size_t start[], const size_t count[], void * valuesp);
+
+#endif /* __DVL_BLOCK_H__ */
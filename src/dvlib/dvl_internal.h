@@ -14,6 +14,8 @@
  * Internal shared data structures will be protected using rw locks to limit the performance hit.
  * This functionality is provided in a separate DVLib instance libdvlmt.so that is compatible with libdvl.so.
  * Recommendation: use libdvlmt.so only for clients that need it; use libdvl.so for the simulator.
+ * The same holds for the HDF5 (libdvlh8mt.so, libdvlh10mt.so) and PnetCDF (libdvlpnmt.so) variants.
+ * Each thread uses its own connection to DV (see dvl_proxy.c).
 
  * Please note: NetCDF itself is **not** thread safe.
  * It keeps various global states re the open file. Thus, any multi-threaded client application
@@ -39,9 +41,8 @@
 #include <pnetcdf.h>
 #include "pnetcdf/pnetcdf_bind.h"
 
-    #ifdef __MT__
-    #error Multithreaded clients are not supported yet for PNetCDF
-    #endif
+    // MT (libdvlpnmt): MPI must be initialized with MPI_THREAD_MULTIPLE, and threads that
+    // open files concurrently are expected to use their own communicators.
 
 
 #elif __HDF5__
@@ -52,9 +53,8 @@
 #include <H5Ppublic.h>
 #include "hdf5/dvl_hdf5.h"
 
-    #ifdef __MT__
-    #error Multithreaded clients are not supported yet for HDF5
-    #endif
+    // MT (libdvlh8mt / libdvlh10mt): HDF5 itself must be built thread-safe
+    // (--enable-threadsafe); DVLib calls into HDF5 from all client threads.
 
 
 #else
@@ -78,9 +78,18 @@
 */
 #define MAX_FILE_NAME 2040
 #define MAX_VAR_NAME 512
-#define MAX_OPEN_FILES 1024
+
+/* open file table: entries are allocated in chunks on demand (no upper limit);
+   the id -> file map and the interned paths are split into shards with separate locks (MT) */
+#define DVL_FILE_SHARDS 16
+#define DVL_PATH_SHARDS 16
+#define DVL_FILE_CHUNK 64
+#ifdef __MT__
+#define DVL_FILE_LOCAL_FREE 32
+#endif
 
 #define MAX_REDIR_FILES 1024
+#define MAX_REPORT_PUTS_FILES 64
 
 #ifdef __MT__
 #define MAX_CLIENT_THREADS 128
@@ -88,14 +97,27 @@
 
 #define DVL_FILE_OPEN 0
 #define DVL_FILE_SIM 1
+#define DVL_FILE_PARTIAL 2 // actual file open while still being simulated; gets ask DV (see dvl_nc_get())
 
 #define DVL_REPLY_FILE_OPEN '0'
 #define DVL_REPLY_FILE_SIM '1'
 #define DVL_REPLY_RDMA '2'
+#define DVL_REPLY_VAR_AVAIL '3' // the requested slab has been written; the file is still being simulated
+#define DVL_REPLY_BLOCK '4' // followed by :blockname; the slab can be read from the block (see dvl_block.h)
 
 #define DVL_CREATE_REPLY_ACK '0'
 #define DVL_CREATE_REPLY_KILL '1'
 #define DVL_CREATE_REPLY_REDIRECT '2'
+// followed by :report puts (0/1):staged path; the file is created in DV's staging area
+#define DVL_CREATE_REPLY_STAGE '3'
+// followed by :redirect path; as redirect, but the data writes are skipped (the redirected file is
+// removed by DV; see sim_redirect_skip_writes in the DV config)
+#define DVL_CREATE_REPLY_REDIRECT_SKIP_WRITES '4'
+// optional second field of the ack: report flushed variable puts (see dvl_nc_put_done())
+#define DVL_CREATE_REPLY_REPORT_PUTS '1'
+
+// last field of put messages sent after the data has been written and flushed
+#define DVL_VPUT_FLUSHED '1'
 
 #define DVL_MSG_HELLO '0'
 #define DVL_MSG_FOPEN '1'
@@ -122,17 +144,27 @@
 #define ENV_JOBID "DV_JOBID"
 #define ENV_DISABLE "DV_DISABLE"
 
+/* path normalization cache: 0 off; 1 on (default); 2 on, entries validated with the mtime of the directory */
+#define ENV_PATH_CACHE "DV_PATH_CACHE"
+#define DVL_PATH_CACHE_OFF 0
+#define DVL_PATH_CACHE_ON 1
+#define DVL_PATH_CACHE_VALIDATE 2
+#define MAX_PATH_CACHE_ENTRIES 128
+
+#ifdef __NCMPI__
+/* DV communication of collective pnetcdf calls (open, get):
+   0 each rank talks to DV; 1 only rank 0 of the communicator talks to DV and broadcasts the reply (default) */
+#define ENV_NCMPI_COLLECTIVE "DV_NCMPI_COLLECTIVE"
+#define DVL_NCMPI_PER_RANK 0
+#define DVL_NCMPI_AGGREGATED 1
+#endif
+
 
 #define DVL_FILETYPE_UNKNOWN 0
 #define DVL_FILETYPE_RESULT 1
 #define DVL_FILETYPE_CHECKPOINT 2
 
 
-#ifdef __WRITE_NO_DATA_DURING_REDIRECT__
-    #define DVL_PREVENT_WRITING_DATA_DURING_REDIRECT (-10000)
-#endif
-
-
 #ifdef BENCH
     #ifdef __MT__
     #error Multithreaded clients are not supported yet for LibLSB benchmarking
@@ -261,6 +293,23 @@
 */
 
 
+#ifdef __HDF5__
+typedef hid_t dvl_file_key_t;
+#else
+typedef int dvl_file_key_t;
+#endif
+
+
+/* interned path; shared by all open file entries of the same file.
+   MT: refs is changed atomically; only the last release takes the lock of its shard (see release_path()) */
+typedef struct dvl_path {
+    uint32_t refs;
+    uint32_t shard;
+    UT_hash_handle hh;
+    char path[];
+} dvl_path_t;
+
+
 typedef struct dvl_file {
 #ifdef __HDF5__
     hid_t key;        // key == fid
@@ -277,20 +326,37 @@ typedef struct dvl_file {
 #endif
 
     int state;
-    int id;
-    char path[MAX_FILE_NAME];
+    uint8_t leased; // opened under a read lease without DV (see dvl_lease.h): no close message
+    const char * path; // interned; see dvl_file_new()
     struct dvl_file * trash_next;
 
 #ifdef __NCMPI__
     MPI_Comm comm;
     int rank;
     MPI_Info info; // will hold a duplicate of the info -> thus needs to be cleared in close()
+    uint8_t skip_writes; // created with DVL_CREATE_REPLY_REDIRECT_SKIP_WRITES (all ranks)
 #endif
     
     UT_hash_handle hh;
 } dvl_file_t;
 
 
+typedef struct dvl_file_shard {
+#ifdef __MT__
+    pthread_rwlock_t lock;
+#endif
+    dvl_file_t * idx;
+} dvl_file_shard_t;
+
+
+typedef struct dvl_path_shard {
+#ifdef __MT__
+    pthread_mutex_t lock;
+#endif
+    dvl_path_t * idx;
+} dvl_path_shard_t;
+
+
 typedef struct dvl_redirected_file {
 #ifdef __HDF5__
     hid_t key;      // key == fid (note: v1.8 and v1.10 have hid_t of different sizes; thus 2 different libdvlh wrapper libraries)
@@ -302,6 +368,8 @@ typedef struct dvl_redirected_file {
     char opath[MAX_FILE_NAME];
     char path[MAX_FILE_NAME];
     int file_type;
+    uint8_t staged; // created in DV's staging area (not redirected): DV gets the size of the staged file
+    uint8_t skip_writes; // redirected with DVL_CREATE_REPLY_REDIRECT_SKIP_WRITES: data writes are no-ops
     struct dvl_redirected_file *trash_next;
 
 #ifdef __NCMPI__
@@ -315,6 +383,17 @@ typedef struct dvl_redirected_file {
 } dvl_redirected_file_t;
 
 
+/* cached realpath() of a directory as given by the application (made absolute with the cwd)
+   see normalize_path() in dvl.c; referenced: set by hits, cleared by the clock hand (eviction) */
+typedef struct dvl_path_entry {
+    char key[MAX_FILE_NAME];
+    char path[MAX_FILE_NAME];
+    time_t mtime;
+    uint8_t referenced;
+    UT_hash_handle hh;
+} dvl_path_entry_t;
+
+
 #ifdef __MT__
 typedef struct dvl_tid_rank_mapping {
     pid_t key;      // key == tid
@@ -331,7 +410,9 @@ typedef struct _dvl {
     // - most is read-only after init (which is lock protected)
     // - finalized: only used by simulator -> no locks at the moment
     // - open_files_count: only used by simulator -> no locks at the moment
-    // - open_files and client_tid_rank_mapping have rw locks
+    // - open file shards and client_tid_rank_mapping have rw locks; the pool of free
+    //   file entries has a mutex (per-thread free lists in front), the interned paths
+    //   have a mutex per shard
     // - redirected_files is only on simulator side -> no locking there at the moment
     // - opcount: BENCH is not (yet) supported -> will need locking, too then
     // - gni: only read only at the moment; RDMA is not active at the moment
@@ -346,15 +427,21 @@ typedef struct _dvl {
     // only used on simulator side at the moment
     uint8_t to_terminate; 
     uint8_t finalized;
+    // ncids of the open files for which DV asked for reports of flushed puts in the create reply
+    int report_puts_ids[MAX_REPORT_PUTS_FILES];
+    uint32_t report_puts_count;
     uint32_t open_files_count;
     
     // hashmap to handle .meta files (mainly client side, but for pnetcdf also simulator side)
+    // see dvl_file_*() functions below
+    dvl_file_shard_t file_shards[DVL_FILE_SHARDS];
 #ifdef __MT__
-    pthread_rwlock_t open_files_lock;
+    pthread_mutex_t file_pool_lock;
 #endif
-    dvl_file_t open_files[MAX_OPEN_FILES];
     dvl_file_t * free_files;
-    dvl_file_t * open_files_idx;
+    dvl_path_shard_t path_shards[DVL_PATH_SHARDS];
+    uint32_t open_files_allocated;
+    uint32_t open_files_active;
 
     // hashmap to handle redirected files (see simulator side)
     // no lock here since only client side is considering multiple threads at the moment
@@ -376,6 +463,24 @@ typedef struct _dvl {
     // the same for checkpoint files
     char checkpoint_path[MAX_FILE_NAME];
 
+    // both paths are normalized once after the hello message; lengths for the prefix checks
+    size_t respath_len;
+    size_t checkpoint_path_len;
+
+    // DV's staging area for new result files (client side; empty: off); see dvl_staged_path()
+    char staging_path[MAX_FILE_NAME];
+
+    // hashmap to cache realpath() of directories (each call costs metadata requests on parallel file systems)
+#ifdef __MT__
+    pthread_rwlock_t path_cache_lock;
+#endif
+    uint8_t path_cache_mode;
+    uint32_t path_cache_count;
+    uint64_t path_cache_hits;
+    uint64_t path_cache_misses;
+    dvl_path_entry_t * path_cache_idx;
+    dvl_path_entry_t * path_cache_hand; // clock hand over the insertion order; NULL: head
+
 #if defined(BENCH) || defined(PROFILE)
     uint32_t opcount[DVL_NC_TOTOPS];
 #endif
@@ -385,6 +490,7 @@ typedef struct _dvl {
 
 #ifdef __NCMPI__
     oncmpi_open_t ncmpiopen; // deliberately a separete name since signature differs
+    uint8_t ncmpi_collective;
 #elif __HDF5__
     dvl_hdf5_originals_t h5originals;
 #else
@@ -417,6 +523,56 @@ int64_t file_size(const char *path);
 
 char * is_result_file(const char * path, char * npath);
 
+/* staged copy of the result file path (relative to the result path) in buff if DV stages new
+ * result files and the copy is still there (i.e. not yet written back to the result path);
+ * NULL otherwise. Opening the staged copy may still fail if the write-back completes in the
+ * meantime: callers fall back to the result path then. */
+const char * dvl_staged_path(const char * path, char * buff);
+
+/* open files whose flushed puts are reported to DV (simulator side; see dvl_nc_put_done())
+ * dvl_report_puts_add() ignores files beyond MAX_REPORT_PUTS_FILES (notified at the close) */
+void dvl_report_puts_add(int id);
+
+int dvl_report_puts_find(int id);
+
+void dvl_report_puts_remove(int id);
+
+
+/* open file table
+ * - dvl_file_new() returns a zeroed entry with interned path (not yet in the table)
+ * - dvl_file_add() / dvl_file_find() / dvl_file_remove() use dfile->key to select the shard
+ * - dvl_file_delete() returns a removed entry to the free list
+ * MT: add/find/remove must be called with the lock of the shard of the key held
+ *     (dvl_files_rdlock() / dvl_files_wrlock() / dvl_files_unlock()). Allocation and
+ *     deletion do not need these locks.
+ */
+dvl_file_t * dvl_file_new(const char * path);
+
+void dvl_file_delete(dvl_file_t * dfile);
+
+void dvl_file_add(dvl_file_t * dfile);
+
+dvl_file_t * dvl_file_find(dvl_file_key_t key);
+
+void dvl_file_remove(dvl_file_t * dfile);
+
+/* an additional reference keeps an interned path (dfile->path) valid after releasing the shard lock */
+const char * dvl_path_ref(const char * path);
+
+void dvl_path_unref(const char * path);
+
+#ifdef __MT__
+void dvl_files_rdlock(dvl_file_key_t key);
+
+void dvl_files_wrlock(dvl_file_key_t key);
+
+void dvl_files_unlock(dvl_file_key_t key);
+#else
+#define dvl_files_rdlock(key)
+#define dvl_files_wrlock(key)
+#define dvl_files_unlock(key)
+#endif
+
 char * is_checkpoint_file(const char * path, char * npath);
 
 #endif /* __DVL_INTERNAL_H__ */
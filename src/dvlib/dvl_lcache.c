@@ -0,0 +1,478 @@
+/*
+ * Node-local read cache for result files (see dvl_lcache.h).
+ *
+ * -> entries: free -> filling (copy in progress, owner = pid; the index lock is not held while
+ *    copying) -> ready. Copies are named <slot>.<gen> in the folder; a new gen per fill keeps a
+ *    late owner from touching the copy of a later fill of the same slot.
+ * -> the bytes of a copy are reserved when the fill starts; entries of terminated owners are
+ *    reclaimed.
+ * -> the journal cursor is shared: the process that takes the lock next applies new evictions
+ *    for all. Entries made under the journal (epoch != 0) skip the stat check.
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "dvl.h"
+#include "dvl_internal.h"
+#include "dvl_proxy.h"
+#include "dvl_shm.h"
+#include "dvl_lcache.h"
+
+#ifdef __MT__
+#include <pthread.h>
+#endif
+
+/* copy buffer */
+#define DVL_LCACHE_COPY_SIZE (1 << 20)
+
+#define LCACHE_FREE 0
+#define LCACHE_FILLING 1
+#define LCACHE_READY 2
+
+typedef struct dvl_lcache_entry {
+    uint64_t hash;
+    uint64_t last_use;
+    uint64_t gen;
+    uint64_t epoch; // of the journal when the fill started; 0: checked by stat
+    int64_t size;
+    uint64_t src_ino;
+    int64_t src_mtime_sec;
+    int64_t src_mtime_nsec;
+    int32_t state;
+    int32_t owner;
+    int32_t linked; // hard link to the result file: not charged to used
+    int32_t padding;
+    char path[MAX_FILE_NAME];
+} dvl_lcache_entry_t;
+
+typedef struct dvl_lcache_index {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entries;
+    uint32_t padding;
+    int64_t capacity;
+    int64_t used;
+    uint64_t tick;
+    uint64_t journal_epoch;
+    uint64_t journal_cursor;
+    uint64_t hits;
+    uint64_t copies;
+    uint64_t links;
+    uint64_t evictions;
+    uint64_t invalidations;
+    dvl_lcache_entry_t entry[DVL_LCACHE_ENTRIES];
+} dvl_lcache_index_t;
+
+
+static char lcache_dir[MAX_FILE_NAME];
+static int lcache_fd = -1;
+static dvl_lcache_index_t * lcache = NULL;
+static const dvl_evict_header_t * journal = NULL;
+
+#ifdef __MT__
+/* flock does not exclude the threads of this process (one open file description) */
+static pthread_mutex_t lcache_lock = PTHREAD_MUTEX_INITIALIZER;
+#define LCACHE_LOCK { pthread_mutex_lock(&lcache_lock); flock(lcache_fd, LOCK_EX); }
+#define LCACHE_UNLOCK { flock(lcache_fd, LOCK_UN); pthread_mutex_unlock(&lcache_lock); }
+#else
+#define LCACHE_LOCK flock(lcache_fd, LOCK_EX)
+#define LCACHE_UNLOCK flock(lcache_fd, LOCK_UN)
+#endif
+
+
+static int pid_alive(pid_t pid){
+    return kill(pid, 0) == 0 || errno == EPERM;
+}
+
+/* 64-bit FNV-1a; same as EvictionJournal::hash() */
+static uint64_t lcache_hash(const char * path){
+    uint64_t h = 14695981039346656037ull;
+    for (const unsigned char * c = (const unsigned char *) path; *c != '\0'; c++){
+        h ^= *c;
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+static int lcache_name(const dvl_lcache_entry_t * e, char * buff){
+    uint32_t slot = (uint32_t) (e - lcache->entry);
+    return snprintf(buff, MAX_FILE_NAME, "%s/%u.%lu", lcache_dir, slot, (unsigned long) e->gen) < MAX_FILE_NAME;
+}
+
+/* frees the entry and removes its copy (a running fill removes its own files); the lock must be held */
+static void lcache_remove(dvl_lcache_entry_t * e){
+    char name[MAX_FILE_NAME];
+    if (e->state == LCACHE_READY && lcache_name(e, name)) unlink(name);
+    if (!e->linked) lcache->used -= e->size;
+    e->linked = 0;
+    e->state = LCACHE_FREE;
+    e->owner = 0;
+}
+
+/* frees the entry of a terminated fill; the lock must be held */
+static void lcache_reclaim(dvl_lcache_entry_t * e){
+    char name[MAX_FILE_NAME];
+    char tmp[MAX_FILE_NAME + 8];
+    if (lcache_name(e, name)) {
+        snprintf(tmp, sizeof(tmp), "%s.tmp", name);
+        unlink(tmp);
+        unlink(name);
+    }
+    lcache_remove(e);
+}
+
+
+static void journal_attach(void){
+    if (!dvl_is_local_endpoint(dvl_srv_ip_list())) return;
+
+    char name[64];
+    snprintf(name, sizeof(name), "%s%i", DVL_EVICT_PREFIX, dvl_srv_port());
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) return;
+
+    struct stat st;
+    void * ptr = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && (size_t) st.st_size >= sizeof(dvl_evict_header_t)) {
+        ptr = mmap(NULL, sizeof(dvl_evict_header_t), PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (ptr == MAP_FAILED) return;
+
+    const dvl_evict_header_t * header = (const dvl_evict_header_t *) ptr;
+    if (__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != DVL_EVICT_MAGIC
+        || header->version != DVL_EVICT_VERSION || header->entries != DVL_EVICT_ENTRIES
+        || !pid_alive(header->pid)) {
+        munmap(ptr, sizeof(dvl_evict_header_t));
+        return;
+    }
+
+    journal = header;
+    DVLPRINT("[DVLIB] local cache: using eviction journal %s\n", name);
+}
+
+/* current journal epoch (0: no journal); stopped DV instances are detached */
+static uint64_t journal_epoch(void){
+    if (journal == NULL) return 0;
+    if (__atomic_load_n(&journal->magic, __ATOMIC_ACQUIRE) != DVL_EVICT_MAGIC || !pid_alive(journal->pid)) {
+        munmap((void *) journal, sizeof(dvl_evict_header_t));
+        journal = NULL;
+        return 0;
+    }
+    return journal->epoch;
+}
+
+/* drops the entries of evicted result files; entries that cannot be checked by the journal
+   anymore fall back to the stat check. The lock must be held. */
+static void journal_apply(void){
+    uint64_t epoch = journal_epoch();
+    if (epoch == 0) return;
+
+    uint64_t head = __atomic_load_n(&journal->head, __ATOMIC_ACQUIRE);
+    if (lcache->journal_epoch != epoch) {
+        // entries of the former epoch are checked by stat; evictions before now do not matter
+        for (uint32_t i = 0; i < DVL_LCACHE_ENTRIES; i++) {
+            if (lcache->entry[i].epoch == lcache->journal_epoch) lcache->entry[i].epoch = 0;
+        }
+        lcache->journal_epoch = epoch;
+        lcache->journal_cursor = head;
+        return;
+    }
+
+    int lost = head - lcache->journal_cursor > DVL_EVICT_ENTRIES;
+    for (uint64_t seq = lcache->journal_cursor + 1; seq <= head && !lost; seq++) {
+        const dvl_evict_record_t * r = &journal->record[seq % DVL_EVICT_ENTRIES];
+        uint64_t seq1 = __atomic_load_n(&r->seq, __ATOMIC_ACQUIRE);
+        uint64_t hash = __atomic_load_n(&r->hash, __ATOMIC_ACQUIRE);
+        uint64_t seq2 = __atomic_load_n(&r->seq, __ATOMIC_ACQUIRE);
+        if (seq1 != seq || seq2 != seq) {
+            // overwritten in the meantime
+            lost = 1;
+            break;
+        }
+
+        for (uint32_t i = 0; i < DVL_LCACHE_ENTRIES; i++) {
+            dvl_lcache_entry_t * e = &lcache->entry[i];
+            if (e->state != LCACHE_FREE && e->hash == hash) {
+                lcache_remove(e);
+                lcache->invalidations++;
+            }
+        }
+    }
+
+    if (lost) {
+        for (uint32_t i = 0; i < DVL_LCACHE_ENTRIES; i++) {
+            if (lcache->entry[i].epoch == epoch) lcache->entry[i].epoch = 0;
+        }
+    }
+    lcache->journal_cursor = head;
+}
+
+/* 1 if the copy of e may be used; the lock must be held */
+static int lcache_valid(const dvl_lcache_entry_t * e, const char * fullpath){
+    if (e->epoch != 0 && e->epoch == journal_epoch()) return 1;
+
+    struct stat st;
+    return stat(fullpath, &st) == 0 && (uint64_t) st.st_ino == e->src_ino && st.st_size == e->size
+        && st.st_mtim.tv_sec == e->src_mtime_sec && st.st_mtim.tv_nsec == e->src_mtime_nsec;
+}
+
+/* a free entry (terminated fills are reclaimed, then the least recently used copy is removed);
+   NULL if all entries are being filled. The lock must be held. */
+static dvl_lcache_entry_t * lcache_victim(void){
+    dvl_lcache_entry_t * lru = NULL;
+    for (uint32_t i = 0; i < DVL_LCACHE_ENTRIES; i++) {
+        dvl_lcache_entry_t * e = &lcache->entry[i];
+        if (e->state == LCACHE_FREE) return e;
+        if (e->state == LCACHE_FILLING && !pid_alive(e->owner)) {
+            lcache_reclaim(e);
+            return e;
+        }
+        if (e->state == LCACHE_READY && (lru == NULL || e->last_use < lru->last_use)) lru = e;
+    }
+
+    if (lru != NULL) {
+        lcache_remove(lru);
+        lcache->evictions++;
+    }
+    return lru;
+}
+
+/* removes copies (not links) until size bytes fit; 0 if that is not possible. The lock must be held. */
+static int lcache_make_room(int64_t size){
+    while (lcache->capacity < lcache->used + size) {
+        dvl_lcache_entry_t * lru = NULL;
+        for (uint32_t i = 0; i < DVL_LCACHE_ENTRIES; i++) {
+            dvl_lcache_entry_t * e = &lcache->entry[i];
+            if (e->state == LCACHE_READY && !e->linked && (lru == NULL || e->last_use < lru->last_use)) lru = e;
+        }
+        if (lru == NULL) return 0;
+        lcache_remove(lru);
+        lcache->evictions++;
+    }
+    return 1;
+}
+
+static int copy_file(const char * from, const char * to, int64_t size){
+    int in = open(from, O_RDONLY);
+    if (in < 0) return 0;
+    int out = open(to, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (out < 0) {
+        close(in);
+        return 0;
+    }
+
+    char * buff = malloc(DVL_LCACHE_COPY_SIZE);
+    int64_t copied = 0;
+    ssize_t n = 0;
+    while (buff != NULL) {
+        n = read(in, buff, DVL_LCACHE_COPY_SIZE);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+
+        ssize_t off = 0;
+        while (off < n) {
+            ssize_t w = write(out, buff + off, n - off);
+            if (w < 0 && errno == EINTR) continue;
+            if (w <= 0) break;
+            off += w;
+        }
+        if (off < n) {
+            n = -1;
+            break;
+        }
+        copied += n;
+    }
+
+    free(buff);
+    close(in);
+    int ok = close(out) == 0 && n == 0 && copied == size;
+    if (!ok) unlink(to);
+    return ok;
+}
+
+
+void dvl_lcache_init(void){
+    char * dir = getenv(ENV_LOCAL_CACHE);
+    if (dvl.is_simulator || dir == NULL || dir[0] == '\0') return;
+
+    char * env = getenv(ENV_LOCAL_CACHE_MB);
+    int64_t capacity = (int64_t) ((env != NULL) ? atol(env) : DVL_LCACHE_DEFAULT_MB) * 1024 * 1024;
+    if (capacity <= 0) return;
+
+    char name[MAX_FILE_NAME];
+    if (snprintf(name, sizeof(name), "%s/%s", dir, DVL_LCACHE_INDEX) >= (int) sizeof(name)) return;
+    snprintf(lcache_dir, sizeof(lcache_dir), "%s", dir);
+    if (mkdir(lcache_dir, 0755) != 0 && errno != EEXIST) {
+        printf("[DVLIB] local cache: cannot create %s; local cache off\n", lcache_dir);
+        return;
+    }
+
+    int fd = open(name, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        printf("[DVLIB] local cache: cannot open %s; local cache off\n", name);
+        return;
+    }
+
+    // the first process creates the index; an index of another layout is replaced
+    flock(fd, LOCK_EX);
+    struct stat st;
+    void * ptr = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && (st.st_size == sizeof(dvl_lcache_index_t) || ftruncate(fd, sizeof(dvl_lcache_index_t)) == 0)) {
+        ptr = mmap(NULL, sizeof(dvl_lcache_index_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    if (ptr == MAP_FAILED) {
+        flock(fd, LOCK_UN);
+        close(fd);
+        printf("[DVLIB] local cache: cannot map %s; local cache off\n", name);
+        return;
+    }
+
+    dvl_lcache_index_t * index = (dvl_lcache_index_t *) ptr;
+    if (index->magic != DVL_LCACHE_MAGIC || index->version != DVL_LCACHE_VERSION || index->entries != DVL_LCACHE_ENTRIES) {
+        memset(index, 0, sizeof(dvl_lcache_index_t));
+        index->version = DVL_LCACHE_VERSION;
+        index->entries = DVL_LCACHE_ENTRIES;
+        index->capacity = capacity;
+        index->magic = DVL_LCACHE_MAGIC;
+    }
+    flock(fd, LOCK_UN);
+
+    lcache_fd = fd;
+    lcache = index;
+    journal_attach();
+    DVLPRINT("[DVLIB] local cache: %s, %ld MiB\n", lcache_dir, (long) (lcache->capacity >> 20));
+}
+
+int dvl_lcache_enabled(void){
+    return lcache != NULL;
+}
+
+const char * dvl_lcache_path(const char * path, const char * fullpath, char * buff){
+    if (lcache == NULL) return fullpath;
+
+    uint64_t hash = lcache_hash(path);
+    pid_t pid = getpid();
+
+    LCACHE_LOCK;
+    journal_apply();
+
+    dvl_lcache_entry_t * e = NULL;
+    for (uint32_t i = 0; i < DVL_LCACHE_ENTRIES && e == NULL; i++) {
+        dvl_lcache_entry_t * c = &lcache->entry[i];
+        if (c->state != LCACHE_FREE && c->hash == hash && strcmp(c->path, path) == 0) e = c;
+    }
+
+    if (e != NULL && e->state == LCACHE_READY) {
+        if (lcache_valid(e, fullpath) && lcache_name(e, buff)) {
+            e->last_use = ++lcache->tick;
+            lcache->hits++;
+            LCACHE_UNLOCK;
+            return buff;
+        }
+        lcache_remove(e);
+        lcache->invalidations++;
+        e = NULL;
+    }
+
+    if (e != NULL) {
+        // being filled by another process: read the result file meanwhile
+        if (pid_alive(e->owner)) {
+            LCACHE_UNLOCK;
+            return fullpath;
+        }
+        lcache_reclaim(e);
+        e = NULL;
+    }
+
+    struct stat st;
+    if (stat(fullpath, &st) != 0 || !S_ISREG(st.st_mode) || lcache->capacity < st.st_size
+        || !lcache_make_room(st.st_size) || (e = lcache_victim()) == NULL) {
+        LCACHE_UNLOCK;
+        return fullpath;
+    }
+
+    // the bytes are reserved until it is known whether the file can be linked
+    e->state = LCACHE_FILLING;
+    e->owner = pid;
+    e->linked = 0;
+    e->hash = hash;
+    snprintf(e->path, MAX_FILE_NAME, "%s", path);
+    e->gen++;
+    e->epoch = journal_epoch();
+    e->size = st.st_size;
+    e->src_ino = st.st_ino;
+    e->src_mtime_sec = st.st_mtim.tv_sec;
+    e->src_mtime_nsec = st.st_mtim.tv_nsec;
+    lcache->used += st.st_size;
+    uint64_t gen = e->gen;
+    int named = lcache_name(e, buff);
+    LCACHE_UNLOCK;
+
+    // DV keeps the result file while it is open; copies that are invalidated meanwhile are dropped below
+    int linked = 0;
+    int ok = 0;
+    if (named) {
+        char tmp[MAX_FILE_NAME + 8];
+        snprintf(tmp, sizeof(tmp), "%s.tmp", buff);
+        linked = link(fullpath, buff) == 0;
+        ok = linked || (copy_file(fullpath, tmp, st.st_size) && rename(tmp, buff) == 0);
+        if (!ok) unlink(tmp);
+    }
+
+    LCACHE_LOCK;
+    journal_apply();
+    int current = e->state == LCACHE_FILLING && e->owner == pid && e->gen == gen;
+    if (current && ok) {
+        e->state = LCACHE_READY;
+        e->owner = 0;
+        e->last_use = ++lcache->tick;
+        if (linked) {
+            e->linked = 1;
+            lcache->used -= e->size;
+            lcache->links++;
+        } else {
+            lcache->copies++;
+        }
+    } else if (current) {
+        lcache_remove(e);
+    }
+    LCACHE_UNLOCK;
+
+    if (current && ok) return buff;
+    if (ok) unlink(buff);
+    return fullpath;
+}
+
+void dvl_lcache_finalize(void){
+    if (lcache == NULL) return;
+
+    // links of evicted result files: journal_apply() otherwise only runs at the next open
+    LCACHE_LOCK;
+    journal_apply();
+    char name[MAX_FILE_NAME];
+    struct stat st;
+    for (uint32_t i = 0; i < DVL_LCACHE_ENTRIES; i++) {
+        dvl_lcache_entry_t * e = &lcache->entry[i];
+        if (e->state == LCACHE_READY && e->linked && lcache_name(e, name)
+            && (stat(name, &st) != 0 || st.st_nlink <= 1)) {
+            lcache_remove(e);
+            lcache->invalidations++;
+        }
+    }
+    LCACHE_UNLOCK;
+
+    DVLPRINT("[DVLIB] local cache: %lu hits, %lu copies, %lu links, %lu evictions, %lu invalidations, %ld bytes used\n",
+             (unsigned long) lcache->hits, (unsigned long) lcache->copies, (unsigned long) lcache->links,
+             (unsigned long) lcache->evictions, (unsigned long) lcache->invalidations, (long) lcache->used);
+}
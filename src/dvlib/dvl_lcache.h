@@ -0,0 +1,70 @@
+#ifndef __DVL_LCACHE_H__
+#define __DVL_LCACHE_H__
+
+/* node-local read cache for result files (DV_LOCAL_CACHE=<folder>).
+   Read-only opens of available result files are redirected to a copy in a node-local folder
+   (e.g. a local SSD or /dev/shm); the copy is made on the first open (hard link if the folder is
+   on the same file system as the result path). All processes of the node that use the same
+   folder share the copies and one index (DVL_LCACHE_INDEX in the folder: mapped shared, guarded
+   by flock); the copies used least recently are removed when the capacity
+   (DV_LOCAL_CACHE_MB, fixed by the process that creates the index) is exceeded. Hard links use
+   no local space and are not charged to the capacity.
+
+   A copy is valid as long as DV keeps its result file. If DV runs on the same node with
+   dv_eviction_journal = 1, evictions are read from the eviction journal of DV (see
+   EvictionJournal in the DV server); otherwise,
+   or if the journal has been lost (DV restart, too many evictions in between), the result file
+   is checked by stat (inode, size, mtime) before the copy is used. A hard link keeps the blocks
+   of an evicted result file allocated: each process drops the links of evicted files at its
+   finalize (journal, or link count 1 if DV has removed the result file).
+
+   Use one folder per DV instance (the index is keyed by the path relative to the result path).
+   Application clients only (netCDF and HDF5 variants).
+
+   note: the journal layout must match EvictionJournal.h */
+
+#include <stdint.h>
+
+#define ENV_LOCAL_CACHE "DV_LOCAL_CACHE"
+#define ENV_LOCAL_CACHE_MB "DV_LOCAL_CACHE_MB"
+
+#define DVL_LCACHE_DEFAULT_MB 1024
+#define DVL_LCACHE_ENTRIES 1024
+#define DVL_LCACHE_INDEX ".dvl_lcache_index"
+#define DVL_LCACHE_MAGIC 0x53464c43
+#define DVL_LCACHE_VERSION 2
+
+#define DVL_EVICT_PREFIX "/simfs_dv_evict_"
+#define DVL_EVICT_MAGIC 0x53464a45
+#define DVL_EVICT_VERSION 1
+#define DVL_EVICT_ENTRIES 4096
+
+typedef struct dvl_evict_record {
+    uint64_t seq;
+    uint64_t hash;
+} dvl_evict_record_t;
+
+typedef struct dvl_evict_header {
+    uint32_t magic;
+    uint32_t version;
+    int32_t pid;
+    uint32_t entries;
+    uint64_t epoch;
+    uint64_t head;
+    dvl_evict_record_t record[DVL_EVICT_ENTRIES];
+} dvl_evict_header_t;
+
+void dvl_lcache_init(void);
+
+int dvl_lcache_enabled(void);
+
+/* local copy of the available result file path (relative to the result path); fullpath: the
+   result file as passed to open. The copy is made if there is none. Returns buff (MAX_FILE_NAME)
+   with the copy or fullpath if the file is not cached; the caller opens fullpath if opening the
+   copy fails (e.g. it has been removed in between by another process). */
+const char * dvl_lcache_path(const char * path, const char * fullpath, char * buff);
+
+/* drops the links of evicted result files and prints the counters of the shared index (see dvl_finalize) */
+void dvl_lcache_finalize(void);
+
+#endif /* __DVL_LCACHE_H__ */
@@ -0,0 +1,142 @@
+/*
+ * Client read leases (see dvl_lease.h).
+ *
+ * -> leases: hashmap path -> local expiry (monotonic clock in ms)
+ * -> leased opens are reported with the batched access reports (see dvl_report.c)
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "dvl.h"
+#include "dvl_internal.h"
+#include "dvl_lease.h"
+
+#ifdef __MT__
+#include <pthread.h>
+#endif
+
+
+typedef struct dvl_lease {
+    uint64_t expiry;
+    UT_hash_handle hh;
+    char path[];
+} dvl_lease_t;
+
+
+static int lease_enabled = 0;
+
+#ifdef __MT__
+static pthread_mutex_t lease_lock = PTHREAD_MUTEX_INITIALIZER;
+#define LEASE_LOCK pthread_mutex_lock(&lease_lock)
+#define LEASE_UNLOCK pthread_mutex_unlock(&lease_lock)
+#else
+#define LEASE_LOCK
+#define LEASE_UNLOCK
+#endif
+
+static dvl_lease_t * leases_idx = NULL;
+static uint32_t lease_count = 0;
+
+
+
+uint64_t dvl_lease_now_ms(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+void dvl_lease_init(void){
+#ifdef __NCMPI__
+    // collective opens: all ranks must take the same path (no leases)
+    lease_enabled = 0;
+#else
+    char * env = getenv(ENV_LEASES);
+    lease_enabled = !dvl.is_simulator && (env == NULL || atoi(env) != 0);
+#endif
+}
+
+int dvl_lease_enabled(void){
+    return lease_enabled;
+}
+
+
+/* called with lease_lock held (MT) */
+static void remove_lease(dvl_lease_t * e){
+    HASH_DEL(leases_idx, e);
+    free(e);
+    lease_count--;
+}
+
+/* called with lease_lock held (MT) */
+static void remove_expired(uint64_t now){
+    dvl_lease_t *e, *tmp;
+    HASH_ITER(hh, leases_idx, e, tmp) {
+        if (e->expiry <= now) remove_lease(e);
+    }
+}
+
+int dvl_lease_valid(const char * path){
+    if (!lease_enabled) return 0;
+
+    int valid = 0;
+    dvl_lease_t * e;
+
+    LEASE_LOCK;
+    HASH_FIND(hh, leases_idx, path, strlen(path), e);
+    if (e != NULL) {
+        if (dvl_lease_now_ms() < e->expiry) valid = 1;
+        else remove_lease(e);
+    }
+    LEASE_UNLOCK;
+
+    return valid;
+}
+
+void dvl_lease_grant(const char * path, const char * reply, uint64_t sent_ms){
+    if (!lease_enabled || reply[0] != DVL_REPLY_FILE_OPEN || reply[1] != DVL_MSG_SEP[0]) return;
+
+    long ms = atol(reply + 2);
+    if (ms <= DVL_LEASE_MARGIN_MS) return;
+    uint64_t expiry = sent_ms + ms - DVL_LEASE_MARGIN_MS;
+
+    size_t len = strlen(path);
+    dvl_lease_t * e;
+
+    LEASE_LOCK;
+    HASH_FIND(hh, leases_idx, path, len, e);
+    if (e == NULL) {
+        if (MAX_LEASES <= lease_count) {
+            remove_expired(dvl_lease_now_ms());
+        }
+        if (MAX_LEASES <= lease_count) {
+            // all valid: just drop them (they are only an optimization)
+            dvl_lease_t *tmp;
+            HASH_ITER(hh, leases_idx, e, tmp) {
+                remove_lease(e);
+            }
+        }
+
+        e = malloc(sizeof(dvl_lease_t) + len + 1);
+        if (e != NULL) {
+            memcpy(e->path, path, len + 1);
+            HASH_ADD_KEYPTR(hh, leases_idx, e->path, len, e);
+            lease_count++;
+        }
+    }
+    if (e != NULL) e->expiry = expiry;
+    LEASE_UNLOCK;
+}
+
+void dvl_lease_drop(const char * path){
+    dvl_lease_t * e;
+
+    LEASE_LOCK;
+    HASH_FIND(hh, leases_idx, path, strlen(path), e);
+    if (e != NULL) remove_lease(e);
+    LEASE_UNLOCK;
+}
+
@@ -0,0 +1,46 @@
+#ifndef __DVL_LEASE_H__
+#define __DVL_LEASE_H__
+
+/* client read leases (see LeaseTable in the DV server).
+   DV answers the open of an available file with "0:<ms>" if dv_lease_ms > 0 and the open
+   message requested a lease (DVL_LEASE_REQUEST). Until the lease expires, re-opens of this
+   file skip DV; they are reported in batches (see dvl_report.h) for the recency and
+   prefetcher bookkeeping of DV. Closes of leased opens are not sent to DV.
+
+   The local expiry is computed from the time the open request was sent (minus a margin)
+   and thus ends before DV releases its lock on the file.
+
+   Only read-only opens request and use leases (no NC_WRITE / H5F_ACC_RDWR): opens for writing
+   always go through DV.
+
+   DV_LEASES=0 disables leases. Application clients only (netCDF and HDF5 variants). */
+
+#include <stdint.h>
+
+#define ENV_LEASES "DV_LEASES"
+
+#define DVL_LEASE_REQUEST "lease"
+
+/* safety margin subtracted from the granted duration */
+#define DVL_LEASE_MARGIN_MS 50
+
+/* at most this many leases are cached (expired ones are dropped first) */
+#define MAX_LEASES 1024
+
+void dvl_lease_init(void);
+
+/* 1 if the open message shall request a lease */
+int dvl_lease_enabled(void);
+
+/* 1 if path has a valid lease */
+int dvl_lease_valid(const char * path);
+
+/* records the lease of a "0:<ms>" open reply; sent_ms: time the open request was sent (dvl_lease_now_ms()) */
+void dvl_lease_grant(const char * path, const char * reply, uint64_t sent_ms);
+
+/* drops the lease of path (e.g. open failed under the lease) */
+void dvl_lease_drop(const char * path);
+
+uint64_t dvl_lease_now_ms(void);
+
+#endif /* __DVL_LEASE_H__ */
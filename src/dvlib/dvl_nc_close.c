@@ -3,6 +3,8 @@
 #include "dvl.h"
 #include "dvl_internal.h"
 #include "dvl_proxy.h"
+#include "dvl_readahead.h"
+#include "dvl_report.h"
 
 /*
 int _dvl_nc_close(int id, onc_close_t onc_close); 
@@ -42,15 +44,11 @@ int _dvl_nc_close(int id, onc_close_t onc_close){
     } else {
         // client
 
-#ifdef __MT__
-        if (pthread_rwlock_rdlock(&dvl.open_files_lock) != 0) fatal("_dvl_nc_close(): can't get rdlock");
-#endif
-        HASH_FIND_INT(dvl.open_files_idx, &id, dfile);
+        dvl_files_rdlock(id);
+        dfile = dvl_file_find(id);
         if (dfile == NULL) {
             fprintf(stderr, "Warning: client is closing a file (id: %i) that was not open by DVLIB. Trying to close it with netcdf (hint: opening/creating function may have not been intercepted!).\n", id);
-#ifdef __MT__
-            pthread_rwlock_unlock(&dvl.open_files_lock);
-#endif
+            dvl_files_unlock(id);
             return (*onc_close)(id);     
         }
 
@@ -62,9 +60,9 @@ int _dvl_nc_close(int id, onc_close_t onc_close){
         } else {
             toclose = dfile->ncid;
         }
-#ifdef __MT__
-        pthread_rwlock_unlock(&dvl.open_files_lock);
-#endif        
+        dvl_files_unlock(id);
+
+        dvl_readahead_flush();
 
     }
 
@@ -79,12 +77,13 @@ int _dvl_nc_close(int id, onc_close_t onc_close){
 
     if (dvl.is_simulator) {
         dvl.open_files_count--;
+        dvl_report_puts_remove(id);
     }
 
 
     // for simulators and in case of redirected files, the path used for messaging with DV
     // must be retrieved from the hashmap. The path recovered by nc_inq_path() refers to redirected file
-    // opath/cpath is needed, too, to get file_size later
+    // opath/cpath is needed, too, to get file_size later (staged files: the size of the staged file)
     dvl_redirected_file_t *rfile = NULL;
     path = NULL;
     int is_redirected = 0;
@@ -94,13 +93,24 @@ int _dvl_nc_close(int id, onc_close_t onc_close){
         HASH_FIND_INT(dvl.open_redirected_files_idx, &id, rfile);
 
         if (rfile != NULL) {
-            is_redirected = 1;
-            cpath_ptr = rfile->opath;
+            is_redirected = !rfile->staged;
+            if (!rfile->staged) {
+                cpath_ptr = rfile->opath;
+            }
             path = rfile->path;
             file_type = rfile->file_type;
         }
     }
 
+    if (path == NULL && dfile != NULL && dfile->state == DVL_FILE_SIM) {
+        /* client closing the metadata file of a file that has not been opened itself
+           (e.g. all gets served from blocks; see dvl_block.h): cpath is the one of the metadata file */
+        snprintf(npath, MAX_FILE_NAME, "%s", dfile->path);
+        path = npath;
+        file_type = DVL_FILETYPE_RESULT;
+        DVL_PROFILE(DVL_NC_CLOSE_ID, "dvl_nc_close", cpath);
+    }
+
     if (path == NULL) {
         path = is_result_file(cpath, npath);
         if (path != NULL) {
@@ -109,8 +119,16 @@ int _dvl_nc_close(int id, onc_close_t onc_close){
         }
     }
 
-    // note: we are not sending close messages for closed checkpoint files
-    // but redirected checkpoint files have to be removed from the hashmap
+    if (path == NULL && dvl.is_simulator) {
+        path = is_checkpoint_file(cpath, npath);
+        if (path != NULL) {
+            file_type = DVL_FILETYPE_CHECKPOINT;
+        }
+    }
+
+    // note: close messages for checkpoint files are only sent if they were not redirected
+    // (i.e. new checkpoint files that DV adds to its restart lookup).
+    // redirected checkpoint files have to be removed from the hashmap
     // and in this case, path is already set.
 
     if (path == NULL) {
@@ -120,8 +138,8 @@ int _dvl_nc_close(int id, onc_close_t onc_close){
     if (dvl.is_simulator) {
         //loc = dvl_srv_mark_complete(&dvl, buff);
 
-        // messages are only sent for result files but not for checkpoint files
-        if (file_type == DVL_FILETYPE_RESULT) {
+        // messages are sent for result files and new (not redirected) checkpoint files
+        if (file_type == DVL_FILETYPE_RESULT || (file_type == DVL_FILETYPE_CHECKPOINT && !is_redirected)) {
             int64_t size = file_size(cpath_ptr);
             if (size < 0) {
                 DVLPRINT("DVL_NC_CLOSE: could not determine file size of %s", cpath_ptr);
@@ -135,8 +153,8 @@ int _dvl_nc_close(int id, onc_close_t onc_close){
             dvl_send_message(buff, bsize, 1);
         }
 
-        // free data structures for redirected files (both, results and checkpoints)
-        if (is_redirected) {
+        // free data structures for redirected and staged files (both, results and checkpoints)
+        if (rfile != NULL) {
             dvl.redirected_files[rfile->id].trash_next = dvl.free_redirected_files;
             dvl.free_redirected_files = &(dvl.redirected_files[rfile->id]);
             HASH_DEL(dvl.open_redirected_files_idx, &(dvl.redirected_files[rfile->id]));
@@ -144,38 +162,42 @@ int _dvl_nc_close(int id, onc_close_t onc_close){
 
     } else {
 
+        dvl_files_wrlock(id);
 #ifdef __MT__
-        if (pthread_rwlock_wrlock(&dvl.open_files_lock) != 0) fatal("_dvl_nc_close(): can't get wrlock");
-        dvl_file_t *dfile_check = NULL;
-        HASH_FIND_INT(dvl.open_files_idx, &id, dfile_check);
+        dvl_file_t *dfile_check = dvl_file_find(id);
         if (dfile != dfile_check) {
             fprintf(stderr, "ERROR client calling _dvl_nc_close(): dfile structure removed by other thread before sending message (i.e. 2 close calls for the same file)");
-            pthread_rwlock_unlock(&dvl.open_files_lock);
+            dvl_files_unlock(id);
             DVL_PROFILE_END;
             return toclose_res;
         }
 #endif
-        if (dfile->state == DVL_FILE_OPEN){ /* we are the client and an actual file is open (not meta) */
-
-            MAKE_MESSAGE(buff, bsize, "%c:%s", DVL_MSG_FCLOSE_CLIENT, path);
+        if (!dfile->leased){ /* we are the client and the file has been opened through DV (actual file or meta) */
 
             DVLPRINT("[DVLIB] DVL_NC_CLOSE: closing %s (ncid: %i)\n", path, toclose);
 
-            dvl_send_message(buff, bsize, 1);
+            if (dvl_report_closes()) {
+                /* batched with other access events (see dvl_report.h) */
+#ifdef __MT__
+                dvl_report_add(DVL_REPORT_CLOSE, path, mt_rank);
+#else
+                dvl_report_add(DVL_REPORT_CLOSE, path, dvl.gni.myrank);
+#endif
+            } else {
+                MAKE_MESSAGE(buff, bsize, "%c:%s", DVL_MSG_FCLOSE_CLIENT, path);
+                dvl_send_message(buff, bsize, 1);
+            }
             
-            if (dfile->meta_toclose != -1){
+            /* in DVL_FILE_SIM, the metadata file has been closed above already */
+            if (dfile->state != DVL_FILE_SIM && dfile->meta_toclose != -1){
                 (*onc_close)(dfile->meta_toclose);
             }
         }
 
-        //printf("freeing data strutures id: %i\n", dfile->id);
         /* free the file descriptor */
-        dvl.open_files[dfile->id].trash_next = dvl.free_files;
-        dvl.free_files = &(dvl.open_files[dfile->id]);
-        HASH_DEL(dvl.open_files_idx, &(dvl.open_files[dfile->id]));
-#ifdef __MT__
-        pthread_rwlock_unlock(&dvl.open_files_lock);
-#endif        
+        dvl_file_remove(dfile);
+        dvl_files_unlock(id);
+        dvl_file_delete(dfile);
     }
 
 
@@ -44,6 +44,9 @@ int dvl_nc_create(char * opath, int omode, int * ncidp, onc_create_t onc_ocreate
 
     
     int redirected = 0;
+    int staged = 0;
+    int skip_writes = 0;
+    int report_puts = 0;
     char *create_path = opath;
 
     if (dvl.is_simulator){
@@ -96,7 +99,11 @@ int dvl_nc_create(char * opath, int omode, int * ncidp, onc_create_t onc_ocreate
         } else {
             dvl.open_files_count++;
 
-            if (buff[0] == DVL_CREATE_REPLY_REDIRECT) {
+            if (buff[0] == DVL_CREATE_REPLY_ACK && buff[1] == DVL_MSG_SEP[0] && buff[2] == DVL_CREATE_REPLY_REPORT_PUTS) {
+                report_puts = 1;
+            }
+
+            if (buff[0] == DVL_CREATE_REPLY_REDIRECT || buff[0] == DVL_CREATE_REPLY_REDIRECT_SKIP_WRITES) {
                 // at least a small security check that the path is a /0 terminated string
                 char *redir_path = &buff[2];
                 size_t max_len = BUFFER_SIZE - 4;
@@ -105,15 +112,41 @@ int dvl_nc_create(char * opath, int omode, int * ncidp, onc_create_t onc_ocreate
                     printf("CREATE of %s is redirected to %s\n", opath, redir_path);
                     create_path = redir_path;
                     redirected = 1;                    
+                    skip_writes = buff[0] == DVL_CREATE_REPLY_REDIRECT_SKIP_WRITES;
                 } else {
                     printf("ERROR: redir path was longer than available buffer size. Check buffer size and/or networking protocol. Using original path that will overwrite the existing file\n");
                 }
             }
+
+            // new result file: created in DV's staging area and written back to the result path by DV
+            if (buff[0] == DVL_CREATE_REPLY_STAGE && buff[1] == DVL_MSG_SEP[0] && buff[3] == DVL_MSG_SEP[0]) {
+                char *staged_path = &buff[4];
+                size_t max_len = BUFFER_SIZE - 6;
+                size_t staged_len = strnlen(staged_path, max_len);
+                if (staged_len < max_len) {
+                    create_path = staged_path;
+                    redirected = 1;
+                    staged = 1;
+                    if (buff[2] == DVL_CREATE_REPLY_REPORT_PUTS) {
+                        report_puts = 1;
+                    }
+                } else {
+                    printf("ERROR: staged path was longer than available buffer size. Using the result path\n");
+                }
+            }
         }
     }
 
     int retval = (*onc_ocreate)(create_path, omode, ncidp);
 
+    if (retval != NC_NOERR && staged) {
+        // DV finds the file in the result path at the write-back
+        printf("CREATE of %s in the staging area failed; using the result path\n", opath);
+        redirected = 0;
+        staged = 0;
+        retval = (*onc_ocreate)(opath, omode, ncidp);
+    }
+
     if (retval != NC_NOERR) {
         return retval;
     }
@@ -122,6 +155,10 @@ int dvl_nc_create(char * opath, int omode, int * ncidp, onc_create_t onc_ocreate
         return retval;
     }
 
+    if (report_puts) {
+        dvl_report_puts_add(*ncidp);
+    }
+
     if(!redirected) {
         return retval;
     }
@@ -144,6 +181,14 @@ int dvl_nc_create(char * opath, int omode, int * ncidp, onc_create_t onc_ocreate
     memcpy(rfile->path, path, pathlen + 1);
 
     rfile->file_type = file_type;
+    rfile->staged = staged;
+    rfile->skip_writes = skip_writes;
+
+    // the data writes are skipped: no fill values for the fixed-size variables at nc_enddef() either
+    if (skip_writes) {
+        int old_mode;
+        nc_set_fill(*ncidp, NC_NOFILL, &old_mode);
+    }
 
     HASH_ADD_INT(dvl.open_redirected_files_idx, key, &(dvl.redirected_files[redir_fileid]));
 
@@ -3,9 +3,92 @@
 #include "dvl.h"
 #include "dvl_internal.h"
 #include "dvl_proxy.h"
+#include "dvl_block.h"
 #include <assert.h>
 
-int dvl_nc_get(int id, int varid, const size_t start[], const size_t count[], const void * valuesp){
+#if NC_NAT != DVL_MEMTYPE_NAT || NC_CHAR != DVL_MEMTYPE_CHAR || NC_INT != DVL_MEMTYPE_INT \
+    || NC_FLOAT != DVL_MEMTYPE_FLOAT || NC_DOUBLE != DVL_MEMTYPE_DOUBLE
+#error DVL_MEMTYPE_* (dvl.h) must match nc_type of netcdf.h
+#endif
+
+/* builds the get message; it carries the slab of the get if the number of dimensions is known.
+   DV then notifies the get as soon as this slab has been written by the simulator
+   (reply DVL_REPLY_VAR_AVAIL; see dv_variable_notification in the DV config).
+   block: the slab may be served from a block (see dvl_block.h)
+   returns the message size (<0: error) */
+static int make_get_message(char * buff, int ncid, const char * path, int varid, uint32_t rank,
+                            const size_t start[], const size_t count[], int block){
+    char startstr[BUFFER_SIZE];
+    char countstr[BUFFER_SIZE];
+    int msgsize = BUFFER_SIZE;
+    int ndims;
+
+    if (start != NULL && count != NULL && nc_inq_varndims(ncid, varid, &ndims) == NC_NOERR) {
+        stringify_size_array(startstr, BUFFER_SIZE, start, ndims);
+        stringify_size_array(countstr, BUFFER_SIZE, count, ndims);
+        if (block) {
+            MAKE_MESSAGE(buff, msgsize, "%c:%s:%i:%i:%i:%s:%s:%s", DVL_MSG_VGET, path, varid, rank, ndims, startstr, countstr, DVL_BLOCK_REQUEST);
+        } else {
+            MAKE_MESSAGE(buff, msgsize, "%c:%s:%i:%i:%i:%s:%s", DVL_MSG_VGET, path, varid, rank, ndims, startstr, countstr);
+        }
+    } else {
+        MAKE_MESSAGE(buff, msgsize, "%c:%s:%i:%i:", DVL_MSG_VGET, path, varid, rank);
+    }
+    return msgsize;
+}
+
+/* sends the get message and receives DV's reply into buff (blocking).
+   a block reply is served here (DVL_GET_SERVED); if the block cannot be read,
+   the get is sent again without block request */
+static int ask_dv(char * buff, int ncid, const char * path, int varid, uint32_t rank,
+                  const size_t start[], const size_t count[], int block, void * valuesp){
+    int msgsize = make_get_message(buff, ncid, path, varid, rank, start, count, block);
+    if (msgsize<0) return DVL_ERROR;
+
+    dvl_send_message(buff, msgsize, 0);
+    dvl_recv_message(buff, BUFFER_SIZE, 1);
+
+    if (block && buff[0] == DVL_REPLY_BLOCK) {
+        if (dvl_block_read(ncid, path, varid, buff[1] == ':' ? buff + 2 : "", start, count, valuesp) == 0) {
+            return DVL_GET_SERVED;
+        }
+        DVLPRINT("[DVLIB] block %s of %s not readable; asking for the file\n", buff + 1, path);
+        return ask_dv(buff, ncid, path, varid, rank, start, count, 0, valuesp);
+    }
+    return DVL_SUCCESS;
+}
+
+/* opens the actual file after DV's reply to a get (write lock held in MT) and returns the id to read from.
+   DVL_REPLY_FILE_OPEN: the file is complete -> DVL_FILE_OPEN
+   DVL_REPLY_VAR_AVAIL: only the requested slab is -> DVL_FILE_PARTIAL; the simulator is still writing the file,
+                        thus it is opened with NC_SHARE (no stale buffers) and the next gets still ask DV
+   new result files are read from DV's staging area until they are written back (see dvl_staged_path()) */
+static int open_after_reply(dvl_file_t * dfile, char reply, const char * fullpath){
+    if (dfile->state == DVL_FILE_SIM) {
+        int ncid;
+        int omode = dfile->omode;
+        if (reply == DVL_REPLY_VAR_AVAIL) omode |= NC_SHARE;
+
+        char sbuff[MAX_FILE_NAME];
+        const char * spath = dvl_staged_path(dfile->path, sbuff);
+        int res = NC_NOERR;
+        if (spath == NULL || dvl.ncopen(spath, omode, &ncid) != NC_NOERR) {
+            res = dvl.ncopen(fullpath, omode, &ncid);
+        }
+        if (res != NC_NOERR) {
+            fprintf(stderr, "dvl_nc_get(): cannot open %s: %s\n", fullpath, nc_strerror(res));
+            return res;
+        }
+        dfile->ncid = ncid;
+        dfile->state = reply == DVL_REPLY_VAR_AVAIL ? DVL_FILE_PARTIAL : DVL_FILE_OPEN;
+    } else if (dfile->state == DVL_FILE_PARTIAL && reply == DVL_REPLY_FILE_OPEN) {
+        dfile->state = DVL_FILE_OPEN;
+    }
+    return dfile->ncid;
+}
+
+
+int dvl_nc_get(int id, int varid, const size_t start[], const size_t count[], int memtype, const void * valuesp){
 
     char buff[BUFFER_SIZE];        
 
@@ -21,7 +104,8 @@ int dvl_nc_get(int id, int varid, const size_t start[], const size_t count[], co
     // the entire open_files hashmap useless in that case.
     // And actually, the messaging with DV is a blocking operation that can take a while
     // if the file needs to be generated first.
-    // Thus, a local copy of the data structure is created for MT aware libraries.
+    // Thus, a compact local copy of the needed fields is created for MT aware libraries
+    // (the interned path is kept valid with a reference; see dvl_path_ref()).
     // Default library continues using the data as before
     // * Additional difference for MT: mt_rank (created inside DVL_CHECK() macro) is used instead
     //   of dvl.gni.myrank in MAKE_MESSAGE.
@@ -33,100 +117,93 @@ int dvl_nc_get(int id, int varid, const size_t start[], const size_t count[], co
 #ifdef __MT__
     // copy of default code with several modifications as explained above
 
-    if (pthread_rwlock_rdlock(&dvl.open_files_lock) != 0) fatal("dvl_nc_get(): can't get rdlock");
-    dvl_file_t * dfile_ptr = NULL;
-    HASH_FIND_INT(dvl.open_files_idx, &id, dfile_ptr);
+    dvl_files_rdlock(id);
+    dvl_file_t * dfile_ptr = dvl_file_find(id);
     if (dfile_ptr == NULL) {
-        pthread_rwlock_unlock(&dvl.open_files_lock);
+        dvl_files_unlock(id);
         return id;
     }
 
-    // create local copy and release lock
-    dvl_file_t dfile = *dfile_ptr;
-    pthread_rwlock_unlock(&dvl.open_files_lock);
-
     /* if the file is already open, just get the data */
-    if (dfile.state == DVL_FILE_OPEN) {
-        return dfile.ncid;
+    if (dfile_ptr->state == DVL_FILE_OPEN) {
+        int ncid = dfile_ptr->ncid;
+        dvl_files_unlock(id);
+        return ncid;
     }
 
+    // create a compact local copy and release lock
+    // the interned path stays valid with the additional reference
+    int state = dfile_ptr->state;
+    int ncid = dfile_ptr->ncid;
+    int omode = dfile_ptr->omode;
+    const char * dpath = dvl_path_ref(dfile_ptr->path);
+    dvl_files_unlock(id);
+
     nc_type type;
     size_t tsize;
-    nc_inq_vartype(dfile.ncid, varid, &type);
-    nc_inq_type(dfile.ncid, type, NULL, &tsize);
+    nc_inq_vartype(ncid, varid, &type);
+    nc_inq_type(ncid, type, NULL, &tsize);
 
     //printf("GET (size: %u)!!!\n", (uint32_t) tsize);
 
     /* ask the dvl for this data, communicate the rank. 
-       It can reply with AVAIL or SIMULATING */
-    int msgsize = BUFFER_SIZE;
-
+       It can reply with AVAIL, SIMULATING, or a block (files not open yet) */
     // note: additional change here: dvl.gni.myrank -> mt_rank
-    MAKE_MESSAGE(buff, msgsize, "%c:%s:%i:%i:", DVL_MSG_VGET, dfile.path, varid, mt_rank);
-
-    if (msgsize<0) return DVL_ERROR;
-
-    dvl_send_message(buff, msgsize, 0);
-    
-    /* recv response (which is blocking) */
-    dvl_recv_message(buff, BUFFER_SIZE, 1);
+    int block = state == DVL_FILE_SIM && dvl_block_usable(ncid, varid, memtype);
+    int res = ask_dv(buff, ncid, dpath, varid, mt_rank, start, count, block, (void *) valuesp);
+    if (res != DVL_SUCCESS) {
+        dvl_path_unref(dpath);
+        return res;
+    }
    
-    if (buff[0] == DVL_REPLY_FILE_OPEN) {
+    if (buff[0] == DVL_REPLY_FILE_OPEN || buff[0] == DVL_REPLY_VAR_AVAIL) {
         /* if AVAIL just open the file and read from it */
-        assert(dfile.state==DVL_FILE_SIM);
+        assert(state==DVL_FILE_SIM || state==DVL_FILE_PARTIAL);
+        char reply = buff[0];
 
         // more things need to happen within the write lock here to avoid race conditions to actually open the file
         // note: it is not clear how a client may have made non-thread-safe netcdf working with multiple threads
         // while open and close may be encapsulated in locks, get operations may potentially be free floating
         // -> thus: any race condition between changing states here and actually open file identifiers must be avoided
 
-        snprintf(buff, BUFFER_SIZE, "%s%s", dvl.respath, dfile.path);
+        snprintf(buff, BUFFER_SIZE, "%s%s", dvl.respath, dpath);
         printf("DVL said the file is avail: opening %s\n", buff);
 
-        if (pthread_rwlock_wrlock(&dvl.open_files_lock) != 0) fatal("dvl_nc_get(): can't get wrlock");        
-        HASH_FIND_INT(dvl.open_files_idx, &id, dfile_ptr);
+        dvl_files_wrlock(id);
+        dfile_ptr = dvl_file_find(id);
         if (dfile_ptr == NULL) {
-            pthread_rwlock_unlock(&dvl.open_files_lock);
+            dvl_files_unlock(id);
+            dvl_path_unref(dpath);
             fprintf(stderr, "dvl_nc_get(): file data structure removed before it could be updated with new info. Check client code.\n");
             return NC_EBADID; // return error message
         }
 
-        if (strncmp(dfile.path, dfile_ptr->path, MAX_FILE_NAME) == 0) {
-            if (dfile_ptr->state == DVL_FILE_SIM) {
-                // see assert above: OK to actually open the actual file
-                dvl.ncopen(buff, dfile.omode, &(dfile.ncid));
-                dfile.state = DVL_FILE_OPEN;
-
-                dfile_ptr->state = dfile.state;
-                dfile_ptr->ncid = dfile.ncid;
-            } else if (dfile_ptr->state == DVL_FILE_OPEN) {
-                // a get() operation from another thread has been faster -> use that id
-                dfile.ncid = dfile_ptr->ncid;
-            } else {
-                fprintf(stderr, "dvl_nc_get(): Unknown state inside of dfile. Check DVLib code.\n");
-                // this should not happen
-                dfile.ncid = NC_EBADID;
-            }
+        // paths are interned: same file <=> same pointer
+        if (dpath == dfile_ptr->path) {
+            // note: a get() operation from another thread may have been faster -> its id is used
+            ncid = open_after_reply(dfile_ptr, reply, buff);
         } else {
             fprintf(stderr, "dvl_nc_get(): file path does not match after lookup. File ID must have been reused by other file. Check client code.\n");
-            dfile.ncid = NC_EBADID;
+            ncid = NC_EBADID;
         }
 
-        pthread_rwlock_unlock(&dvl.open_files_lock);
+        dvl_files_unlock(id);
+        dvl_path_unref(dpath);
 
-        return dfile.ncid;
+        return ncid;
 
     } else if (buff[0] == DVL_REPLY_RDMA) {
         /* make RDMA get */
 
+        dvl_path_unref(dpath);
         return -1; /* do not call the original get */
     }
 
+    dvl_path_unref(dpath);
 
 #else
     // default / master code
-    dvl_file_t * dfile = NULL;
-    HASH_FIND_INT(dvl.open_files_idx, &id, dfile);
+    dvl_file_t * dfile = dvl_file_find(id);
     if (dfile==NULL) return id;
 
     /* if the file is already open, just get the data */
@@ -142,29 +219,20 @@ int dvl_nc_get(int id, int varid, const size_t start[], const size_t count[], co
     //printf("GET (size: %u)!!!\n", (uint32_t) tsize);
 
     /* ask the dvl for this data, communicate the rank. 
-       It can reply with AVAIL or SIMULATING */
-    int msgsize = BUFFER_SIZE;
-
-    MAKE_MESSAGE(buff, msgsize, "%c:%s:%i:%i:", DVL_MSG_VGET, dfile->path, varid, dvl.gni.myrank);
-
-    if (msgsize<0) return DVL_ERROR;
-
-    dvl_send_message(buff, msgsize, 0);
-    
-    /* recv response (which is blocking) */
-    dvl_recv_message(buff, BUFFER_SIZE, 1);
+       It can reply with AVAIL, SIMULATING, or a block (files not open yet) */
+    int block = dfile->state == DVL_FILE_SIM && dvl_block_usable(dfile->ncid, varid, memtype);
+    int res = ask_dv(buff, dfile->ncid, dfile->path, varid, dvl.gni.myrank, start, count, block, (void *) valuesp);
+    if (res != DVL_SUCCESS) return res;
    
-    if (buff[0] == DVL_REPLY_FILE_OPEN) {
+    if (buff[0] == DVL_REPLY_FILE_OPEN || buff[0] == DVL_REPLY_VAR_AVAIL) {
         /* if AVAIL just open the file and read from it */
-        assert(dfile->state==DVL_FILE_SIM);
-    
-        dfile->state = DVL_FILE_OPEN;
-        snprintf(buff, BUFFER_SIZE, "%s%s", dvl.respath, dfile->path);        
+        assert(dfile->state==DVL_FILE_SIM || dfile->state==DVL_FILE_PARTIAL);
+        char reply = buff[0];
 
-        dvl.ncopen(buff, dfile->omode, &(dfile->ncid));
+        snprintf(buff, BUFFER_SIZE, "%s%s", dvl.respath, dfile->path);
+        printf("DVL said the %s is avail: opening %s\n", reply == DVL_REPLY_VAR_AVAIL ? "variable" : "file", buff);
 
-        printf("DVL said the file is avail: opening %s\n", buff);
-        return dfile->ncid;
+        return open_after_reply(dfile, reply, buff);
 
     } else if (buff[0] == DVL_REPLY_RDMA) {
         /* make RDMA get */
@@ -178,3 +246,21 @@ int dvl_nc_get(int id, int varid, const size_t start[], const size_t count[], co
     assert(1!=1);
     return id; /* shouldn't be reached */
 }
+
+
+int dvl_nc_get_done(int id, int ncid, int varid, const size_t start[], const size_t count[], int memtype,
+                    const void * valuesp, int status){
+    char path[MAX_FILE_NAME];
+
+    if (status != NC_NOERR || !dvl.enabled || dvl.is_simulator || !dvl_block_enabled()) return status;
+
+    /* blocks are taken from complete files only */
+    dvl_files_rdlock(id);
+    dvl_file_t * dfile = dvl_file_find(id);
+    int complete = dfile != NULL && dfile->state == DVL_FILE_OPEN;
+    if (complete) snprintf(path, MAX_FILE_NAME, "%s", dfile->path);
+    dvl_files_unlock(id);
+
+    if (complete) dvl_block_capture(ncid, path, varid, memtype, start, count, valuesp);
+    return status;
+}
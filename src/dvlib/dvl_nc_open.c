@@ -3,6 +3,10 @@
 #include "dvl.h"
 #include "dvl_internal.h"
 #include "dvl_proxy.h"
+#include "dvl_lease.h"
+#include "dvl_report.h"
+#include "dvl_lcache.h"
+#include "dvl_readahead.h"
 
 /*
 int dvl_nc_open(char *path, int omode, int * ncidp){
@@ -10,6 +14,19 @@ int dvl_nc_open(char *path, int omode, int * ncidp){
 }
 */
 
+/* new result files are read from DV's staging area until they are written back (see dvl_staged_path());
+   read-only opens of other result files use the node-local cache if enabled (see dvl_lcache.h) */
+static int open_result_file(char * opath, const char * path, int omode, int * ncidp, onc_open_t onc_open){
+    char sbuff[MAX_FILE_NAME];
+    const char * spath = dvl_staged_path(path, sbuff);
+    if (spath != NULL && (*onc_open)(spath, omode, ncidp) == NC_NOERR) return NC_NOERR;
+    if (spath == NULL && !(omode & NC_WRITE)) {
+        const char * lpath = dvl_lcache_path(path, opath, sbuff);
+        if (lpath != opath && (*onc_open)(lpath, omode, ncidp) == NC_NOERR) return NC_NOERR;
+    }
+    return (*onc_open)(opath, omode, ncidp);
+}
+
 int _dvl_nc_open(char * opath, int omode, int * ncidp, onc_open_t onc_open){
 
     char buff[BUFFER_SIZE];        
@@ -35,33 +52,40 @@ int _dvl_nc_open(char * opath, int omode, int * ncidp, onc_open_t onc_open){
 
         //printf("DVL OPEN!\n");
 
-#ifdef __MT__
-        if (pthread_rwlock_wrlock(&dvl.open_files_lock) != 0) fatal("_dvl_nc_open(): can't get wrlock");
-#endif
-        /* Check if we have file descriptors available */
-        if (dvl.free_files==NULL){
-            printf("Error: too many open files!\n");
-            DVL_ABORT;
-        }        
-
-        size_t pathlen = strlen(path);
-        if (pathlen >= MAX_FILE_NAME){
-            printf("Error: file name too long: %s\n", path);
-            DVL_ABORT;
-        }
-    
-        /* get the next free file descriptor */
-        int fileid = dvl.free_files->id;
-        dvl.free_files = dvl.free_files->trash_next;
-
-        dvl_file_t * dfile = &(dvl.open_files[fileid]);
-        memcpy(dfile->path, path, pathlen + 1);
+        /* get a new file descriptor (the table grows on demand) */
+        dvl_file_t * dfile = dvl_file_new(path);
 
 #ifdef __MT__
-        pthread_rwlock_unlock(&dvl.open_files_lock);
-        // avoid having the data structure locked over the entire communication time with DV
+        uint32_t rank = mt_rank;
+#else
+        uint32_t rank = dvl.gni.myrank;
 #endif
 
+        /* read lease: the file is available and locked by DV -> no round trip */
+        int read_only = !(omode & NC_WRITE);
+        if (read_only && dvl_lease_valid(path)) {
+            int res = open_result_file(opath, path, omode, ncidp, onc_open);
+            if (res == NC_NOERR) {
+                dfile->state = DVL_FILE_OPEN;
+                dfile->leased = 1;
+                dfile->meta_toclose = -1;
+                dfile->ncid = *ncidp;
+                dfile->key = *ncidp;
+                dfile->omode = omode;
+
+                dvl_files_wrlock(dfile->key);
+                dvl_file_add(dfile);
+                dvl_files_unlock(dfile->key);
+
+                dvl_report_add(DVL_REPORT_OPEN_LEASED, path, rank);
+
+                DVLPRINT("[DVLIB] DVL_NC_OPEN (leased): %s; open files: %u; key: %i\n", path, dvl.open_files_active, *ncidp);
+                DVL_PROFILE_END;
+                return res;
+            }
+            dvl_lease_drop(path);
+        }
+
 
 #ifdef BENCH
         //LSB_Set_Rparam_str("restart", simstart);
@@ -71,18 +95,28 @@ int _dvl_nc_open(char * opath, int omode, int * ncidp, onc_open_t onc_open){
         /* send request to the dvl */
         int msgsize = BUFFER_SIZE;
 
-#ifdef __MT__
-        MAKE_MESSAGE(buff, msgsize, "%c:%s:%i:file=%s;gni_addr=%u", DVL_MSG_FOPEN, path, mt_rank, path, dvl.gni.addr);
-#else
-        MAKE_MESSAGE(buff, msgsize, "%c:%s:%i:file=%s;gni_addr=%u", DVL_MSG_FOPEN, path, dvl.gni.myrank, path, dvl.gni.addr);
-#endif
+        char options[32] = "";
+        if (0 < dvl_readahead_files()) {
+            snprintf(options, sizeof(options), ":%s%i", DVL_READAHEAD_REQUEST, dvl_readahead_files());
+        }
+        if (read_only && dvl_lease_enabled()) {
+            MAKE_MESSAGE(buff, msgsize, "%c:%s:%i:file=%s;gni_addr=%u:%s%s", DVL_MSG_FOPEN, path, rank, path, dvl.gni.addr, DVL_LEASE_REQUEST, options);
+        } else {
+            MAKE_MESSAGE(buff, msgsize, "%c:%s:%i:file=%s;gni_addr=%u%s", DVL_MSG_FOPEN, path, rank, path, dvl.gni.addr, options);
+        }
 
 
-        if (msgsize<0) return DVL_ERROR;
+        if (msgsize<0) {
+            dvl_file_delete(dfile);
+            return DVL_ERROR;
+        }
+        uint64_t sent_ms = dvl_lease_now_ms();
         dvl_send_message(buff, msgsize, 0);
     
         /* recv response */
         dvl_recv_message(buff, BUFFER_SIZE, 1);
+        dvl_lease_grant(path, buff, sent_ms);
+        dvl_readahead_hints(buff);
 
         int res; /* it has to be a valid ncid*/
         int is_meta=0;
@@ -97,8 +131,11 @@ int _dvl_nc_open(char * opath, int omode, int * ncidp, onc_open_t onc_open){
                 MAKE_MESSAGE(buff, msgsize, "%c:%s:%i:%i:", DVL_MSG_VGET, dfile->path, 0, dvl.gni.myrank);
 
                 //printf("sending (%i): %s\n", msgsize, buff);
-                if (msgsize<0) return DVL_ERROR;
-                
+                if (msgsize<0) {
+                    dvl_file_delete(dfile);
+                    return DVL_ERROR;
+                }
+
 
                 dvl_send_message(buff, msgsize, 0);
             
@@ -114,7 +151,7 @@ int _dvl_nc_open(char * opath, int omode, int * ncidp, onc_open_t onc_open){
         }
 
         if (!is_meta){
-            res = (*onc_open)(opath, omode, ncidp);
+            res = open_result_file(opath, path, omode, ncidp, onc_open);
             dfile->state = DVL_FILE_OPEN;
             dfile->meta_toclose = -1;
         }
@@ -124,17 +161,11 @@ int _dvl_nc_open(char * opath, int omode, int * ncidp, onc_open_t onc_open){
         dfile->omode = omode;
 
 
-#ifdef __MT__
-        if (pthread_rwlock_wrlock(&dvl.open_files_lock) != 0) fatal("_dvl_nc_open(): can't get wrlock");
-#endif
-
-        HASH_ADD_INT(dvl.open_files_idx, key, &(dvl.open_files[fileid]));
-         
-        DVLPRINT("[DVLIB] DVL_NC_OPEN: %s; fileid: %i; idx cnt: %u; res: %i; key: %i\n", path, fileid, HASH_COUNT(dvl.open_files_idx), res, *ncidp); 
+        dvl_files_wrlock(dfile->key);
+        dvl_file_add(dfile);
+        dvl_files_unlock(dfile->key);
 
-#ifdef __MT__
-        pthread_rwlock_unlock(&dvl.open_files_lock);
-#endif
+        DVLPRINT("[DVLIB] DVL_NC_OPEN: %s; open files: %u; res: %i; key: %i\n", path, dvl.open_files_active, res, *ncidp);
        
         DVL_PROFILE_END;
         return res; 
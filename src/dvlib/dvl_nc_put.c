@@ -9,20 +9,37 @@
 void stringify_size_array(char * buff, size_t bsize, const size_t * arr, size_t asize){
     int off = 0;
     int res;
+    buff[0] = '\0';
     for (int i=0; i<asize; i++){
         res = snprintf(buff + off, bsize-off, "%lu,", arr[i]);
 
         //printf("stringify: ndims: %lu, res: %i, write: %lu; buff: %s\n", asize, res, arr[i], buff);
-        if (res>bsize-off) { printf("BUFFER TO SMALL!\n"); DVL_ABORT;}
+        if (res>=bsize-off) { printf("BUFFER TO SMALL!\n"); DVL_ABORT;}
         off += res;
     }
-    printf("\n");
-    buff[off-1] = '\0';
+    if (off > 0) buff[off-1] = '\0';
+}
+
+
+int dvl_nc_put_skipped(int id){
+    // redirected result file of a re-simulation (DVL_CREATE_REPLY_REDIRECT_SKIP_WRITES): DV keeps the
+    // existing file and removes the redirected one -> the data is not written.
+    // note: no DVL_CHECK here; files are only redirected after the init (see dvl_nc_create)
+    if (dvl.enabled && dvl.is_simulator && dvl.open_redirected_files_idx != NULL) {
+        dvl_redirected_file_t *rfile = NULL;
+        HASH_FIND_INT(dvl.open_redirected_files_idx, &id, rfile);
+        return rfile != NULL && rfile->skip_writes;
+    }
+    return 0;
 }
 
 
 int dvl_nc_put(int id, int varid, const size_t start[], const size_t count[], const void * valuesp){
-    // nothing is done here at the moment (see: the macro is not defined)
+    if (dvl_nc_put_skipped(id)) {
+        return DVL_PREVENT_WRITING_DATA_DURING_REDIRECT;
+    }
+
+    // nothing else is done here at the moment (see: the macro is not defined)
     // when it gets activated, various things need to be checked again against the latest version of the code base
 
 #ifdef SEND_PUT_MESSAGE
@@ -44,16 +61,6 @@ int dvl_nc_put(int id, int varid, const size_t start[], const size_t count[], co
 
 
     if (dvl.is_simulator) {
-#ifdef __WRITE_NO_DATA_DURING_REDIRECT__
-        // here the implementation if SEND_PUT_MESSAGE is on
-        // below follows the implementation if it is off
-        dvl_redirected_file_t *rfile = NULL;
-        HASH_FIND_INT(dvl.open_redirected_files_idx, &id, rfile);
-        if (rfile != NULL) {
-            return DVL_PREVENT_WRITING_DATA_DURING_REDIRECT;
-        }
-#endif
-
         size_t pathlen;
         int ndims;
 
@@ -87,30 +94,64 @@ int dvl_nc_put(int id, int varid, const size_t start[], const size_t count[], co
         return id;
     }
     printf("put from client applications is not supported yet\n");
+#endif // SEND_PUT_MESSAGE
 
 
-#else
-    // inactive SEND_PUT_MESSAGE
-    // only code for testing of __WRITE_NO_DATA_DURING_REDIRECT__
+    return id;
+}
 
-#ifdef __WRITE_NO_DATA_DURING_REDIRECT__
 
-#ifdef __MT__
-    uint32_t mt_rank = 0;
-#endif
-    DVL_CHECK(DVL_NC_PUT_ID);
+/* early data availability (see dv_variable_notification in the DV config):
+   after a successful put, the data is flushed and the written slab is reported to DV,
+   which notifies the clients waiting for it before the file is closed.
+   -> only for files for which DV asked for it in the create reply
+   -> not for netCDF-4 files: HDF5 files cannot be read while they are being written;
+      clients waiting for them are notified at the close (safety mode)
+   -> not for redirected files (clients read the existing file); staged files are reported
+      with their path relative to the result path
+   -> also called for skipped puts of redirected files (status NC_NOERR; see dvl_nc_put())
+   returns status (of the original put) */
+int dvl_nc_put_done(int id, int varid, const size_t start[], const size_t count[], int status){
+    if (status != NC_NOERR || !dvl.enabled || !dvl.is_simulator || dvl.finalized || !dvl_report_puts_find(id)) return status;
 
-    if (dvl.is_simulator) {
-        dvl_redirected_file_t *rfile = NULL;
-        HASH_FIND_INT(dvl.open_redirected_files_idx, &id, rfile);
-        if (rfile != NULL) {
-            return DVL_PREVENT_WRITING_DATA_DURING_REDIRECT;
-        }
+    dvl_redirected_file_t *rfile = NULL;
+    HASH_FIND_INT(dvl.open_redirected_files_idx, &id, rfile);
+    if (rfile != NULL && !rfile->staged) return status;
+
+    int format;
+    if (nc_inq_format(id, &format) != NC_NOERR) return status;
+    if (format == NC_FORMAT_NETCDF4 || format == NC_FORMAT_NETCDF4_CLASSIC) return status;
+
+    char buff[BUFFER_SIZE];
+    char pathbuff[MAX_FILE_NAME];
+    char npath[MAX_FILE_NAME];
+    char countstr[BUFFER_SIZE];
+    char startstr[BUFFER_SIZE];
+    size_t pathlen;
+    int ndims;
+
+    char * path;
+    if (rfile != NULL) {
+        path = rfile->path;
+    } else {
+        if (nc_inq_path(id, &pathlen, NULL) != NC_NOERR || pathlen >= MAX_FILE_NAME) return status;
+        nc_inq_path(id, NULL, pathbuff);
+        path = is_result_file(pathbuff, npath);
+        if (path == NULL) return status;
     }
-#endif // __WRITE_NO_DATA_DURING_REDIRECT__
 
-#endif // SEND_PUT_MESSAGE
+    if (nc_inq_varndims(id, varid, &ndims) != NC_NOERR) return status;
 
+    // clients may read the slab as soon as DV has the message
+    if (nc_sync(id) != NC_NOERR) return status;
 
-    return id;
+    stringify_size_array(startstr, BUFFER_SIZE, start, ndims);
+    stringify_size_array(countstr, BUFFER_SIZE, count, ndims);
+
+    int bsize = BUFFER_SIZE;
+    MAKE_MESSAGE(buff, bsize, "%c:%i:%i:%s:%i:%s:%s:%c", DVL_MSG_VPUT, dvl.gni.myrank, varid, path, ndims, startstr, countstr, DVL_VPUT_FLUSHED);
+    if (bsize<0) return status;
+
+    dvl_send_message(buff, bsize, 1);
+    return status;
 }
@@ -6,6 +6,8 @@
 #include <unistd.h>
 #include <string.h>
 #include "dvl_proxy.h"
+#include "dvl_shm.h"
+#include "dvl_report.h"
 #include "dvl.h"
 
 /* AF_INET socket stuff */
@@ -33,25 +35,45 @@
 
 #define CONN_TRIES 1
 char * jobid;
+#ifdef __MT__
+// messages and replies of different threads must not interleave on one connection
+__thread int sockfd=0;
+#else
 int sockfd=0;
+#endif
 
 char * srv_last_ip=NULL;
 
+/* 1: the reply to the last message is expected on the shared-memory channel (see dvl_shm.c) */
+#ifdef __MT__
+__thread int shm_pending=0;
+#else
+int shm_pending=0;
+#endif
 
-int dvl_srv_connect(){
-
-    int res=-1;
-    struct sockaddr_in srv_addr;
 
+int dvl_srv_port(){
     int port = (dvl.is_simulator) ? DVL_PROXY_SRV_DEFAULT_JOB_PORT : DVL_PROXY_SRV_DEFAULT_APP_PORT;
-    port = (getenv(ENV_PORT)!=NULL) ? atoi(getenv(ENV_PORT)) : port;
-    uint16_t srv_port = htons(port);
+    return (getenv(ENV_PORT)!=NULL) ? atoi(getenv(ENV_PORT)) : port;
+}
 
+char * dvl_srv_ip_list(){
     /* this can be a comma-separated list of IPs */
-    char * srv_ip_list = (getenv(ENV_IP)!=NULL) ? getenv(ENV_IP) : DVL_PROXY_SRV_DEFAULT_IP;
+    return (getenv(ENV_IP)!=NULL) ? getenv(ENV_IP) : DVL_PROXY_SRV_DEFAULT_IP;
+}
+
+
+/* connects the given socket to DV; exits on failure (see dvl_srv_connect) */
+static int dvl_connect_socket(int * fd){
+
+    int res=-1;
+    struct sockaddr_in srv_addr;
+
+    uint16_t srv_port = htons(dvl_srv_port());
+    char * srv_ip_list = dvl_srv_ip_list();
 
-    sockfd = socket(AF_INET, SOCK_STREAM, 0);
-    if (sockfd < 0) {
+    *fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (*fd < 0) {
         perror("Error while creating socket");
 	    exit(-1);
     }
@@ -73,7 +95,7 @@ int dvl_srv_connect(){
         srv_addr.sin_port = srv_port;
         res = inet_pton(AF_INET, srv_ip, &srv_addr.sin_addr);
         if (res<=0) {
-            sockfd=0;
+            *fd=0;
             DVLPRINT("Invald IP address\n");
             //return INVALID_IP;
         }else{
@@ -82,7 +104,7 @@ int dvl_srv_connect(){
             int tries=0;
             res = -1;
             while (res<0 && tries<CONN_TRIES){
-    	        res = connect(sockfd, (struct sockaddr *)&srv_addr, sizeof(srv_addr));
+    	        res = connect(*fd, (struct sockaddr *)&srv_addr, sizeof(srv_addr));
     	        if (res<0) {
                     DVLPRINT("Error while connecting: %i (%i/%i)\n", res, tries+1, CONN_TRIES);
                     tries++;
@@ -103,6 +125,10 @@ int dvl_srv_connect(){
     return CONNECTED;
 }
 
+int dvl_srv_connect(){
+    return dvl_connect_socket(&sockfd);
+}
+
 int dvl_srv_disconnect(){
     if (sockfd) close(sockfd);
     sockfd=0;
@@ -122,6 +148,14 @@ int dvl_check_connection(){
 
 int dvl_send_message(char * buff, int size, int disconnect){
 
+    /* requests waiting for a reply: DV must have seen all earlier events first (see dvl_report.h) */
+    if (!disconnect) dvl_report_flush();
+
+    /* node-local DV: shared memory instead of the socket (application clients only) */
+    if (!dvl.is_simulator && dvl_shm_usable(dvl_srv_port(), dvl_srv_ip_list())) {
+        shm_pending = !disconnect;
+        return dvl_shm_send(buff, size);
+    }
 	 
     int res = dvl_check_connection();
     if (res!=CONNECTED) return res;
@@ -143,8 +177,26 @@ int dvl_send_message(char * buff, int size, int disconnect){
 }
 
 int dvl_recv_message(char * buff, int size, int disconnect){
+
+    int res;
+    if (shm_pending) {
+        shm_pending = 0;
+        int oversized = 0;
+        res = dvl_shm_recv(buff, size, &oversized);
+        if (!oversized) return res;
+
+        /* too large for the channel: DV keeps the reply until it is fetched on the socket */
+        res = dvl_check_connection();
+        if (res!=CONNECTED) return res;
+        if (write(sockfd, buff, strlen(buff))<0){
+            dvl_srv_disconnect();
+            DVLPRINT("Error while fetching a reply on the socket (message: %s)\n", buff);
+            return DVL_ERROR;
+        }
+        disconnect = 1;
+    }
     
-    int res = dvl_check_connection();
+    res = dvl_check_connection();
     if (res!=CONNECTED) return res;
 
     res = read(sockfd, buff, size-1);
@@ -168,5 +220,33 @@ int dvl_recv_message(char * buff, int size, int disconnect){
 }
 
 
+int dvl_open_connection(){
+    int fd = 0;
+    if (dvl_connect_socket(&fd) != CONNECTED || fd <= 0) return DVL_ERROR;
+    return fd;
+}
+
+int dvl_send_message_on(int fd, char * buff, int size){
+    int res = write(fd, buff, size);
+    if (res<0){
+        DVLPRINT("Error while writing to socket: %i (message: %s)\n", res, buff);
+        return DVL_ERROR;
+    }
+    return DVL_SUCCESS;
+}
+
+int dvl_recv_message_on(int fd, char * buff, int size){
+    int res = read(fd, buff, size-1);
+    if (res<=0){
+        if (res<0) perror("Read failed!");
+        else printf("Server socket has been closed\n");
+        return DVL_ERROR;
+    }
+
+    buff[res] = '\0';
+    return res;
+}
+
+
 
 
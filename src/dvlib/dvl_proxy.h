@@ -15,6 +15,16 @@
 int dvl_send_message(char * buff, int size, int disconnect);
 int dvl_recv_message(char * buff, int size, int disconnect);
 
+/* DV endpoint of this process (see ENV_PORT, ENV_IP) */
+int dvl_srv_port();
+char * dvl_srv_ip_list();
+
+/* dedicated connections (e.g. for asynchronous opens, see extended API):
+   the caller owns the returned socket and closes it */
+int dvl_open_connection();
+int dvl_send_message_on(int fd, char * buff, int size);
+int dvl_recv_message_on(int fd, char * buff, int size);
+
 
 #define MAKE_MESSAGE(buff, size, format, ...) \
 { \
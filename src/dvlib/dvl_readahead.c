@@ -0,0 +1,186 @@
+/*
+ * Readahead of predicted result files (see dvl_readahead.h).
+ *
+ * -> the hints are relative to the result path (DV file names); the full path is dvl.respath + name
+ * -> a file is advised with open + posix_fadvise(WILLNEED) + close; the kernel reads it asynchronously
+ * -> the hints of an open reply are queued; the MT variants drain the queue in a background thread,
+ *    the other variants at the next close of the client (dvl_readahead_flush())
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "dvl.h"
+#include "dvl_internal.h"
+#include "dvl_proxy.h"
+#include "dvl_readahead.h"
+
+#ifdef __MT__
+#include <pthread.h>
+#endif
+
+
+static int readahead_files = 0;
+
+static uint64_t recent[DVL_READAHEAD_RECENT];
+static uint32_t recent_next = 0;
+
+static uint64_t readahead_hints = 0;
+static uint64_t readahead_advised = 0;
+static uint64_t readahead_dropped = 0;
+
+static char readahead_queue[DVL_READAHEAD_QUEUE][MAX_FILE_NAME];
+static uint32_t queue_head = 0;
+static uint32_t queue_count = 0;
+
+#ifdef __MT__
+static pthread_mutex_t readahead_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t readahead_cond = PTHREAD_COND_INITIALIZER;
+static int readahead_thread_started = 0;
+#define READAHEAD_LOCK pthread_mutex_lock(&readahead_lock)
+#define READAHEAD_UNLOCK pthread_mutex_unlock(&readahead_lock)
+#else
+#define READAHEAD_LOCK
+#define READAHEAD_UNLOCK
+#endif
+
+
+/* 64-bit FNV-1a */
+static uint64_t readahead_hash(const char * name, size_t len){
+    uint64_t h = 14695981039346656037ull;
+    for (size_t i = 0; i < len; i++){
+        h ^= (unsigned char) name[i];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+/* 1 if the file has been advised recently (it is remembered otherwise); the lock must be held */
+static int readahead_recent(uint64_t hash){
+    for (uint32_t i = 0; i < DVL_READAHEAD_RECENT; i++){
+        if (recent[i] == hash) return 1;
+    }
+    recent[recent_next] = hash;
+    recent_next = (recent_next + 1) % DVL_READAHEAD_RECENT;
+    return 0;
+}
+
+/* takes the oldest pending file; 0 if there is none; the lock must be held */
+static int readahead_dequeue(char * fullpath){
+    if (queue_count == 0) return 0;
+    memcpy(fullpath, readahead_queue[queue_head], MAX_FILE_NAME);
+    queue_head = (queue_head + 1) % DVL_READAHEAD_QUEUE;
+    queue_count--;
+    return 1;
+}
+
+static void readahead_advise(const char * fullpath){
+    int fd = open(fullpath, O_RDONLY);
+    if (fd < 0) return;
+    posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+    close(fd);
+}
+
+#ifdef __MT__
+static void * readahead_loop(void * arg){
+    char fullpath[MAX_FILE_NAME];
+    while (1) {
+        READAHEAD_LOCK;
+        while (!readahead_dequeue(fullpath)) pthread_cond_wait(&readahead_cond, &readahead_lock);
+        READAHEAD_UNLOCK;
+
+        readahead_advise(fullpath);
+    }
+    return NULL;
+}
+#endif
+
+
+void dvl_readahead_init(void){
+    char * env = getenv(ENV_READAHEAD);
+    readahead_files = dvl.is_simulator ? 0 : (env != NULL ? atoi(env) : DVL_READAHEAD_DEFAULT);
+    if (readahead_files < 0) readahead_files = 0;
+    if (DVL_READAHEAD_MAX < readahead_files) readahead_files = DVL_READAHEAD_MAX;
+}
+
+int dvl_readahead_files(void){
+    return readahead_files;
+}
+
+void dvl_readahead_hints(const char * reply){
+    if (readahead_files == 0 || reply[0] != DVL_REPLY_FILE_OPEN || reply[1] != DVL_MSG_SEP[0]) return;
+
+    // skip the lease duration
+    const char * name = strchr(reply + 2, DVL_MSG_SEP[0]);
+    while (name != NULL) {
+        name++;
+        const char * end = strchr(name, DVL_MSG_SEP[0]);
+        size_t len = end != NULL ? (size_t) (end - name) : strlen(name);
+
+        char fullpath[MAX_FILE_NAME];
+        int ok = 0 < len && dvl.respath_len + len < MAX_FILE_NAME;
+        if (ok) {
+            memcpy(fullpath, dvl.respath, dvl.respath_len);
+            memcpy(fullpath + dvl.respath_len, name, len);
+            fullpath[dvl.respath_len + len] = '\0';
+        }
+
+        READAHEAD_LOCK;
+        readahead_hints++;
+        ok = ok && !readahead_recent(readahead_hash(name, len));
+#ifdef __MT__
+        if (ok && !readahead_thread_started) {
+            pthread_t thread;
+            readahead_thread_started = pthread_create(&thread, NULL, readahead_loop, NULL) == 0;
+            if (readahead_thread_started) pthread_detach(thread);
+        }
+#endif
+        if (ok) {
+            if (queue_count < DVL_READAHEAD_QUEUE) {
+                memcpy(readahead_queue[(queue_head + queue_count) % DVL_READAHEAD_QUEUE], fullpath, MAX_FILE_NAME);
+                queue_count++;
+                readahead_advised++;
+#ifdef __MT__
+                pthread_cond_signal(&readahead_cond);
+#endif
+            } else {
+                readahead_dropped++;
+            }
+        }
+        READAHEAD_UNLOCK;
+
+        name = end;
+    }
+}
+
+void dvl_readahead_flush(void){
+    if (readahead_files == 0) return;
+
+    char fullpath[MAX_FILE_NAME];
+    READAHEAD_LOCK;
+#ifdef __MT__
+    // the background thread drains the queue
+    if (readahead_thread_started) {
+        READAHEAD_UNLOCK;
+        return;
+    }
+#endif
+    while (readahead_dequeue(fullpath)) {
+        READAHEAD_UNLOCK;
+        readahead_advise(fullpath);
+        READAHEAD_LOCK;
+    }
+    READAHEAD_UNLOCK;
+}
+
+void dvl_readahead_finalize(void){
+    if (readahead_files == 0) return;
+
+    DVLPRINT("[DVLIB] readahead: %lu hints, %lu files advised, %lu dropped\n",
+             (unsigned long) readahead_hints, (unsigned long) readahead_advised, (unsigned long) readahead_dropped);
+}
@@ -0,0 +1,48 @@
+#ifndef __DVL_READAHEAD_H__
+#define __DVL_READAHEAD_H__
+
+/* readahead of the result files a client is likely to open next.
+   The open message asks DV for up to DV_READAHEAD files (DVL_READAHEAD_REQUEST<n>; default
+   DVL_READAHEAD_DEFAULT). DV predicts them with its prefetcher (stride or pattern) and names the
+   ones that are available in the open reply ("0:<lease ms or 0>:<file>:<file>..."; see
+   ClientFileOpenMessageHandler). DVLib then announces these files to the kernel
+   (posix_fadvise WILLNEED) so that the first read of the client hits the page cache.
+
+   The MT variants hand the files to a background thread. The other variants keep them until the
+   next close of the client (dvl_readahead_flush()): the open itself never waits for the advice,
+   which costs an open + close of each file on the parallel file system. Files advised recently
+   are skipped.
+
+   Off by default: DV_READAHEAD=<n> enables it (at most DVL_READAHEAD_MAX files). Application
+   clients only (netCDF and HDF5 variants). */
+
+#define ENV_READAHEAD "DV_READAHEAD"
+
+#define DVL_READAHEAD_REQUEST "readahead="
+
+#define DVL_READAHEAD_DEFAULT 0
+
+/* upper bound of DV (kMaxReadaheadFiles) */
+#define DVL_READAHEAD_MAX 8
+
+/* files advised recently (hashes) */
+#define DVL_READAHEAD_RECENT 64
+
+/* pending files (background thread or next close); more are dropped */
+#define DVL_READAHEAD_QUEUE 16
+
+void dvl_readahead_init(void);
+
+/* files to request with an open; 0: off */
+int dvl_readahead_files(void);
+
+/* advises the files named in an open reply of DV */
+void dvl_readahead_hints(const char * reply);
+
+/* advises the pending files if there is no background thread; called at the close of a client file */
+void dvl_readahead_flush(void);
+
+/* prints the counters (see dvl_finalize) */
+void dvl_readahead_finalize(void);
+
+#endif /* __DVL_READAHEAD_H__ */
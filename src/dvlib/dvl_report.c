@@ -0,0 +1,177 @@
+/*
+ * Batched access reports (see dvl_report.h).
+ *
+ * -> events are kept in order; paths are copied into report_paths
+ * -> the message is built when it is sent since it carries the age of each event
+ *    (DV derives the access times for its client profile from it)
+ * -> reports are sent with report_lock held: DV gets them in the order of the events, and before
+ *    the request of the thread that flushes them
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "dvl.h"
+#include "dvl_internal.h"
+#include "dvl_proxy.h"
+#include "dvl_lease.h"
+#include "dvl_report.h"
+
+#ifdef __MT__
+#include <pthread.h>
+#include <time.h>
+#endif
+
+
+typedef struct dvl_report_event {
+    char event;
+    uint32_t offset; // of the path in report_paths
+    uint32_t rank;
+    uint64_t time;
+} dvl_report_event_t;
+
+
+static int report_closes = 0;
+
+#ifdef __MT__
+static pthread_mutex_t report_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t report_cond; // CLOCK_MONOTONIC like dvl_lease_now_ms()
+static int report_thread_started = 0;
+#define REPORT_LOCK pthread_mutex_lock(&report_lock)
+#define REPORT_UNLOCK pthread_mutex_unlock(&report_lock)
+#else
+#define REPORT_LOCK
+#define REPORT_UNLOCK
+#endif
+
+static dvl_report_event_t report[DVL_REPORT_MAX];
+static uint32_t report_count = 0;
+static char report_paths[BUFFER_SIZE];
+static uint32_t report_paths_len = 0;
+static uint32_t report_msg_len = 0; // upper bound of the message size
+
+
+void dvl_report_init(void){
+    char * env = getenv(ENV_REPORT);
+    report_closes = !dvl.is_simulator && (env == NULL ? DVL_REPORT_CLOSES_DEFAULT : atoi(env) != 0);
+
+#ifdef __MT__
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&report_cond, &attr);
+    pthread_condattr_destroy(&attr);
+#endif
+}
+
+int dvl_report_closes(void){
+    return report_closes;
+}
+
+
+/* builds the report message and resets the report; called with report_lock held (MT);
+   returns the message size (0: nothing to send) */
+static int take_report(char * buff){
+    if (report_count == 0) return 0;
+
+    uint64_t now = dvl_lease_now_ms();
+    int size = snprintf(buff, BUFFER_SIZE, "%c", DVL_MSG_ACCESS_REPORT);
+    for (uint32_t i = 0; i < report_count && 0 < size && size < BUFFER_SIZE; i++) {
+        size += snprintf(buff + size, BUFFER_SIZE - size, ":%c:%s:%u:%lu", report[i].event,
+                         report_paths + report[i].offset, report[i].rank, (unsigned long) (now - report[i].time));
+    }
+
+    report_count = 0;
+    report_paths_len = 0;
+    report_msg_len = 0;
+
+    if (BUFFER_SIZE <= size) {
+        // cannot happen with the estimate in dvl_report_add(); the report is lost otherwise
+        DVLPRINT("[DVLIB] access report too long\n");
+        return 0;
+    }
+    return size;
+}
+
+#ifdef __MT__
+/* sends the report when its oldest event reaches DVL_REPORT_MS, also if no further event or request follows */
+static void * report_loop(void * arg){
+    char buff[BUFFER_SIZE];
+    REPORT_LOCK;
+    while (1) {
+        if (report_count == 0) {
+            pthread_cond_wait(&report_cond, &report_lock);
+            continue;
+        }
+
+        uint64_t deadline = report[0].time + DVL_REPORT_MS;
+        if (dvl_lease_now_ms() < deadline) {
+            struct timespec ts;
+            ts.tv_sec = deadline / 1000;
+            ts.tv_nsec = (deadline % 1000) * 1000000;
+            pthread_cond_timedwait(&report_cond, &report_lock, &ts);
+            continue;
+        }
+
+        int size = take_report(buff);
+        if (0 < size) dvl_send_message(buff, size, 1);
+    }
+    return NULL;
+}
+#endif
+
+void dvl_report_add(char event, const char * path, uint32_t rank){
+    char buff[BUFFER_SIZE];
+    int size = 0;
+    uint64_t now = dvl_lease_now_ms();
+
+    // ':' event ':' path ':' rank (10) ':' age (20)
+    uint32_t len = strlen(path);
+    uint32_t entry_len = len + 35;
+
+    REPORT_LOCK;
+#ifdef __MT__
+    if (!report_thread_started) {
+        pthread_t thread;
+        report_thread_started = pthread_create(&thread, NULL, report_loop, NULL) == 0;
+        if (report_thread_started) pthread_detach(thread);
+    }
+#endif
+    if (BUFFER_SIZE <= 1 + report_msg_len + entry_len) {
+        size = take_report(buff);
+    }
+
+    if (1 + entry_len < BUFFER_SIZE) {
+        memcpy(report_paths + report_paths_len, path, len + 1);
+        report[report_count].event = event;
+        report[report_count].offset = report_paths_len;
+        report[report_count].rank = rank;
+        report[report_count].time = now;
+        report_count++;
+        report_paths_len += len + 1;
+        report_msg_len += entry_len;
+    }
+
+    if (size == 0 && 0 < report_count
+        && (DVL_REPORT_MAX <= report_count || report[0].time + DVL_REPORT_MS <= now)) {
+        size = take_report(buff);
+    }
+
+    if (0 < size) dvl_send_message(buff, size, 1);
+#ifdef __MT__
+    // the first event of a new report sets the deadline of report_loop()
+    if (report_count == 1) pthread_cond_signal(&report_cond);
+#endif
+    REPORT_UNLOCK;
+}
+
+void dvl_report_flush(void){
+    char buff[BUFFER_SIZE];
+
+    REPORT_LOCK;
+    int size = take_report(buff);
+    if (0 < size) dvl_send_message(buff, size, 1);
+    REPORT_UNLOCK;
+}
@@ -0,0 +1,51 @@
+#ifndef __DVL_REPORT_H__
+#define __DVL_REPORT_H__
+
+/* batched access reports of application clients (see ClientAccessReportMessageHandler in DV).
+   Events that need no reply are collected and sent as one message
+       R:<event>:<file>:<appid>:<age>:...
+   with age: ms between the event and sending the report.
+
+   events:
+   - DVL_REPORT_OPEN_LEASED: open under a read lease (see dvl_lease.h); always batched
+   - DVL_REPORT_CLOSE: close of a file opened through DV; replaces DVL_MSG_FCLOSE_CLIENT
+     if DV_REPORT=1 (closes are sent one by one otherwise); default: DVL_REPORT_CLOSES_DEFAULT
+
+   A report is sent once it holds DVL_REPORT_MAX events, would exceed the message size, or its
+   oldest event is older than DVL_REPORT_MS. Additionally, pending events are sent before each
+   request that waits for a reply (see dvl_send_message()) and at finalize. Thus, DV sees all
+   events in order.
+   MT: a thread sends the report at the deadline of its oldest event. Otherwise, the deadline is
+   only checked with the next event: a deferred close keeps the file locked in DV until the next
+   DVLib call of the client, therefore closes are not batched by default. */
+
+#include <stdint.h>
+
+#define ENV_REPORT "DV_REPORT"
+
+#define DVL_MSG_ACCESS_REPORT 'R'
+
+#define DVL_REPORT_OPEN_LEASED 'O'
+#define DVL_REPORT_CLOSE 'C'
+
+#define DVL_REPORT_MAX 64
+#define DVL_REPORT_MS 500
+
+#ifdef __MT__
+#define DVL_REPORT_CLOSES_DEFAULT 1
+#else
+#define DVL_REPORT_CLOSES_DEFAULT 0
+#endif
+
+void dvl_report_init(void);
+
+/* 1 if closes are reported in batches */
+int dvl_report_closes(void);
+
+/* adds an event (rank: appid as used in the open message) */
+void dvl_report_add(char event, const char * path, uint32_t rank);
+
+/* sends pending events */
+void dvl_report_flush(void);
+
+#endif /* __DVL_REPORT_H__ */
@@ -0,0 +1,318 @@
+/*
+ * Shared-memory transport between DVLib and a node-local DV.
+ *
+ * -> DV creates the segment DVL_SHM_PREFIX<client port> (see ShmTransport in DV).
+ * -> each client thread claims one channel (owner = pid) with two SPSC rings;
+ *    the channel is given back when the thread exits (__MT__, thread specific key):
+ *    requests are added to the request ring followed by a doorbell increment + futex wake;
+ *    replies are awaited on the futex word resp_head of the response ring.
+ * -> requests carry a sequence number; replies to requests nobody waits for
+ *    (e.g. send with disconnect) are discarded with the next request.
+ * -> if DV stops (magic reset) or dies, the waiting client gets an error and this
+ *    process continues with sockets.
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <ifaddrs.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+
+#include "dvl.h"
+#include "dvl_internal.h"
+#include "dvl_shm.h"
+
+#ifdef __MT__
+#include <pthread.h>
+#endif
+
+/* busy polling before the client sleeps on the futex; covers cache hits
+   (multi-core nodes only: on one core, spinning just delays DV) */
+#define DVL_SHM_SPINS 2000
+
+/* regular wakeups while waiting to check whether DV is still alive */
+#define DVL_SHM_WAIT_MS 1000
+
+#define SHM_UNKNOWN 0
+#define SHM_ON 1
+#define SHM_OFF -1
+
+static dvl_shm_header_t * shm_header = NULL;
+static volatile int shm_state = SHM_UNKNOWN;
+static int shm_spins = 0;
+
+#ifdef __MT__
+static pthread_mutex_t shm_attach_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t shm_channel_key;
+__thread dvl_shm_channel_t * shm_channel = NULL;
+__thread pid_t shm_channel_pid = 0;
+__thread int shm_channel_none = 0;
+__thread uint32_t shm_seq = 0;
+#else
+dvl_shm_channel_t * shm_channel = NULL;
+pid_t shm_channel_pid = 0;
+int shm_channel_none = 0;
+uint32_t shm_seq = 0;
+#endif
+
+
+/* no FUTEX_PRIVATE_FLAG: the futex words are shared with DV */
+static void futex_wait(uint32_t * addr, uint32_t value, long timeout_ms){
+    struct timespec ts;
+    ts.tv_sec = timeout_ms / 1000;
+    ts.tv_nsec = (timeout_ms % 1000) * 1000000;
+    syscall(SYS_futex, addr, FUTEX_WAIT, value, &ts, NULL, 0);
+}
+
+static void futex_wake(uint32_t * addr){
+    syscall(SYS_futex, addr, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+static int pid_alive(pid_t pid){
+    return kill(pid, 0) == 0 || errno == EPERM;
+}
+
+static int dv_alive(){
+    return __atomic_load_n(&shm_header->magic, __ATOMIC_ACQUIRE) == DVL_SHM_MAGIC
+        && pid_alive(shm_header->pid);
+}
+
+#ifdef __MT__
+/* thread exit: channel of the thread back to DV (unless given up already, see dvl_shm_release) */
+static void dvl_shm_thread_exit(void * ptr){
+    dvl_shm_channel_t * ch = (dvl_shm_channel_t *) ptr;
+    if (ch == NULL || ch != shm_channel || shm_channel_pid != getpid()) return;
+
+    int32_t owner = shm_channel_pid;
+    __atomic_compare_exchange_n(&ch->owner, &owner, 0, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+    shm_channel = NULL;
+}
+#endif
+
+static inline void cpu_relax(){
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+
+int dvl_is_local_endpoint(const char * srv_ip_list){
+    char list[1024];
+    snprintf(list, sizeof(list), "%s", srv_ip_list);
+
+    struct ifaddrs * ifaddr = NULL;
+    int local = 0;
+    char * saveptr = NULL;
+    for (char * ip = strtok_r(list, ",", &saveptr); ip != NULL && !local; ip = strtok_r(NULL, ",", &saveptr)){
+        struct in_addr addr;
+        if (inet_pton(AF_INET, ip, &addr) <= 0) continue;
+        if ((ntohl(addr.s_addr) >> 24) == 127) {
+            local = 1;
+            break;
+        }
+
+        if (ifaddr == NULL && getifaddrs(&ifaddr) != 0) break;
+        for (struct ifaddrs * ifa = ifaddr; ifa != NULL; ifa = ifa->ifa_next){
+            if (ifa->ifa_addr == NULL || ifa->ifa_addr->sa_family != AF_INET) continue;
+            if (((struct sockaddr_in *) ifa->ifa_addr)->sin_addr.s_addr == addr.s_addr) {
+                local = 1;
+                break;
+            }
+        }
+    }
+
+    if (ifaddr != NULL) freeifaddrs(ifaddr);
+    return local;
+}
+
+static void dvl_shm_attach(int port, const char * srv_ip_list){
+    char * env = getenv(ENV_SHM);
+    if ((env != NULL && atoi(env) == 0) || !dvl_is_local_endpoint(srv_ip_list)) {
+        shm_state = SHM_OFF;
+        return;
+    }
+
+    char name[64];
+    snprintf(name, sizeof(name), "%s%i", DVL_SHM_PREFIX, port);
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0) {
+        // DV is not offering the transport
+        shm_state = SHM_OFF;
+        return;
+    }
+
+    struct stat st;
+    void * ptr = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && (size_t) st.st_size >= sizeof(dvl_shm_header_t)) {
+        ptr = mmap(NULL, sizeof(dvl_shm_header_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (ptr == MAP_FAILED) {
+        shm_state = SHM_OFF;
+        return;
+    }
+
+    dvl_shm_header_t * header = (dvl_shm_header_t *) ptr;
+    if (__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != DVL_SHM_MAGIC
+        || header->version != DVL_SHM_VERSION || header->channels != DVL_SHM_CHANNELS
+        || !pid_alive(header->pid)) {
+        munmap(ptr, sizeof(dvl_shm_header_t));
+        shm_state = SHM_OFF;
+        return;
+    }
+
+#ifdef __MT__
+    if (pthread_key_create(&shm_channel_key, dvl_shm_thread_exit) != 0) {
+        munmap(ptr, sizeof(dvl_shm_header_t));
+        shm_state = SHM_OFF;
+        return;
+    }
+#endif
+
+    shm_header = header;
+    shm_spins = sysconf(_SC_NPROCESSORS_ONLN) > 1 ? DVL_SHM_SPINS : 0;
+    shm_state = SHM_ON;
+    DVLPRINT("[DVLIB] using shared-memory transport %s\n", name);
+}
+
+/* claims a free channel (or one of a terminated process) for the calling thread */
+static int dvl_shm_claim(){
+    pid_t pid = getpid();
+
+    for (uint32_t c = 0; c < DVL_SHM_CHANNELS; c++){
+        dvl_shm_channel_t * ch = &shm_header->channel[c];
+        int32_t owner = __atomic_load_n(&ch->owner, __ATOMIC_ACQUIRE);
+        if (owner != 0 && (owner == pid || pid_alive(owner))) continue;
+
+        if (__atomic_compare_exchange_n(&ch->owner, &owner, pid, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            // continue the sequence of the former owner; its replies are discarded
+            shm_seq = __atomic_load_n(&ch->req_head, __ATOMIC_ACQUIRE);
+            __atomic_store_n(&ch->resp_tail, __atomic_load_n(&ch->resp_head, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+            shm_channel = ch;
+            shm_channel_pid = pid;
+#ifdef __MT__
+            pthread_setspecific(shm_channel_key, ch);
+#endif
+            return 1;
+        }
+    }
+
+    // all channels in use: this thread uses sockets
+    shm_channel_none = 1;
+    return 0;
+}
+
+int dvl_shm_usable(int port, const char * srv_ip_list){
+    if (shm_state == SHM_UNKNOWN) {
+#ifdef __MT__
+        pthread_mutex_lock(&shm_attach_lock);
+        if (shm_state == SHM_UNKNOWN) dvl_shm_attach(port, srv_ip_list);
+        pthread_mutex_unlock(&shm_attach_lock);
+#else
+        dvl_shm_attach(port, srv_ip_list);
+#endif
+    }
+    if (shm_state != SHM_ON) return 0;
+
+    if (shm_channel != NULL) {
+        // fork: the channel belongs to the parent
+        if (shm_channel_pid == getpid()) return 1;
+        shm_channel = NULL;
+        shm_channel_none = 0;
+    }
+    if (shm_channel_none) return 0;
+
+    return dvl_shm_claim();
+}
+
+int dvl_shm_send(char * buff, int size){
+    dvl_shm_channel_t * ch = shm_channel;
+    if (ch == NULL || size < 0 || size > DVL_SHM_MSG_SIZE) return DVL_ERROR;
+
+    // stale replies
+    __atomic_store_n(&ch->resp_tail, __atomic_load_n(&ch->resp_head, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+
+    uint32_t head = ch->req_head;
+    uint32_t tail;
+    while (head - (tail = __atomic_load_n(&ch->req_tail, __ATOMIC_ACQUIRE)) == DVL_SHM_RING_ENTRIES){
+        futex_wait(&ch->req_tail, tail, DVL_SHM_WAIT_MS);
+        if (!dv_alive()) {
+            shm_state = SHM_OFF;
+            return DVL_ERROR;
+        }
+    }
+
+    dvl_shm_entry_t * e = &ch->req[head % DVL_SHM_RING_ENTRIES];
+    shm_seq++;
+    e->seq = shm_seq & DVL_SHM_SEQ_MASK;
+    e->len = size;
+    memcpy(e->data, buff, size);
+    __atomic_store_n(&ch->req_head, head + 1, __ATOMIC_RELEASE);
+
+    __atomic_add_fetch(&shm_header->doorbell, 1, __ATOMIC_RELEASE);
+    futex_wake(&shm_header->doorbell);
+    return DVL_SUCCESS;
+}
+
+int dvl_shm_recv(char * buff, int size, int * oversized){
+    dvl_shm_channel_t * ch = shm_channel;
+    *oversized = 0;
+    if (ch == NULL) return DVL_ERROR;
+
+    uint32_t expected = shm_seq & DVL_SHM_SEQ_MASK;
+    int spins = 0;
+    while (1){
+        uint32_t head = __atomic_load_n(&ch->resp_head, __ATOMIC_ACQUIRE);
+        uint32_t tail = ch->resp_tail;
+        for (; tail != head; tail++){
+            dvl_shm_entry_t * e = &ch->resp[tail % DVL_SHM_RING_ENTRIES];
+            if ((e->seq & ~DVL_SHM_OVERSIZED_FLAG) != expected) continue;
+
+            int len = e->len < (uint32_t) size ? (int) e->len : size - 1;
+            memcpy(buff, e->data, len);
+            buff[len] = '\0';
+            *oversized = (e->seq & DVL_SHM_OVERSIZED_FLAG) != 0;
+            __atomic_store_n(&ch->resp_tail, tail + 1, __ATOMIC_RELEASE);
+            return len;
+        }
+        __atomic_store_n(&ch->resp_tail, tail, __ATOMIC_RELEASE);
+
+        if (spins < shm_spins) {
+            spins++;
+            cpu_relax();
+            continue;
+        }
+
+        // replies may take long (notification after re-simulation)
+        futex_wait(&ch->resp_head, head, DVL_SHM_WAIT_MS);
+        if (head == __atomic_load_n(&ch->resp_head, __ATOMIC_ACQUIRE) && !dv_alive()) {
+            fprintf(stderr, "Warning: DV shared-memory transport has been closed.\n");
+            shm_state = SHM_OFF;
+            return DVL_ERROR;
+        }
+    }
+}
+
+void dvl_shm_release(void){
+    if (shm_header == NULL) return;
+
+    pid_t pid = getpid();
+    for (uint32_t c = 0; c < DVL_SHM_CHANNELS; c++){
+        int32_t owner = pid;
+        __atomic_compare_exchange_n(&shm_header->channel[c].owner, &owner, 0, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+    }
+}
@@ -0,0 +1,71 @@
+#ifndef __DVL_SHM_H__
+#define __DVL_SHM_H__
+
+/* shared-memory transport to a node-local DV (see ShmTransport in the DV server).
+   Used automatically by dvl_send_message() / dvl_recv_message() of application clients
+   if the DV endpoint is local and DV offers the segment (dv_shm_transport = 1).
+   DV_SHM=0 disables it; sockets are used then as before.
+   Replies that do not fit into an entry are fetched on a socket (see dvl_recv_message).
+
+   note: the layout must match ShmTransport.h */
+
+#include <stdint.h>
+
+#define ENV_SHM "DV_SHM"
+
+#define DVL_SHM_PREFIX "/simfs_dv_"
+#define DVL_SHM_MAGIC 0x53465348
+#define DVL_SHM_VERSION 2
+#define DVL_SHM_CHANNELS 64
+#define DVL_SHM_RING_ENTRIES 4
+#define DVL_SHM_MSG_SIZE 4096
+#define DVL_SHM_SEQ_MASK 0xffffff
+/* set in seq of a reply entry that only holds the request to fetch the reply on a socket */
+#define DVL_SHM_OVERSIZED_FLAG 0x80000000u
+
+typedef struct dvl_shm_entry {
+    uint32_t seq;
+    uint32_t len;
+    char data[DVL_SHM_MSG_SIZE];
+} dvl_shm_entry_t;
+
+typedef struct dvl_shm_channel {
+    int32_t owner; /* pid; 0: free */
+    uint32_t req_head;
+    uint32_t req_tail;
+    uint32_t resp_head;
+    uint32_t resp_tail;
+    uint32_t padding[3];
+    dvl_shm_entry_t req[DVL_SHM_RING_ENTRIES];
+    dvl_shm_entry_t resp[DVL_SHM_RING_ENTRIES];
+} dvl_shm_channel_t;
+
+typedef struct dvl_shm_header {
+    uint32_t magic;
+    uint32_t version;
+    int32_t pid;
+    uint32_t channels;
+    uint32_t doorbell;
+    uint32_t padding[3];
+    dvl_shm_channel_t channel[DVL_SHM_CHANNELS];
+} dvl_shm_header_t;
+
+/* returns 1 if the calling thread can use the shared-memory transport (a channel is claimed on
+   first use); 0: use sockets.
+   port and srv_ip_list: DV endpoint as used for the socket connection */
+int dvl_shm_usable(int port, const char * srv_ip_list);
+
+/* request / reply on the channel of the calling thread; same return values as the socket variants.
+   *oversized = 1: the reply is too large for the channel; buff holds the fetch request to send
+   on a socket instead (the reply to it is the actual reply) */
+int dvl_shm_send(char * buff, int size);
+int dvl_shm_recv(char * buff, int size, int * oversized);
+
+/* 1 if one of the given IPs (comma-separated) belongs to this node */
+int dvl_is_local_endpoint(const char * srv_ip_list);
+
+/* gives all channels of this process back to DV (see dvl_finalize);
+   with __MT__, the channel of a thread is given back when the thread exits */
+void dvl_shm_release(void);
+
+#endif /* __DVL_SHM_H__ */
@@ -7,7 +7,10 @@
 #include "dvl_extended_api.h"
 
 #include <inttypes.h>
+#include <poll.h>
 #include <stdio.h>
+#include <string.h>
+#include <unistd.h>
 
 #include "../dvl.h"
 #include "../dvl_internal.h"
@@ -21,6 +24,7 @@
 #define API_REQUEST_RANGE 3
 #define API_TEST_FILE 4
 #define API_STATUS 5
+#define API_HINT 6
 
 
 int64_t sdavi_set_info(const char *key, int64_t value) {
@@ -224,3 +228,321 @@ int64_t sdavi_status() {
     }
     return retval;
 }
+
+
+//--- asynchronous open --------------------------------------------------------
+
+#define MAX_ASYNC_HANDLES 256
+// pending handles with a dedicated notification connection (see async_register())
+#define MAX_ASYNC_CONNECTIONS 16
+
+#define ASYNC_FREE 0
+#define ASYNC_PENDING 1
+#define ASYNC_READY 2
+
+typedef struct {
+    int state;
+    int fd;     // dedicated connection while pending and registered, -1 otherwise
+    uint32_t mt_rank;
+    char path[MAX_FILE_NAME];  // relative path as known by DV
+} dvl_async_open_t;
+
+static dvl_async_open_t async_opens[MAX_ASYNC_HANDLES];
+static int async_connections = 0;
+
+#ifdef __MT__
+static pthread_mutex_t async_lock = PTHREAD_MUTEX_INITIALIZER;
+#define ASYNC_LOCK { if (pthread_mutex_lock(&async_lock) != 0) fatal("sdavi async: can't get lock"); }
+#define ASYNC_UNLOCK pthread_mutex_unlock(&async_lock)
+#else
+#define ASYNC_LOCK
+#define ASYNC_UNLOCK
+#endif
+
+static dvl_async_open_t * async_get(int64_t handle) {
+    if (handle < 0 || MAX_ASYNC_HANDLES <= handle || async_opens[handle].state == ASYNC_FREE) {
+        fprintf(stderr, "sdavi async: invalid handle %" PRId64 ".\n", handle);
+        return NULL;
+    }
+    return &async_opens[handle];
+}
+
+static void async_disconnect(dvl_async_open_t * a) {
+    if (a->fd < 0) {
+        return;
+    }
+    close(a->fd);
+    a->fd = -1;
+    ASYNC_LOCK;
+    async_connections--;
+    ASYNC_UNLOCK;
+}
+
+/*
+ * registers the handle for the notification of DV on a dedicated connection.
+ *
+ * Note: the connections cannot be shared between the pending handles (nor with the
+ * regular messages of the thread): DV reads exactly one message per accepted connection
+ * and answers a waiting VGET by a notification without the file name on that connection,
+ * which it closes afterwards (see SimulatorFileCloseMessageHandler). Instead, at most
+ * MAX_ASYNC_CONNECTIONS handles hold a connection; the others register lazily in
+ * sdavi_test() (when a connection became free) or in sdavi_wait() (always). DV answers
+ * a late VGET immediately if the file became available in the meantime.
+ * return: 0 ok (a->fd < 0 if no connection was free and !force), -1 error
+ */
+static int async_register(dvl_async_open_t * a, int force) {
+    ASYNC_LOCK;
+    int free_connection = async_connections < MAX_ASYNC_CONNECTIONS;
+    if (free_connection || force) {
+        async_connections++;
+    }
+    ASYNC_UNLOCK;
+    if (!free_connection && !force) {
+        return 0;
+    }
+
+    a->fd = dvl_open_connection();
+    char buff[BUFFER_SIZE];
+    int msgsize = BUFFER_SIZE;
+    MAKE_MESSAGE(buff, msgsize, "%c:%s:%i:%i:", DVL_MSG_VGET, a->path, 0, a->mt_rank);
+    if (a->fd < 0 || msgsize < 0 || dvl_send_message_on(a->fd, buff, msgsize) != DVL_SUCCESS) {
+        if (0 <= a->fd) close(a->fd);
+        a->fd = -1;
+        ASYNC_LOCK;
+        async_connections--;
+        ASYNC_UNLOCK;
+        return -1;
+    }
+    return 0;
+}
+
+/* reads the notification from the dedicated connection */
+static int64_t async_complete(dvl_async_open_t * a) {
+    char buff[BUFFER_SIZE];
+    int res = dvl_recv_message_on(a->fd, buff, BUFFER_SIZE);
+    async_disconnect(a);
+    if (res < 0) {
+        return EXTENDED_API_ERROR_RETURN_VALUE;
+    }
+    a->state = ASYNC_READY;
+    return 0;
+}
+
+
+int64_t sdavi_open_async(const char *path) {
+    uint32_t mt_rank = 0;
+    DVL_CHECK_WITHOUT_BENCH;
+#ifndef __MT__
+    mt_rank = dvl.gni.myrank;
+#endif
+
+    if (dvl.is_simulator) {
+        return EXTENDED_API_ERROR_RETURN_VALUE;
+    }
+
+    char npath[MAX_FILE_NAME];
+    char *rpath = is_result_file(path, npath);
+    if (rpath == NULL) {
+        fprintf(stderr, "sdavi_open_async(): not a result file: %s.\n", path);
+        return EXTENDED_API_ERROR_RETURN_VALUE;
+    }
+
+    size_t len = strlen(rpath);
+    if (MAX_FILE_NAME <= len) {
+        return EXTENDED_API_ERROR_RETURN_VALUE;
+    }
+
+    // reserve a handle
+    int64_t handle = -1;
+    ASYNC_LOCK;
+    for (int i = 0; i < MAX_ASYNC_HANDLES; i++) {
+        if (async_opens[i].state == ASYNC_FREE) {
+            handle = i;
+            async_opens[i].state = ASYNC_PENDING;
+            async_opens[i].fd = -1;
+            break;
+        }
+    }
+    ASYNC_UNLOCK;
+    if (handle < 0) {
+        fprintf(stderr, "sdavi_open_async(): too many pending asynchronous opens.\n");
+        return EXTENDED_API_ERROR_RETURN_VALUE;
+    }
+    dvl_async_open_t *a = &async_opens[handle];
+    a->mt_rank = mt_rank;
+    memcpy(a->path, rpath, len + 1);
+
+    // same open message as a regular open: DV handles hit/miss and the prefetcher
+    char buff[BUFFER_SIZE];
+    int msgsize = BUFFER_SIZE;
+    MAKE_MESSAGE(buff, msgsize, "%c:%s:%i:file=%s;gni_addr=%u", DVL_MSG_FOPEN, a->path, mt_rank, a->path, dvl.gni.addr);
+    if (msgsize < 0) {
+        a->state = ASYNC_FREE;
+        return EXTENDED_API_ERROR_RETURN_VALUE;
+    }
+    dvl_send_message(buff, msgsize, 0);
+    if (dvl_recv_message(buff, BUFFER_SIZE, 1) < 0) {
+        a->state = ASYNC_FREE;
+        return EXTENDED_API_ERROR_RETURN_VALUE;
+    }
+
+    if (buff[0] == DVL_REPLY_FILE_OPEN) {
+        a->state = ASYNC_READY;
+        return handle;
+    }
+
+    // being simulated: register for the notification (if a connection is free)
+    if (async_register(a, 0) < 0) {
+        sdavi_release(handle);
+        return EXTENDED_API_ERROR_RETURN_VALUE;
+    }
+
+    return handle;
+}
+
+
+int64_t sdavi_test(int64_t handle) {
+    dvl_async_open_t *a = async_get(handle);
+    if (a == NULL) {
+        return EXTENDED_API_ERROR_RETURN_VALUE;
+    }
+
+    if (a->state == ASYNC_READY) {
+        return 1;
+    }
+
+    if (a->fd < 0) {
+        if (async_register(a, 0) < 0) {
+            return EXTENDED_API_ERROR_RETURN_VALUE;
+        }
+        if (a->fd < 0) {
+            return 0;
+        }
+    }
+
+    struct pollfd pfd;
+    pfd.fd = a->fd;
+    pfd.events = POLLIN;
+    int res = poll(&pfd, 1, 0);
+    if (res < 0) {
+        perror("sdavi_test(): poll failed");
+        return EXTENDED_API_ERROR_RETURN_VALUE;
+    }
+    if (res == 0) {
+        return 0;
+    }
+
+    return async_complete(a) < 0 ? EXTENDED_API_ERROR_RETURN_VALUE : 1;
+}
+
+
+int64_t sdavi_wait(int64_t handle) {
+    dvl_async_open_t *a = async_get(handle);
+    if (a == NULL) {
+        return EXTENDED_API_ERROR_RETURN_VALUE;
+    }
+
+    if (a->state == ASYNC_READY) {
+        return 0;
+    }
+
+    if (a->fd < 0 && async_register(a, 1) < 0) {
+        return EXTENDED_API_ERROR_RETURN_VALUE;
+    }
+    return async_complete(a);
+}
+
+
+int64_t sdavi_release(int64_t handle) {
+    dvl_async_open_t *a = async_get(handle);
+    if (a == NULL) {
+        return EXTENDED_API_ERROR_RETURN_VALUE;
+    }
+
+    async_disconnect(a);
+
+    // releases the lock of the announced open in DV
+    char buff[BUFFER_SIZE];
+    int msgsize = BUFFER_SIZE;
+    MAKE_MESSAGE(buff, msgsize, "%c:%s", DVL_MSG_FCLOSE_CLIENT, a->path);
+    int64_t retval = 0;
+    if (msgsize < 0 || dvl_send_message(buff, msgsize, 1) != DVL_SUCCESS) {
+        retval = EXTENDED_API_ERROR_RETURN_VALUE;
+    }
+
+    ASYNC_LOCK;
+    a->state = ASYNC_FREE;
+    ASYNC_UNLOCK;
+    return retval;
+}
+
+
+static int64_t sdavi_hint_internal(uint32_t rank, const char *args, int count) {
+    char buff[BUFFER_SIZE];
+    int msgsize = BUFFER_SIZE;
+    MAKE_MESSAGE(buff, msgsize, "%c:%i:%i:%i%s", DVL_MSG_EXTENDED_API, rank, API_HINT, count, args);
+    if (msgsize < 0) {
+        fprintf(stderr, "sdavi_hint_internal(): could not build message for %i hints.\n", count);
+        return EXTENDED_API_ERROR_RETURN_VALUE;
+    }
+    dvl_send_message(buff, msgsize, 0);
+    dvl_recv_message(buff, BUFFER_SIZE, 1);
+    int64_t retval;
+    int scount = sscanf(buff, "%" PRId64, &retval);
+    if (scount != 1) {
+        buff[BUFFER_SIZE-1] = 0;
+        fprintf(stderr, "sdavi_hint_internal(): invalid return value: %s.\n", buff);
+        return EXTENDED_API_ERROR_RETURN_VALUE;
+    }
+    return retval;
+}
+
+
+// reserve for the message header "E:rank:function:count"
+#define HINT_HEADER_RESERVE 64
+
+int64_t sdavi_hint(const char **paths, int64_t n) {
+    uint32_t mt_rank = 0;
+    DVL_CHECK_WITHOUT_BENCH;
+#ifndef __MT__
+    mt_rank = dvl.gni.myrank;
+#endif
+
+    // hints are packed into as few messages as possible: ":path1:path2:..."
+    char args[BUFFER_SIZE];
+    size_t args_len = 0;
+    int count = 0;
+    char npath[MAX_FILE_NAME];
+
+    for (int64_t i = 0; i < n; i++) {
+        char *rpath = is_result_file(paths[i], npath);
+        if (rpath == NULL) {
+            continue;
+        }
+
+        size_t len = strlen(rpath);
+        if (BUFFER_SIZE <= HINT_HEADER_RESERVE + len + 1) {
+            fprintf(stderr, "sdavi_hint(): path too long: %s.\n", paths[i]);
+            continue;
+        }
+
+        if (BUFFER_SIZE <= HINT_HEADER_RESERVE + args_len + len + 1) {
+            int64_t retval = sdavi_hint_internal(mt_rank, args, count);
+            if (retval < 0) {
+                return retval;
+            }
+            args_len = 0;
+            count = 0;
+        }
+
+        args[args_len++] = ':';
+        memcpy(args + args_len, rpath, len + 1);
+        args_len += len;
+        count++;
+    }
+
+    if (count == 0) {
+        return 0;
+    }
+    return sdavi_hint_internal(mt_rank, args, count);
+}
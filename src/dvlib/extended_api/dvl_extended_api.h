@@ -2,6 +2,7 @@
  * stubs that translate arguments into the defined message format for DV.
  * note: all functions are synchronous. Thus, functions with void return type
  * are also waiting for a reply from DV before returning back to the caller.
+ * Exception: the asynchronous open (see sdavi_open_async() below).
  *
  * message format:
  * E:appid:function_nr:n_arguments:argument1:argument2:argument3:...
@@ -56,4 +57,41 @@ int64_t sdavi_test_file(const char *path);
 int64_t sdavi_status();
 
 
+/**
+ * asynchronous open of a result file: announces the access to DV (which starts a
+ * re-simulation if needed) without waiting for the file.
+ * returns a handle >= 0, or -1 in case of error.
+ *
+ * For files that are being simulated, the handle keeps a dedicated connection to DV
+ * open on which the notification arrives (DV answers one message per connection, thus
+ * the pending handles cannot share one). At most 16 pending handles hold a connection at
+ * a time; the others register when one becomes free. Use sdavi_test() / sdavi_wait() to
+ * check for it, then open the file as usual (nc_open, H5Fopen) and release the handle with
+ * sdavi_release(). DV keeps the file locked in its cache until the handle is released.
+ */
+int64_t sdavi_open_async(const char *path);
+
+/**
+ * non-blocking test
+ *  1 -> file is available
+ *  0 -> file is still being simulated
+ * -1 -> error
+ */
+int64_t sdavi_test(int64_t handle);
+
+// blocks until the file is available; return: 0 ok, -1 error
+int64_t sdavi_wait(int64_t handle);
+
+// return: 0 ok, -1 error
+int64_t sdavi_release(int64_t handle);
+
+
+/**
+ * announces future accesses (paths in access order). DV schedules simulations for the
+ * files that are neither cached nor being simulated and protects them from eviction.
+ * return: 0 ok, error otherwise
+ */
+int64_t sdavi_hint(const char **paths, int64_t n);
+
+
 #endif // CLIENTLIB_EXTENDED_API_DVL_EXTENDED_API_H_
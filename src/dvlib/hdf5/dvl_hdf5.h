@@ -29,7 +29,7 @@
    - Only create, open and close (and associated functions); no read (get), no write (put).
    - Finalize / stopping the simulator is supported (if simulator accepts it; see SIGINT).
    - The implementation includes result and checkpoint files redirection (if existent),
-   but does not include the avoid writing feature (see put and get not implemented).
+   including the skipped writes of redirected result files (H5Dwrite; see dvl_hdf5_write.c).
    - Multithreaded client support is also not supported (yet).
 
    v0.6 2017-09-20 Pirmin Schmid
@@ -59,6 +59,8 @@ typedef struct dvl_hdf5_originals_ {
     oh5f_open_t h5fopen;
     oh5f_close_t h5fclose;
 
+    oh5d_write_t h5dwrite;
+
     oh5i_inc_ref_t h5iinc_ref;
     oh5i_dec_ref_t h5idec_ref;
 
@@ -98,10 +100,9 @@ herr_t dvl_H5Dread(hid_t dset_id, hid_t mem_type_id, hid_t mem_space_id,
             hid_t file_space_id, hid_t plist_id, void *buf out);
 */
 
-/*
-herr_t dvl_H5Dwrite(hid_t dset_id, hid_t mem_type_id, hid_t mem_space_id,
+// no-op for files redirected with skipped writes
+herr_t H5Dwrite(hid_t dset_id, hid_t mem_type_id, hid_t mem_space_id,
              hid_t file_space_id, hid_t plist_id, const void *buf);
-*/
 
 int H5Idec_ref(hid_t id);
 
@@ -20,6 +20,8 @@
 #include "../dvl.h"
 #include "../dvl_internal.h"
 #include "../dvl_proxy.h"
+#include "../dvl_readahead.h"
+#include "../dvl_report.h"
 
 #include "dvl_hdf5.h"
 
@@ -75,9 +77,11 @@ dvl_hdf5_herr_or_int_t dvl_hdf5_handle_file_close(hid_t file_id, dvl_hdf5_file_c
         dvl_H5_filename_associated_with_id(toclose, cpath, MAX_FILE_NAME);
     } else {
         // use lookup on client side
-        HASH_FIND_INT(dvl.open_files_idx, &file_id, dfile);
+        dvl_files_rdlock(file_id);
+        dfile = dvl_file_find(file_id);
 
         if (dfile == NULL) {
+            dvl_files_unlock(file_id);
             fprintf(stderr, "dvl_hdf5_handle_file_close(): Could not find file id %li in hash map.\n", (long) file_id);
             return dvl_hdf5_call_original_close(toclose, type);
         }
@@ -95,6 +99,9 @@ dvl_hdf5_herr_or_int_t dvl_hdf5_handle_file_close(hid_t file_id, dvl_hdf5_file_c
         // no name lookup here, we have to use the name stored in the hashmap
         // and extend it with the given respath to get a normalized path again
         snprintf(cpath, MAX_FILE_NAME, "%s%s", dvl.respath, dfile->path);
+        dvl_files_unlock(file_id);
+
+        dvl_readahead_flush();
     }
 
     // note: only if the refCount gets to 0, the file will actually close
@@ -132,7 +139,7 @@ dvl_hdf5_herr_or_int_t dvl_hdf5_handle_file_close(hid_t file_id, dvl_hdf5_file_c
 
     // actual DVL handling
     if (dvl.is_simulator){
-        // messages only sent for result files
+        // messages only sent for result files and new checkpoint files
         // redirect check and handling hashmap for result- and checkpoint files
         // 1) lookup in redirect hashmap 2) if not found: check whether file is result file
         dvl.open_files_count--;
@@ -152,6 +159,11 @@ dvl_hdf5_herr_or_int_t dvl_hdf5_handle_file_close(hid_t file_id, dvl_hdf5_file_c
             path = is_result_file(cpath, npath);
             if (path != NULL) {
                 file_type = DVL_FILETYPE_RESULT;
+            } else {
+                path = is_checkpoint_file(cpath, npath);
+                if (path != NULL) {
+                    file_type = DVL_FILETYPE_CHECKPOINT;
+                }
             }
         }
 
@@ -159,7 +171,8 @@ dvl_hdf5_herr_or_int_t dvl_hdf5_handle_file_close(hid_t file_id, dvl_hdf5_file_c
             return toclose_res;
         }        
 
-        if (file_type == DVL_FILETYPE_RESULT) {
+        // messages for result files and new (not redirected) checkpoint files
+        if (file_type == DVL_FILETYPE_RESULT || (file_type == DVL_FILETYPE_CHECKPOINT && !is_redirected)) {
             int64_t size = file_size(cpath_ptr); // returning file size of the original file if redirected
             if (size < 0) {
                 DVLPRINT("DVL_NC_CLOSE: could not determine file size of %s", cpath_ptr);
@@ -190,33 +203,58 @@ dvl_hdf5_herr_or_int_t dvl_hdf5_handle_file_close(hid_t file_id, dvl_hdf5_file_c
             return toclose_res;
         }
 
+        // both entries are removed from the hashmap first; afterwards no other thread can reach them (MT)
+        // note: the shards are locked one after the other to avoid any lock order issues
+        dvl_files_wrlock(file_id);
+        if (dvl_file_find(file_id) != dfile) {
+            // MT: another thread has closed this file id in the meantime
+            dvl_files_unlock(file_id);
+            return toclose_res;
+        }
+        dvl_file_remove(dfile);
+        dvl_files_unlock(file_id);
+
+        hid_t other_key = dfile->other_key;
+        dvl_file_t *other_dfile = NULL;
+
+        if (0 <= other_key) {
+            dvl_files_wrlock(other_key);
+            other_dfile = dvl_file_find(other_key);
+            if (other_dfile != NULL) {
+                dvl_file_remove(other_dfile);
+            }
+            dvl_files_unlock(other_key);
+        }
+
         // to distinguish whether the file was open, we need to look at both hashmap entries
         // additionally, we have to close also the meta file if it was opened
         // note: the same closing procedure is used as is generally used by the application
-        int is_open = dfile->state == DVL_FILE_OPEN;
+        // leased opens were not announced to DV (see dvl_lease.h)
+        int is_open = dfile->state == DVL_FILE_OPEN && !dfile->leased;
 
         if (dfile->is_meta) {
             DVLPRINT("closing the meta file.\n");
             dvl_hdf5_call_original_close(dfile->key, type);
         }
 
-        hid_t other_key = dfile->other_key;
-        dvl_file_t *other_dfile = NULL;
-
-        if (0 <= other_key) {
-            HASH_FIND_INT(dvl.open_files_idx, &other_key, other_dfile);
-
-            if (other_dfile != NULL) {
-                // it's a file meta-file combo
-                is_open = is_open || (other_dfile->state == DVL_FILE_OPEN);
-                if (other_dfile->is_meta) {
-                    DVLPRINT("closing the meta file.\n");
-                    dvl_hdf5_call_original_close(dfile->key, type);
-                }
+        if (other_dfile != NULL) {
+            // it's a file meta-file combo
+            is_open = is_open || (other_dfile->state == DVL_FILE_OPEN);
+            if (other_dfile->is_meta) {
+                DVLPRINT("closing the meta file.\n");
+                dvl_hdf5_call_original_close(dfile->key, type);
             }
         }
 
-        if (is_open) {
+        if (is_open && dvl_report_closes()) {
+            /* batched with other access events (see dvl_report.h) */
+            DVLPRINT("DVL_HDF5_CLOSE: closing %s (reported)\n", path);
+#ifdef __MT__
+            dvl_report_add(DVL_REPORT_CLOSE, path, dvl_get_current_rank());
+#else
+            dvl_report_add(DVL_REPORT_CLOSE, path, dvl.gni.myrank);
+#endif
+        } else if (is_open) {
             /* we are the client and an actual file is open (not meta) */
             MAKE_MESSAGE(buff, bsize, "%c:%s", DVL_MSG_FCLOSE_CLIENT, path);
 
@@ -225,28 +263,22 @@ dvl_hdf5_herr_or_int_t dvl_hdf5_handle_file_close(hid_t file_id, dvl_hdf5_file_c
             if (bsize < 0) {
                 DVLPRINT("dvl_hdf5_handle_file_close(): ERROR while building the message.\n");
                 fprintf(stderr, "dvl_hdf5_handle_file_close(): ERROR while building the message.\n");
-                return toclose_res; // this should not block the entire client, actual file close was OK.
+            } else {
+                dvl_send_message(buff, bsize, 1);
+                // no reply is expected
             }
-
-            dvl_send_message(buff, bsize, 1);
-
-            // no reply is expected
         }
 
-        DVLPRINT("freeing data strutures fid: %li, id: %i, name: %s, is_meta: %d\n",
-            (long) dfile->key, dfile->id, dfile->path, dfile->is_meta);
+        DVLPRINT("freeing data strutures fid: %li, name: %s, is_meta: %d\n",
+            (long) dfile->key, dfile->path, dfile->is_meta);
         /* free the file descriptor */
-        dvl.open_files[dfile->id].trash_next = dvl.free_files;
-        dvl.free_files=&(dvl.open_files[dfile->id]);
-        HASH_DEL(dvl.open_files_idx, &(dvl.open_files[dfile->id]));
+        dvl_file_delete(dfile);
 
         if (other_dfile != NULL) {
-            DVLPRINT("freeing 2nd associated data strutures fid: %li, id: %i, name: %s, is_meta: %d\n",
-                (long) other_dfile->key, other_dfile->id, other_dfile->path, other_dfile->is_meta);
+            DVLPRINT("freeing 2nd associated data strutures fid: %li, name: %s, is_meta: %d\n",
+                (long) other_dfile->key, other_dfile->path, other_dfile->is_meta);
             /* free the file descriptor */
-            dvl.open_files[other_dfile->id].trash_next = dvl.free_files;
-            dvl.free_files=&(dvl.open_files[other_dfile->id]);
-            HASH_DEL(dvl.open_files_idx, &(dvl.open_files[other_dfile->id]));
+            dvl_file_delete(other_dfile);
         }
     }
 
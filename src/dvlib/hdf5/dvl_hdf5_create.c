@@ -23,6 +23,9 @@ hid_t H5Fcreate(const char *name, unsigned flags, hid_t fcpl_id, hid_t fapl_id)
 
     int file_type = DVL_FILETYPE_UNKNOWN;
 
+#ifdef __MT__
+    uint32_t mt_rank = 0;
+#endif
     DVL_CHECK(DVL_NC_CREATE_ID);
 
     /* Check if this file is relevant to us */
@@ -41,6 +44,7 @@ hid_t H5Fcreate(const char *name, unsigned flags, hid_t fcpl_id, hid_t fapl_id)
     printf("CREATING!\n");
 
     int redirected = 0;
+    int skip_writes = 0;
     char *create_path = (char *) name;
     // explicit cast to express awareness of "discards ‘const’ qualifier from pointer target type"
     // we assure in the code below that data in *name is not modified
@@ -97,7 +101,7 @@ hid_t H5Fcreate(const char *name, unsigned flags, hid_t fcpl_id, hid_t fapl_id)
         } else {
             dvl.open_files_count++;
 
-            if (buff[0] == DVL_CREATE_REPLY_REDIRECT) {
+            if (buff[0] == DVL_CREATE_REPLY_REDIRECT || buff[0] == DVL_CREATE_REPLY_REDIRECT_SKIP_WRITES) {
                 // at least a small security check that the path is a /0 terminated string
                 char *redir_path = &buff[2];
                 size_t max_len = BUFFER_SIZE - 4;
@@ -106,6 +110,7 @@ hid_t H5Fcreate(const char *name, unsigned flags, hid_t fcpl_id, hid_t fapl_id)
                     printf("CREATE of %s is redirected to %s\n", name, redir_path);
                     create_path = redir_path;
                     redirected = 1;                    
+                    skip_writes = buff[0] == DVL_CREATE_REPLY_REDIRECT_SKIP_WRITES;
                 } else {
                     printf("ERROR: redir path was longer than available buffer size. Check buffer size and/or networking protocol. Using original path that will overwrite the existing file\n");
                 }
@@ -149,6 +154,8 @@ hid_t H5Fcreate(const char *name, unsigned flags, hid_t fcpl_id, hid_t fapl_id)
     memcpy(rfile->path, path, pathlen + 1);
 
     rfile->file_type = file_type;
+    rfile->staged = 0;
+    rfile->skip_writes = skip_writes;
 
     HASH_ADD_INT(dvl.open_redirected_files_idx, key, &(dvl.redirected_files[redir_fileid]));
 
@@ -22,6 +22,8 @@ void dvl_H5_fill_originals_table(dvl_hdf5_originals_t *originals) {
     originals->h5fopen = dlsym(RTLD_NEXT, "H5Fopen");
     originals->h5fclose = dlsym(RTLD_NEXT, "H5Fclose");
 
+    originals->h5dwrite = dlsym(RTLD_NEXT, "H5Dwrite");
+
     originals->h5iinc_ref = dlsym(RTLD_NEXT, "H5Iinc_ref");
     originals->h5idec_ref = dlsym(RTLD_NEXT, "H5Idec_ref");
 
@@ -9,6 +9,8 @@
 #define __HDF5__
 #endif
 
+#define _DEFAULT_SOURCE
+
 #include <assert.h>
 #include <stdio.h>
 
@@ -21,7 +23,11 @@
 hid_t H5Oopen(hid_t loc_id, const char *name, hid_t lapl_id) {
     char buff[BUFFER_SIZE];        
     
+    uint32_t mt_rank = 0;
     DVL_CHECK(DVL_NC_GET_ID);   
+#ifndef __MT__
+    mt_rank = dvl.gni.myrank;
+#endif
 
     if (dvl.is_simulator) {
         return dvl.h5originals.h5oopen(loc_id, name, lapl_id);
@@ -54,10 +60,13 @@ hid_t H5Oopen(hid_t loc_id, const char *name, hid_t lapl_id) {
     DVLPRINT("DVL open object named %s at loc id %li -> file id %li filename %s\n", name, (long) loc_id, (long) file_id, filename);
 
     // client side
-    dvl_file_t * dfile = NULL;
-    HASH_FIND_INT(dvl.open_files_idx, &file_id, dfile);
+    // MT: the shard lock is not kept over the messaging with DV; a compact local copy
+    //     of the entry is used instead (see dvl_nc_get())
+    dvl_files_rdlock(file_id);
+    dvl_file_t * dfile = dvl_file_find(file_id);
 
     if (dfile == NULL) {
+        dvl_files_unlock(file_id);
         return dvl.h5originals.h5oopen(loc_id, name, lapl_id);
     }
 
@@ -67,10 +76,14 @@ hid_t H5Oopen(hid_t loc_id, const char *name, hid_t lapl_id) {
     // adjusted; we do not need the type information at the moment
     // lookup will differ from netcdf, see HDF5 profiler in tests
 
+    int state = dfile->state;
+    hid_t other_key = dfile->other_key;
+    hid_t fid_to_use = dfile->fid_to_use;
 
     /* if the file is already open, just get the data */
-    if (dfile->state == DVL_FILE_OPEN) {
-        hid_t res = dvl.h5originals.h5oopen(dfile->fid_to_use, name, lapl_id);
+    if (state == DVL_FILE_OPEN) {
+        dvl_files_unlock(file_id);
+        hid_t res = dvl.h5originals.h5oopen(fid_to_use, name, lapl_id);
 
         // during testing
         DVLPRINT("DVL HDF5 open object: file is open, returning object id %li for name %s\n", (long) res, name);
@@ -95,17 +108,23 @@ hid_t H5Oopen(hid_t loc_id, const char *name, hid_t lapl_id) {
 
     // thus: if the information is already known that the actual file is available
     // -> no need to send a message again to the DVL server
-    if (0 <= dfile->other_key) {
-        hid_t res = dvl.h5originals.h5oopen(dfile->fid_to_use, name, lapl_id);
+    if (0 <= other_key) {
+        dvl_files_unlock(file_id);
+        hid_t res = dvl.h5originals.h5oopen(fid_to_use, name, lapl_id);
 
         // during testing
         DVLPRINT("DVL HDF5 open object: file is open but still accessed thru meta file id (as expected), returning id %li for name %s (in file id %li)\n",
-            (long) res, name, (long) dfile->fid_to_use);
+            (long) res, name, (long) fid_to_use);
         return res;
     } else {
         DVLPRINT("File not yet available. Going through DVL server messaging.\n");
     }
 
+    // the interned path stays valid with the additional reference
+    unsigned flags = dfile->flags;
+    const char * dpath = dvl_path_ref(dfile->path);
+    dvl_files_unlock(file_id);
+
 
     //--- here we start building up the connection with the DVL server ---------
 
@@ -121,9 +140,10 @@ hid_t H5Oopen(hid_t loc_id, const char *name, hid_t lapl_id) {
        It can reply with AVAIL or SIMULATING */
     int msgsize = BUFFER_SIZE;
 
-    MAKE_MESSAGE(buff, msgsize, "%c:%s:%li:%i:", DVL_MSG_VGET, dfile->path, (long) obj_res, dvl.gni.myrank);
+    MAKE_MESSAGE(buff, msgsize, "%c:%s:%li:%i:", DVL_MSG_VGET, dpath, (long) obj_res, mt_rank);
 
     if (msgsize < 0) {
+        dvl_path_unref(dpath);
         return DVL_ERROR;
     }
 
@@ -143,9 +163,30 @@ hid_t H5Oopen(hid_t loc_id, const char *name, hid_t lapl_id) {
 
     if (buff[0] == DVL_REPLY_FILE_OPEN){
         /* if AVAIL just open the file and read from it */
-        assert(dfile->state==DVL_FILE_SIM);
+        assert(state==DVL_FILE_SIM);
+
+        snprintf(buff, BUFFER_SIZE, "%s%s", dvl.respath, dpath);
+
+        // MT: another thread may have opened the actual file in the meantime -> use its id
+        // note: the entry is locked while the file is opened to avoid opening it twice
+        dvl_files_wrlock(file_id);
+        dfile = dvl_file_find(file_id);
+        if (dfile == NULL || dfile->path != dpath) {
+            dvl_files_unlock(file_id);
+            dvl_path_unref(dpath);
+            fprintf(stderr, "DVL HDF5 object open: ERROR: file data structure removed before it could be updated. Check client code.\n");
+            return -1;
+        }
+
+        if (0 <= dfile->other_key) {
+            fid_to_use = dfile->fid_to_use;
+            dvl_files_unlock(file_id);
+            dvl_path_unref(dpath);
 
-        snprintf(buff, BUFFER_SIZE, "%s%s", dvl.respath, dfile->path);
+            obj_res = dvl.h5originals.h5oopen(fid_to_use, name, lapl_id);
+            DVLPRINT("DVL open object: file was opened by another thread, returning object id %li for name %s\n", (long) obj_res, name);
+            return obj_res;
+        }
 
         //hid_t plist_res = H5Pcopy(dfile->access_plist); 
         // note: copying of the property list does not work
@@ -155,11 +196,13 @@ hid_t H5Oopen(hid_t loc_id, const char *name, hid_t lapl_id) {
         //DVLPRINT("DVL open %s with prop list %li copied to %li\n", buff, (long) dfile->access_plist, (long) plist_res);
 
         // note: here, we open the file and not the object: thus fopen and not oopen.
-        hid_t file_res = dvl.h5originals.h5fopen(buff, dfile->flags, plist_res);
+        hid_t file_res = dvl.h5originals.h5fopen(buff, flags, plist_res);
 
         DVLPRINT("DVL file is freshly opened, returning file id %li for name %s\n", (long) file_res, buff);
 
         if (file_res < 0) {
+            dvl_files_unlock(file_id);
+            dvl_path_unref(dpath);
             fprintf(stderr, "DVL HDF5 object open: ERROR: Could not open actual file %s\n", buff);
             return -1;
         }
@@ -168,10 +211,8 @@ hid_t H5Oopen(hid_t loc_id, const char *name, hid_t lapl_id) {
         // old key is referring to .meta fileid
         // new key is referring to actual fileid
 
-        /* get the next free file descriptor */
-        int fileid = dvl.free_files->id;
-        dvl.free_files = dvl.free_files->trash_next;
-        dvl_file_t * new_dfile = &(dvl.open_files[fileid]);
+        /* get a new file descriptor; shares the interned path */
+        dvl_file_t * new_dfile = dvl_file_new(dpath);
 
         dfile->other_key = file_res;
         dfile->fid_to_use = file_res;
@@ -179,19 +220,21 @@ hid_t H5Oopen(hid_t loc_id, const char *name, hid_t lapl_id) {
         new_dfile->key = file_res;
         new_dfile->fid_to_use = file_res;
         new_dfile->is_meta = 0;
-        new_dfile->flags = dfile->flags;
+        new_dfile->flags = flags;
         new_dfile->access_plist = plist_res;
         new_dfile->state = DVL_FILE_OPEN;
-        size_t pathlen = strlen(dfile->path);
-        memcpy(new_dfile->path, dfile->path, pathlen + 1);
+        dvl_files_unlock(file_id);
+        dvl_path_unref(dpath);
 
         // add the new file_id to hashmap for the next lookup
-        HASH_ADD_INT(dvl.open_files_idx, key, &(dvl.open_files[new_dfile->id]));
+        dvl_files_wrlock(file_res);
+        dvl_file_add(new_dfile);
+        dvl_files_unlock(file_res);
 
-        DVLPRINT("DVL said the file is avail: opening object %s in file  %s (fid %li)\n", name, buff, (long) new_dfile->fid_to_use);
+        DVLPRINT("DVL said the file is avail: opening object %s in file  %s (fid %li)\n", name, buff, (long) file_res);
 
         // here, we open the object for real
-        obj_res = dvl.h5originals.h5oopen(new_dfile->fid_to_use, name, lapl_id);
+        obj_res = dvl.h5originals.h5oopen(file_res, name, lapl_id);
 
         DVLPRINT("DVL open object file is freshly opened, returning object id %li for name %s\n", (long) obj_res, name);
         return obj_res;
@@ -199,9 +242,12 @@ hid_t H5Oopen(hid_t loc_id, const char *name, hid_t lapl_id) {
     } else if (buff[0] == DVL_REPLY_RDMA){
         /* make RDMA get */
 
+        dvl_path_unref(dpath);
         return -1; /* do not call the original get */
     }
 
+    dvl_path_unref(dpath);
+
     printf("#####Going to fail! Message: %s\n", buff);
     assert(1!=1);
     return -1; /* shouldn't be reached */
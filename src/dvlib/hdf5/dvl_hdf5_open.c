@@ -8,17 +8,40 @@
 #define __HDF5__
 #endif
 
+#define _DEFAULT_SOURCE
+
 #include "../dvl.h"
 #include "../dvl_internal.h"
 #include "../dvl_proxy.h"
+#include "../dvl_lease.h"
+#include "../dvl_report.h"
+#include "../dvl_lcache.h"
+#include "../dvl_readahead.h"
 
 #include "dvl_hdf5.h"
 
+/* read-only opens of available result files use the node-local cache if enabled (see dvl_lcache.h) */
+static hid_t open_result_file(const char * opath, const char * path, unsigned flags, hid_t access_plist) {
+    if (flags == H5F_ACC_RDONLY) {
+        char lbuff[MAX_FILE_NAME];
+        const char * lpath = dvl_lcache_path(path, opath, lbuff);
+        if (lpath != opath) {
+            hid_t res = dvl.h5originals.h5fopen(lpath, flags, access_plist);
+            if (0 <= res) return res;
+        }
+    }
+    return dvl.h5originals.h5fopen(opath, flags, access_plist);
+}
+
 hid_t H5Fopen(const char *opath, unsigned flags, hid_t access_plist) {
     char buff[BUFFER_SIZE];        
     char npath[MAX_FILE_NAME];
 
+    uint32_t mt_rank = 0;
     DVL_CHECK(DVL_NC_OPEN_ID);
+#ifndef __MT__
+    mt_rank = dvl.gni.myrank;
+#endif
 
     DVLPRINT("open!! %s\n", opath);
 
@@ -32,24 +55,35 @@ hid_t H5Fopen(const char *opath, unsigned flags, hid_t access_plist) {
     if (!dvl.is_simulator) {
         DVLPRINT("DVL OPEN!\n");
 
-        /* Check if we have file descriptors available */
-        if (dvl.free_files==NULL){
-            printf("Error: too many open files!\n");
-            DVL_ABORT;
-        }        
-
-        size_t pathlen = strlen(path);
-
-        if (pathlen >= MAX_FILE_NAME){
-            printf("Error: file name too long: %s\n", path);
-            DVL_ABORT;
+        /* get a new file descriptor (the table grows on demand) */
+        dvl_file_t * dfile = dvl_file_new(path);
+
+        /* read lease: the file is available and locked by DV -> no round trip */
+        int read_only = !(flags & H5F_ACC_RDWR);
+        if (read_only && dvl_lease_valid(path)) {
+            hid_t res = open_result_file(opath, path, flags, access_plist);
+            if (0 <= res) {
+                dfile->state = DVL_FILE_OPEN;
+                dfile->leased = 1;
+                dfile->is_meta = 0;
+                dfile->key = res;
+                dfile->other_key = -1;
+                dfile->fid_to_use = res;
+                dfile->flags = flags;
+                dfile->access_plist = access_plist;
+
+                dvl_files_wrlock(dfile->key);
+                dvl_file_add(dfile);
+                dvl_files_unlock(dfile->key);
+
+                dvl_report_add(DVL_REPORT_OPEN_LEASED, path, mt_rank);
+
+                DVLPRINT("DVL_NC_OPEN (leased): %s, open files: %u, key: %li\n", path, dvl.open_files_active, (long) dfile->key);
+                return res;
+            }
+            dvl_lease_drop(path);
         }
-    
-        /* get the next free file descriptor */
-        int fileid = dvl.free_files->id;
-        dvl.free_files = dvl.free_files->trash_next;
 
-        dvl_file_t * dfile = &(dvl.open_files[fileid]);
 #ifdef BENCH
         //LSB_Set_Rparam_str("restart", simstart);
         //LSB_Res();
@@ -59,16 +93,28 @@ hid_t H5Fopen(const char *opath, unsigned flags, hid_t access_plist) {
         int msgsize = BUFFER_SIZE;
 
         // here we use the shorter path (without pre-defined respath): path (equal as in nc version)
-        MAKE_MESSAGE(buff, msgsize, "%c:%s:%i:file=%s;gni_addr=%u", DVL_MSG_FOPEN, path, dvl.gni.myrank, path, dvl.gni.addr);
+        char options[32] = "";
+        if (0 < dvl_readahead_files()) {
+            snprintf(options, sizeof(options), ":%s%i", DVL_READAHEAD_REQUEST, dvl_readahead_files());
+        }
+        if (read_only && dvl_lease_enabled()) {
+            MAKE_MESSAGE(buff, msgsize, "%c:%s:%i:file=%s;gni_addr=%u:%s%s", DVL_MSG_FOPEN, path, mt_rank, path, dvl.gni.addr, DVL_LEASE_REQUEST, options);
+        } else {
+            MAKE_MESSAGE(buff, msgsize, "%c:%s:%i:file=%s;gni_addr=%u%s", DVL_MSG_FOPEN, path, mt_rank, path, dvl.gni.addr, options);
+        }
 
         if (msgsize<0) {
             fprintf(stderr, "DVLib H5Fopen: could not create the message.\n");
+            dvl_file_delete(dfile);
             return DVL_ERROR;
         }
+        uint64_t sent_ms = dvl_lease_now_ms();
         dvl_send_message(buff, msgsize, 0);
     
         /* recv response -> this is blocking for a typically short time */
         dvl_recv_message(buff, BUFFER_SIZE, 1);
+        dvl_lease_grant(path, buff, sent_ms);
+        dvl_readahead_hints(buff);
 
         hid_t res;
 
@@ -83,7 +129,7 @@ hid_t H5Fopen(const char *opath, unsigned flags, hid_t access_plist) {
             dfile->is_meta = 1;     
         } else {
             DVLPRINT("DVL message received: file %s is available\n", opath);
-            res = dvl.h5originals.h5fopen(opath, flags, access_plist);
+            res = open_result_file(opath, path, flags, access_plist);
             dfile->state = DVL_FILE_OPEN;
             dfile->is_meta = 0;  
         }
@@ -94,12 +140,12 @@ hid_t H5Fopen(const char *opath, unsigned flags, hid_t access_plist) {
         dfile->flags = flags;
         dfile->access_plist = access_plist;
 
-        memcpy(dfile->path, path, pathlen + 1);
-
-        HASH_ADD_INT(dvl.open_files_idx, key, &(dvl.open_files[fileid]));
+        dvl_files_wrlock(dfile->key);
+        dvl_file_add(dfile);
+        dvl_files_unlock(dfile->key);
 
-        DVLPRINT("DVL_NC_OPEN: relative path (used for DVL comm): %s, full path: %s, fileid: %i, idx cnt: %u, is_meta: %i, key: %li\n",
-            path, npath, fileid, HASH_COUNT(dvl.open_files_idx), dfile->is_meta, (long) dfile->key);
+        DVLPRINT("DVL_NC_OPEN: relative path (used for DVL comm): %s, full path: %s, open files: %u, is_meta: %i, key: %li\n",
+            path, npath, dvl.open_files_active, dfile->is_meta, (long) dfile->key);
         return res;
 
     } else { /* we don't care about the simulator */
@@ -0,0 +1,47 @@
+/* hdf5 dataset write following the netcdf put version
+ * only the skipped writes of redirected files are handled (see DVL_CREATE_REPLY_REDIRECT_SKIP_WRITES);
+ * all other writes go to the original function directly
+*/
+
+#ifndef __HDF5__
+#define __HDF5__
+#endif
+
+#define _GNU_SOURCE
+
+#include <dlfcn.h>
+
+#include "../dvl.h"
+#include "../dvl_internal.h"
+
+#include "dvl_hdf5.h"
+
+// 1 if the dataset belongs to a file that has been redirected with skipped writes
+static int is_skip_write_dataset(hid_t dset_id) {
+    hid_t file_id = H5Iget_file_id(dset_id); // note: needs an H5Fclose afterwards
+    if (file_id < 0) {
+        return 0;
+    }
+
+    dvl_redirected_file_t *rfile = NULL;
+    HASH_FIND_INT(dvl.open_redirected_files_idx, &file_id, rfile);
+    dvl.h5originals.h5fclose(file_id);
+
+    return rfile != NULL && rfile->skip_writes;
+}
+
+herr_t H5Dwrite(hid_t dset_id, hid_t mem_type_id, hid_t mem_space_id,
+             hid_t file_space_id, hid_t plist_id, const void *buf) {
+    // note: no DVL_CHECK here; files are only redirected after the init (see H5Fcreate)
+    if (dvl.enabled && dvl.is_simulator && dvl.open_redirected_files_idx != NULL && is_skip_write_dataset(dset_id)) {
+        // DV keeps the existing file and removes the redirected one
+        return DVL_HDF5_SUCCESS;
+    }
+
+    if (dvl.h5originals.h5dwrite == NULL) {
+        // DVLib is not initialized yet
+        oh5d_write_t original = dlsym(RTLD_NEXT, "H5Dwrite");
+        return original(dset_id, mem_type_id, mem_space_id, file_space_id, plist_id, buf);
+    }
+    return dvl.h5originals.h5dwrite(dset_id, mem_type_id, mem_space_id, file_space_id, plist_id, buf);
+}
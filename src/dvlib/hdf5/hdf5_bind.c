@@ -3,7 +3,7 @@
    Read currently maps the areas to netcdf compatible areas to
    be compatible with the netcdf calls
 
-   Put/Write is not yet implemented.
+   Put/Write: only the skipped writes of redirected files (see dvl_hdf5_write.c).
 
    v0.4 2017-04-27 Pirmin Schmid
 */
@@ -68,17 +68,9 @@ herr_t H5Dread(hid_t dset_id, hid_t mem_type_id, hid_t mem_space_id,
 }
 */
 
-/*
-herr_t H5Dwrite(hid_t dset_id, hid_t mem_type_id, hid_t mem_space_id,
-             hid_t file_space_id, hid_t plist_id, const void *buf) {
-    oh5d_write_t original = dlsym(RTLD_NEXT, "H5Dwrite");
-
-    hid_t res = dvl_H5Dwrite(dset_id, mem_type_id, mem_space_id, file_space_id, plist_id, buf);
-    if (res >= 0) return (*original)(dset_id, mem_type_id, mem_space_id, file_space_id, plist_id, buf)
-    // default: negative error
-    return -1; 
-}
-*/
+// herr_t H5Dwrite(hid_t dset_id, hid_t mem_type_id, hid_t mem_space_id,
+//             hid_t file_space_id, hid_t plist_id, const void *buf)
+// see dvl_hdf5_write.c
 
 
 //--- I: identifier interface --------------------------------------------------
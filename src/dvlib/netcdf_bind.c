@@ -34,36 +34,41 @@ int nc_create(char *path, int cmode, int * ncidp){
 int nc_get_vara(int ncid, int varid, const size_t start[], const size_t count[], const void * valuesp){
     onc_get_vara_t original = dlsym(RTLD_NEXT, "nc_get_vara");
   
-    int res = dvl_nc_get(ncid, varid, start, count, valuesp);
-    if (res>=0) return (*original)(res, varid, start, count, valuesp);
+    int res = dvl_nc_get(ncid, varid, start, count, DVL_MEMTYPE_NAT, valuesp);
+    if (res>=0) return dvl_nc_get_done(ncid, res, varid, start, count, DVL_MEMTYPE_NAT, valuesp, (*original)(res, varid, start, count, valuesp));
+    if (res == DVL_GET_SERVED) return 0; /* NC_NOERR */
     return res;
 }
 
 int nc_get_vara_int(int ncid, int varid, const size_t start[], const size_t count[], const int * valuesp){
     onc_get_vara_int_t original = dlsym(RTLD_NEXT, "nc_get_vara_int");
-    int res = dvl_nc_get(ncid, varid, start, count, valuesp);
-    if (res>=0) return (*original)(res, varid, start, count, valuesp);
+    int res = dvl_nc_get(ncid, varid, start, count, DVL_MEMTYPE_INT, valuesp);
+    if (res>=0) return dvl_nc_get_done(ncid, res, varid, start, count, DVL_MEMTYPE_INT, valuesp, (*original)(res, varid, start, count, valuesp));
+    if (res == DVL_GET_SERVED) return 0; /* NC_NOERR */
     return res;
 }
 
 int nc_get_vara_float(int ncid, int varid, const size_t start[], const size_t count[], const float * valuesp){
     onc_get_vara_float_t original = dlsym(RTLD_NEXT, "nc_get_vara_float");
-    int res = dvl_nc_get(ncid, varid, start, count, valuesp);
-    if (res>=0) return (*original)(res, varid, start, count, valuesp);
+    int res = dvl_nc_get(ncid, varid, start, count, DVL_MEMTYPE_FLOAT, valuesp);
+    if (res>=0) return dvl_nc_get_done(ncid, res, varid, start, count, DVL_MEMTYPE_FLOAT, valuesp, (*original)(res, varid, start, count, valuesp));
+    if (res == DVL_GET_SERVED) return 0; /* NC_NOERR */
     return res;
 }
 
 int nc_get_vara_double(int ncid, int varid, const size_t start[], const size_t count[], const double * valuesp){
     onc_get_vara_double_t original = dlsym(RTLD_NEXT, "nc_get_vara_double");
-    int res = dvl_nc_get(ncid, varid, start, count, valuesp);
-    if (res>=0) return (*original)(res, varid, start, count, valuesp);
+    int res = dvl_nc_get(ncid, varid, start, count, DVL_MEMTYPE_DOUBLE, valuesp);
+    if (res>=0) return dvl_nc_get_done(ncid, res, varid, start, count, DVL_MEMTYPE_DOUBLE, valuesp, (*original)(res, varid, start, count, valuesp));
+    if (res == DVL_GET_SERVED) return 0; /* NC_NOERR */
     return res;
 }
 
 int nc_get_vara_char(int ncid, int varid, const size_t start[], const size_t count[], const char * valuesp){
     onc_get_vara_text_t original = dlsym(RTLD_NEXT, "nc_get_vara_text");
-    int res = dvl_nc_get(ncid, varid, start, count, valuesp);
-    if (res>=0) return (*original)(res, varid, start, count, valuesp);
+    int res = dvl_nc_get(ncid, varid, start, count, DVL_MEMTYPE_CHAR, valuesp);
+    if (res>=0) return dvl_nc_get_done(ncid, res, varid, start, count, DVL_MEMTYPE_CHAR, valuesp, (*original)(res, varid, start, count, valuesp));
+    if (res == DVL_GET_SERVED) return 0; /* NC_NOERR */
     return res;
 }
 
@@ -72,75 +77,58 @@ int nc_get_vara_char(int ncid, int varid, const size_t start[], const size_t cou
 int nc_put_vara(int ncid, int varid, const size_t start[], const size_t count[], const void * valuesp){
     onc_put_vara_t original = dlsym(RTLD_NEXT, "nc_put_vara");
     int res = dvl_nc_put(ncid, varid, start, count, valuesp);
-#ifdef __WRITE_NO_DATA_DURING_REDIRECT__
-    if (res >= 0) {
-        return (*original)(res, varid, start, count, valuesp);
-    } else if (res == DVL_PREVENT_WRITING_DATA_DURING_REDIRECT) {
-        return NC_NOERR;
-    }
-#else
-    if (res>=0) return (*original)(res, varid, start, count, valuesp);
-#endif
-
+    if (res>=0) return dvl_nc_put_done(res, varid, start, count, (*original)(res, varid, start, count, valuesp));
+    if (res == DVL_PREVENT_WRITING_DATA_DURING_REDIRECT) return dvl_nc_put_done(ncid, varid, start, count, 0); /* NC_NOERR */
     return res;
 }
 
 int nc_put_vara_int(int ncid, int varid, const size_t start[], const size_t count[], const int * valuesp){
     onc_put_vara_int_t original = dlsym(RTLD_NEXT, "nc_put_vara_int");
     int res = dvl_nc_put(ncid, varid, start, count, valuesp);
-#ifdef __WRITE_NO_DATA_DURING_REDIRECT__
-    if (res >= 0) {
-        return (*original)(res, varid, start, count, valuesp);
-    } else if (res == DVL_PREVENT_WRITING_DATA_DURING_REDIRECT) {
-        return NC_NOERR;
-    }
-#else    
-    if (res>=0) return (*original)(res, varid, start, count, valuesp);
-#endif
+    if (res>=0) return dvl_nc_put_done(res, varid, start, count, (*original)(res, varid, start, count, valuesp));
+    if (res == DVL_PREVENT_WRITING_DATA_DURING_REDIRECT) return dvl_nc_put_done(ncid, varid, start, count, 0); /* NC_NOERR */
     return res;
 }
 
 int nc_put_vara_float(int ncid, int varid, const size_t start[], const size_t count[], const float * valuesp){
     onc_put_vara_float_t original = dlsym(RTLD_NEXT, "nc_put_vara_float");
     int res = dvl_nc_put(ncid, varid, start, count, valuesp);
-#ifdef __WRITE_NO_DATA_DURING_REDIRECT__
-    if (res >= 0) {
-        return (*original)(res, varid, start, count, valuesp);
-    } else if (res == DVL_PREVENT_WRITING_DATA_DURING_REDIRECT) {
-        return NC_NOERR;
-    }
-#else     
-    if (res>=0) return (*original)(res, varid, start, count, valuesp);
-#endif
+    if (res>=0) return dvl_nc_put_done(res, varid, start, count, (*original)(res, varid, start, count, valuesp));
+    if (res == DVL_PREVENT_WRITING_DATA_DURING_REDIRECT) return dvl_nc_put_done(ncid, varid, start, count, 0); /* NC_NOERR */
     return res;
 }
 
 int nc_put_vara_double(int ncid, int varid, const size_t start[], const size_t count[], const double * valuesp){
     onc_put_vara_double_t original = dlsym(RTLD_NEXT, "nc_put_vara_double");
     int res = dvl_nc_put(ncid, varid, start, count, valuesp);
-#ifdef __WRITE_NO_DATA_DURING_REDIRECT__
-    if (res >= 0) {
-        return (*original)(res, varid, start, count, valuesp);
-    } else if (res == DVL_PREVENT_WRITING_DATA_DURING_REDIRECT) {
-        return NC_NOERR;
-    }
-#else 
-    if (res>=0) return (*original)(res, varid, start, count, valuesp);
-#endif
+    if (res>=0) return dvl_nc_put_done(res, varid, start, count, (*original)(res, varid, start, count, valuesp));
+    if (res == DVL_PREVENT_WRITING_DATA_DURING_REDIRECT) return dvl_nc_put_done(ncid, varid, start, count, 0); /* NC_NOERR */
     return res;
 }
 
 int nc_put_vara_char(int ncid, int varid, const size_t start[], const size_t count[], const char * valuesp){
     onc_put_vara_text_t original = dlsym(RTLD_NEXT, "nc_put_vara_text");
     int res = dvl_nc_put(ncid, varid, start, count, valuesp);
-#ifdef __WRITE_NO_DATA_DURING_REDIRECT__
-    if (res >= 0) {
-        return (*original)(res, varid, start, count, valuesp);
-    } else if (res == DVL_PREVENT_WRITING_DATA_DURING_REDIRECT) {
-        return NC_NOERR;
-    }
-#else 
-    if (res>=0) return (*original)(res, varid, start, count, valuesp);
-#endif
+    if (res>=0) return dvl_nc_put_done(res, varid, start, count, (*original)(res, varid, start, count, valuesp));
+    if (res == DVL_PREVENT_WRITING_DATA_DURING_REDIRECT) return dvl_nc_put_done(ncid, varid, start, count, 0); /* NC_NOERR */
     return res;
 }
+
+/* skipped writes only; these puts are not reported for early data availability (notified at the close) */
+int nc_put_var(int ncid, int varid, const void * valuesp){
+    onc_put_var_t original = dlsym(RTLD_NEXT, "nc_put_var");
+    if (dvl_nc_put_skipped(ncid)) return 0; /* NC_NOERR */
+    return (*original)(ncid, varid, valuesp);
+}
+
+int nc_put_var1(int ncid, int varid, const size_t index[], const void * valuep){
+    onc_put_var1_t original = dlsym(RTLD_NEXT, "nc_put_var1");
+    if (dvl_nc_put_skipped(ncid)) return 0; /* NC_NOERR */
+    return (*original)(ncid, varid, index, valuep);
+}
+
+int nc_put_vars(int ncid, int varid, const size_t start[], const size_t count[], const ptrdiff_t stride[], const void * valuesp){
+    onc_put_vars_t original = dlsym(RTLD_NEXT, "nc_put_vars");
+    if (dvl_nc_put_skipped(ncid)) return 0; /* NC_NOERR */
+    return (*original)(ncid, varid, start, count, stride, valuesp);
+}
@@ -2,6 +2,7 @@
 #ifndef __NETCDF_BIND_H__
 #define __NETCDF_BIND_H__
 
+#include <stddef.h>
 #include <stdlib.h>
 
 typedef int (*onc_open_t)(const char *, int, int *);
@@ -14,6 +15,10 @@ typedef int (*onc_put_vara_double_t)(int, int, const size_t[], const size_t[], c
 typedef int (*onc_put_vara_float_t)(int, int, const size_t[], const size_t[], const float *);
 typedef int (*onc_put_vara_text_t)(int, int, const size_t[], const size_t[], const char *);
 
+typedef int (*onc_put_var_t)(int, int, const void *);
+typedef int (*onc_put_var1_t)(int, int, const size_t[], const void *);
+typedef int (*onc_put_vars_t)(int, int, const size_t[], const size_t[], const ptrdiff_t[], const void *);
+
 typedef int (*onc_get_vara_t)(int, int, const size_t[], const size_t[], const void *);
 typedef int (*onc_get_vara_int_t)(int, int, const size_t[], const size_t[], const int *);
 typedef int (*onc_get_vara_double_t)(int, int, const size_t[], const size_t[], const double *);
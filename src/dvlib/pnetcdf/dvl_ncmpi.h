@@ -39,5 +39,10 @@ int dvl_ncmpi_put(int ncid, int varid, const MPI_Offset *start,
                const MPI_Offset *count, const void *op,
                MPI_Offset bufcount, MPI_Datatype buftype);
 
+/* sends the message (msgsize < 0: invalid message) to DV and receives the reply into buff (BUFFER_SIZE).
+   aggregated mode: collective call; only rank 0 of comm talks to DV and the reply is broadcast.
+   returns DVL_SUCCESS or DVL_ERROR (in aggregated mode equal on all ranks) */
+int dvl_ncmpi_exchange(MPI_Comm comm, int comm_rank, char *buff, int msgsize);
+
 #endif // CLIENTLIB_PNETCDF_DVL_NCMPI_
 
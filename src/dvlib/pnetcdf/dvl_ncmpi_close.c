@@ -17,6 +17,8 @@
  * 2017-03-14 / 2017-03-19 ps
  */
 
+#define _DEFAULT_SOURCE
+
 #ifndef __NCMPI__
 #define __NCMPI__
 #endif
@@ -34,6 +36,9 @@ int _dvl_ncmpi_close(int ncid, oncmpi_close_t oncmpi_close) {
     char * path;
     int bsize = BUFFER_SIZE;
 
+#ifdef __MT__
+    uint32_t mt_rank = 0;
+#endif
     DVL_CHECK(DVL_NC_CLOSE_ID);
 
     int toclose = ncid;
@@ -41,25 +46,24 @@ int _dvl_ncmpi_close(int ncid, oncmpi_close_t oncmpi_close) {
     dvl_file_t * dfile = NULL;
 
     // lookup for both, simulator and not simulator
-    if (!dvl.is_simulator){
-        HASH_FIND_INT(dvl.open_files_idx, &ncid, dfile);
-        if (dfile->state == DVL_FILE_SIM) {
-            /* corner case: closing file while still being simulated. Here the 
-            * key is the ncid of the metadata file */
-            toclose = ncid;
-            //ncid = dfile->ncid; 
-        }else{
-            toclose = dfile->ncid;
-        }
-    } else {
-        // simulator lookup added. note: we cannot be sure whether there is a
-        // descriptor in the hash table since we are tracking create but not open on this side.
-        HASH_FIND_INT(dvl.open_files_idx, &ncid, dfile);
-        if (NULL == dfile) {
-            // must have been an opened restart file -> just close it
-            return oncmpi_close(ncid);
-        }
+    // the entry is removed from the hashmap right away; afterwards it is only used by this thread (MT)
+    // note re simulator: we cannot be sure whether there is a descriptor in the hash table
+    // since we are tracking create but not open on this side.
+    dvl_files_wrlock(ncid);
+    dfile = dvl_file_find(ncid);
+    if (NULL == dfile) {
+        dvl_files_unlock(ncid);
+        // must have been an opened restart file (simulator) or a file not opened thru DVLib -> just close it
+        return oncmpi_close(ncid);
+    }
+    dvl_file_remove(dfile);
+    dvl_files_unlock(ncid);
 
+    if (!dvl.is_simulator && dfile->state == DVL_FILE_SIM) {
+        /* corner case: closing file while still being simulated. Here the 
+        * key is the ncid of the metadata file */
+        toclose = ncid;
+    } else {
         // we have a tracked file here
         toclose = dfile->ncid;
     }
@@ -76,7 +80,10 @@ int _dvl_ncmpi_close(int ncid, oncmpi_close_t oncmpi_close) {
     int toclose_res = oncmpi_close(toclose);
 
     path = is_result_file(cpath, npath);
-    if (path==NULL) return toclose_res;
+    if (path==NULL) {
+        dvl_file_delete(dfile);
+        return toclose_res;
+    }
 
     DVLPRINT("DVL_NCMPI_CLOSE: recognizes as result file\n");
 
@@ -94,19 +101,20 @@ int _dvl_ncmpi_close(int ncid, oncmpi_close_t oncmpi_close) {
             }
 
             MAKE_MESSAGE(buff, bsize, "%c:%i:%s:%li", DVL_MSG_FCLOSE_SIM, dvl.gni.myrank, path, size);
-            if (bsize<0) return DVL_ERROR;
-            
+            if (bsize<0) {
+                dvl_file_delete(dfile);
+                return DVL_ERROR;
+            }
+
             DVLPRINT("DVL_NCMPI_CLOSE: simulator has closed %s (ncid: %i, gni_rank %i)\n", path, toclose, dvl.gni.myrank);
 
             dvl_send_message(buff, bsize, 1);
         }
 
         // added cleanup equally as for !is_simulator
-        printf("freeing data strutures id: %i\n", dfile->id);
+        printf("freeing data strutures ncid: %i\n", dfile->key);
         /* free the file descriptor */
-        dvl.open_files[dfile->id].trash_next = dvl.free_files;
-        dvl.free_files=&(dvl.open_files[dfile->id]);
-        HASH_DEL(dvl.open_files_idx, &(dvl.open_files[dfile->id]));
+        dvl_file_delete(dfile);
     } else {
         if (dfile->state == DVL_FILE_OPEN){ /* we are the client and an actual file is open (not meta) */
             // added check for rank 0
@@ -120,11 +128,9 @@ int _dvl_ncmpi_close(int ncid, oncmpi_close_t oncmpi_close) {
             }
         }
 
-        printf("freeing data strutures id: %i\n", dfile->id);
+        printf("freeing data strutures ncid: %i\n", dfile->key);
         /* free the file descriptor */
-        dvl.open_files[dfile->id].trash_next = dvl.free_files;
-        dvl.free_files=&(dvl.open_files[dfile->id]);
-        HASH_DEL(dvl.open_files_idx, &(dvl.open_files[dfile->id]));
+        dvl_file_delete(dfile);
     }
 
     printf("to close: %i\n", toclose);
@@ -0,0 +1,43 @@
+/*
+ * DV communication for collective pnetcdf calls.
+ *
+ * -> in aggregated mode (default; see ENV_NCMPI_COLLECTIVE), only rank 0 of the
+ *    communicator sends the request to DV and waits for the reply/notification.
+ *    The reply is then broadcast to all ranks. Thus, DV sees one logical client
+ *    per communicator instead of one identical request per rank.
+ * -> in per-rank mode, each rank talks to DV itself (previous behavior of get).
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <mpi.h>
+#include <string.h>
+
+#ifndef __NCMPI__
+#define __NCMPI__
+#endif
+
+#include "../dvl.h"
+#include "../dvl_internal.h"
+#include "../dvl_proxy.h"
+
+#include "dvl_ncmpi.h"
+
+int dvl_ncmpi_exchange(MPI_Comm comm, int comm_rank, char *buff, int msgsize) {
+    int aggregated = dvl.ncmpi_collective == DVL_NCMPI_AGGREGATED;
+
+    if (!aggregated || 0 == comm_rank) {
+        if (msgsize < 0
+            || dvl_send_message(buff, msgsize, 0) != DVL_SUCCESS
+            || dvl_recv_message(buff, BUFFER_SIZE, 1) < 0) {
+            // empty reply: marks the error also on the other ranks
+            buff[0] = '\0';
+        }
+    }
+
+    if (aggregated) {
+        MPI_Bcast(buff, BUFFER_SIZE, MPI_CHAR, 0, comm);
+    }
+
+    return buff[0] == '\0' ? DVL_ERROR : DVL_SUCCESS;
+}
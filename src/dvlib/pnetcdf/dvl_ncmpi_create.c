@@ -11,12 +11,17 @@
  *    - we need to duplicate the MPI_Info structure into the descriptor, too
  *      since dvl_ncmpi_get may open a file
  *
+ *    - the reply of DV is broadcast to all ranks: redirects (incl. skipped writes, see
+ *      dvl_ncmpi_put) apply to all of them
+ *
  * note: create is only caught on the simulator side at the moment
  * as in _dvl_nc_create()
  *
  * 2017-03-09 / 2017-03-19 ps
  */
 
+#define _DEFAULT_SOURCE
+
 #include <mpi.h>
 
 #ifndef __NCMPI__
@@ -33,6 +38,9 @@ int _dvl_ncmpi_create(MPI_Comm comm, const char *opath, int cmode, MPI_Info info
     char buff[BUFFER_SIZE];        
     char npath[MAX_FILE_NAME];
 
+#ifdef __MT__
+    uint32_t mt_rank = 0;
+#endif
     DVL_CHECK_WITH_COMM(DVL_NC_CREATE_ID, comm);
 
     /* Check if this file is relevant to us */
@@ -42,25 +50,6 @@ int _dvl_ncmpi_create(MPI_Comm comm, const char *opath, int cmode, MPI_Info info
 
     printf("CREATING!\n");   
     if (dvl.is_simulator){
-    	// prepare file descriptor -- similar to open
-    	/* Check if we have file descriptors available */
-        if (dvl.free_files==NULL){
-            printf("Error: too many open files!\n");
-            DVL_ABORT;
-        }        
-
-        size_t pathlen = strlen(path);
-        if (pathlen >= MAX_FILE_NAME){
-            printf("Error: file name too long: %s\n", path);
-            DVL_ABORT;
-        }
-    
-        /* get the next free file descriptor */
-        int fileid = dvl.free_files->id;
-        dvl.free_files = dvl.free_files->trash_next;
-
-        dvl_file_t * dfile = &(dvl.open_files[fileid]);
-
         // only rank 0 sends message
         int mpi_rank;
         MPI_Comm_rank(comm, &mpi_rank);
@@ -76,21 +65,52 @@ int _dvl_ncmpi_create(MPI_Comm comm, const char *opath, int cmode, MPI_Info info
             // fix for race condition
             // simulator result file creation is now synchronous with DV
             dvl_recv_message(buff, BUFFER_SIZE, 1);
-            // nothing needs to be done with the message at the moment.
         }
 
-        // complete file descriptor and insert into hashmap
+        // create is collective: all ranks create the file at the same (possibly redirected) path
+        MPI_Bcast(buff, BUFFER_SIZE, MPI_CHAR, 0, comm);
+
+        const char *create_path = opath;
+        int skip_writes = 0;
+        if (buff[0] == DVL_CREATE_REPLY_REDIRECT || buff[0] == DVL_CREATE_REPLY_REDIRECT_SKIP_WRITES) {
+            // at least a small security check that the path is a /0 terminated string
+            char *redir_path = &buff[2];
+            size_t max_len = BUFFER_SIZE - 4;
+            if (strnlen(redir_path, max_len) < max_len) {
+                if (0 == mpi_rank) {
+                    printf("CREATE of %s is redirected to %s\n", opath, redir_path);
+                }
+                create_path = redir_path;
+                skip_writes = buff[0] == DVL_CREATE_REPLY_REDIRECT_SKIP_WRITES;
+            } else {
+                printf("ERROR: redir path was longer than available buffer size. Using original path that will overwrite the existing file\n");
+            }
+        }
+
+        int retval = (*oncmpi_create)(comm, create_path, cmode, info, ncidp);
+        if (retval != NC_NOERR) {
+            return retval;
+        }
+
+        // file descriptor -- similar to open; keeps the original path (close reports the size
+        // of the existing file for redirected files)
+        /* get a new file descriptor (the table grows on demand) */
+        dvl_file_t * dfile = dvl_file_new(path);
         dfile->ncid = *ncidp;
         dfile->key = *ncidp;
         dfile->omode = cmode;
-        memcpy(dfile->path, path, pathlen + 1);
 
         // add comm and rank & duplicate info
         dfile->comm = comm;
         dfile->rank = mpi_rank;
         MPI_Info_dup(info, &(dfile->info));
+        dfile->skip_writes = skip_writes;
+
+        dvl_files_wrlock(dfile->key);
+        dvl_file_add(dfile);
+        dvl_files_unlock(dfile->key);
 
-        HASH_ADD_INT(dvl.open_files_idx, key, &(dvl.open_files[fileid]));
+        return retval;
     }
 
     return (*oncmpi_create)(comm, opath, cmode, info, ncidp);
@@ -14,12 +14,17 @@
  *      nor with the looked up information in dvl_nc_get
  *      -> this may change in the future.
  *
- * -> note: since each MPI rank can/will ask for different data regions
- *    all ranks send their message individually and not just rank 0
+ * -> note: all bound get functions are collective (*_all). Thus, by default only
+ *    rank 0 of the communicator of the file asks DV and broadcasts the reply
+ *    (see dvl_ncmpi_exchange()). The variable is requested as a whole; the data
+ *    regions of the ranks are not part of the message.
+ *    DV_NCMPI_COLLECTIVE=0: all ranks send their message individually
  *
  * 2017-03-09 / 2017-03-19 ps
  */
 
+#define _DEFAULT_SOURCE
+
 #include <assert.h>
 #include <mpi.h>
 
@@ -31,20 +36,29 @@
 #include "../dvl_internal.h"
 #include "../dvl_proxy.h"
 
+#include "dvl_ncmpi.h"
+
 int dvl_ncmpi_get(int ncid, int varid, const MPI_Offset *start,
                const MPI_Offset *count, void *ip, MPI_Offset bufcount,
                MPI_Datatype buftype) {
 
     char buff[BUFFER_SIZE];        
 	
+    uint32_t mt_rank = 0;
     DVL_CHECK(DVL_NC_GET_ID);   
+#ifndef __MT__
+    mt_rank = dvl.gni.myrank;
+#endif
 
     if (dvl.is_simulator) return ncid;
 
-
-    dvl_file_t * dfile = NULL;
-    HASH_FIND_INT(dvl.open_files_idx, &ncid, dfile);
-    if (dfile==NULL) return ncid;
+    // MT: the shard lock is not kept over the messaging with DV (see dvl_nc_get())
+    dvl_files_rdlock(ncid);
+    dvl_file_t * dfile = dvl_file_find(ncid);
+    if (dfile==NULL) {
+        dvl_files_unlock(ncid);
+        return ncid;
+    }
 
     // nc_inq lookups removed
     // note: the variables were not used at the moment
@@ -52,37 +66,63 @@ int dvl_ncmpi_get(int ncid, int varid, const MPI_Offset *start,
 
     /* if the file is already open, just get the data */
     if (dfile->state == DVL_FILE_OPEN){
-        return dfile->ncid;
+        int id = dfile->ncid;
+        dvl_files_unlock(ncid);
+        return id;
     }
 
+    int state = dfile->state;
+    MPI_Comm comm = dfile->comm;
+    int comm_rank = dfile->rank;
+    const char * dpath = dvl_path_ref(dfile->path);
+    dvl_files_unlock(ncid);
+
     /* ask the dvl for this data, communicate the rank. 
        It can reply with AVAIL or SIMULATING */
     int msgsize = BUFFER_SIZE;
-    MAKE_MESSAGE(buff, msgsize, "%c:%s:%i:%i:", DVL_MSG_VGET, dfile->path, varid, dvl.gni.myrank);
-    if (msgsize<0) return DVL_ERROR;
+    MAKE_MESSAGE(buff, msgsize, "%c:%s:%i:%i:", DVL_MSG_VGET, dpath, varid, mt_rank);
 
-    dvl_send_message(buff, msgsize, 0);
-    
-    /* recv response */
-    dvl_recv_message(buff, BUFFER_SIZE, 1);
+    /* send request and recv response (all ranks get the same reply) */
+    if (dvl_ncmpi_exchange(comm, comm_rank, buff, msgsize) != DVL_SUCCESS) {
+        dvl_path_unref(dpath);
+        return DVL_ERROR;
+    }
    
     if (buff[0] == DVL_REPLY_FILE_OPEN){
         /* if AVAIL just open the file and read from it */
-        assert(dfile->state==DVL_FILE_SIM);
-        dfile->state = DVL_FILE_OPEN;
+        assert(state==DVL_FILE_SIM);
     
-        snprintf(buff, BUFFER_SIZE, "%s%s", dvl.respath, dfile->path);        
-        dvl.ncmpiopen(dfile->comm, buff, dfile->omode, dfile->info, &(dfile->ncid));
-
-        printf("DVL said the file is avail: opening %s\n", buff);
-        return dfile->ncid;
+        snprintf(buff, BUFFER_SIZE, "%s%s", dvl.respath, dpath);        
+
+        // note: the open is collective on dfile->comm; with several threads, each thread
+        // is expected to use its own communicator
+        int id = NC_EBADID;
+        dvl_files_wrlock(ncid);
+        dfile = dvl_file_find(ncid);
+        if (dfile == NULL || dfile->path != dpath) {
+            fprintf(stderr, "dvl_ncmpi_get(): file data structure removed before it could be updated with new info. Check client code.\n");
+        } else if (dfile->state == DVL_FILE_SIM) {
+            dvl.ncmpiopen(dfile->comm, buff, dfile->omode, dfile->info, &(dfile->ncid));
+            dfile->state = DVL_FILE_OPEN;
+            id = dfile->ncid;
+            printf("DVL said the file is avail: opening %s\n", buff);
+        } else {
+            // a get() operation from another thread has been faster -> use that id
+            id = dfile->ncid;
+        }
+        dvl_files_unlock(ncid);
+        dvl_path_unref(dpath);
+
+        return id;
 
     }else if (buff[0] == DVL_REPLY_RDMA){
         /* make RDMA get */
 
+        dvl_path_unref(dpath);
         return -1; /* do not call the original get */
     }
 
+    dvl_path_unref(dpath);
     assert(1!=1);
     return ncid; /* shouldn't be reached */
 }
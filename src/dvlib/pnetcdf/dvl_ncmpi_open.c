@@ -5,7 +5,7 @@
  *    - onc_open -> oncmpi_open with adjusted argument list
  *      note: comm is before path.
  *    - add comm and rank to file descriptor data structure before hash calculation
- *    - only rank 0 sends message -> add check there
+ *    - only rank 0 sends message and broadcasts the reply (see dvl_ncmpi_exchange())
  *    note: each node/rank keeps its own dvl data structure for lookup purpose
  *
  *    - we need to duplicate the MPI_Info structure into the descriptor, too
@@ -14,6 +14,8 @@
  * 2017-03-14 / 2017-03-19 ps
  */
 
+#define _DEFAULT_SOURCE
+
 #include <mpi.h>
 
 #ifndef __NCMPI__
@@ -25,12 +27,17 @@
 #include "../dvl_proxy.h"
 
 #include "pnetcdf_bind.h"
+#include "dvl_ncmpi.h"
 
 int _dvl_ncmpi_open(MPI_Comm comm, const char *opath, int omode, MPI_Info info, int *ncidp, oncmpi_open_t oncmpi_open) {
     char buff[BUFFER_SIZE];        
     char npath[MAX_FILE_NAME];
 
+    uint32_t mt_rank = 0;
     DVL_CHECK_WITH_COMM(DVL_NC_OPEN_ID, comm);
+#ifndef __MT__
+    mt_rank = dvl.gni.myrank;
+#endif
 
     dvl.ncmpiopen = oncmpi_open;
 
@@ -45,43 +52,25 @@ int _dvl_ncmpi_open(MPI_Comm comm, const char *opath, int omode, MPI_Info info,
 
         printf("DVL OPEN!\n");
 
-        /* Check if we have file descriptors available */
-        if (dvl.free_files==NULL){
-            printf("Error: too many open files!\n");
-            DVL_ABORT;
-        }        
-
-        size_t pathlen = strlen(path);
-        if (pathlen >= MAX_FILE_NAME){
-            printf("Error: file name too long: %s\n", path);
-            DVL_ABORT;
-        }
-    
-        /* get the next free file descriptor */
-        int fileid = dvl.free_files->id;
-        dvl.free_files = dvl.free_files->trash_next;
-
-        dvl_file_t * dfile = &(dvl.open_files[fileid]);
+        /* get a new file descriptor (the table grows on demand) */
+        dvl_file_t * dfile = dvl_file_new(path);
 #ifdef BENCH
         //LSB_Set_Rparam_str("restart", simstart);
         LSB_Res();
 #endif
 
         /* send request to the dvl */
-        // only rank 0 sends message
+        // aggregated mode: only rank 0 sends the message and broadcasts the reply (see dvl_ncmpi_exchange())
+        // per-rank mode: each rank asks DV
         int mpi_rank;
         MPI_Comm_rank(comm, &mpi_rank);
-        if (0 == mpi_rank) {
-
-            int msgsize = BUFFER_SIZE;
 
-            MAKE_MESSAGE(buff, msgsize, "%c:%s:%i:file=%s;gni_addr=%u", DVL_MSG_FOPEN, path, dvl.gni.myrank, path, dvl.gni.addr);
+        int msgsize = BUFFER_SIZE;
+        MAKE_MESSAGE(buff, msgsize, "%c:%s:%i:file=%s;gni_addr=%u", DVL_MSG_FOPEN, path, mt_rank, path, dvl.gni.addr);
 
-            if (msgsize<0) return DVL_ERROR;
-            dvl_send_message(buff, msgsize, 0);
-    
-            /* recv response */
-            dvl_recv_message(buff, BUFFER_SIZE, 1);
+        if (dvl_ncmpi_exchange(comm, mpi_rank, buff, msgsize) != DVL_SUCCESS) {
+            dvl_file_delete(dfile);
+            return DVL_ERROR;
         }
 
         int res; /* it has to be a valid ncid*/
@@ -102,7 +91,6 @@ int _dvl_ncmpi_open(MPI_Comm comm, const char *opath, int omode, MPI_Info info,
         dfile->ncid = *ncidp;
         dfile->key = *ncidp;
         dfile->omode = omode;
-        memcpy(dfile->path, path, pathlen + 1);
 
         // add comm and rank & duplicate info
         dfile->comm = comm;
@@ -110,9 +98,11 @@ int _dvl_ncmpi_open(MPI_Comm comm, const char *opath, int omode, MPI_Info info,
         MPI_Info_dup(info, &(dfile->info));
 
 
-        HASH_ADD_INT(dvl.open_files_idx, key, &(dvl.open_files[fileid]));
+        dvl_files_wrlock(dfile->key);
+        dvl_file_add(dfile);
+        dvl_files_unlock(dfile->key);
          
-        DVLPRINT("DVL_NC_OPEN: %s; fileid: %i; idx cnt: %u; res: %i; key: %i\n", path, fileid, HASH_COUNT(dvl.open_files_idx), res, *ncidp); 
+        DVLPRINT("DVL_NC_OPEN: %s; open files: %u; res: %i; key: %i\n", path, dvl.open_files_active, res, *ncidp); 
 
         return res; 
     }else{ /* we don't care about the simulator */
@@ -29,6 +29,8 @@
  * 2017-03-09 / 2017-03-19 ps
  */
 
+#define _DEFAULT_SOURCE
+
 #include <assert.h>
 #include <mpi.h>
 
@@ -59,6 +61,18 @@ void stringify_MPI_Offset_array(char * buff, size_t bsize, const MPI_Offset * ar
 int dvl_ncmpi_put(int ncid, int varid, const MPI_Offset *start,
                const MPI_Offset *count, const void *op,
                MPI_Offset bufcount, MPI_Datatype buftype) {
+    // redirected result file of a re-simulation (DVL_CREATE_REPLY_REDIRECT_SKIP_WRITES): DV keeps the
+    // existing file and removes the redirected one -> no rank writes the data (see _dvl_ncmpi_create)
+    if (dvl.enabled && dvl.is_simulator) {
+        dvl_files_rdlock(ncid);
+        dvl_file_t * rfile = dvl_file_find(ncid);
+        int skip_writes = rfile != NULL && rfile->skip_writes;
+        dvl_files_unlock(ncid);
+        if (skip_writes) {
+            return DVL_PREVENT_WRITING_DATA_DURING_REDIRECT;
+        }
+    }
+
 #ifdef SEND_PUT_MESSAGE
     char buff[BUFFER_SIZE];
     char pathbuff[MAX_FILE_NAME];
@@ -71,6 +85,9 @@ int dvl_ncmpi_put(int ncid, int varid, const MPI_Offset *start,
     countstr[0] = '\0';
     startstr[0] = '\0';
 
+#ifdef __MT__
+    uint32_t mt_rank = 0;
+#endif
     DVL_CHECK(DVL_NC_PUT_ID);
 
 	dvl_file_t * dfile = NULL;
@@ -85,8 +102,10 @@ int dvl_ncmpi_put(int ncid, int varid, const MPI_Offset *start,
         ncmpi_inq_var(ncid, varid, NULL, NULL, &ndims, NULL, NULL);
 
         // path lookup through dvl hashmap instead of nc_inq_path
-        HASH_FIND_INT(dvl.open_files_idx, &ncid, dfile);
+        dvl_files_rdlock(ncid);
+        dfile = dvl_file_find(ncid);
         if (NULL == dfile) {
+            dvl_files_unlock(ncid);
             // file unknown -> default function will handle it
             return ncid;
         }
@@ -97,6 +116,7 @@ int dvl_ncmpi_put(int ncid, int varid, const MPI_Offset *start,
             DVL_ABORT;
         }
         memcpy(pathbuff, dfile->path, pathlen + 1);
+        dvl_files_unlock(ncid);
 
         char * path = is_result_file(pathbuff, npath);
         if (path==NULL) return ncid;
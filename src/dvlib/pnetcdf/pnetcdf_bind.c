@@ -86,6 +86,7 @@ int ncmpi_put_vara_all(int ncid, int varid, const MPI_Offset *start,
     oncmpi_put_vara_all_t original = dlsym(RTLD_NEXT, "ncmpi_put_vara_all");
     int res = dvl_ncmpi_put(ncid, varid, start, count, op, bufcount, buftype);
     if (res>=0) return (*original)(res, varid, start, count, op, bufcount, buftype);
+    if (res == DVL_PREVENT_WRITING_DATA_DURING_REDIRECT) return NC_NOERR;
     return res;
 }
 
@@ -94,6 +95,7 @@ int ncmpi_put_vara_int(int ncid, int varid, const MPI_Offset *start,
     oncmpi_put_vara_int_all_t original = dlsym(RTLD_NEXT, "ncmpi_put_vara_int");
     int res = dvl_ncmpi_put(ncid, varid, start, count, op, -1, MPI_INT);
     if (res>=0) return (*original)(res, varid, start, count, op);
+    if (res == DVL_PREVENT_WRITING_DATA_DURING_REDIRECT) return NC_NOERR;
     return res;
 }
 
@@ -102,6 +104,7 @@ int ncmpi_put_vara_double_all(int ncid, int varid, const MPI_Offset *start,
     oncmpi_put_vara_double_all_t original = dlsym(RTLD_NEXT, "ncmpi_put_vara_double_all");
     int res = dvl_ncmpi_put(ncid, varid, start, count, op, -1, MPI_DOUBLE);
     if (res>=0) return (*original)(res, varid, start, count, op);
+    if (res == DVL_PREVENT_WRITING_DATA_DURING_REDIRECT) return NC_NOERR;
     return res;
 }
 
@@ -110,6 +113,7 @@ int ncmpi_put_vara_float_all(int ncid, int varid, const MPI_Offset *start,
     oncmpi_put_vara_float_all_t original = dlsym(RTLD_NEXT, "ncmpi_put_vara_float_all");
     int res = dvl_ncmpi_put(ncid, varid, start, count, op, -1, MPI_FLOAT);
     if (res>=0) return (*original)(res, varid, start, count, op);
+    if (res == DVL_PREVENT_WRITING_DATA_DURING_REDIRECT) return NC_NOERR;
     return res;
 }
 
@@ -118,6 +122,7 @@ int ncmpi_put_vara_text_all(int ncid, int varid, const MPI_Offset *start,
     oncmpi_put_vara_text_all_t original = dlsym(RTLD_NEXT, "ncmpi_put_vara_text_all");
     int res = dvl_ncmpi_put(ncid, varid, start, count, op, -1, MPI_CHAR);
     if (res>=0) return (*original)(res, varid, start, count, op);
+    if (res == DVL_PREVENT_WRITING_DATA_DURING_REDIRECT) return NC_NOERR;
     return res;
 }
 